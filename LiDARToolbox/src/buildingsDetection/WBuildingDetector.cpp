@@ -23,7 +23,11 @@
 //---------------------------------------------------------------------------
 
 #include <iostream>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
 
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "WBuildingDetector.h"
 
 WBuildingDetector::WBuildingDetector()
@@ -43,20 +47,17 @@ WBuildingDetector::~WBuildingDetector()
 void WBuildingDetector::detectBuildings( boost::shared_ptr< WDataSetPoints > points )
 {
     WDataSetPoints::VertexArray verts = points->getVertices();
-    size_t count = verts->size()/3;
     WOctree* zones3d = new WOctree( m_detailDepth );
     WQuadTree* zones2d = new WQuadTree( m_detailDepth );
     WQuadTree* minimalMaxima = new WQuadTree( m_minSearchDetailDepth );
     WQuadTree* targetShowables = new WQuadTree( m_detailDepth );
     m_targetGrouped3d = new WOctree( m_detailDepth );
-    for( size_t vertex = 0; vertex < count; vertex++ )
-    {
-        float x = verts->at( vertex*3 );
-        float y = verts->at( vertex*3+1 );
-        float z = verts->at( vertex*3+2 );
-        zones3d->registerPoint( x, y, z );
-        zones2d->registerPoint( x, y, z );
-    }
+    void ( WOctree::*registerOctreePoints )( const vector<float>& ) = &WOctree::registerPoints;
+    void ( WQuadTree::*registerQuadTreePoints )( const vector<float>& ) = &WQuadTree::registerPoints;
+    vector< boost::function<void ()> > treeBuilds;
+    treeBuilds.push_back( boost::bind( registerOctreePoints, zones3d, boost::cref( *verts ) ) );
+    treeBuilds.push_back( boost::bind( registerQuadTreePoints, zones2d, boost::cref( *verts ) ) );
+    WThreadPool::getSharedPool()->parallelInvoke( treeBuilds );
     initMinimalMaxima( zones2d->getRootNode(), minimalMaxima );
     projectDrawableAreas( zones2d->getRootNode(), minimalMaxima, targetShowables );
 
@@ -26,8 +26,57 @@
 #include <iostream>
 #include <fstream>
 
+#include "../threadPool/WThreadPool.h"
 #include "WBmpImage.h"
 
+/**
+ * Thread pool task that draws the rows of an elevation image.
+ */
+class WBmpElevationImageTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param image Image to draw.
+     * \param leafGrid Leaf grid of the drawn quadtree.
+     * \param elevImageMode Mode of the elevation image.
+     */
+    WBmpElevationImageTask( WBmpImage* image, WQuadLeafGrid* leafGrid, size_t elevImageMode )
+    {
+        m_image = image;
+        m_leafGrid = leafGrid;
+        m_elevImageMode = elevImageMode;
+    }
+
+    /**
+     * Draws a range of image rows.
+     * \param begin First row.
+     * \param end Row after the last row.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t y = begin; y < end; y++ )
+            m_image->drawElevationImageRow( m_leafGrid, y, m_elevImageMode );
+    }
+
+private:
+    /**
+     * Image to draw.
+     */
+    WBmpImage* m_image;
+
+    /**
+     * Leaf grid of the drawn quadtree.
+     */
+    WQuadLeafGrid* m_leafGrid;
+
+    /**
+     * Mode of the elevation image.
+     */
+    size_t m_elevImageMode;
+};
 
 WBmpImage::WBmpImage( size_t sizeX, size_t sizeY )
 {
@@ -53,37 +102,25 @@ void WBmpImage::resizeImage( size_t sizeX, size_t sizeY )
 {
     m_sizeX = sizeX;
     m_sizeY = sizeY;
-    size_t size = sizeX * sizeY;
-    m_dataR.reserve( size );
-    m_dataG.reserve( size );
-    m_dataB.reserve( size );
-    m_dataR.resize( size );
-    m_dataG.resize( size );
-    m_dataB.resize( size );
-    for( size_t index = 0; index < size; index++ )
-    {
-        m_dataB[index] = 0;
-        m_dataG[index] = 0;
-        m_dataB[index] = 0;
-    }
+    m_data.assign( sizeX * sizeY * 3, 0 );
 }
 
 size_t WBmpImage::getR( size_t x, size_t y )
 {
     if( x >= m_sizeX || y >= m_sizeY ) return 0;
-    return m_dataR[getIndex( x, y )];
+    return m_data[getIndex( x, y ) * 3 + 2];
 }
 
 size_t WBmpImage::getG( size_t x, size_t y )
 {
     if( x >= m_sizeX || y >= m_sizeY ) return 0;
-    return m_dataG[getIndex( x, y )];
+    return m_data[getIndex( x, y ) * 3 + 1];
 }
 
 size_t WBmpImage::getB( size_t x, size_t y )
 {
     if( x >= m_sizeX || y >= m_sizeY ) return 0;
-    return m_dataB[getIndex( x, y )];
+    return m_data[getIndex( x, y ) * 3 + 0];
 }
 
 size_t WBmpImage::getA( size_t x, size_t y )
@@ -100,10 +137,15 @@ void WBmpImage::setPixel( size_t x, size_t y, size_t intensity )
 void WBmpImage::setPixel( size_t x, size_t y, size_t r, size_t g, size_t b )
 {
     if( x >= m_sizeX || y >= m_sizeY ) return;
-    size_t index = getIndex( x, y );
-    m_dataR[index] = r < 256 ?r :255;
-    m_dataG[index] = g < 256 ?g :255;
-    m_dataB[index] = b < 256 ?b :255;
+    size_t index = getIndex( x, y ) * 3;
+    m_data[index] = b < 256 ?b :255;
+    m_data[index + 1] = g < 256 ?g :255;
+    m_data[index + 2] = r < 256 ?r :255;
+}
+
+const unsigned char* WBmpImage::getRowData( size_t y )
+{
+    return &m_data[getIndex( 0, y ) * 3];
 }
 
 size_t WBmpImage::getIndex( size_t x, size_t y )
@@ -115,37 +157,32 @@ size_t WBmpImage::getIndex( size_t x, size_t y )
 
 void WBmpImage::importElevationImage( WQuadTree* quadTree, size_t elevImageMode )
 {
-    WQuadNode* rootNode = quadTree->getRootNode();
-    double width = quadTree->getBin( rootNode->getXMax() ) - quadTree->getBin( rootNode->getXMin() ) + 1.0;
-    double height = quadTree->getBin( rootNode->getYMax() ) - quadTree->getBin( rootNode->getYMin() ) + 1.0;
-    resizeImage( width, height );
-    for( size_t y = 0; y < getSizeY(); y++ )
-        for( size_t x = 0 ; x < getSizeX(); x++ )
-            setPixel( x, y, 255, 0, 0 );
-
-    importElevationImageDrawNode( rootNode, quadTree, elevImageMode );
+    WQuadLeafGrid leafGrid;
+    leafGrid.importQuadTree( quadTree );
+    resizeImage( leafGrid.getSizeX(), leafGrid.getSizeY() );
+    WBmpElevationImageTask task( this, &leafGrid, elevImageMode );
+    WThreadPool::getSharedPool()->parallelFor( &task, getSizeY() );
 }
 
-void WBmpImage::importElevationImageDrawNode( WQuadNode* node, WQuadTree* quadTree, size_t elevImageMode )
+void WBmpImage::drawElevationImageRow( WQuadLeafGrid* leafGrid, size_t y, size_t elevImageMode )
 {
-    if( node->getRadius() <= quadTree->getDetailLevel() )
+    for( size_t x = 0; x < getSizeX(); x++ )
     {
+        size_t leaf = leafGrid->getLeafIndex( x, y );
+        if( leaf == WQuadLeafGrid::noLeaf )
+        {
+            setPixel( x, y, 255, 0, 0 );
+            continue;
+        }
+        WQuadNode* node = leafGrid->getLeaf( leaf );
         int intensity = ( ( elevImageMode != 0
                 ?node->getValueMax() :node->getValueMin() )
                 - m_minElevImageZ ) * m_intensityIncreasesPerMeter;
         if(elevImageMode == 2) intensity = node->getPointCount();
         if( intensity < 0 ) intensity = 0;
         if( intensity > 255 ) intensity = 255;
-        double x = quadTree->getBin( node->getCenter( 0 ) ) - quadTree->getBin( quadTree->getRootNode()->getXMin() );
-        double y = quadTree->getBin( node->getCenter( 1 ) ) - quadTree->getBin( quadTree->getRootNode()->getYMin() );
         setPixel( x, y, intensity );
     }
-    else
-    {
-        for  ( size_t child = 0; child < 4; child++ )
-            if  ( node->getChild( child ) != 0 )
-                importElevationImageDrawNode( node->getChild( child ), quadTree, elevImageMode );
-    }
 }
 
 void WBmpImage::setExportElevationImageSettings( double minElevImageZ, double intensityIncreasesPerMeter )
@@ -28,6 +28,7 @@
 
 #include <vector>
 
+#include "../../datastructures/quadtree/WQuadLeafGrid.h"
 #include "../../datastructures/quadtree/WQuadNode.h"
 #include "../../datastructures/quadtree/WQuadTree.h"
 #include "../../datastructures/octree/WOctree.h"
@@ -120,10 +121,18 @@ public:
      */
     void setPixel( size_t x, size_t y, size_t r, size_t g, size_t b );
 
+    /**
+     * Returns the pixel data of an image row. Each pixel consists of its blue, green and 
+     * red value as in bmp files.
+     * \param y Pixel index on Y axis (0 to height-1).
+     * \return The blue, green and red values of the row's pixels.
+     */
+    const unsigned char* getRowData( size_t y );
 
     /**
      * Imports Quadtree data to the bitmap image. The Quadtree is aligned automatically by 
-     * the data voxels (currently only smallest possible leafs).
+     * the data voxels (currently only smallest possible leafs). The leafs are put into a 
+     * grid and the image rows are drawn in parallel.
      * \param quadTree Elevation image that is imported to the bitmap image.
      * \param elevImageMode Mode oft the elevation image.
      *                      0: Minimal Z values each X/Y bin coordinate.
@@ -148,12 +157,23 @@ public:
      */
     void highlightBuildingGroups( boost::shared_ptr< WDataSetPointsGrouped >  groupedPoints, WQuadTree* quadTree );
 
+    /**
+     * Draws an image row of an elevation image. Pixels without a quadtree leaf become red.
+     * \param leafGrid Leaf grid of the quadtree that is drawn. Its cells are the pixels.
+     * \param y Pixel index on Y axis (0 to height-1).
+     * \param elevImageMode Mode of the elevation image.
+     *                      0: Minimal Z value each X/Y bin coordinate.
+     *                      1: Maximal Z value each X/Y bin coordinate.
+     *                      2: Point count each X/Y bin coordinate.
+     */
+    void drawElevationImageRow( WQuadLeafGrid* leafGrid, size_t y, size_t elevImageMode );
+
 private:
     /**
      * Returns the color data vector index using X and Y coordinates.
      * \param x X coordinate of the image.
      * \param y Y coordinate of the image.
-     * \return The suuitable color data vector index (e. g. for m_dataG).
+     * \return The suuitable pixel index of m_data.
      */
     size_t getIndex( size_t x, size_t y );
 
@@ -168,22 +188,11 @@ private:
     size_t m_sizeY;
 
     /**
-     * Image red color intensity data. The order corresponds to the following pixel traversing.
-     * It traverses linewise each starting at Y=0 from first to last X value.
-     */
-    std::vector<size_t> m_dataR;
-
-    /**
-     * Image green color intensity data. The order corresponds to the following pixel traversing.
-     * It traverses linewise each starting at Y=0 from first to last X value.
-     */
-    std::vector<size_t> m_dataG;
-
-    /**
-     * Image blue color intensity data. The order corresponds to the following pixel traversing.
-     * It traverses linewise each starting at Y=0 from first to last X value.
+     * Image color intensity data. Each pixel consists of its blue, green and red value. 
+     * The order corresponds to the following pixel traversing. It traverses linewise each 
+     * starting at Y=0 from first to last X value.
      */
-    std::vector<size_t> m_dataB;
+    std::vector<unsigned char> m_data;
 
     /**
      * Elevation image export setting.
@@ -196,18 +205,6 @@ private:
      * Intensity increase count per meter.
      */
     double m_intensityIncreasesPerMeter;
-
-    /**
-     * Draws a quadtree leaf node to the bmp file. All subchildren will also be drawn.
-     * \param node Quadtree node to draw
-     * \param quadTree Quadtree that is drawn. Method knows where to draw points on the image 
-     *                 using mandatory parameters (puxel size, x/y min/max etc.).
-     * \param elevImageMode Mode of the elevation image.
-     *                      0: Minimal Z value each X/Y bin coordinate.
-     *                      1: Maximal Z value each X/Y bin coordinate.
-     *                      2: Point count each X/Y bin coordinate.
-     */
-    void importElevationImageDrawNode( WQuadNode* node, WQuadTree* quadTree, size_t elevImageMode );
 };
 
 #endif  // WBMPIMAGE_H
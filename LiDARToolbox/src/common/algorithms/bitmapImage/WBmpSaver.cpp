@@ -103,15 +103,8 @@ void WBmpSaver::saveImage( WBmpImage* image, const char* path )
 
     for( int y = 0; y < h; y++ )
     {
-        for( int x = 0; x < w; x++ )
-        {
-            unsigned char pixel[3];
-            pixel[0] = image->getB( x, y );
-            pixel[1] = image->getG( x, y );
-            pixel[2] = image->getR( x, y );
-
-            stream.write( reinterpret_cast<char*>( pixel ), 3 );
-        }
+        if( w > 0 )
+            stream.write( reinterpret_cast<const char*>( image->getRowData( y ) ), w * 3 );
         stream.write( reinterpret_cast<char*>( pad ), padSize );
     }
     stream.close();
@@ -24,12 +24,16 @@
 
 
 #include <stdio.h>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "WPointSaver.h"
 WPointSaver::WPointSaver()
 {
@@ -151,6 +155,9 @@ bool WPointSaver::load()
     m_colors = outColors;
     m_groups = outGroups;
 
+    if( pathEndsWith( m_hasGroupInfo ?EXTENSION_WDATASETPOINTSGROUPED_BINARY :EXTENSION_WDATASETPOINTS_BINARY, m_filePath ) )
+        return loadBinary();
+
     const char* extension = m_hasGroupInfo ?EXTENSION_WDATASETPOINTSGROUPED :EXTENSION_WDATASETPOINTS;
     const string tmp = m_filePath->str();
     const char* path = tmp.c_str();
@@ -208,9 +215,92 @@ bool WPointSaver::load()
     return m_verts->size() > 0;
 }
 
+bool WPointSaver::loadBinary()
+{
+    const string path = m_filePath->str();
+    cout << "Attempting to load binary file: " << path << endl;
+    try
+    {
+        boost::interprocess::file_mapping file( path.c_str(), boost::interprocess::read_only );
+        boost::interprocess::mapped_region region( file, boost::interprocess::read_only );
+        const char* data = static_cast<const char*>( region.get_address() );
+        size_t fileSize = region.get_size();
+        if( fileSize < BINARY_HEADER_SIZE || std::memcmp( data, BINARY_MAGIC, sizeof( BINARY_MAGIC ) ) != 0 )
+        {
+            cout << "!!!No binary point file" << endl;
+            return false;
+        }
+
+        boost::uint32_t version = 0;
+        boost::uint32_t flags = 0;
+        boost::uint64_t pointCount = 0;
+        boost::uint64_t blockOffsets[3] = { 0, 0, 0 };
+        std::memcpy( &version, data + 8, sizeof( version ) );
+        std::memcpy( &flags, data + 12, sizeof( flags ) );
+        std::memcpy( &pointCount, data + 16, sizeof( pointCount ) );
+        std::memcpy( blockOffsets, data + 72, sizeof( blockOffsets ) );
+        if( version != BINARY_VERSION || ( m_hasGroupInfo && ( flags & 1 ) == 0 ) )
+        {
+            cout << "!!!Unsupported binary point file version or content" << endl;
+            return false;
+        }
+        boost::uint64_t blockSizes[3] = { pointCount * 3 * sizeof( float ), pointCount * 3 * sizeof( float ),
+                ( flags & 1 ) != 0 ?pointCount * sizeof( boost::uint64_t ) :0 };
+        for( size_t block = 0; block < 3; block++ )
+            if( pointCount > fileSize || blockOffsets[block] > fileSize || blockSizes[block] > fileSize - blockOffsets[block] )
+            {
+                cout << "!!!Truncated binary point file" << endl;
+                return false;
+            }
+
+        size_t count = static_cast<size_t>( pointCount );
+        m_verts->resize( count * 3 );
+        m_colors->resize( count * 3 );
+        if( count > 0 )
+        {
+            std::memcpy( &( *m_verts )[0], data + blockOffsets[0], count * 3 * sizeof( float ) );
+            std::memcpy( &( *m_colors )[0], data + blockOffsets[1], count * 3 * sizeof( float ) );
+        }
+        if( m_hasGroupInfo )
+        {
+            m_groups->resize( count );
+            const char* groupData = data + blockOffsets[2];
+            if( sizeof( size_t ) == sizeof( boost::uint64_t ) && count > 0 )
+            {
+                std::memcpy( &( *m_groups )[0], groupData, count * sizeof( size_t ) );
+            }
+            else
+            {
+                for( size_t index = 0; index < count; index++ )
+                {
+                    boost::uint64_t group = 0;
+                    std::memcpy( &group, groupData + index * sizeof( group ), sizeof( group ) );
+                    ( *m_groups )[index] = static_cast<size_t>( group );
+                }
+            }
+        }
+        m_containsData = m_containsData || count > 0;
+    }
+    catch( const boost::interprocess::interprocess_exception& exception )
+    {
+        cout << "!!!Could not map the point file: " << exception.what() << endl;
+        return false;
+    }
+
+    cout << "Vertices: " << m_verts->size() << endl;
+    cout << "Colors: " << m_colors->size() << endl;
+    cout << "Groups: " << m_groups->size() << endl;
+    return m_verts->size() > 0;
+}
+
 void WPointSaver::save()
 {
     cout << "Attempting to save pointfile" << endl;
+    if( pathEndsWith( m_hasGroupInfo ?EXTENSION_WDATASETPOINTSGROUPED_BINARY :EXTENSION_WDATASETPOINTS_BINARY, m_filePath ) )
+    {
+        saveBinary();
+        return;
+    }
     if( !correctFilePathByExtension() )
         return;
 
@@ -244,6 +334,58 @@ void WPointSaver::save()
     cout << "Saved point file: " << m_filePath->str() << endl;
 }
 
+void WPointSaver::saveBinary()
+{
+    const string path = m_filePath->str();
+    size_t pointCount = m_verts->size() / 3;
+    double bounds[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    for( size_t index = 0; index < pointCount; index++ )
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+        {
+            double coordinate = ( *m_verts )[index * 3 + dimension];
+            if( coordinate < bounds[dimension] || index == 0 )
+                bounds[dimension] = coordinate;
+            if( coordinate > bounds[3 + dimension] || index == 0 )
+                bounds[3 + dimension] = coordinate;
+        }
+
+    boost::uint32_t flags = m_hasGroupInfo ?1 :0;
+    boost::uint64_t count = pointCount;
+    boost::uint64_t blockOffsets[3] = { BINARY_HEADER_SIZE, BINARY_HEADER_SIZE + count * 3 * sizeof( float ),
+            BINARY_HEADER_SIZE + count * 6 * sizeof( float ) };
+    ofstream stream;
+    remove( path.c_str() );
+    stream.open( path.c_str(), std::ios::out | std::ios::binary );
+    stream.write( BINARY_MAGIC, sizeof( BINARY_MAGIC ) );
+    stream.write( reinterpret_cast<const char*>( &BINARY_VERSION ), sizeof( BINARY_VERSION ) );
+    stream.write( reinterpret_cast<const char*>( &flags ), sizeof( flags ) );
+    stream.write( reinterpret_cast<const char*>( &count ), sizeof( count ) );
+    stream.write( reinterpret_cast<const char*>( bounds ), sizeof( bounds ) );
+    stream.write( reinterpret_cast<const char*>( blockOffsets ), sizeof( blockOffsets ) );
+    if( pointCount > 0 )
+    {
+        stream.write( reinterpret_cast<const char*>( &( *m_verts )[0] ), pointCount * 3 * sizeof( float ) );
+        stream.write( reinterpret_cast<const char*>( &( *m_colors )[0] ), pointCount * 3 * sizeof( float ) );
+    }
+    if( m_hasGroupInfo && pointCount > 0 )
+    {
+        if( sizeof( size_t ) == sizeof( boost::uint64_t ) )
+        {
+            stream.write( reinterpret_cast<const char*>( &( *m_groups )[0] ), pointCount * sizeof( size_t ) );
+        }
+        else
+        {
+            vector<boost::uint64_t> groups( m_groups->begin(), m_groups->begin() + pointCount );
+            stream.write( reinterpret_cast<const char*>( &groups[0] ), pointCount * sizeof( boost::uint64_t ) );
+        }
+    }
+    stream.close();
+    if( !stream )
+        cout << "!!!Could not save the binary point file: " << path << endl;
+    else
+        cout << "Saved binary point file: " << path << endl;
+}
+
 bool WPointSaver::isNumberChar( const char sign )
 {
     for( char index = '0'; index <= '9'; index++)
@@ -284,3 +426,13 @@ void WPointSaver::fetchNumberCharsFromLine( string line )
 const char* WPointSaver::EXTENSION_WDATASETPOINTS = ".points";
 
 const char* WPointSaver::EXTENSION_WDATASETPOINTSGROUPED = ".groups";
+
+const char* WPointSaver::EXTENSION_WDATASETPOINTS_BINARY = ".pointsbin";
+
+const char* WPointSaver::EXTENSION_WDATASETPOINTSGROUPED_BINARY = ".groupsbin";
+
+const char WPointSaver::BINARY_MAGIC[8] = { 'W', 'P', 'T', 'S', 'B', 'I', 'N', '\0' };
+
+const boost::uint32_t WPointSaver::BINARY_VERSION = 1;
+
+const size_t WPointSaver::BINARY_HEADER_SIZE = 96;
@@ -30,6 +30,8 @@
 #include <vector>
 #include <string>
 
+#include <boost/cstdint.hpp>
+
 #include "../../datastructures/WDataSetPointsGrouped.h"
 
 using std::cout;
@@ -54,7 +56,17 @@ using std::vector;
  *   - loadWDataSetPoints() or loadWDataSetPointsGrouped()
  *   - Check whether containsData()
  *   - getVertices(), getColors() and getGroups()
- * //TODO(aschwarzkopf): Still very very slow using very big datasets.
+ *
+ * Files are written as text with one point per line unless the path ends with the 
+ * binary extension ".pointsbin" or ".groupsbin". The binary format consists of:
+ *   - 8 byte magic "WPTSBIN" and a 32 bit format version
+ *   - 32 bit flags (1 = has group IDs) and the 64 bit point count
+ *   - Minimal and maximal X/Y/Z coordinate as doubles
+ *   - 64 bit byte offsets of the vertex, color and group ID block
+ *   - Vertex and color block of 3 floats per point and the group ID block of one 64 bit 
+ *     integer per point.
+ * All values have the byte order of the saving machine. Binary files are loaded by 
+ * mapping them into memory and copying the blocks without any parsing.
  */
 class WPointSaver
 {
@@ -157,11 +169,22 @@ private:
      */
     bool load();
 
+    /**
+     * Loads point dataset from a binary file.
+     * \return File was successfully loaded or not.
+     */
+    bool loadBinary();
+
     /**
      * Writes point data to a file.
      */
     void save();
 
+    /**
+     * Writes point data to a binary file.
+     */
+    void saveBinary();
+
     /**
      * Separates a single string representing numbers to several character sets. Their 
      * count corresponds to the count of numbers. 
@@ -211,6 +234,31 @@ private:
      */
     static const char* EXTENSION_WDATASETPOINTSGROUPED;
 
+    /**
+     * Extension for binary WDataSetPoints point data files.
+     */
+    static const char* EXTENSION_WDATASETPOINTS_BINARY;
+
+    /**
+     * Extension for binary WDataSetPointsGrouped point data files.
+     */
+    static const char* EXTENSION_WDATASETPOINTSGROUPED_BINARY;
+
+    /**
+     * Leading bytes of binary point data files.
+     */
+    static const char BINARY_MAGIC[8];
+
+    /**
+     * Version of the binary point data format.
+     */
+    static const boost::uint32_t BINARY_VERSION;
+
+    /**
+     * Byte count of the binary point data file header.
+     */
+    static const size_t BINARY_HEADER_SIZE;
+
     /**
      * Current row of read in numbers from a file that has further to be parsed
      */
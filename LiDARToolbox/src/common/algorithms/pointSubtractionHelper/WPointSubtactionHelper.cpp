@@ -22,16 +22,131 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
 #include <vector>
+
+#include "../threadPool/WThreadPool.h"
+#include "../../math/mortonCode/WMortonCode.h"
 #include "WPointSubtactionHelper.h"
 
+using std::pair;
+
+const size_t WPointSubtactionHelper::noCell = static_cast<size_t>( -1 );
+
+/**
+ * Thread pool task that calculates the grid cube keys of the subtracted points.
+ */
+class WPointSubtractionKeyTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param helper Subtraction helper that calculates the keys.
+     * \param vertices Interleaved X/Y/Z coordinates of the subtracted points.
+     * \param pointKeys Output cube key and index of each point.
+     */
+    WPointSubtractionKeyTask( WPointSubtactionHelper* helper, WDataSetPoints::VertexArray vertices,
+            vector< pair<boost::uint64_t, size_t> >* pointKeys )
+    {
+        m_helper = helper;
+        m_vertices = vertices;
+        m_pointKeys = pointKeys;
+    }
+
+    /**
+     * Calculates the keys of a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            ( *m_pointKeys )[index] = pair<boost::uint64_t, size_t>( WPointSubtactionHelper::getCellKey(
+                    m_helper->getCellCoordinate( m_vertices->at( index * 3 ) ),
+                    m_helper->getCellCoordinate( m_vertices->at( index * 3 + 1 ) ),
+                    m_helper->getCellCoordinate( m_vertices->at( index * 3 + 2 ) ) ), index );
+    }
+
+private:
+    /**
+     * Subtraction helper that calculates the keys.
+     */
+    WPointSubtactionHelper* m_helper;
+
+    /**
+     * Interleaved X/Y/Z coordinates of the subtracted points.
+     */
+    WDataSetPoints::VertexArray m_vertices;
+
+    /**
+     * Output cube key and index of each point.
+     */
+    vector< pair<boost::uint64_t, size_t> >* m_pointKeys;
+};
+
+/**
+ * Thread pool task that tests coordinates for subtracted points nearby.
+ */
+class WPointSubtractionSearchTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param helper Subtraction helper that tests the coordinates.
+     * \param coordinates Interleaved X/Y/Z coordinates to be tested.
+     * \param pointsExist Output flag of each coordinate. Bytes are used instead of bits 
+     *                    so that threads never write to the same element.
+     */
+    WPointSubtractionSearchTask( WPointSubtactionHelper* helper, const vector<float>& coordinates,
+            vector<unsigned char>* pointsExist ) :
+        m_coordinates( coordinates )
+    {
+        m_helper = helper;
+        m_pointsExist = pointsExist;
+    }
+
+    /**
+     * Tests a range of coordinates.
+     * \param begin First coordinate index of the range.
+     * \param end Index after the last coordinate of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            ( *m_pointsExist )[index] = m_helper->pointsExistNearCoordinate( m_coordinates[index * 3],
+                    m_coordinates[index * 3 + 1], m_coordinates[index * 3 + 2] ) ?1 :0;
+    }
+
+private:
+    /**
+     * Subtraction helper that tests the coordinates.
+     */
+    WPointSubtactionHelper* m_helper;
+
+    /**
+     * Interleaved X/Y/Z coordinates to be tested.
+     */
+    const vector<float>& m_coordinates;
+
+    /**
+     * Output flag of each coordinate.
+     */
+    vector<unsigned char>* m_pointsExist;
+};
 
 WPointSubtactionHelper::WPointSubtactionHelper()
 {
-    m_searchTree = new WKdTreeND( 3 );
-    m_pointSearcher.setExaminedKdTree( m_searchTree );
-    m_pointSearcher.setMaxResultPointCountInfinite();
-    m_pointSearcher.setMaxSearchDistance( 0.0 );
+    m_subtractionRadius = 0.0;
+    m_searchExtent = 0.0;
+    m_cellSize = 1.0;
+    m_hashBits = 0;
+    m_cellPointOffsets.push_back( 0 );
 }
 
 WPointSubtactionHelper::~WPointSubtactionHelper()
@@ -40,37 +155,164 @@ WPointSubtactionHelper::~WPointSubtactionHelper()
 
 void WPointSubtactionHelper::initSubtraction( boost::shared_ptr< WDataSetPoints > pointsToSubtract, double subtractionRadius )
 {
-    delete m_searchTree;
-    m_searchTree = new WKdTreeND( 3 );
-
+    m_points.clear();
+    m_pointIndices.clear();
+    m_cellKeys.clear();
+    m_cellPointOffsets.assign( 1, 0 );
+    m_hashSlots.clear();
+    m_cellFilter.clear();
+    m_hashBits = 0;
     if( !pointsToSubtract )
-    {
-        m_searchTree = 0;
         return;
-    }
-    vector<WKdPointND*>* points = new vector<WKdPointND*>();
     WDataSetPoints::VertexArray vertices = pointsToSubtract->getVertices();
-    if( vertices->size() == 0 )
-    {
-        m_searchTree = 0;
+    size_t pointCount = vertices->size() / 3;
+    if( pointCount == 0 )
         return;
-    }
 
-    for( size_t index = 0; index < vertices->size() / 3; index++ )
-        points->push_back( new WKdPointND( vertices->at( index*3 + 0 ),
-                                           vertices->at( index*3 + 1 ),
-                                           vertices->at( index*3 + 2 ) ) );
+    // The searched cubes are taken from a slightly widened radius. So rounding can't miss 
+    // the cube of a point that lies just on the radius.
+    m_subtractionRadius = subtractionRadius;
+    m_searchExtent = subtractionRadius * 1.000001;
+    m_cellSize = subtractionRadius > 0.0 ?subtractionRadius :1.0;
+
+    vector< pair<boost::uint64_t, size_t> > pointKeys( pointCount );
+    WPointSubtractionKeyTask task( this, vertices, &pointKeys );
+    WThreadPool::getSharedPool()->parallelFor( &task, pointCount );
+    std::sort( pointKeys.begin(), pointKeys.end() );
+
+    m_cellPointOffsets.clear();
+    m_points.resize( pointCount * 3 );
+    m_pointIndices.resize( pointCount );
+    for( size_t index = 0; index < pointCount; index++ )
+    {
+        if( index == 0 || pointKeys[index].first != pointKeys[index - 1].first )
+        {
+            m_cellKeys.push_back( pointKeys[index].first );
+            m_cellPointOffsets.push_back( index );
+        }
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+            m_points[index * 3 + dimension] = vertices->at( pointKeys[index].second * 3 + dimension );
+        m_pointIndices[index] = pointKeys[index].second;
+    }
+    m_cellPointOffsets.push_back( pointCount );
 
-    m_searchTree->add( points );
-    m_pointSearcher.setExaminedKdTree( m_searchTree );
-    m_pointSearcher.setMaxResultPointCountInfinite();
-    m_pointSearcher.setMaxSearchDistance( subtractionRadius );
+    m_hashBits = 4;
+    while( ( static_cast<size_t>( 1 ) << m_hashBits ) < m_cellKeys.size() * 2 )
+        m_hashBits++;
+    size_t slotCount = static_cast<size_t>( 1 ) << m_hashBits;
+    m_hashSlots.assign( slotCount, pair<boost::uint64_t, size_t>( 0, noCell ) );
+    for( size_t cell = 0; cell < m_cellKeys.size(); cell++ )
+    {
+        size_t slot = getHashSlot( m_cellKeys[cell] );
+        while( m_hashSlots[slot].second != noCell )
+            slot = ( slot + 1 ) & ( slotCount - 1 );
+        m_hashSlots[slot] = pair<boost::uint64_t, size_t>( m_cellKeys[cell], cell );
+    }
+    m_cellFilter.assign( slotCount * 4 / 64, 0 );
+    for( size_t cell = 0; cell < m_cellKeys.size(); cell++ )
+    {
+        size_t bit = getFilterBit( m_cellKeys[cell] );
+        m_cellFilter[bit / 64] |= static_cast<boost::uint64_t>( 1 ) << ( bit % 64 );
+    }
 }
 
 bool WPointSubtactionHelper::pointsExistNearCoordinate( const vector<double>& coordinate )
 {
-    if( m_searchTree == 0 )
+    return pointsExistNearCoordinate( coordinate[0], coordinate[1], coordinate[2] );
+}
+
+bool WPointSubtactionHelper::pointsExistNearCoordinate( double x, double y, double z )
+{
+    return searchPointsNearCoordinate( x, y, z, 0 );
+}
+
+void WPointSubtactionHelper::fetchPointsNearCoordinate( double x, double y, double z, vector<size_t>* pointIndices )
+{
+    searchPointsNearCoordinate( x, y, z, pointIndices );
+}
+
+bool WPointSubtactionHelper::searchPointsNearCoordinate( double x, double y, double z, vector<size_t>* pointIndices )
+{
+    if( m_cellKeys.empty() )
         return false;
-    m_pointSearcher.setSearchedPoint( coordinate );
-    return m_pointSearcher.getNearestNeighborCount() > 0;
+    bool pointsFound = false;
+    boost::int64_t minCellX = getCellCoordinate( x - m_searchExtent );
+    boost::int64_t minCellY = getCellCoordinate( y - m_searchExtent );
+    boost::int64_t minCellZ = getCellCoordinate( z - m_searchExtent );
+    boost::int64_t maxCellX = getCellCoordinate( x + m_searchExtent );
+    boost::int64_t maxCellY = getCellCoordinate( y + m_searchExtent );
+    boost::int64_t maxCellZ = getCellCoordinate( z + m_searchExtent );
+    for( boost::int64_t cellX = minCellX; cellX <= maxCellX; cellX++ )
+        for( boost::int64_t cellY = minCellY; cellY <= maxCellY; cellY++ )
+            for( boost::int64_t cellZ = minCellZ; cellZ <= maxCellZ; cellZ++ )
+            {
+                size_t cell = findCell( getCellKey( cellX, cellY, cellZ ) );
+                if( cell == noCell )
+                    continue;
+                for( size_t index = m_cellPointOffsets[cell]; index < m_cellPointOffsets[cell + 1]; index++ )
+                {
+                    double differenceX = static_cast<double>( m_points[index * 3] ) - x;
+                    double differenceY = static_cast<double>( m_points[index * 3 + 1] ) - y;
+                    double differenceZ = static_cast<double>( m_points[index * 3 + 2] ) - z;
+                    double distance = sqrt( differenceX * differenceX + differenceY * differenceY
+                                            + differenceZ * differenceZ );
+                    if( distance <= m_subtractionRadius )
+                    {
+                        if( pointIndices == 0 )
+                            return true;
+                        pointIndices->push_back( m_pointIndices[index] );
+                        pointsFound = true;
+                    }
+                }
+            }
+    return pointsFound;
+}
+
+vector<bool> WPointSubtactionHelper::pointsExistNearCoordinates( const vector<float>& coordinates )
+{
+    size_t coordinateCount = coordinates.size() / 3;
+    vector<bool> pointsExist( coordinateCount, false );
+    if( m_cellKeys.empty() )
+        return pointsExist;
+    vector<unsigned char> pointsExistFlags( coordinateCount, 0 );
+    WPointSubtractionSearchTask task( this, coordinates, &pointsExistFlags );
+    WThreadPool::getSharedPool()->parallelFor( &task, coordinateCount );
+    for( size_t index = 0; index < coordinateCount; index++ )
+        pointsExist[index] = pointsExistFlags[index] != 0;
+    return pointsExist;
+}
+
+boost::int64_t WPointSubtactionHelper::getCellCoordinate( double coordinate )
+{
+    return static_cast<boost::int64_t>( floor( coordinate / m_cellSize ) );
+}
+
+boost::uint64_t WPointSubtactionHelper::getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ )
+{
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    return WMortonCode::encode( static_cast<boost::uint32_t>( cellX + latticeOrigin ),
+                                static_cast<boost::uint32_t>( cellY + latticeOrigin ),
+                                static_cast<boost::uint32_t>( cellZ + latticeOrigin ) );
+}
+
+size_t WPointSubtactionHelper::findCell( boost::uint64_t key )
+{
+    size_t bit = getFilterBit( key );
+    if( ( m_cellFilter[bit / 64] >> ( bit % 64 ) & 1 ) == 0 )
+        return noCell;
+    size_t slotMask = m_hashSlots.size() - 1;
+    for( size_t slot = getHashSlot( key ); m_hashSlots[slot].second != noCell; slot = ( slot + 1 ) & slotMask )
+        if( m_hashSlots[slot].first == key )
+            return m_hashSlots[slot].second;
+    return noCell;
+}
+
+size_t WPointSubtactionHelper::getHashSlot( boost::uint64_t key )
+{
+    return static_cast<size_t>( ( key * 0x9e3779b97f4a7c15ULL ) >> ( 64 - m_hashBits ) );
+}
+
+size_t WPointSubtactionHelper::getFilterBit( boost::uint64_t key )
+{
+    return static_cast<size_t>( ( key * 0x9e3779b97f4a7c15ULL ) >> ( 62 - m_hashBits ) );
 }
@@ -25,17 +25,22 @@
 #ifndef WPOINTSUBTACTIONHELPER_H
 #define WPOINTSUBTACTIONHELPER_H
 
+#include <utility>
 #include <vector>
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
 #include "core/dataHandler/WDataSetPoints.h"
-#include "../../datastructures/kdtree/WKdTreeND.h"
-#include "../../datastructures/kdtree/WPointSearcher.h"
-#include "../../math/vectors/WVectorMaths.h"
 
+using std::vector;
 
 /**
  * The class tells wheter points exist around a radius by means of a D coordinate.
  * It is mainly used to subtract point coordinates from point datasets.
+ *
+ * The subtracted points are binned into a uniform grid of cubes with the edge length 
+ * of the subtraction radius. A hash table maps the Morton code of each occupied cube 
+ * to its points. So a test only looks at the cubes the radius reaches (at most 27) 
+ * and stops at the first point within the radius.
  */
 class WPointSubtactionHelper
 {
@@ -51,7 +56,7 @@ public:
     virtual ~WPointSubtactionHelper();
 
     /**
-     * Initializes the instance.
+     * Initializes the instance. The grid is built in parallel.
      * \param pointsToSubtract Point set to be tested whether its points are near a 
      *                         coordinate to be tested.
      * \param subtractionRadius Search radius for point existance.
@@ -65,16 +70,141 @@ public:
      */
     bool pointsExistNearCoordinate( const vector<double>& coordinate );
 
+    /**
+     * Returns whether points exist near a coordinate by means of a radius.
+     * \param x X coordinate to be tested.
+     * \param y Y coordinate to be tested.
+     * \param z Z coordinate to be tested.
+     * \return Points exist near a coordinate by means of a radius or not.
+     */
+    bool pointsExistNearCoordinate( double x, double y, double z );
+
+    /**
+     * Fetches all points within the radius around a coordinate.
+     * \param x X coordinate to be tested.
+     * \param y Y coordinate to be tested.
+     * \param z Z coordinate to be tested.
+     * \param pointIndices Output list the indices of the found points are appended to. 
+     *                     They refer to the point set passed to initSubtraction().
+     */
+    void fetchPointsNearCoordinate( double x, double y, double z, vector<size_t>* pointIndices );
+
+    /**
+     * Returns whether points exist near each coordinate of a whole point set. The 
+     * coordinates are tested in parallel.
+     * \param coordinates Interleaved 3D coordinates to be tested (X, Y, Z, X, Y, Z, ...).
+     * \return Points exist near each coordinate or not.
+     */
+    vector<bool> pointsExistNearCoordinates( const vector<float>& coordinates );
+
+    /**
+     * Returns the grid cube index of a coordinate along one axis.
+     * \param coordinate X, Y or Z coordinate.
+     * \return Cube index along that axis.
+     */
+    boost::int64_t getCellCoordinate( double coordinate );
+
+    /**
+     * Returns the key of a grid cube.
+     * \param cellX Cube index along the X axis.
+     * \param cellY Cube index along the Y axis.
+     * \param cellZ Cube index along the Z axis.
+     * \return Morton code of the cube.
+     */
+    static boost::uint64_t getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ );
+
+    /**
+     * Marks an empty hash slot and missing cubes.
+     */
+    static const size_t noCell;
+
 private:
     /**
-     * Point search tree.
+     * Visits the points within the radius around a coordinate.
+     * \param x X coordinate to be tested.
+     * \param y Y coordinate to be tested.
+     * \param z Z coordinate to be tested.
+     * \param pointIndices Output list the found point indices are appended to. The 
+     *                     search stops at the first found point if it is 0.
+     * \return Any point was found or not.
+     */
+    bool searchPointsNearCoordinate( double x, double y, double z, vector<size_t>* pointIndices );
+
+    /**
+     * Returns the index of an occupied cube.
+     * \param key Morton code of the cube.
+     * \return Index of the cube or noCell if it has no points.
+     */
+    size_t findCell( boost::uint64_t key );
+
+    /**
+     * Returns the first hash slot of a cube key.
+     * \param key Morton code of the cube.
+     * \return First probed hash table slot.
+     */
+    size_t getHashSlot( boost::uint64_t key );
+
+    /**
+     * Returns the bit of a cube key within m_cellFilter.
+     * \param key Morton code of the cube.
+     * \return Bit index within m_cellFilter.
+     */
+    size_t getFilterBit( boost::uint64_t key );
+
+    /**
+     * Search radius for point existance.
+     */
+    double m_subtractionRadius;
+
+    /**
+     * Subtraction radius widened by a small rounding tolerance. It selects the grid 
+     * cubes to be searched.
+     */
+    double m_searchExtent;
+
+    /**
+     * Edge length of the grid cubes.
+     */
+    double m_cellSize;
+
+    /**
+     * Interleaved X/Y/Z coordinates of the subtracted points ordered by their cube.
+     */
+    vector<float> m_points;
+
+    /**
+     * Index of each point of m_points within the initial point set.
+     */
+    vector<size_t> m_pointIndices;
+
+    /**
+     * Morton code of each occupied cube in ascending order.
+     */
+    vector<boost::uint64_t> m_cellKeys;
+
+    /**
+     * Index of the first point of each cube within m_points. An additional last entry 
+     * holds the point count.
+     */
+    vector<size_t> m_cellPointOffsets;
+
+    /**
+     * Cube key and cube index of each hash table slot. The index is noCell if the slot 
+     * is empty. Both are kept together so that a probe touches only one cache line.
+     */
+    vector< std::pair<boost::uint64_t, size_t> > m_hashSlots;
+
+    /**
+     * Bit set with four bits per hash table slot. The bit of each occupied cube is set. 
+     * It is small enough to stay in the cache and rejects most empty cubes before the 
+     * hash table has to be accessed.
      */
-    WKdTreeND* m_searchTree;
+    vector<boost::uint64_t> m_cellFilter;
 
     /**
-     * Point search instance.
+     * Count of bits of a hash table slot index.
      */
-    WPointSearcher m_pointSearcher;
+    size_t m_hashBits;
 };
 
 #endif  // WPOINTSUBTACTIONHELPER_H
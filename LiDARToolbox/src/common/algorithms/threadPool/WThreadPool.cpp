@@ -0,0 +1,282 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+#include "WThreadPool.h"
+
+/**
+ * State of a job that is processed by WThreadPool. All members are guarded by the mutex 
+ * of the pool.
+ */
+class WThreadPoolJob
+{
+public:
+    /**
+     * Creates the job state.
+     * \param task Task that processes the chunks.
+     * \param count Count of processed indices.
+     * \param chunkSize Count of indices of a single chunk.
+     * \param threadCount Thread count of the pool.
+     */
+    WThreadPoolJob( WThreadPoolTask* task, size_t count, size_t chunkSize, size_t threadCount ) :
+        m_isProcessedByThread( threadCount, false )
+    {
+        m_task = task;
+        m_count = count;
+        m_chunkSize = chunkSize;
+        m_nextChunkBegin = 0;
+        m_unfinishedChunkCount = ( count + chunkSize - 1 ) / chunkSize;
+    }
+
+    /**
+     * Task that processes the chunks.
+     */
+    WThreadPoolTask* m_task;
+
+    /**
+     * Count of processed indices.
+     */
+    size_t m_count;
+
+    /**
+     * Count of indices of a single chunk.
+     */
+    size_t m_chunkSize;
+
+    /**
+     * First index of the next chunk that is not fetched yet.
+     */
+    size_t m_nextChunkBegin;
+
+    /**
+     * Count of chunks that are not processed completely yet.
+     */
+    size_t m_unfinishedChunkCount;
+
+    /**
+     * Flag of each thread index whether the thread currently processes a chunk of the 
+     * job.
+     */
+    vector<bool> m_isProcessedByThread;
+
+    /**
+     * Notifies the thread that started the job when the last chunk is finished.
+     */
+    boost::condition_variable m_finished;
+};
+
+/**
+ * Thread pool task that executes a list of functions. Each index executes one function.
+ */
+class WThreadPoolFunctionTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param functions Functions to execute.
+     */
+    explicit WThreadPoolFunctionTask( const vector< boost::function<void ()> >& functions ) :
+        m_functions( functions )
+    {
+    }
+
+    /**
+     * Executes a range of the functions.
+     * \param begin Index of the first executed function.
+     * \param end Index after the last executed function.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        ( void )threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            m_functions[index]();
+    }
+
+private:
+    /**
+     * Functions to execute.
+     */
+    const vector< boost::function<void ()> >& m_functions;
+};
+
+/**
+ * Guards the creation of the shared thread pool.
+ */
+static boost::once_flag sharedPoolCreated = BOOST_ONCE_INIT;
+
+/**
+ * Thread pool that is shared by all algorithms.
+ */
+static WThreadPool* sharedPool = 0;
+
+/**
+ * Creates the shared thread pool. It is never destroyed because algorithms may use it 
+ * until the process ends.
+ */
+static void createSharedPool()
+{
+    sharedPool = new WThreadPool( WThreadPool::getHardwareThreadCount() );
+}
+
+WThreadPool::WThreadPool( size_t threadCount )
+{
+    m_threadCount = threadCount > 0 ?threadCount :1;
+    m_isShutDown = false;
+    for( size_t threadIndex = 1; threadIndex < m_threadCount; threadIndex++ )
+        m_workers.push_back( new boost::thread( &WThreadPool::runWorker, this, threadIndex ) );
+}
+
+WThreadPool::~WThreadPool()
+{
+    {
+        boost::unique_lock<boost::mutex> lock( m_mutex );
+        m_isShutDown = true;
+        m_jobQueued.notify_all();
+    }
+    for( size_t index = 0; index < m_workers.size(); index++ )
+    {
+        m_workers[index]->join();
+        delete m_workers[index];
+    }
+    m_workers.clear();
+}
+
+WThreadPool* WThreadPool::getSharedPool()
+{
+    boost::call_once( &createSharedPool, sharedPoolCreated );
+    return sharedPool;
+}
+
+size_t WThreadPool::getHardwareThreadCount()
+{
+    size_t threadCount = boost::thread::hardware_concurrency();
+    return threadCount > 0 ?threadCount :1;
+}
+
+size_t WThreadPool::getThreadCount()
+{
+    return m_threadCount;
+}
+
+void WThreadPool::parallelFor( WThreadPoolTask* task, size_t count )
+{
+    size_t chunkSize = count / ( m_threadCount * 16 );
+    parallelFor( task, count, chunkSize > 0 ?chunkSize :1 );
+}
+
+void WThreadPool::parallelFor( WThreadPoolTask* task, size_t count, size_t chunkSize )
+{
+    if( count == 0 )
+        return;
+    if( chunkSize == 0 )
+        chunkSize = 1;
+    size_t threadIndex = getCallingThreadIndex();
+    WThreadPoolJob job( task, count, chunkSize, m_threadCount );
+
+    boost::unique_lock<boost::mutex> lock( m_mutex );
+    if( job.m_unfinishedChunkCount > 1 && m_workers.size() > 0 )
+    {
+        m_jobs.push_back( &job );
+        m_jobQueued.notify_all();
+    }
+    while( processNextChunk( &job, threadIndex, lock ) )
+    {
+    }
+    // Only workers help out with other jobs. Threads outside the pool share the index 0.
+    while( job.m_unfinishedChunkCount > 0 )
+    {
+        WThreadPoolJob* otherJob = threadIndex > 0 ?findJobToHelp( threadIndex ) :0;
+        if( otherJob != 0 )
+            processNextChunk( otherJob, threadIndex, lock );
+        else
+            job.m_finished.wait( lock );
+    }
+}
+
+void WThreadPool::parallelInvoke( const vector< boost::function<void ()> >& functions )
+{
+    WThreadPoolFunctionTask task( functions );
+    parallelFor( &task, functions.size(), 1 );
+}
+
+void WThreadPool::runWorker( size_t threadIndex )
+{
+    m_workerThreadIndex.reset( new size_t( threadIndex ) );
+    boost::unique_lock<boost::mutex> lock( m_mutex );
+    while( !m_isShutDown )
+    {
+        if( m_jobs.empty() )
+            m_jobQueued.wait( lock );
+        else
+            processNextChunk( m_jobs.front(), threadIndex, lock );
+    }
+}
+
+bool WThreadPool::processNextChunk( WThreadPoolJob* job, size_t threadIndex, boost::unique_lock<boost::mutex>& lock )
+{
+    if( job->m_nextChunkBegin >= job->m_count )
+    {
+        dequeueJob( job );
+        return false;
+    }
+    size_t begin = job->m_nextChunkBegin;
+    size_t end = job->m_count - begin > job->m_chunkSize ?begin + job->m_chunkSize :job->m_count;
+    job->m_nextChunkBegin = end;
+    if( end == job->m_count )
+        dequeueJob( job );
+
+    job->m_isProcessedByThread[threadIndex] = true;
+    lock.unlock();
+    job->m_task->processRange( begin, end, threadIndex );
+    lock.lock();
+    job->m_isProcessedByThread[threadIndex] = false;
+
+    job->m_unfinishedChunkCount--;
+    if( job->m_unfinishedChunkCount == 0 )
+        job->m_finished.notify_all();
+    return true;
+}
+
+WThreadPoolJob* WThreadPool::findJobToHelp( size_t threadIndex )
+{
+    for( size_t index = 0; index < m_jobs.size(); index++ )
+        if( !m_jobs[index]->m_isProcessedByThread[threadIndex] )
+            return m_jobs[index];
+    return 0;
+}
+
+void WThreadPool::dequeueJob( WThreadPoolJob* job )
+{
+    deque<WThreadPoolJob*>::iterator position = std::find( m_jobs.begin(), m_jobs.end(), job );
+    if( position != m_jobs.end() )
+        m_jobs.erase( position );
+}
+
+size_t WThreadPool::getCallingThreadIndex()
+{
+    size_t* threadIndex = m_workerThreadIndex.get();
+    return threadIndex != 0 ?*threadIndex :0;
+}
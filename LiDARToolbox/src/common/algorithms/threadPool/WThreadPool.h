@@ -0,0 +1,190 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADPOOL_H
+#define WTHREADPOOL_H
+
+#include <deque>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "WThreadPoolTask.h"
+
+using std::deque;
+using std::vector;
+
+class WThreadPoolJob;
+
+/**
+ * Pool of worker threads that processes index ranges in parallel. A range is split into 
+ * chunks that are fetched by the threads one by one. So threads that finish early take 
+ * over the remaining work of the slower ones.
+ *
+ * The thread that starts a job processes chunks of it as well. A task may therefore 
+ * start a nested job on the same pool without waiting for idle workers. Workers that 
+ * wait for the rest of their nested job meanwhile help out with other queued jobs, 
+ * except the ones they are already processing.
+ */
+class WThreadPool
+{
+public:
+    /**
+     * Creates a thread pool.
+     * \param threadCount Count of threads that process a job, including the thread that 
+     *                    starts the job. The pool creates one worker thread less.
+     */
+    explicit WThreadPool( size_t threadCount );
+
+    /**
+     * Stops all worker threads and destroys the thread pool.
+     */
+    virtual ~WThreadPool();
+
+    /**
+     * Returns the thread pool that is shared by all algorithms. It is created on the 
+     * first call using as much threads as the machine can run concurrently.
+     * \return The shared thread pool.
+     */
+    static WThreadPool* getSharedPool();
+
+    /**
+     * Returns the count of threads the machine can run concurrently.
+     * \return Hardware thread count, at least 1.
+     */
+    static size_t getHardwareThreadCount();
+
+    /**
+     * Returns the count of threads that process a job. Thread indices passed to 
+     * WThreadPoolTask::processRange() are smaller than this value.
+     * \return Thread count of the pool.
+     */
+    size_t getThreadCount();
+
+    /**
+     * Processes the range [0, count) in parallel and returns when all chunks are 
+     * processed. The chunk size is chosen so that each thread gets several chunks.
+     * \param task Task that processes the chunks.
+     * \param count Count of processed indices.
+     */
+    void parallelFor( WThreadPoolTask* task, size_t count );
+
+    /**
+     * Processes the range [0, count) in parallel and returns when all chunks are 
+     * processed.
+     * \param task Task that processes the chunks.
+     * \param count Count of processed indices.
+     * \param chunkSize Count of indices that are processed by a single 
+     *                  WThreadPoolTask::processRange() call.
+     */
+    void parallelFor( WThreadPoolTask* task, size_t count, size_t chunkSize );
+
+    /**
+     * Executes functions in parallel and returns when all of them are finished. It is 
+     * meant for recursive algorithms that fork into a few branches. The functions may 
+     * start nested jobs on the pool themselves.
+     * \param functions Functions to execute.
+     */
+    void parallelInvoke( const vector< boost::function<void ()> >& functions );
+
+private:
+    /**
+     * Main loop of a worker thread. It processes chunks of the queued jobs until the 
+     * pool is destroyed.
+     * \param threadIndex Thread index of the worker.
+     */
+    void runWorker( size_t threadIndex );
+
+    /**
+     * Fetches the next chunk of a job and processes it. The job is removed from the 
+     * queue as soon as its last chunk is fetched.
+     * \param job Job to process a chunk of.
+     * \param threadIndex Index of the processing thread.
+     * \param lock Lock of m_mutex. It is held on call and on return but released while 
+     *             the chunk is processed.
+     * \return A chunk was processed or not. False means that all chunks of the job had 
+     *         already been fetched.
+     */
+    bool processNextChunk( WThreadPoolJob* job, size_t threadIndex, boost::unique_lock<boost::mutex>& lock );
+
+    /**
+     * Returns the first queued job that a waiting thread can help out with. Jobs of which 
+     * the thread already processes a chunk further up its stack are skipped. Otherwise 
+     * their tasks would be entered twice with the same thread index.
+     * \param threadIndex Index of the waiting thread.
+     * \return Job to process a chunk of or 0 if there is none.
+     */
+    WThreadPoolJob* findJobToHelp( size_t threadIndex );
+
+    /**
+     * Removes a job from the job queue.
+     * \param job Job to remove.
+     */
+    void dequeueJob( WThreadPoolJob* job );
+
+    /**
+     * Returns the index of the calling thread. Threads outside the pool get the index 0 
+     * which is not used by any worker.
+     * \return Thread index of the caller.
+     */
+    size_t getCallingThreadIndex();
+
+    /**
+     * Count of threads that process a job.
+     */
+    size_t m_threadCount;
+
+    /**
+     * Worker threads.
+     */
+    vector<boost::thread*> m_workers;
+
+    /**
+     * Jobs that have chunks that are not fetched yet.
+     */
+    deque<WThreadPoolJob*> m_jobs;
+
+    /**
+     * Mutex that guards the job queue and the job states.
+     */
+    boost::mutex m_mutex;
+
+    /**
+     * Notifies the workers about queued jobs and the pool destruction.
+     */
+    boost::condition_variable m_jobQueued;
+
+    /**
+     * The pool is destroyed or not.
+     */
+    bool m_isShutDown;
+
+    /**
+     * Thread index of each worker. It is not set for threads outside the pool.
+     */
+    boost::thread_specific_ptr<size_t> m_workerThreadIndex;
+};
+
+#endif  // WTHREADPOOL_H
@@ -0,0 +1,60 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WTHREADPOOLTASK_H
+#define WTHREADPOOLTASK_H
+
+#include <cstddef>
+
+/**
+ * Work that is executed by WThreadPool. Derived classes process a range of indices and 
+ * carry the input and output data of the job.
+ */
+class WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     */
+    WThreadPoolTask();
+
+    /**
+     * Destroys the task.
+     */
+    virtual ~WThreadPoolTask();
+
+    /**
+     * Processes a chunk of the job. It is called concurrently by several threads. Calls 
+     * of a single job with the same thread index never run at the same time, even if 
+     * the task starts nested jobs. So it can be used to select scratch buffers. A task 
+     * object that is processed by several jobs at once can't rely on that.
+     * \param begin First index of the chunk.
+     * \param end Index after the last index of the chunk.
+     * \param threadIndex Index of the processing thread. It is smaller than 
+     *                    WThreadPool::getThreadCount().
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex ) = 0;
+};
+
+#endif  // WTHREADPOOLTASK_H
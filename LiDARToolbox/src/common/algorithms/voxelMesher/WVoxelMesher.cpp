@@ -0,0 +1,402 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "../../math/mortonCode/WMortonCode.h"
+#include "../threadPool/WThreadPool.h"
+#include "WVoxelMesher.h"
+
+const size_t WVoxelMesher::rectangleSize = 7;
+
+/**
+ * Thread pool task that detects the visible faces of voxels.
+ */
+class WVoxelFaceTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param mesher Mesher of the voxels.
+     * \param visibleFaces Output visible faces of each voxel.
+     */
+    WVoxelFaceTask( WVoxelMesher* mesher, vector<unsigned char>* visibleFaces )
+    {
+        m_mesher = mesher;
+        m_visibleFaces = visibleFaces;
+    }
+
+    /**
+     * Detects the visible faces of a range of voxels.
+     * \param begin Index of the first voxel.
+     * \param end Index after the last voxel.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t voxel = begin; voxel < end; voxel++ )
+            ( *m_visibleFaces )[voxel] = m_mesher->getVisibleFaces( voxel );
+    }
+
+private:
+    /**
+     * Mesher of the voxels.
+     */
+    WVoxelMesher* m_mesher;
+
+    /**
+     * Output visible faces of each voxel.
+     */
+    vector<unsigned char>* m_visibleFaces;
+};
+
+/**
+ * Thread pool task that converts the faces of slabs to rectangles.
+ */
+class WVoxelSlabTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param mesher Mesher of the voxels.
+     * \param slabRectangles Output rectangles of each slab.
+     */
+    WVoxelSlabTask( WVoxelMesher* mesher, vector< vector<boost::int64_t> >* slabRectangles )
+    {
+        m_mesher = mesher;
+        m_slabRectangles = slabRectangles;
+    }
+
+    /**
+     * Converts the faces of a range of slabs.
+     * \param begin Index of the first slab.
+     * \param end Index after the last slab.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t slab = begin; slab < end; slab++ )
+            m_mesher->fetchSlabRectangles( slab, &( *m_slabRectangles )[slab] );
+    }
+
+private:
+    /**
+     * Mesher of the voxels.
+     */
+    WVoxelMesher* m_mesher;
+
+    /**
+     * Output rectangles of each slab.
+     */
+    vector< vector<boost::int64_t> >* m_slabRectangles;
+};
+
+WVoxelMesher::WVoxelMesher()
+{
+    m_voxelWidth = 1.0;
+    m_mergeFaces = true;
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+        m_origin[dimension] = 0.0;
+}
+
+WVoxelMesher::~WVoxelMesher()
+{
+}
+
+void WVoxelMesher::setVoxelWidth( double voxelWidth )
+{
+    m_voxelWidth = voxelWidth;
+    clear();
+}
+
+void WVoxelMesher::setMergeFaces( bool mergeFaces )
+{
+    m_mergeFaces = mergeFaces;
+}
+
+void WVoxelMesher::addVoxel( double x, double y, double z, const osg::Vec4& color )
+{
+    if( m_voxelColors.size() == 0 )
+    {
+        m_origin[0] = x;
+        m_origin[1] = y;
+        m_origin[2] = z;
+    }
+    boost::int64_t cellX = getCellCoordinate( x, 0 );
+    boost::int64_t cellY = getCellCoordinate( y, 1 );
+    boost::int64_t cellZ = getCellCoordinate( z, 2 );
+    boost::uint64_t key = getCellKey( cellX, cellY, cellZ );
+    if( m_voxelIndices.find( key ) != m_voxelIndices.end() )
+        return;
+
+    m_voxelIndices[key] = m_voxelColors.size();
+    m_cells.push_back( cellX );
+    m_cells.push_back( cellY );
+    m_cells.push_back( cellZ );
+    m_voxelColors.push_back( getColorIndex( color ) );
+}
+
+size_t WVoxelMesher::getVoxelCount()
+{
+    return m_voxelColors.size();
+}
+
+void WVoxelMesher::clear()
+{
+    m_cells.clear();
+    m_voxelColors.clear();
+    m_voxelIndices.clear();
+    m_colors.clear();
+    m_colorIndices.clear();
+    m_directionFaces.clear();
+    m_slabs.clear();
+}
+
+boost::shared_ptr< WTriangleMesh > WVoxelMesher::getMesh()
+{
+    boost::shared_ptr< WTriangleMesh > outputMesh( new WTriangleMesh( 0, 0 ) );
+    addToMesh( outputMesh );
+    return outputMesh;
+}
+
+void WVoxelMesher::addToMesh( boost::shared_ptr< WTriangleMesh > outputMesh )
+{
+    vector<unsigned char> visibleFaces( m_voxelColors.size(), 0 );
+    WVoxelFaceTask faceTask( this, &visibleFaces );
+    WThreadPool::getSharedPool()->parallelFor( &faceTask, visibleFaces.size() );
+    initSlabs( visibleFaces );
+
+    size_t slabCount = m_slabs.size() / 3;
+    vector< vector<boost::int64_t> > slabRectangles( slabCount );
+    WVoxelSlabTask slabTask( this, &slabRectangles );
+    WThreadPool::getSharedPool()->parallelFor( &slabTask, slabCount, 1 );
+
+    boost::unordered_map< pair<boost::uint64_t, size_t>, size_t > vertexIndices;
+    for( size_t slab = 0; slab < slabCount; slab++ )
+        for( size_t index = 0; index < slabRectangles[slab].size(); index += rectangleSize )
+            addRectangle( &slabRectangles[slab][index], outputMesh, &vertexIndices );
+    m_directionFaces.clear();
+    m_slabs.clear();
+}
+
+unsigned char WVoxelMesher::getVisibleFaces( size_t voxel )
+{
+    unsigned char visibleFaces = 0;
+    for( size_t direction = 0; direction < 6; direction++ )
+    {
+        boost::int64_t neighbor[3];
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+            neighbor[dimension] = m_cells[voxel * 3 + dimension];
+        neighbor[getDirectionAxis( direction )] += direction % 2 == 0 ?-1 :1;
+        if( m_voxelIndices.find( getCellKey( neighbor[0], neighbor[1], neighbor[2] ) ) == m_voxelIndices.end() )
+            visibleFaces |= static_cast<unsigned char>( 1 << direction );
+    }
+    return visibleFaces;
+}
+
+void WVoxelMesher::fetchSlabRectangles( size_t slab, vector<boost::int64_t>* rectangles )
+{
+    size_t direction = m_slabs[slab * 3];
+    size_t begin = m_slabs[slab * 3 + 1];
+    size_t end = m_slabs[slab * 3 + 2];
+    const vector< pair<boost::uint64_t, size_t> >& faces = m_directionFaces[direction];
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    boost::uint64_t coordinateMask = ( static_cast<boost::uint64_t>( 1 ) << WMortonCode::BITS_PER_DIMENSION ) - 1;
+    boost::uint64_t planeMask = ( static_cast<boost::uint64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION * 2 ) ) - 1;
+    boost::int64_t layer = static_cast<boost::int64_t>( faces[begin].first >> ( WMortonCode::BITS_PER_DIMENSION * 2 ) )
+            - latticeOrigin;
+
+    boost::unordered_map<boost::uint64_t, size_t> facePositions;
+    if( m_mergeFaces )
+        for( size_t position = begin; position < end; position++ )
+            facePositions[faces[position].first & planeMask] = position;
+    vector<bool> isMerged( end - begin, false );
+    for( size_t position = begin; position < end; position++ )
+    {
+        if( isMerged[position - begin] )
+            continue;
+        size_t color = m_voxelColors[faces[position].second];
+        boost::uint64_t u = faces[position].first & coordinateMask;
+        boost::uint64_t v = ( faces[position].first >> WMortonCode::BITS_PER_DIMENSION ) & coordinateMask;
+        boost::uint64_t width = 1;
+        boost::uint64_t height = 1;
+        if( m_mergeFaces )
+        {
+            while( isMergeableFace( direction, facePositions, isMerged, begin, u + width, v, color ) )
+                width++;
+            bool isRowMergeable = true;
+            while( isRowMergeable )
+            {
+                for( boost::uint64_t offset = 0; isRowMergeable && offset < width; offset++ )
+                    isRowMergeable = isMergeableFace( direction, facePositions, isMerged, begin, u + offset, v + height, color );
+                if( isRowMergeable )
+                    height++;
+            }
+            for( boost::uint64_t row = 0; row < height; row++ )
+                for( boost::uint64_t offset = 0; offset < width; offset++ )
+                    isMerged[facePositions[( ( v + row ) << WMortonCode::BITS_PER_DIMENSION ) | ( u + offset )] - begin] = true;
+        }
+        rectangles->push_back( direction );
+        rectangles->push_back( layer );
+        rectangles->push_back( static_cast<boost::int64_t>( u ) - latticeOrigin );
+        rectangles->push_back( static_cast<boost::int64_t>( v ) - latticeOrigin );
+        rectangles->push_back( static_cast<boost::int64_t>( u + width - 1 ) - latticeOrigin );
+        rectangles->push_back( static_cast<boost::int64_t>( v + height - 1 ) - latticeOrigin );
+        rectangles->push_back( color );
+    }
+}
+
+size_t WVoxelMesher::getDirectionAxis( size_t direction )
+{
+    return direction / 2;
+}
+
+boost::uint64_t WVoxelMesher::getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ )
+{
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    return WMortonCode::encode( static_cast<boost::uint32_t>( cellX + latticeOrigin ),
+                                static_cast<boost::uint32_t>( cellY + latticeOrigin ),
+                                static_cast<boost::uint32_t>( cellZ + latticeOrigin ) );
+}
+
+boost::int64_t WVoxelMesher::getCellCoordinate( double coordinate, size_t dimension )
+{
+    return static_cast<boost::int64_t>( floor( ( coordinate - m_origin[dimension] ) / m_voxelWidth + 0.5 ) );
+}
+
+size_t WVoxelMesher::getColorIndex( const osg::Vec4& color )
+{
+    boost::uint32_t channels[4];
+    for( size_t channel = 0; channel < 4; channel++ )
+    {
+        float value = color[channel];
+        memcpy( &channels[channel], &value, sizeof( value ) );
+    }
+    pair<boost::uint64_t, boost::uint64_t> key(
+            ( static_cast<boost::uint64_t>( channels[0] ) << 32 ) | channels[1],
+            ( static_cast<boost::uint64_t>( channels[2] ) << 32 ) | channels[3] );
+    std::map< pair<boost::uint64_t, boost::uint64_t>, size_t >::iterator found = m_colorIndices.find( key );
+    if( found != m_colorIndices.end() )
+        return found->second;
+    m_colorIndices[key] = m_colors.size();
+    m_colors.push_back( color );
+    return m_colors.size() - 1;
+}
+
+void WVoxelMesher::initSlabs( const vector<unsigned char>& visibleFaces )
+{
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    m_directionFaces.assign( 6, vector< pair<boost::uint64_t, size_t> >() );
+    for( size_t voxel = 0; voxel < visibleFaces.size(); voxel++ )
+        for( size_t direction = 0; direction < 6; direction++ )
+            if( ( visibleFaces[voxel] >> direction ) & 1 )
+            {
+                size_t axis = getDirectionAxis( direction );
+                boost::uint64_t layer = static_cast<boost::uint64_t>( m_cells[voxel * 3 + axis] + latticeOrigin );
+                boost::uint64_t u = static_cast<boost::uint64_t>( m_cells[voxel * 3 + ( axis + 1 ) % 3] + latticeOrigin );
+                boost::uint64_t v = static_cast<boost::uint64_t>( m_cells[voxel * 3 + ( axis + 2 ) % 3] + latticeOrigin );
+                boost::uint64_t key = ( layer << ( WMortonCode::BITS_PER_DIMENSION * 2 ) )
+                        | ( v << WMortonCode::BITS_PER_DIMENSION ) | u;
+                m_directionFaces[direction].push_back( pair<boost::uint64_t, size_t>( key, voxel ) );
+            }
+
+    m_slabs.clear();
+    for( size_t direction = 0; direction < 6; direction++ )
+    {
+        vector< pair<boost::uint64_t, size_t> >& faces = m_directionFaces[direction];
+        std::sort( faces.begin(), faces.end() );
+        size_t begin = 0;
+        for( size_t position = 1; position <= faces.size(); position++ )
+            if( position == faces.size() || ( faces[position].first >> ( WMortonCode::BITS_PER_DIMENSION * 2 ) )
+                    != ( faces[begin].first >> ( WMortonCode::BITS_PER_DIMENSION * 2 ) ) )
+            {
+                m_slabs.push_back( direction );
+                m_slabs.push_back( begin );
+                m_slabs.push_back( position );
+                begin = position;
+            }
+    }
+}
+
+bool WVoxelMesher::isMergeableFace( size_t direction, const boost::unordered_map<boost::uint64_t, size_t>& facePositions,
+        const vector<bool>& isMerged, size_t begin, boost::uint64_t u, boost::uint64_t v, size_t color )
+{
+    boost::uint64_t coordinateMask = ( static_cast<boost::uint64_t>( 1 ) << WMortonCode::BITS_PER_DIMENSION ) - 1;
+    if( u > coordinateMask || v > coordinateMask )
+        return false;
+    boost::unordered_map<boost::uint64_t, size_t>::const_iterator found =
+            facePositions.find( ( v << WMortonCode::BITS_PER_DIMENSION ) | u );
+    if( found == facePositions.end() || isMerged[found->second - begin] )
+        return false;
+    return m_voxelColors[m_directionFaces[direction][found->second].second] == color;
+}
+
+void WVoxelMesher::addRectangle( const boost::int64_t* rectangle, boost::shared_ptr< WTriangleMesh > outputMesh,
+        boost::unordered_map< pair<boost::uint64_t, size_t>, size_t >* vertexIndices )
+{
+    size_t direction = static_cast<size_t>( rectangle[0] );
+    size_t axis = getDirectionAxis( direction );
+    size_t color = static_cast<size_t>( rectangle[6] );
+    boost::int64_t cornerU[4] = { rectangle[2], rectangle[4] + 1, rectangle[4] + 1, rectangle[2] };
+    boost::int64_t cornerV[4] = { rectangle[3], rectangle[3], rectangle[5] + 1, rectangle[5] + 1 };
+    size_t vertices[4];
+    for( size_t corner = 0; corner < 4; corner++ )
+    {
+        boost::int64_t lattice[3];
+        lattice[axis] = rectangle[1] + direction % 2;
+        lattice[( axis + 1 ) % 3] = cornerU[corner];
+        lattice[( axis + 2 ) % 3] = cornerV[corner];
+        pair<boost::uint64_t, size_t> key( getCellKey( lattice[0], lattice[1], lattice[2] ), color );
+        boost::unordered_map< pair<boost::uint64_t, size_t>, size_t >::iterator found = vertexIndices->find( key );
+        if( found != vertexIndices->end() )
+        {
+            vertices[corner] = found->second;
+            continue;
+        }
+        vertices[corner] = outputMesh->vertSize();
+        outputMesh->addVertex( m_origin[0] + ( static_cast<double>( lattice[0] ) - 0.5 ) * m_voxelWidth,
+                               m_origin[1] + ( static_cast<double>( lattice[1] ) - 0.5 ) * m_voxelWidth,
+                               m_origin[2] + ( static_cast<double>( lattice[2] ) - 0.5 ) * m_voxelWidth );
+        outputMesh->setVertexColor( vertices[corner], m_colors[color] );
+        ( *vertexIndices )[key] = vertices[corner];
+    }
+    // The corners run counterclockwise seen from the upper side of the axis.
+    if( direction % 2 == 1 )
+    {
+        outputMesh->addTriangle( vertices[0], vertices[1], vertices[2] );
+        outputMesh->addTriangle( vertices[0], vertices[2], vertices[3] );
+    }
+    else
+    {
+        outputMesh->addTriangle( vertices[0], vertices[2], vertices[1] );
+        outputMesh->addTriangle( vertices[0], vertices[3], vertices[2] );
+    }
+}
@@ -0,0 +1,253 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WVOXELMESHER_H
+#define WVOXELMESHER_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "core/graphicsEngine/WTriangleMesh.h"
+
+using std::pair;
+using std::vector;
+
+/**
+ * Converts voxels of a regular grid to a triangle mesh. Unlike drawing a cube for 
+ * each voxel only faces between an occupied and an empty cell are drawn.
+ *
+ * How it works:
+ *  A) Voxels are added one by one. Their cells are kept in a hash map.
+ *  B) The visible faces of each voxel are detected in parallel.
+ *  C) The faces are grouped into slabs. A slab holds the faces of a single direction 
+ *     and layer. Optionally adjacent faces of the same color within a slab are merged 
+ *     to rectangles (greedy meshing). Slabs are processed in parallel.
+ *  D) Rectangle corners are added to the triangle mesh. Corners on the same lattice 
+ *     position and of the same color share one vertex.
+ *
+ * Cell coordinates are relative to the first added voxel and limited to +-2^20 cells.
+ */
+class WVoxelMesher
+{
+public:
+    /**
+     * Creates a mesher for voxels of the width 1.0. Faces are merged.
+     */
+    WVoxelMesher();
+
+    /**
+     * Destroys the mesher.
+     */
+    virtual ~WVoxelMesher();
+
+    /**
+     * Sets the edge length of the voxels. It clears the added voxels.
+     * \param voxelWidth Edge length of the voxels.
+     */
+    void setVoxelWidth( double voxelWidth );
+
+    /**
+     * Sets whether adjacent faces of the same color and direction are merged to 
+     * rectangles.
+     * \param mergeFaces Merge faces or draw each face separately.
+     */
+    void setMergeFaces( bool mergeFaces );
+
+    /**
+     * Adds a voxel. A voxel that is added again to an occupied cell keeps the color of 
+     * the first one.
+     * \param x X coordinate of the voxel center.
+     * \param y Y coordinate of the voxel center.
+     * \param z Z coordinate of the voxel center.
+     * \param color Color of the voxel.
+     */
+    void addVoxel( double x, double y, double z, const osg::Vec4& color );
+
+    /**
+     * Returns the count of added voxels.
+     * \return The count of added voxels.
+     */
+    size_t getVoxelCount();
+
+    /**
+     * Removes all added voxels.
+     */
+    void clear();
+
+    /**
+     * Creates a triangle mesh of the added voxels.
+     * \return The triangle mesh of the voxel outline.
+     */
+    boost::shared_ptr< WTriangleMesh > getMesh();
+
+    /**
+     * Adds the outline of the added voxels to an existing triangle mesh.
+     * \param outputMesh Triangle mesh to add the triangles to.
+     */
+    void addToMesh( boost::shared_ptr< WTriangleMesh > outputMesh );
+
+    /**
+     * Detects which faces of a voxel border on an empty cell.
+     * \param voxel Index of the voxel.
+     * \return Bit mask of the visible faces. Bit n stands for the direction n (see 
+     *         getDirectionAxis()).
+     */
+    unsigned char getVisibleFaces( size_t voxel );
+
+    /**
+     * Converts the faces of a slab to rectangles.
+     * \param slab Index of the slab.
+     * \param rectangles Output rectangles. Each one consists of the direction, the 
+     *                   layer, the minimal U and V and the maximal U and V cell 
+     *                   coordinate and the color index (see rectangleSize).
+     */
+    void fetchSlabRectangles( size_t slab, vector<boost::int64_t>* rectangles );
+
+    /**
+     * Count of values that describe a rectangle.
+     */
+    static const size_t rectangleSize;
+
+private:
+    /**
+     * Returns the axis perpendicular to faces of a direction. Directions 2n and 
+     * 2n + 1 point to the lower and upper side of the axis n.
+     * \param direction Face direction.
+     * \return Axis of the direction.
+     */
+    static size_t getDirectionAxis( size_t direction );
+
+    /**
+     * Returns the cell key of a cell coordinate.
+     * \param cellX X cell coordinate.
+     * \param cellY Y cell coordinate.
+     * \param cellZ Z cell coordinate.
+     * \return Key of the cell.
+     */
+    static boost::uint64_t getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ );
+
+    /**
+     * Returns a cell coordinate relative to the first voxel.
+     * \param coordinate World coordinate.
+     * \param dimension Axis of the coordinate.
+     * \return Cell coordinate.
+     */
+    boost::int64_t getCellCoordinate( double coordinate, size_t dimension );
+
+    /**
+     * Returns the index of a color within the color list. Unknown colors are added.
+     * \param color Searched color.
+     * \return Index of the color.
+     */
+    size_t getColorIndex( const osg::Vec4& color );
+
+    /**
+     * Groups the visible faces by direction and layer into slabs.
+     * \param visibleFaces Visible faces of each voxel.
+     */
+    void initSlabs( const vector<unsigned char>& visibleFaces );
+
+    /**
+     * Tells whether a face of a slab can be merged into the current rectangle.
+     * \param direction Direction of the slab.
+     * \param facePositions Position within m_directionFaces of each packed V and U 
+     *                      cell coordinate of the slab.
+     * \param isMerged Faces of the slab that are already merged.
+     * \param begin First position of the slab within m_directionFaces.
+     * \param u Packed U cell coordinate of the face.
+     * \param v Packed V cell coordinate of the face.
+     * \param color Color index of the rectangle.
+     * \return The face exists, isn't merged yet and has the rectangle's color or not.
+     */
+    bool isMergeableFace( size_t direction, const boost::unordered_map<boost::uint64_t, size_t>& facePositions,
+            const vector<bool>& isMerged, size_t begin, boost::uint64_t u, boost::uint64_t v, size_t color );
+
+    /**
+     * Adds a rectangle as two triangles to the triangle mesh.
+     * \param rectangle First value of the rectangle (see fetchSlabRectangles()).
+     * \param outputMesh Triangle mesh to add the triangles to.
+     * \param vertexIndices Vertex indices of lattice corners and colors that are 
+     *                      already added to the mesh.
+     */
+    void addRectangle( const boost::int64_t* rectangle, boost::shared_ptr< WTriangleMesh > outputMesh,
+            boost::unordered_map< pair<boost::uint64_t, size_t>, size_t >* vertexIndices );
+
+    /**
+     * Edge length of the voxels.
+     */
+    double m_voxelWidth;
+
+    /**
+     * Merge adjacent faces to rectangles or not.
+     */
+    bool m_mergeFaces;
+
+    /**
+     * Center of the first added voxel. Cell coordinates are relative to it.
+     */
+    double m_origin[3];
+
+    /**
+     * X/Y/Z cell coordinate of each voxel.
+     */
+    vector<boost::int64_t> m_cells;
+
+    /**
+     * Color index of each voxel.
+     */
+    vector<size_t> m_voxelColors;
+
+    /**
+     * Voxel index of each occupied cell key.
+     */
+    boost::unordered_map<boost::uint64_t, size_t> m_voxelIndices;
+
+    /**
+     * Distinct voxel colors.
+     */
+    vector<osg::Vec4> m_colors;
+
+    /**
+     * Color index of each color. The key consists of the bits of the color channels.
+     */
+    std::map< pair<boost::uint64_t, boost::uint64_t>, size_t > m_colorIndices;
+
+    /**
+     * Visible faces sorted by direction, layer, V and U. Each face consists of the 
+     * packed layer, V and U cell coordinate and the voxel index.
+     */
+    vector< vector< pair<boost::uint64_t, size_t> > > m_directionFaces;
+
+    /**
+     * Direction, first and end position within m_directionFaces of each slab.
+     */
+    vector<size_t> m_slabs;
+};
+
+#endif  // WVOXELMESHER_H
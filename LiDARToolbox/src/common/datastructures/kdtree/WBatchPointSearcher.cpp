@@ -0,0 +1,547 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../../math/mortonCode/WMortonCode.h"
+#include "WBatchPointSearcher.h"
+
+using std::numeric_limits;
+
+/**
+ * Thread pool task that counts the neighbors of queries.
+ */
+template< typename T > class WBatchNeighborCountTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param searcher Searcher that examines a single query.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param dimensions Dimension count of the queries.
+     * \param queryOrder Order in which the queries are processed.
+     * \param neighborCounts Output neighbor count of each query.
+     * \param threadCount Thread count of the processing pool.
+     */
+    WBatchNeighborCountTask( WBatchPointSearcher* searcher, const vector<T>& queryCoordinates, size_t dimensions,
+            const vector<size_t>& queryOrder, vector<size_t>* neighborCounts, size_t threadCount ) :
+        m_queryCoordinates( queryCoordinates ),
+        m_queryOrder( queryOrder ),
+        m_coordinates( threadCount, vector<double>( dimensions, 0.0 ) )
+    {
+        m_searcher = searcher;
+        m_dimensions = dimensions;
+        m_neighborCounts = neighborCounts;
+    }
+
+    /**
+     * Counts the neighbors of a range of the sorted queries.
+     * \param begin First index of the range within the query order.
+     * \param end Index after the range within the query order.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        vector<double>& coordinate = m_coordinates[threadIndex];
+        size_t maxCount = m_searcher->getMaxResultPointCount();
+        for( size_t index = begin; index < end; index++ )
+        {
+            size_t query = m_queryOrder[index];
+            for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+                coordinate[dimension] = m_queryCoordinates[query * m_dimensions + dimension];
+            ( *m_neighborCounts )[query] = m_searcher->countNeighbors( coordinate, 0, maxCount );
+        }
+    }
+
+private:
+    /**
+     * Searcher that examines a single query.
+     */
+    WBatchPointSearcher* m_searcher;
+
+    /**
+     * Interleaved query coordinates.
+     */
+    const vector<T>& m_queryCoordinates;
+
+    /**
+     * Dimension count of the queries.
+     */
+    size_t m_dimensions;
+
+    /**
+     * Order in which the queries are processed.
+     */
+    const vector<size_t>& m_queryOrder;
+
+    /**
+     * Output neighbor count of each query.
+     */
+    vector<size_t>* m_neighborCounts;
+
+    /**
+     * Query coordinate buffer of each thread.
+     */
+    vector< vector<double> > m_coordinates;
+};
+
+/**
+ * Thread pool task that collects the neighbors of queries. Neighbors are put into a 
+ * separate list for each chunk. They are moved to the final array by 
+ * WBatchNeighborCopyTask after the offsets are known.
+ */
+template< typename T > class WBatchNeighborCollectTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param searcher Searcher that examines a single query.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param dimensions Dimension count of the queries.
+     * \param queryOrder Order in which the queries are processed.
+     * \param chunkSize Count of queries of a chunk.
+     * \param neighborCounts Output neighbor count of each query.
+     * \param chunkNeighbors Output neighbor indices of each chunk.
+     * \param threadCount Thread count of the processing pool.
+     */
+    WBatchNeighborCollectTask( WBatchPointSearcher* searcher, const vector<T>& queryCoordinates, size_t dimensions,
+            const vector<size_t>& queryOrder, size_t chunkSize, vector<size_t>* neighborCounts,
+            vector< vector<size_t> >* chunkNeighbors, size_t threadCount ) :
+        m_queryCoordinates( queryCoordinates ),
+        m_queryOrder( queryOrder ),
+        m_coordinates( threadCount, vector<double>( dimensions, 0.0 ) ),
+        m_nearestPoints( threadCount )
+    {
+        m_searcher = searcher;
+        m_dimensions = dimensions;
+        m_chunkSize = chunkSize;
+        m_neighborCounts = neighborCounts;
+        m_chunkNeighbors = chunkNeighbors;
+    }
+
+    /**
+     * Collects the neighbors of a range of the sorted queries.
+     * \param begin First index of the range within the query order.
+     * \param end Index after the range within the query order.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        vector<double>& coordinate = m_coordinates[threadIndex];
+        vector< pair<double, size_t> >* nearestPoints = &m_nearestPoints[threadIndex];
+        vector<size_t>* neighbors = &( *m_chunkNeighbors )[begin / m_chunkSize];
+        bool isInfinite = m_searcher->isMaxResultPointCountInfinite();
+        for( size_t index = begin; index < end; index++ )
+        {
+            size_t query = m_queryOrder[index];
+            for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+                coordinate[dimension] = m_queryCoordinates[query * m_dimensions + dimension];
+            size_t neighborsBefore = neighbors->size();
+            if( isInfinite )
+            {
+                m_searcher->collectNeighbors( coordinate, 0, neighbors );
+            }
+            else
+            {
+                nearestPoints->clear();
+                m_searcher->collectKNearestNeighbors( coordinate, 0, nearestPoints );
+                std::sort_heap( nearestPoints->begin(), nearestPoints->end() );
+                for( size_t neighbor = 0; neighbor < nearestPoints->size(); neighbor++ )
+                    neighbors->push_back( ( *nearestPoints )[neighbor].second );
+            }
+            ( *m_neighborCounts )[query] = neighbors->size() - neighborsBefore;
+        }
+    }
+
+private:
+    /**
+     * Searcher that examines a single query.
+     */
+    WBatchPointSearcher* m_searcher;
+
+    /**
+     * Interleaved query coordinates.
+     */
+    const vector<T>& m_queryCoordinates;
+
+    /**
+     * Dimension count of the queries.
+     */
+    size_t m_dimensions;
+
+    /**
+     * Order in which the queries are processed.
+     */
+    const vector<size_t>& m_queryOrder;
+
+    /**
+     * Count of queries of a chunk.
+     */
+    size_t m_chunkSize;
+
+    /**
+     * Output neighbor count of each query.
+     */
+    vector<size_t>* m_neighborCounts;
+
+    /**
+     * Output neighbor indices of each chunk.
+     */
+    vector< vector<size_t> >* m_chunkNeighbors;
+
+    /**
+     * Query coordinate buffer of each thread.
+     */
+    vector< vector<double> > m_coordinates;
+
+    /**
+     * Nearest neighbor heap of each thread.
+     */
+    vector< vector< pair<double, size_t> > > m_nearestPoints;
+};
+
+/**
+ * Thread pool task that moves the neighbors of each chunk to their final position.
+ */
+class WBatchNeighborCopyTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param queryOrder Order in which the queries were processed.
+     * \param chunkSize Count of queries of a chunk.
+     * \param neighborOffsets Index of the first neighbor of each query.
+     * \param chunkNeighbors Neighbor indices of each chunk. They are released while 
+     *                       being copied.
+     * \param neighborIndices Output point indices of the neighbors of all queries.
+     */
+    WBatchNeighborCopyTask( const vector<size_t>& queryOrder, size_t chunkSize, const vector<size_t>& neighborOffsets,
+            vector< vector<size_t> >* chunkNeighbors, vector<size_t>* neighborIndices ) :
+        m_queryOrder( queryOrder ),
+        m_neighborOffsets( neighborOffsets )
+    {
+        m_chunkSize = chunkSize;
+        m_chunkNeighbors = chunkNeighbors;
+        m_neighborIndices = neighborIndices;
+    }
+
+    /**
+     * Copies the neighbors of a range of chunks.
+     * \param begin First chunk index.
+     * \param end Index after the last chunk.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        ( void )threadIndex;
+        for( size_t chunk = begin; chunk < end; chunk++ )
+        {
+            vector<size_t>* neighbors = &( *m_chunkNeighbors )[chunk];
+            size_t source = 0;
+            size_t queryEnd = std::min( ( chunk + 1 ) * m_chunkSize, m_queryOrder.size() );
+            for( size_t index = chunk * m_chunkSize; index < queryEnd; index++ )
+            {
+                size_t query = m_queryOrder[index];
+                size_t count = m_neighborOffsets[query + 1] - m_neighborOffsets[query];
+                std::copy( neighbors->begin() + source, neighbors->begin() + source + count,
+                           m_neighborIndices->begin() + m_neighborOffsets[query] );
+                source += count;
+            }
+            vector<size_t>().swap( *neighbors );
+        }
+    }
+
+private:
+    /**
+     * Order in which the queries were processed.
+     */
+    const vector<size_t>& m_queryOrder;
+
+    /**
+     * Index of the first neighbor of each query.
+     */
+    const vector<size_t>& m_neighborOffsets;
+
+    /**
+     * Count of queries of a chunk.
+     */
+    size_t m_chunkSize;
+
+    /**
+     * Neighbor indices of each chunk.
+     */
+    vector< vector<size_t> >* m_chunkNeighbors;
+
+    /**
+     * Output point indices of the neighbors of all queries.
+     */
+    vector<size_t>* m_neighborIndices;
+};
+
+WBatchPointSearcher::WBatchPointSearcher()
+{
+    m_examinedKdTree = 0;
+    m_maxSearchDistance = 0.5;
+    m_maxResultPointCount = 50;
+    m_threadPool = WThreadPool::getSharedPool();
+}
+
+WBatchPointSearcher::WBatchPointSearcher( WKdTreeStaticND* kdTree )
+{
+    m_examinedKdTree = kdTree;
+    m_maxSearchDistance = 0.5;
+    m_maxResultPointCount = 50;
+    m_threadPool = WThreadPool::getSharedPool();
+}
+
+WBatchPointSearcher::~WBatchPointSearcher()
+{
+}
+
+void WBatchPointSearcher::getNearestNeighborCounts( const vector<double>& queryCoordinates, vector<size_t>* neighborCounts )
+{
+    countAllNeighbors( queryCoordinates, neighborCounts );
+}
+
+void WBatchPointSearcher::getNearestNeighborCounts( const vector<float>& queryCoordinates, vector<size_t>* neighborCounts )
+{
+    countAllNeighbors( queryCoordinates, neighborCounts );
+}
+
+void WBatchPointSearcher::getNearestPointIndices( const vector<double>& queryCoordinates,
+        vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices )
+{
+    collectAllNeighbors( queryCoordinates, neighborOffsets, neighborIndices );
+}
+
+void WBatchPointSearcher::getNearestPointIndices( const vector<float>& queryCoordinates,
+        vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices )
+{
+    collectAllNeighbors( queryCoordinates, neighborOffsets, neighborIndices );
+}
+
+void WBatchPointSearcher::setExaminedKdTree( WKdTreeStaticND* kdTree )
+{
+    m_examinedKdTree = kdTree;
+}
+
+void WBatchPointSearcher::setMaxSearchDistance( double distance )
+{
+    m_maxSearchDistance = distance;
+}
+
+void WBatchPointSearcher::setMaxResultPointCount( size_t maxPointCount )
+{
+    m_maxResultPointCount = maxPointCount;
+}
+
+void WBatchPointSearcher::setMaxResultPointCountInfinite()
+{
+    m_maxResultPointCount = numeric_limits< size_t >::max();
+}
+
+void WBatchPointSearcher::setThreadPool( WThreadPool* threadPool )
+{
+    m_threadPool = threadPool;
+}
+
+size_t WBatchPointSearcher::countNeighbors( const vector<double>& coordinate, size_t node, size_t maxCount )
+{
+    size_t pointCount = 0;
+    if( m_examinedKdTree->isLeafNode( node ) )
+    {
+        size_t end = m_examinedKdTree->getNodePointsEnd( node );
+        for( size_t index = m_examinedKdTree->getNodePointsBegin( node ); index < end && pointCount < maxCount; index++ )
+            if( sqrt( getSquaredDistance( coordinate, index ) ) <= m_maxSearchDistance )
+                pointCount++;
+    }
+    else
+    {
+        double pointCoord = coordinate[m_examinedKdTree->getSplittingDimension( node )];
+        if( m_examinedKdTree->lowerChildCanContain( node, pointCoord - m_maxSearchDistance ) )
+            pointCount += countNeighbors( coordinate, m_examinedKdTree->getLowerChild( node ), maxCount );
+        if( pointCount < maxCount && m_examinedKdTree->higherChildCanContain( node, pointCoord + m_maxSearchDistance ) )
+            pointCount += countNeighbors( coordinate, m_examinedKdTree->getHigherChild( node ), maxCount - pointCount );
+    }
+    return pointCount;
+}
+
+void WBatchPointSearcher::collectNeighbors( const vector<double>& coordinate, size_t node, vector<size_t>* neighborIndices )
+{
+    if( m_examinedKdTree->isLeafNode( node ) )
+    {
+        size_t end = m_examinedKdTree->getNodePointsEnd( node );
+        for( size_t index = m_examinedKdTree->getNodePointsBegin( node ); index < end; index++ )
+            if( sqrt( getSquaredDistance( coordinate, index ) ) <= m_maxSearchDistance )
+                neighborIndices->push_back( index );
+    }
+    else
+    {
+        double pointCoord = coordinate[m_examinedKdTree->getSplittingDimension( node )];
+        if( m_examinedKdTree->lowerChildCanContain( node, pointCoord - m_maxSearchDistance ) )
+            collectNeighbors( coordinate, m_examinedKdTree->getLowerChild( node ), neighborIndices );
+        if( m_examinedKdTree->higherChildCanContain( node, pointCoord + m_maxSearchDistance ) )
+            collectNeighbors( coordinate, m_examinedKdTree->getHigherChild( node ), neighborIndices );
+    }
+}
+
+void WBatchPointSearcher::collectKNearestNeighbors( const vector<double>& coordinate, size_t node,
+        vector< pair<double, size_t> >* nearestPoints )
+{
+    if( m_examinedKdTree->isLeafNode( node ) )
+    {
+        size_t end = m_examinedKdTree->getNodePointsEnd( node );
+        for( size_t index = m_examinedKdTree->getNodePointsBegin( node ); index < end; index++ )
+        {
+            pair<double, size_t> candidate( sqrt( getSquaredDistance( coordinate, index ) ), index );
+            if( candidate.first > m_maxSearchDistance )
+                continue;
+            if( nearestPoints->size() < m_maxResultPointCount )
+            {
+                nearestPoints->push_back( candidate );
+                std::push_heap( nearestPoints->begin(), nearestPoints->end() );
+            }
+            else if( candidate < nearestPoints->front() )
+            {
+                std::pop_heap( nearestPoints->begin(), nearestPoints->end() );
+                nearestPoints->back() = candidate;
+                std::push_heap( nearestPoints->begin(), nearestPoints->end() );
+            }
+        }
+    }
+    else
+    {
+        double pointCoord = coordinate[m_examinedKdTree->getSplittingDimension( node )];
+        bool isLowerCase = m_examinedKdTree->lowerChildCanContain( node, pointCoord );
+        size_t lowerChild = m_examinedKdTree->getLowerChild( node );
+        size_t higherChild = m_examinedKdTree->getHigherChild( node );
+        collectKNearestNeighbors( coordinate, isLowerCase ?lowerChild :higherChild, nearestPoints );
+        double bound = nearestPoints->size() < m_maxResultPointCount ?m_maxSearchDistance :nearestPoints->front().first;
+        if( isLowerCase ?m_examinedKdTree->higherChildCanContain( node, pointCoord + bound )
+                        :m_examinedKdTree->lowerChildCanContain( node, pointCoord - bound ) )
+            collectKNearestNeighbors( coordinate, isLowerCase ?higherChild :lowerChild, nearestPoints );
+    }
+}
+
+size_t WBatchPointSearcher::getMaxResultPointCount()
+{
+    return m_maxResultPointCount;
+}
+
+bool WBatchPointSearcher::isMaxResultPointCountInfinite()
+{
+    return m_maxResultPointCount == numeric_limits< size_t >::max();
+}
+
+template< typename T > vector<size_t> WBatchPointSearcher::getMortonOrder( const vector<T>& coordinates, size_t dimensions )
+{
+    size_t count = dimensions > 0 ?coordinates.size() / dimensions :0;
+    size_t sortedDimensions = std::min( dimensions, static_cast<size_t>( 3 ) );
+    vector<double> minCoordinate( 3, 0.0 );
+    vector<double> cellsPerUnit( 3, 0.0 );
+    for( size_t dimension = 0; dimension < sortedDimensions && count > 0; dimension++ )
+    {
+        double min = coordinates[dimension];
+        double max = coordinates[dimension];
+        for( size_t index = 1; index < count; index++ )
+        {
+            double value = coordinates[index * dimensions + dimension];
+            min = value < min ?value :min;
+            max = value > max ?value :max;
+        }
+        minCoordinate[dimension] = min;
+        cellsPerUnit[dimension] = max > min ?WMortonCode::getMaxCellCoordinate() / ( max - min ) :0.0;
+    }
+
+    vector< pair<boost::uint64_t, size_t> > codes( count );
+    boost::uint32_t cell[3] = { 0, 0, 0 };
+    for( size_t index = 0; index < count; index++ )
+    {
+        for( size_t dimension = 0; dimension < sortedDimensions; dimension++ )
+            cell[dimension] = static_cast<boost::uint32_t>( ( coordinates[index * dimensions + dimension]
+                    - minCoordinate[dimension] ) * cellsPerUnit[dimension] );
+        codes[index] = pair<boost::uint64_t, size_t>( WMortonCode::encode( cell[0], cell[1], cell[2] ), index );
+    }
+    std::sort( codes.begin(), codes.end() );
+
+    vector<size_t> order( count );
+    for( size_t index = 0; index < count; index++ )
+        order[index] = codes[index].second;
+    return order;
+}
+
+template< typename T > void WBatchPointSearcher::countAllNeighbors( const vector<T>& queryCoordinates, vector<size_t>* neighborCounts )
+{
+    size_t dimensions = m_examinedKdTree != 0 ?m_examinedKdTree->getDimensions() :3;
+    neighborCounts->assign( queryCoordinates.size() / dimensions, 0 );
+    if( m_examinedKdTree == 0 || m_examinedKdTree->isEmpty() || m_maxResultPointCount == 0 )
+        return;
+
+    vector<size_t> queryOrder = getMortonOrder( queryCoordinates, dimensions );
+    WBatchNeighborCountTask<T> task( this, queryCoordinates, dimensions, queryOrder,
+            neighborCounts, m_threadPool->getThreadCount() );
+    m_threadPool->parallelFor( &task, queryOrder.size() );
+}
+
+template< typename T > void WBatchPointSearcher::collectAllNeighbors( const vector<T>& queryCoordinates,
+        vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices )
+{
+    size_t dimensions = m_examinedKdTree != 0 ?m_examinedKdTree->getDimensions() :3;
+    size_t queryCount = queryCoordinates.size() / dimensions;
+    neighborOffsets->assign( queryCount + 1, 0 );
+    neighborIndices->clear();
+    if( m_examinedKdTree == 0 || m_examinedKdTree->isEmpty() || m_maxResultPointCount == 0 || queryCount == 0 )
+        return;
+
+    vector<size_t> queryOrder = getMortonOrder( queryCoordinates, dimensions );
+    size_t chunkSize = std::max( queryCount / ( m_threadPool->getThreadCount() * 16 ), static_cast<size_t>( 1 ) );
+    size_t chunkCount = ( queryCount + chunkSize - 1 ) / chunkSize;
+    vector<size_t> neighborCounts( queryCount, 0 );
+    vector< vector<size_t> > chunkNeighbors( chunkCount );
+    WBatchNeighborCollectTask<T> collectTask( this, queryCoordinates, dimensions, queryOrder, chunkSize,
+            &neighborCounts, &chunkNeighbors, m_threadPool->getThreadCount() );
+    m_threadPool->parallelFor( &collectTask, queryCount, chunkSize );
+
+    for( size_t query = 0; query < queryCount; query++ )
+        ( *neighborOffsets )[query + 1] = ( *neighborOffsets )[query] + neighborCounts[query];
+    neighborIndices->resize( neighborOffsets->back() );
+    WBatchNeighborCopyTask copyTask( queryOrder, chunkSize, *neighborOffsets, &chunkNeighbors, neighborIndices );
+    m_threadPool->parallelFor( &copyTask, chunkCount, 1 );
+}
+
+double WBatchPointSearcher::getSquaredDistance( const vector<double>& coordinate, size_t pointIndex )
+{
+    double sum = 0.0;
+    for( size_t dimension = 0; dimension < coordinate.size(); dimension++ )
+    {
+        double difference = m_examinedKdTree->getCoordinate( pointIndex, dimension ) - coordinate[dimension];
+        sum += difference * difference;
+    }
+    return sum;
+}
@@ -0,0 +1,240 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WBATCHPOINTSEARCHER_H
+#define WBATCHPOINTSEARCHER_H
+
+#include <utility>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "../../algorithms/threadPool/WThreadPool.h"
+#include "WKdTreeStaticND.h"
+
+using std::pair;
+using std::vector;
+
+/**
+ * Searches the neighbors of a whole set of coordinates within a WKdTreeStaticND in one 
+ * go. It is the batch counterpart of WPointSearcher. Neighbors are points within the 
+ * maximal search distance. If a maximal result point count is set then only the 
+ * nearest ones are taken.
+ *
+ * Queries are passed as an interleaved coordinate array (X, Y, Z, X, Y, Z, ...) using 
+ * the dimension count of the examined tree. They are processed in parallel on a 
+ * WThreadPool. Queries are sorted along a Morton curve before. So queries that follow 
+ * each other visit the same tree nodes which then still are cached.
+ *
+ * Found neighbors are returned as indices of the tree points (see 
+ * WKdTreeStaticND::getPoint()). Results of all queries are put into a single array. 
+ * An offset array tells where the neighbors of each query begin (compressed sparse row 
+ * layout). The neighbors of the query i are found at [offsets[i], offsets[i + 1]).
+ */
+class WBatchPointSearcher
+{
+public:
+    /**
+     * Instantiates the batch searcher.
+     */
+    WBatchPointSearcher();
+
+    /**
+     * Instantiates the batch searcher.
+     * \param kdTree The kd tree to search points in.
+     */
+    explicit WBatchPointSearcher( WKdTreeStaticND* kdTree );
+
+    /**
+     * Destroys the batch searcher.
+     */
+    virtual ~WBatchPointSearcher();
+
+    /**
+     * Counts the neighbors of each query coordinate. Counts are limited to the maximal 
+     * result point count. The search of a query stops as soon as that count is reached. 
+     * So setting it to 1 is the fastest way to test whether points exist near 
+     * coordinates.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborCounts Output neighbor count of each query coordinate.
+     */
+    void getNearestNeighborCounts( const vector<double>& queryCoordinates, vector<size_t>* neighborCounts );
+
+    /**
+     * Counts the neighbors of each query coordinate. Counts are limited to the maximal 
+     * result point count.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborCounts Output neighbor count of each query coordinate.
+     */
+    void getNearestNeighborCounts( const vector<float>& queryCoordinates, vector<size_t>* neighborCounts );
+
+    /**
+     * Returns the neighbor point indices of each query coordinate. If a maximal result 
+     * point count is set then neighbors of a query are sorted by their distance 
+     * ascending. Otherwise they are returned in the order of the tree.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborOffsets Output index of the first neighbor of each query within 
+     *                        neighborIndices. It gets an additional last item that 
+     *                        is the total neighbor count.
+     * \param neighborIndices Output point indices of the neighbors of all queries.
+     */
+    void getNearestPointIndices( const vector<double>& queryCoordinates,
+            vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices );
+
+    /**
+     * Returns the neighbor point indices of each query coordinate. If a maximal result 
+     * point count is set then neighbors of a query are sorted by their distance 
+     * ascending. Otherwise they are returned in the order of the tree.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborOffsets Output index of the first neighbor of each query within 
+     *                        neighborIndices. It gets an additional last item that 
+     *                        is the total neighbor count.
+     * \param neighborIndices Output point indices of the neighbors of all queries.
+     */
+    void getNearestPointIndices( const vector<float>& queryCoordinates,
+            vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices );
+
+    /**
+     * Sets the kd tree to search points in.
+     * \param kdTree The kd tree to search points in.
+     */
+    void setExaminedKdTree( WKdTreeStaticND* kdTree );
+
+    /**
+     * Sets the maximal distance of neighbors to their query coordinate.
+     * \param distance Maximal neighbor distance.
+     */
+    void setMaxSearchDistance( double distance );
+
+    /**
+     * Sets the maximal neighbor count of a query. Only the nearest points are taken.
+     * \param maxPointCount Maximal neighbor count of a query.
+     */
+    void setMaxResultPointCount( size_t maxPointCount );
+
+    /**
+     * Sets the maximal neighbor count of a query to infinite.
+     */
+    void setMaxResultPointCountInfinite();
+
+    /**
+     * Sets the thread pool that processes the queries. It is the shared pool by default.
+     * \param threadPool Thread pool that processes the queries.
+     */
+    void setThreadPool( WThreadPool* threadPool );
+
+    /**
+     * Counts the neighbors of a single coordinate.
+     * \param coordinate Query coordinate.
+     * \param node Currently examined node.
+     * \param maxCount The search stops when this count is reached.
+     * \return Neighbor count of the query within the node, at most maxCount.
+     */
+    size_t countNeighbors( const vector<double>& coordinate, size_t node, size_t maxCount );
+
+    /**
+     * Collects all neighbors of a single coordinate.
+     * \param coordinate Query coordinate.
+     * \param node Currently examined node.
+     * \param neighborIndices Output point indices of the neighbors.
+     */
+    void collectNeighbors( const vector<double>& coordinate, size_t node, vector<size_t>* neighborIndices );
+
+    /**
+     * Collects the nearest neighbors of a single coordinate. The neighbors are kept in a 
+     * max heap of their distance that is limited to the maximal result point count.
+     * \param coordinate Query coordinate.
+     * \param node Currently examined node.
+     * \param nearestPoints Max heap of distances and point indices of the nearest 
+     *                      neighbors found so far.
+     */
+    void collectKNearestNeighbors( const vector<double>& coordinate, size_t node, vector< pair<double, size_t> >* nearestPoints );
+
+    /**
+     * Returns the maximal result point count.
+     * \return The maximal result point count.
+     */
+    size_t getMaxResultPointCount();
+
+    /**
+     * Tells whether the maximal result point count is infinite.
+     * \return The maximal result point count is infinite or not.
+     */
+    bool isMaxResultPointCountInfinite();
+
+private:
+    /**
+     * Returns the order in which a set of coordinates lies along a Morton curve. The 
+     * first three dimensions are used.
+     * \param coordinates Interleaved coordinates.
+     * \param dimensions Dimension count of the coordinates.
+     * \return Indices of the coordinates sorted by their Morton code.
+     */
+    template< typename T > static vector<size_t> getMortonOrder( const vector<T>& coordinates, size_t dimensions );
+
+    /**
+     * Counts the neighbors of all queries.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborCounts Output neighbor count of each query coordinate.
+     */
+    template< typename T > void countAllNeighbors( const vector<T>& queryCoordinates, vector<size_t>* neighborCounts );
+
+    /**
+     * Collects the neighbors of all queries.
+     * \param queryCoordinates Interleaved query coordinates.
+     * \param neighborOffsets Output index of the first neighbor of each query.
+     * \param neighborIndices Output point indices of the neighbors of all queries.
+     */
+    template< typename T > void collectAllNeighbors( const vector<T>& queryCoordinates,
+            vector<size_t>* neighborOffsets, vector<size_t>* neighborIndices );
+
+    /**
+     * Returns the squared distance between a query coordinate and a tree point.
+     * \param coordinate Query coordinate.
+     * \param pointIndex Index of the tree point.
+     * \return Squared Euclidean distance.
+     */
+    double getSquaredDistance( const vector<double>& coordinate, size_t pointIndex );
+
+    /**
+     * Kd tree to search points in.
+     */
+    WKdTreeStaticND* m_examinedKdTree;
+
+    /**
+     * Maximal distance of neighbors to their query coordinate.
+     */
+    double m_maxSearchDistance;
+
+    /**
+     * Maximal neighbor count of a query.
+     */
+    size_t m_maxResultPointCount;
+
+    /**
+     * Thread pool that processes the queries.
+     */
+    WThreadPool* m_threadPool;
+};
+
+#endif  // WBATCHPOINTSEARCHER_H
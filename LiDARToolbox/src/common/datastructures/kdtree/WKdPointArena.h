@@ -0,0 +1,186 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WKDPOINTARENA_H
+#define WKDPOINTARENA_H
+
+#include <new>
+#include <vector>
+
+using std::vector;
+using std::size_t;
+
+/**
+ * Typed arena that keeps kd tree points of a single class. Points are constructed within 
+ * chunks of pointsPerChunk consecutive instances instead of being allocated one by one. 
+ * They can't be deleted separately. All of them are destroyed and their chunks are freed 
+ * at once by clear() or when the arena is destroyed. So the kd trees don't own their 
+ * points. Point pointers stay valid until then.
+ *
+ * Points are added by a single thread at a time. Point classes used this way should 
+ * keep their members in fixed size fields. So destroying a point doesn't free more 
+ * than its coordinate.
+ */
+template< typename T > class WKdPointArena
+{
+public:
+    /**
+     * Creates an empty arena.
+     * \param pointsPerChunk Count of points of each allocated chunk.
+     */
+    explicit WKdPointArena( size_t pointsPerChunk = 4096 );
+
+    /**
+     * Destroys all points of the arena.
+     */
+    virtual ~WKdPointArena();
+
+    /**
+     * Constructs a new point using a single constructor argument.
+     * \param argument Constructor argument of the point.
+     * \return The new point.
+     */
+    template< typename A > T* create( const A& argument );
+
+    /**
+     * Constructs a new point using two constructor arguments.
+     * \param argument1 First constructor argument of the point.
+     * \param argument2 Second constructor argument of the point.
+     * \return The new point.
+     */
+    template< typename A, typename B > T* create( const A& argument1, const B& argument2 );
+
+    /**
+     * Constructs a new point using three constructor arguments.
+     * \param argument1 First constructor argument of the point.
+     * \param argument2 Second constructor argument of the point.
+     * \param argument3 Third constructor argument of the point.
+     * \return The new point.
+     */
+    template< typename A, typename B, typename C > T* create( const A& argument1, const B& argument2, const C& argument3 );
+
+    /**
+     * Destroys all points and frees their chunks.
+     */
+    void clear();
+
+    /**
+     * Returns the count of points within the arena.
+     * \return The point count.
+     */
+    size_t getPointCount();
+
+private:
+    /**
+     * Copying isn't supported as the points are referenced by pointer.
+     * \param arena Not used.
+     */
+    WKdPointArena( const WKdPointArena& arena );
+
+    /**
+     * Copying isn't supported as the points are referenced by pointer.
+     * \param arena Not used.
+     * \return Not used.
+     */
+    WKdPointArena& operator=( const WKdPointArena& arena );
+
+    /**
+     * Returns the uninitialized storage of the next point. A new chunk is allocated if 
+     * the last one is full.
+     * \return Storage of the next point.
+     */
+    void* getNextStorage();
+
+    /**
+     * Count of points of each allocated chunk.
+     */
+    size_t m_pointsPerChunk;
+
+    /**
+     * Count of constructed points.
+     */
+    size_t m_pointCount;
+
+    /**
+     * Allocated point chunks.
+     */
+    vector<T*> m_chunks;
+};
+
+template< typename T > WKdPointArena<T>::WKdPointArena( size_t pointsPerChunk )
+{
+    m_pointsPerChunk = pointsPerChunk > 0 ?pointsPerChunk :1;
+    m_pointCount = 0;
+}
+
+template< typename T > WKdPointArena<T>::~WKdPointArena()
+{
+    clear();
+}
+
+template< typename T > template< typename A > T* WKdPointArena<T>::create( const A& argument )
+{
+    T* point = new( getNextStorage() ) T( argument );
+    m_pointCount++;
+    return point;
+}
+
+template< typename T > template< typename A, typename B > T* WKdPointArena<T>::create( const A& argument1, const B& argument2 )
+{
+    T* point = new( getNextStorage() ) T( argument1, argument2 );
+    m_pointCount++;
+    return point;
+}
+
+template< typename T > template< typename A, typename B, typename C > T* WKdPointArena<T>::create( const A& argument1,
+        const B& argument2, const C& argument3 )
+{
+    T* point = new( getNextStorage() ) T( argument1, argument2, argument3 );
+    m_pointCount++;
+    return point;
+}
+
+template< typename T > void WKdPointArena<T>::clear()
+{
+    for( size_t index = 0; index < m_pointCount; index++ )
+        m_chunks[index / m_pointsPerChunk][index % m_pointsPerChunk].~T();
+    for( size_t chunk = 0; chunk < m_chunks.size(); chunk++ )
+        ::operator delete( m_chunks[chunk] );
+    m_chunks.clear();
+    m_pointCount = 0;
+}
+
+template< typename T > size_t WKdPointArena<T>::getPointCount()
+{
+    return m_pointCount;
+}
+
+template< typename T > void* WKdPointArena<T>::getNextStorage()
+{
+    if( m_pointCount == m_chunks.size() * m_pointsPerChunk )
+        m_chunks.push_back( static_cast<T*>( ::operator new( sizeof( T ) * m_pointsPerChunk ) ) );
+    return m_chunks.back() + m_pointCount % m_pointsPerChunk;
+}
+
+#endif  // WKDPOINTARENA_H
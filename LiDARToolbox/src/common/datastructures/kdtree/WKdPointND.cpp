@@ -29,7 +29,7 @@
 
 using std::cout;
 using std::endl;
-WKdPointND::WKdPointND( vector<double> coordinate )
+WKdPointND::WKdPointND( const vector<double>& coordinate )
 {
     m_coordinate = coordinate;
 }
@@ -58,12 +58,12 @@ size_t WKdPointND::getDimensionCount()
     return m_coordinate.size();
 }
 
-vector<double> WKdPointND::getCoordinate()
+const vector<double>& WKdPointND::getCoordinate()
 {
     return m_coordinate;
 }
 
-void WKdPointND::setCoordinate( vector<double> coordinate )
+void WKdPointND::setCoordinate( const vector<double>& coordinate )
 {
     m_coordinate = coordinate;
 }
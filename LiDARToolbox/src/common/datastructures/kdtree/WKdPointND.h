@@ -43,7 +43,7 @@ public:
      * Instance to create an n dimensional kd tree point instance.
      * \param coordinate N dimensional coordinate of the new kd tree point.
      */
-    explicit WKdPointND( vector<double> coordinate );
+    explicit WKdPointND( const vector<double>& coordinate );
 
     /**
      * Instance to create a two dimensional kd tree point instance.
@@ -72,16 +72,18 @@ public:
     size_t getDimensionCount();
 
     /**
-     * Returns the coordinate of a kd tree point.
+     * Returns the coordinate of a kd tree point. The reference is valid as long as the 
+     * point exists and its coordinate isn't set again. Nothing is copied so that 
+     * searching kd trees doesn't allocate memory for each visited point.
      * \return Coordinate of a kd tree point.
      */
-    vector<double> getCoordinate();
+    const vector<double>& getCoordinate();
 
     /**
      * Sets coordinate of the point.
      * \param coordinate Point's coordinate.
      */
-    void setCoordinate( vector<double> coordinate );
+    void setCoordinate( const vector<double>& coordinate );
 
 private:
     /**
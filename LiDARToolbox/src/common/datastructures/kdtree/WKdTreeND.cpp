@@ -24,20 +24,220 @@
 
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <vector>
+#include <boost/bind/bind.hpp>
 #include "WKdTreeND.h"
 
 using std::cout;
 using std::endl;
+
+/**
+ * Predicate that tells whether a point lies on the lower side of a splitting plane. It 
+ * is used to partition points between the two children of a node.
+ */
+class WKdPointPositionLess
+{
+public:
+    /**
+     * Creates the predicate.
+     * \param dimension Splitting dimension.
+     * \param position Splitting position.
+     */
+    WKdPointPositionLess( size_t dimension, double position )
+    {
+        m_dimension = dimension;
+        m_position = position;
+    }
+
+    /**
+     * Tells whether a point lies on the lower side of the splitting plane.
+     * \param point Examined point.
+     * \return The point belongs to the lower child or not.
+     */
+    bool operator()( WKdPointND* point ) const
+    {
+        return point->getCoordinate()[m_dimension] < m_position;
+    }
+
+private:
+    /**
+     * Splitting dimension.
+     */
+    size_t m_dimension;
+
+    /**
+     * Splitting position.
+     */
+    double m_position;
+};
+
+/**
+ * Thread pool task that calculates the bounding box of a point range. Each thread 
+ * extends its own box. The boxes are merged afterwards.
+ */
+class WKdBoundingBoxTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param points Points of which the range is examined.
+     * \param begin First index of the examined range.
+     * \param dimensions Dimension count of the points.
+     * \param threadCount Thread count of the processing pool.
+     */
+    WKdBoundingBoxTask( vector<WKdPointND* >* points, size_t begin, size_t dimensions, size_t threadCount ) :
+        m_boundingBoxMin( threadCount, vector<double>( dimensions, std::numeric_limits<double>::max() ) ),
+        m_boundingBoxMax( threadCount, vector<double>( dimensions, -std::numeric_limits<double>::max() ) )
+    {
+        m_points = points;
+        m_begin = begin;
+        m_dimensions = dimensions;
+    }
+
+    /**
+     * Extends the bounding box of a thread by a range of points.
+     * \param begin First point index relative to the examined range.
+     * \param end Index after the last point relative to the examined range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        vector<double>& boundingBoxMin = m_boundingBoxMin[threadIndex];
+        vector<double>& boundingBoxMax = m_boundingBoxMax[threadIndex];
+        for( size_t index = m_begin + begin; index < m_begin + end; index++ )
+        {
+            const vector<double>& coordinate = ( *m_points )[index]->getCoordinate();
+            for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+            {
+                double position = coordinate[dimension];
+                if( position < boundingBoxMin[dimension] )
+                    boundingBoxMin[dimension] = position;
+                if( position > boundingBoxMax[dimension] )
+                    boundingBoxMax[dimension] = position;
+            }
+        }
+    }
+
+    /**
+     * Returns the merged bounding box minimum of all threads.
+     * \param dimension Dimension of the returned minimum.
+     * \return The bounding box minimum.
+     */
+    double getBoundingBoxMin( size_t dimension )
+    {
+        double min = m_boundingBoxMin[0][dimension];
+        for( size_t thread = 1; thread < m_boundingBoxMin.size(); thread++ )
+            min = m_boundingBoxMin[thread][dimension] < min ?m_boundingBoxMin[thread][dimension] :min;
+        return min;
+    }
+
+    /**
+     * Returns the merged bounding box maximum of all threads.
+     * \param dimension Dimension of the returned maximum.
+     * \return The bounding box maximum.
+     */
+    double getBoundingBoxMax( size_t dimension )
+    {
+        double max = m_boundingBoxMax[0][dimension];
+        for( size_t thread = 1; thread < m_boundingBoxMax.size(); thread++ )
+            max = m_boundingBoxMax[thread][dimension] > max ?m_boundingBoxMax[thread][dimension] :max;
+        return max;
+    }
+
+private:
+    /**
+     * Points of which the range is examined.
+     */
+    vector<WKdPointND* >* m_points;
+
+    /**
+     * First index of the examined range.
+     */
+    size_t m_begin;
+
+    /**
+     * Dimension count of the points.
+     */
+    size_t m_dimensions;
+
+    /**
+     * Bounding box minimum of each thread.
+     */
+    vector< vector<double> > m_boundingBoxMin;
+
+    /**
+     * Bounding box maximum of each thread.
+     */
+    vector< vector<double> > m_boundingBoxMax;
+};
+
+/**
+ * Thread pool task that copies a single coordinate of a point range into a contiguous 
+ * array.
+ */
+class WKdCoordinateGatherTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param points Points of which the range is copied.
+     * \param begin First index of the copied range.
+     * \param dimension Dimension of the copied coordinate.
+     * \param line Target coordinate array. It must have the size of the range.
+     */
+    WKdCoordinateGatherTask( vector<WKdPointND* >* points, size_t begin, size_t dimension, vector<double>* line )
+    {
+        m_points = points;
+        m_begin = begin;
+        m_dimension = dimension;
+        m_line = line;
+    }
+
+    /**
+     * Copies the coordinates of a range of points.
+     * \param begin First point index relative to the copied range.
+     * \param end Index after the last point relative to the copied range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        ( void )threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            ( *m_line )[index] = ( *m_points )[m_begin + index]->getCoordinate()[m_dimension];
+    }
+
+private:
+    /**
+     * Points of which the range is copied.
+     */
+    vector<WKdPointND* >* m_points;
+
+    /**
+     * First index of the copied range.
+     */
+    size_t m_begin;
+
+    /**
+     * Dimension of the copied coordinate.
+     */
+    size_t m_dimension;
+
+    /**
+     * Target coordinate array.
+     */
+    vector<double>* m_line;
+};
+
+const size_t WKdTreeND::parallelBuildPointCount = 50000;
+
 WKdTreeND::WKdTreeND()
 {
     m_dimensions = 3;
     m_splittingDimension = 0;
     m_splittingPosition = 0.0;
     m_allowDoubles = true;
-    m_points = new vector<WKdPointND* >();
     m_parentSplittingDimension = 3;
-    m_hierarchyLevel = 0;
     m_higherChild = 0;
     m_lowerChild = 0;
 }
@@ -48,18 +248,13 @@ WKdTreeND::WKdTreeND( size_t dimensions )
     m_splittingDimension = 0;
     m_splittingPosition = 0.0;
     m_allowDoubles = true;
-    m_points = new vector<WKdPointND* >();
     m_parentSplittingDimension = dimensions;
-    m_hierarchyLevel = 0;
     m_higherChild = 0;
     m_lowerChild = 0;
 }
 
 WKdTreeND::~WKdTreeND()
 {
-    for( size_t index = 0; index < m_points->size(); index++ )
-        delete m_points->at( index );
-    delete m_points;
     if( m_lowerChild != 0 )
     {
         delete m_lowerChild;
@@ -74,47 +269,9 @@ void WKdTreeND::add( vector<WKdPointND*>* addables )
 {
     if( addables->size() == 0 )
         return;
-    for( size_t index = 0; index < addables->size(); index++ )
-        m_points->push_back( addables->at( index ) );
-
-    if( m_lowerChild == 0 && m_lowerChild == 0 )
-    {
-        determineNewSplittingDimension( m_points );
-        if( canSplit() )
-        {
-            if( m_points->size() == 2 )
-            {
-                double point1Scalar = m_points->at( 0 )->getCoordinate()[m_splittingDimension];
-                double point2Scalar = m_points->at( 1 )->getCoordinate()[m_splittingDimension];
-                m_splittingPosition = ( point1Scalar + point2Scalar ) / 2.0;
-                if( m_splittingPosition == point2Scalar && point1Scalar > point2Scalar )
-                    m_splittingPosition = point1Scalar;
-                if( m_splittingPosition == point1Scalar && point2Scalar > point1Scalar )
-                    m_splittingPosition = point2Scalar;
-            }
-            else
-            {
-                calculateSplittingPosition( m_points );
-            }
-            initSubNodes();
-            addPointsToChildren( m_points );
-            m_points->resize( 0 );
-            m_points->reserve( 0 );
-        }
-    }
-    else
-    {
-        if( m_lowerChild != 0 && m_lowerChild != 0 )
-        {
-            addPointsToChildren( m_points );
-            m_points->resize( 0 );
-            m_points->reserve( 0 );
-        }
-        else
-        {
-            cout << "!!!UNKNOWN EXCEPTION!!! - adding items" << endl;
-        }
-    }
+    vector<WKdPointND*>* points = new vector<WKdPointND*>( *addables );
+    addPointRange( points, 0, points->size() );
+    delete points;
 }
 
 bool WKdTreeND::canSplit()
@@ -126,8 +283,8 @@ void WKdTreeND::assignZeroToPointers()
 {
     m_lowerChild = 0;
     m_higherChild = 0;
-    m_points->resize( 0 );
-    m_points->reserve( 0 );
+    m_points.resize( 0 );
+    m_points.reserve( 0 );
 }
 
 void WKdTreeND::copyPointersFrom( WKdTreeND* copiedNode )
@@ -139,29 +296,29 @@ void WKdTreeND::copyPointersFrom( WKdTreeND* copiedNode )
     m_splittingDimension = copiedNode->m_splittingDimension;
     m_splittingPosition = copiedNode->m_splittingPosition;
     m_allowDoubles = copiedNode->m_allowDoubles;
-    m_points->resize( 0 );
-    m_points->reserve( 0 );
-    for( size_t index = 0; index < copiedNode->m_points->size(); index++ )
-        m_points->push_back( copiedNode->m_points->at( index ) );
+    m_points.resize( 0 );
+    m_points.reserve( 0 );
+    for( size_t index = 0; index < copiedNode->m_points.size(); index++ )
+        m_points.push_back( copiedNode->m_points.at( index ) );
 }
 
 void WKdTreeND::fetchPoints( vector<WKdPointND* >* targetPointSet )
 {
-    if( m_points->size() > 0 && m_lowerChild == 0 && m_lowerChild == 0 )
+    if( m_points.size() > 0 && m_lowerChild == 0 && m_lowerChild == 0 )
     {
-        for(size_t index = 0; index < m_points->size(); index++)
-            targetPointSet->push_back( m_points->at( index ) );
+        for(size_t index = 0; index < m_points.size(); index++)
+            targetPointSet->push_back( m_points.at( index ) );
     }
     else
     {
-        if( m_points->size() == 0 && m_lowerChild != 0 && m_lowerChild != 0 )
+        if( m_points.size() == 0 && m_lowerChild != 0 && m_lowerChild != 0 )
         {
             m_lowerChild->fetchPoints( targetPointSet );
             m_higherChild->fetchPoints( targetPointSet );
         }
         else
         {
-            if( m_points->size() != 0 || m_lowerChild != 0 || m_lowerChild != 0 )
+            if( m_points.size() != 0 || m_lowerChild != 0 || m_lowerChild != 0 )
                 cout << "!!!UNKNOWN EXCEPTION!!!" << endl;
         }
     }
@@ -174,8 +331,7 @@ vector<WKdPointND*>* WKdTreeND::getAllPoints()
     for( size_t nodeIndex = 0; nodeIndex < kdNodes->size(); nodeIndex++ )
         for( size_t pointIndex = 0; pointIndex < kdNodes->at( nodeIndex )->getNodePoints()->size(); pointIndex++ )
             outputPoints->push_back( kdNodes->at( nodeIndex )->getNodePoints()->at( pointIndex ) );
-    kdNodes->resize( 0 );
-    kdNodes->reserve( 0 );
+    delete kdNodes;
     return outputPoints;
 }
 
@@ -203,7 +359,7 @@ WKdTreeND* WKdTreeND::getLowerChild()
 
 vector<WKdPointND*>* WKdTreeND::getNodePoints()
 {
-    return m_points;
+    return &m_points;
 }
 
 size_t WKdTreeND::getSplittingDimension()
@@ -213,7 +369,7 @@ size_t WKdTreeND::getSplittingDimension()
 
 bool WKdTreeND::isEmpty()
 {
-    return m_points->size() == 0 && m_lowerChild == 0 && m_lowerChild == 0;
+    return m_points.size() == 0 && m_lowerChild == 0 && m_lowerChild == 0;
 }
 
 bool WKdTreeND::isLowerKdNodeCase( double position )
@@ -223,24 +379,24 @@ bool WKdTreeND::isLowerKdNodeCase( double position )
 
 bool WKdTreeND::removePoint( WKdPointND* removablePoint )
 {
-    if( m_points->size() > 0 && m_lowerChild == 0 && m_lowerChild == 0 )
+    if( m_points.size() > 0 && m_lowerChild == 0 && m_lowerChild == 0 )
     {
         size_t keptNodeCount = 0;
-        size_t size = m_points->size();
+        size_t size = m_points.size();
         for(size_t index = 0; index < size; index++)
-            if( m_points->at( index ) != removablePoint )
+            if( m_points.at( index ) != removablePoint )
             {
                 if( index > keptNodeCount )
-                    m_points->at( keptNodeCount ) = m_points->at( index );
+                    m_points.at( keptNodeCount ) = m_points.at( index );
                 keptNodeCount++;
             }
-        m_points->resize( keptNodeCount );
-        m_points->reserve( keptNodeCount );
+        m_points.resize( keptNodeCount );
+        m_points.reserve( keptNodeCount );
         return keptNodeCount < size;
     }
     else
     {
-        if( m_points->size() == 0 && m_lowerChild != 0 && m_lowerChild != 0 )
+        if( m_points.size() == 0 && m_lowerChild != 0 && m_lowerChild != 0 )
         {
             double position = removablePoint->getCoordinate()[getSplittingDimension()];
             WKdTreeND* deletedNode = isLowerKdNodeCase( position ) ?m_lowerChild :m_higherChild;
@@ -258,7 +414,7 @@ bool WKdTreeND::removePoint( WKdPointND* removablePoint )
         }
         else
         {
-            if( m_points->size() != 0 || m_lowerChild != 0 || m_lowerChild != 0 )
+            if( m_points.size() != 0 || m_lowerChild != 0 || m_lowerChild != 0 )
                 cout << "!!!UNKNOWN EXCEPTION!!!" << endl;
         }
     }
@@ -270,149 +426,160 @@ WKdTreeND* WKdTreeND::getNewInstance( size_t dimensions )
     return new WKdTreeND( dimensions );
 }
 
-void WKdTreeND::addPointsToChildren( vector<WKdPointND* >* newPoints )
+void WKdTreeND::addPointRange( vector<WKdPointND* >* points, size_t begin, size_t end )
 {
-    vector<WKdPointND* >* lowerPoints = new vector<WKdPointND* >();
-    vector<WKdPointND* >* higherPoints = new vector<WKdPointND* >();
-    for( size_t index = 0; index < newPoints->size(); index++ )
+    if( begin >= end )
+        return;
+    if( m_lowerChild == 0 && m_higherChild == 0 )
     {
-        WKdPointND* newPoint = newPoints->at( index );
-        double position = newPoint->getCoordinate().at( m_splittingDimension );
-        if( isLowerKdNodeCase( position ) )
+        if( m_points.size() == 0 )
         {
-            lowerPoints->push_back( newPoint );
+            buildFromPointRange( points, begin, end );
         }
         else
         {
-            higherPoints->push_back( newPoint );
+            vector<WKdPointND* > nodePoints;
+            nodePoints.swap( m_points );
+            nodePoints.insert( nodePoints.end(), points->begin() + begin, points->begin() + end );
+            buildFromPointRange( &nodePoints, 0, nodePoints.size() );
         }
     }
+    else
+    {
+        if( m_lowerChild != 0 && m_higherChild != 0 )
+        {
+            addPointsToChildren( points, begin, end );
+        }
+        else
+        {
+            cout << "!!!UNKNOWN EXCEPTION!!! - adding items" << endl;
+        }
+    }
+}
 
-    size_t hierarchyLevel = m_hierarchyLevel;
-    if( hierarchyLevel > 2 )
+void WKdTreeND::buildFromPointRange( vector<WKdPointND* >* points, size_t begin, size_t end )
+{
+    if( !determineNewSplittingDimension( points, begin, end ) )
+    {
+        m_points.assign( points->begin() + begin, points->begin() + end );
+        return;
+    }
+    if( end - begin == 2 )
     {
-        m_lowerChild->add( lowerPoints );
-        m_higherChild->add( higherPoints );
+        double point1Scalar = points->at( begin )->getCoordinate()[m_splittingDimension];
+        double point2Scalar = points->at( begin + 1 )->getCoordinate()[m_splittingDimension];
+        m_splittingPosition = ( point1Scalar + point2Scalar ) / 2.0;
+        if( m_splittingPosition == point2Scalar && point1Scalar > point2Scalar )
+            m_splittingPosition = point1Scalar;
+        if( m_splittingPosition == point1Scalar && point2Scalar > point1Scalar )
+            m_splittingPosition = point2Scalar;
     }
     else
     {
-        boost::thread lowerChildThread( &WKdTreeND::add, m_lowerChild, lowerPoints );
-        boost::thread higherChildThread( &WKdTreeND::add, m_higherChild, higherPoints );
-        lowerChildThread.join();
-        higherChildThread.join();
+        calculateSplittingPosition( points, begin, end );
     }
-
-    lowerPoints->reserve( 0 );
-    lowerPoints->resize( 0 );
-    higherPoints->reserve( 0 );
-    higherPoints->resize( 0 );
-    delete lowerPoints;
-    delete higherPoints;
+    initSubNodes();
+    addPointsToChildren( points, begin, end );
 }
 
-void WKdTreeND::calculateSplittingPosition( vector<WKdPointND* >* inputPoints )
+void WKdTreeND::addPointsToChildren( vector<WKdPointND* >* points, size_t begin, size_t end )
 {
-    if( !canSplit() )
-        return;
-    size_t count = inputPoints->size();
-    vector<double>* line = new vector<double>( inputPoints->size(), 0 );
-    for( size_t index = 0; index < inputPoints->size(); index++ )
-        line->at( index ) = inputPoints->at( index )->getCoordinate()[m_splittingDimension];
-    std::sort( line->begin(), line->end() );
-    size_t medianIdx = count / 2;
-    m_splittingPosition = line->at( medianIdx );
-    size_t medianLeftIdx = medianIdx - 1;
-    double medianLeft = line->at( medianLeftIdx );
-    bool leftIdxValid = true;
-    size_t medianRightIdx = medianIdx;
-    double medianRight = line->at( medianRightIdx );
-    bool rightIdxValid = true;
-    while( rightIdxValid && medianRight == medianLeft )
+    vector<WKdPointND* >::iterator boundary = std::partition( points->begin() + begin, points->begin() + end,
+            WKdPointPositionLess( m_splittingDimension, m_splittingPosition ) );
+    size_t middle = boundary - points->begin();
+
+    if( end - begin < parallelBuildPointCount )
     {
-        if( medianRightIdx + 1 < inputPoints->size() )
-        {
-            medianRightIdx++;
-            medianRight = line->at( medianRightIdx );
-        }
-        else
-        {
-            rightIdxValid = false;
-        }
+        m_lowerChild->addPointRange( points, begin, middle );
+        m_higherChild->addPointRange( points, middle, end );
     }
-    while( leftIdxValid && medianLeftIdx < inputPoints->size() && medianLeft == m_splittingPosition )
+    else
     {
-        if( medianLeftIdx > 0 )
-        {
-            medianLeftIdx--;
-            medianLeft = line->at( medianLeftIdx );
-        }
-        else
-        {
-            leftIdxValid = false;
-        }
+        vector< boost::function<void ()> > childBuilds;
+        childBuilds.push_back( boost::bind( &WKdTreeND::addPointRange, m_lowerChild, points, begin, middle ) );
+        childBuilds.push_back( boost::bind( &WKdTreeND::addPointRange, m_higherChild, points, middle, end ) );
+        WThreadPool::getSharedPool()->parallelInvoke( childBuilds );
     }
-    if( leftIdxValid && rightIdxValid )
+}
+
+void WKdTreeND::calculateSplittingPosition( vector<WKdPointND* >* points, size_t begin, size_t end )
+{
+    if( !canSplit() )
+        return;
+    size_t count = end - begin;
+    vector<double>* line = new vector<double>( count, 0 );
+    WKdCoordinateGatherTask gatherTask( points, begin, m_splittingDimension, line );
+    if( count < parallelBuildPointCount )
+        gatherTask.processRange( 0, count, 0 );
+    else
+        WThreadPool::getSharedPool()->parallelFor( &gatherTask, count );
+
+    size_t medianIdx = count / 2;
+    std::nth_element( line->begin(), line->begin() + medianIdx, line->end() );
+    double median = line->at( medianIdx );
+    double medianLeft = *std::max_element( line->begin(), line->begin() + medianIdx );
+    double lowerScalar = medianLeft;
+    double higherScalar = median;
+    if( medianLeft == median )
     {
-        if( medianRightIdx - medianIdx < medianIdx - medianLeftIdx - 1 )
+        // The median is repeated. The boundary moves to the nearest end of the run of 
+        // equal coordinates, as if the coordinate list were sorted.
+        size_t lowerCount = 0;
+        size_t higherCount = 0;
+        double lowerMax = median;
+        double higherMin = median;
+        for( size_t index = 0; index < count; index++ )
         {
-            medianIdx = medianRightIdx;
-        }
-        else
-        {
-            medianIdx = medianLeftIdx + 1;
+            double position = line->at( index );
+            if( position < median )
+            {
+                lowerMax = lowerCount == 0 || position > lowerMax ?position :lowerMax;
+                lowerCount++;
+            }
+            if( position > median )
+            {
+                higherMin = higherCount == 0 || position < higherMin ?position :higherMin;
+                higherCount++;
+            }
         }
-    }
-    else
-    {
-        if( leftIdxValid )
+        size_t medianRightIdx = count - higherCount;
+        bool leftIdxValid = lowerCount > 0;
+        bool rightIdxValid = higherCount > 0;
+        if( leftIdxValid && ( !rightIdxValid || medianRightIdx - medianIdx >= medianIdx - lowerCount ) )
         {
-            medianIdx = medianLeftIdx + 1;
+            lowerScalar = lowerMax;
         }
         else
         {
             if( rightIdxValid )
-            {
-                medianIdx = medianRightIdx;
-            }
+                higherScalar = higherMin;
             else
-            {
                 cout << "!!!UNKNOWN EXCEPTION!!!" << endl;
-            }
         }
     }
 
-
-    m_splittingPosition = ( line->at( medianIdx - 1 ) + line->at( medianIdx ) ) / 2.0;
-    if( m_splittingPosition == line->at( medianIdx - 1 ) )
-        m_splittingPosition = line->at( medianIdx );
+    m_splittingPosition = ( lowerScalar + higherScalar ) / 2.0;
+    if( m_splittingPosition == lowerScalar )
+        m_splittingPosition = higherScalar;
     delete line;
 }
 
-bool WKdTreeND::determineNewSplittingDimension( vector<WKdPointND* >* inputPoints )
+bool WKdTreeND::determineNewSplittingDimension( vector<WKdPointND* >* points, size_t begin, size_t end )
 {
     m_splittingDimension = m_dimensions;
-    if( inputPoints->size() < 2 )
+    if( end - begin < 2 )
         return false;
-    vector<double>* boundingBoxMin = new vector<double>();
-    vector<double>* boundingBoxMax = new vector<double>();
-    boundingBoxMin->reserve( m_dimensions );
-    boundingBoxMin->resize( m_dimensions );
-    boundingBoxMax->reserve( m_dimensions );
-    boundingBoxMax->resize( m_dimensions );
-    for( size_t index = 0; index < inputPoints->size(); index++ )
-        for( size_t dimension = 0; dimension < getDimensions(); dimension++ )
-        {
-            double position = inputPoints->at( index )->getCoordinate().at( dimension );
-            if( index == 0 || position < boundingBoxMin->at( dimension ) )
-                boundingBoxMin->at( dimension ) = position;
-            if( index == 0 || position > boundingBoxMax->at( dimension ) )
-                boundingBoxMax->at( dimension ) = position;
-        }
+    size_t threadCount = end - begin < parallelBuildPointCount ?1 :WThreadPool::getSharedPool()->getThreadCount();
+    WKdBoundingBoxTask boundingBox( points, begin, getDimensions(), threadCount );
+    if( threadCount == 1 )
+        boundingBox.processRange( 0, end - begin, 0 );
+    else
+        WThreadPool::getSharedPool()->parallelFor( &boundingBox, end - begin );
 
     double spreadMax = 0.0;
     for( size_t dimension = 0; dimension < getDimensions(); dimension++ )
     {
-        double currentSpread = boundingBoxMax->at( dimension ) - boundingBoxMin->at( dimension );
+        double currentSpread = boundingBox.getBoundingBoxMax( dimension ) - boundingBox.getBoundingBoxMin( dimension );
         if( dimension != m_parentSplittingDimension && currentSpread > spreadMax )
         {
             spreadMax = currentSpread;
@@ -420,22 +587,21 @@ bool WKdTreeND::determineNewSplittingDimension( vector<WKdPointND* >* inputPoint
         }
     }
     if( m_splittingDimension >= m_dimensions && m_parentSplittingDimension < m_dimensions
-            && boundingBoxMax->at( m_parentSplittingDimension ) - boundingBoxMin->at( m_parentSplittingDimension ) > 0.0 )
+            && boundingBox.getBoundingBoxMax( m_parentSplittingDimension )
+               - boundingBox.getBoundingBoxMin( m_parentSplittingDimension ) > 0.0 )
         m_splittingDimension = m_parentSplittingDimension;
-    delete boundingBoxMin;
-    delete boundingBoxMax;
     return m_splittingDimension < m_dimensions;
 }
 
 void WKdTreeND::fetchAllLeafNodes( vector<WKdTreeND*>* targetNodeList )
 {
-    if( m_points->size() > 0 && m_lowerChild == 0 && m_higherChild == 0 )
+    if( m_points.size() > 0 && m_lowerChild == 0 && m_higherChild == 0 )
     {
         targetNodeList->push_back( this );
     }
     else
     {
-        if( m_points->size() == 0 && m_lowerChild != 0 && m_higherChild != 0 )
+        if( m_points.size() == 0 && m_lowerChild != 0 && m_higherChild != 0 )
         {
             m_lowerChild->fetchAllLeafNodes( targetNodeList );
             m_higherChild->fetchAllLeafNodes( targetNodeList );
@@ -458,6 +624,4 @@ void WKdTreeND::initSubNodes()
     m_higherChild = getNewInstance( m_dimensions );
     m_lowerChild->m_parentSplittingDimension = m_splittingDimension;
     m_higherChild->m_parentSplittingDimension = m_splittingDimension;
-    m_lowerChild->m_hierarchyLevel = m_hierarchyLevel + 1;
-    m_higherChild->m_hierarchyLevel = m_hierarchyLevel + 1;
 }
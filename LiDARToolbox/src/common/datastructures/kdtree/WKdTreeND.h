@@ -28,7 +28,7 @@
 #include <vector>
 #include <algorithm>
 #include "WKdPointND.h"
-#include <boost/thread.hpp>
+#include "../../algorithms/threadPool/WThreadPool.h"
 
 using std::vector;
 using std::size_t;
@@ -38,6 +38,8 @@ using std::endl;
 /**
  * This is a unidimensional kd tree compound. It is proposed not only to work with two 
  * or three dimensional kd trees but also with a single or more than three dimensions.
+ * The tree doesn't own its points. They are usually kept in a WKdPointArena that 
+ * outlives the tree.
  */
 class WKdTreeND
 {
@@ -51,7 +53,7 @@ public:
     explicit WKdTreeND( size_t dimensions );
 
     /**
-     * Destroys an n dimensional kd tree node.
+     * Destroys an n dimensional kd tree node and its children. Its points are kept.
      */
     virtual ~WKdTreeND();
 
@@ -177,30 +179,58 @@ private:
      */
     vector<WKdTreeND*>* getAllLeafNodes();
 
+    /**
+     * Adds a range of points to the node. The range is reordered in place while points 
+     * are distributed to child nodes. Child nodes of large ranges are processed in 
+     * parallel.
+     * \param points Point list that contains the range.
+     * \param begin First index of the range.
+     * \param end Index after the last point of the range.
+     */
+    void addPointRange( vector<WKdPointND* >* points, size_t begin, size_t end );
+
+    /**
+     * Builds an empty leaf node from a range of points. It either keeps the points or 
+     * splits the node. Afterwards the range is partitioned between the two new children.
+     * \param points Point list that contains the range.
+     * \param begin First index of the range.
+     * \param end Index after the last point of the range.
+     */
+    void buildFromPointRange( vector<WKdPointND* >* points, size_t begin, size_t end );
+
     /**
      * This method is used by the method to add new points. It puts points either to the 
      * node of the lower or higher position across the splitting dimension. The method is 
-     * executed after the splitting dimension and position are calculated.
-     * \param newPoints Points to append to child nodes.
+     * executed after the splitting dimension and position are calculated. Points are 
+     * partitioned in place.
+     * \param points Point list that contains the range.
+     * \param begin First index of the range to append to child nodes.
+     * \param end Index after the last point of the range.
      */
-    void addPointsToChildren( vector<WKdPointND* >* newPoints );
+    void addPointsToChildren( vector<WKdPointND* >* points, size_t begin, size_t end );
 
     /**
      * Calculates the splitting position between the two child nodes. It calculates the 
      * median of all input points across the splitting dimension between two children. 
-     * Always check out the splitting dimension before that.
-     * \param points Input points to calculate the median across the splitted dimension.
+     * Always check out the splitting dimension before that. The median is selected in 
+     * linear time. Ties are resolved like in a fully sorted coordinate list.
+     * \param points Point list that contains the range.
+     * \param begin First index of the range.
+     * \param end Index after the last point of the range.
      */
-    void calculateSplittingPosition( vector<WKdPointND* >* points );
+    void calculateSplittingPosition( vector<WKdPointND* >* points, size_t begin, size_t end );
 
     /**
      * Determines the new splitting dimension between two child nodes. Afterwards the 
      * splitting position can be calculated across that dimension after executing that 
      * method.
-     * \param inputPoints Input points to analyse the most optimal splitting dimension.
+     * \param points Point list that contains the range.
+     * \param begin First index of the range to analyse the most optimal splitting 
+     *              dimension.
+     * \param end Index after the last point of the range.
      * \return The kd tree node can be split or not.
      */
-    bool determineNewSplittingDimension( vector<WKdPointND* >* inputPoints );
+    bool determineNewSplittingDimension( vector<WKdPointND* >* points, size_t begin, size_t end );
 
     /**
      * Fetches all kd tree leaf nodes into a node list.
@@ -230,9 +260,9 @@ private:
     size_t m_parentSplittingDimension;    //TODO(aschwarzkopf): ggf. wegschmeißen
 
     /**
-     * Herarchy level of the kd-tree node. It is used for multithreading regulation.
+     * Minimal point count of a node of which the children are built in parallel.
      */
-    size_t m_hierarchyLevel;
+    static const size_t parallelBuildPointCount;
 
     //TODO(aschwarzkopf): Ggf. Sinn: Nicht bis ins Letzte unterteilen, ggf. nur über einem Threshold
     /**
@@ -276,7 +306,7 @@ private:
     /**
      * Points covered by a kd tree node.
      */
-    vector<WKdPointND* >* m_points;
+    vector<WKdPointND* > m_points;
 };
 
 #endif  // WKDTREEND_H
@@ -0,0 +1,248 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "WKdTreeStaticND.h"
+
+/**
+ * Sorting criterion that compares point indices by their coordinate within a single 
+ * dimension. It is used for the median selection of the static kd tree.
+ */
+class WKdCoordinateOrder
+{
+public:
+    /**
+     * Creates the sorting criterion.
+     * \param coordinates Coordinates of a single dimension. The array is indexed by the 
+     *                    compared point indices.
+     */
+    explicit WKdCoordinateOrder( const double* coordinates )
+    {
+        m_coordinates = coordinates;
+    }
+
+    /**
+     * Compares two point indices by their coordinate.
+     * \param left First point index.
+     * \param right Second point index.
+     * \return The first coordinate is smaller than the second or not.
+     */
+    bool operator()( size_t left, size_t right ) const
+    {
+        return m_coordinates[left] < m_coordinates[right];
+    }
+
+private:
+    /**
+     * Coordinates of a single dimension.
+     */
+    const double* m_coordinates;
+};
+
+WKdTreeStaticND::WKdTreeStaticND()
+{
+    m_dimensions = 3;
+    m_maxLeafPointCount = 8;
+    m_innerNodeCount = 0;
+}
+
+WKdTreeStaticND::WKdTreeStaticND( size_t dimensions )
+{
+    m_dimensions = dimensions;
+    m_maxLeafPointCount = 8;
+    m_innerNodeCount = 0;
+}
+
+WKdTreeStaticND::~WKdTreeStaticND()
+{
+}
+
+void WKdTreeStaticND::add( vector<WKdPointND*>* addables )
+{
+    if( addables->size() == 0 )
+        return;
+    m_points.reserve( m_points.size() + addables->size() );
+    for( size_t index = 0; index < addables->size(); index++ )
+        m_points.push_back( addables->at( index ) );
+    buildTree();
+}
+
+void WKdTreeStaticND::fetchPoints( vector<WKdPointND* >* targetPointSet )
+{
+    targetPointSet->insert( targetPointSet->end(), m_points.begin(), m_points.end() );
+}
+
+vector<WKdPointND*>* WKdTreeStaticND::getAllPoints()
+{
+    return new vector<WKdPointND*>( m_points );
+}
+
+size_t WKdTreeStaticND::getDimensions()
+{
+    return m_dimensions;
+}
+
+size_t WKdTreeStaticND::getPointCount()
+{
+    return m_points.size();
+}
+
+bool WKdTreeStaticND::isEmpty()
+{
+    return m_points.size() == 0;
+}
+
+WKdPointND* WKdTreeStaticND::getPoint( size_t pointIndex )
+{
+    return m_points[pointIndex];
+}
+
+double WKdTreeStaticND::getCoordinate( size_t pointIndex, size_t dimension )
+{
+    return m_coordinates[dimension * m_points.size() + pointIndex];
+}
+
+size_t WKdTreeStaticND::getRootNode()
+{
+    return 0;
+}
+
+bool WKdTreeStaticND::isLeafNode( size_t node )
+{
+    return node >= m_innerNodeCount;
+}
+
+size_t WKdTreeStaticND::getLowerChild( size_t node )
+{
+    return node * 2 + 1;
+}
+
+size_t WKdTreeStaticND::getHigherChild( size_t node )
+{
+    return node * 2 + 2;
+}
+
+size_t WKdTreeStaticND::getSplittingDimension( size_t node )
+{
+    return m_splittingDimensions[node];
+}
+
+bool WKdTreeStaticND::lowerChildCanContain( size_t node, double position )
+{
+    return position <= m_splittingPositions[node];
+}
+
+bool WKdTreeStaticND::higherChildCanContain( size_t node, double position )
+{
+    return position >= m_splittingPositions[node];
+}
+
+size_t WKdTreeStaticND::getNodePointsBegin( size_t node )
+{
+    return m_leafBegins[node - m_innerNodeCount];
+}
+
+size_t WKdTreeStaticND::getNodePointsEnd( size_t node )
+{
+    return m_leafBegins[node - m_innerNodeCount + 1];
+}
+
+void WKdTreeStaticND::buildTree()
+{
+    size_t count = m_points.size();
+    size_t depth = 0;
+    while( ( ( count - 1 ) >> depth ) + 1 > m_maxLeafPointCount )
+        depth++;
+    size_t leafCount = static_cast<size_t>( 1 ) << depth;
+    m_innerNodeCount = leafCount - 1;
+    m_splittingDimensions.assign( m_innerNodeCount, 0 );
+    m_splittingPositions.assign( m_innerNodeCount, 0.0 );
+    m_leafBegins.assign( leafCount + 1, count );
+
+    vector<double> coordinates( m_dimensions * count, 0.0 );
+    for( size_t index = 0; index < count; index++ )
+    {
+        const vector<double>& coordinate = m_points[index]->getCoordinate();
+        for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+            coordinates[dimension * count + index] = coordinate[dimension];
+    }
+    vector<size_t> pointOrder( count, 0 );
+    for( size_t index = 0; index < count; index++ )
+        pointOrder[index] = index;
+
+    buildNode( 0, 0, count, &pointOrder, coordinates );
+
+    vector<WKdPointND*> sortedPoints( count, 0 );
+    m_coordinates.assign( m_dimensions * count, 0.0 );
+    for( size_t index = 0; index < count; index++ )
+    {
+        sortedPoints[index] = m_points[pointOrder[index]];
+        for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+            m_coordinates[dimension * count + index] = coordinates[dimension * count + pointOrder[index]];
+    }
+    m_points.swap( sortedPoints );
+}
+
+void WKdTreeStaticND::buildNode( size_t node, size_t begin, size_t end, vector<size_t>* pointOrder, const vector<double>& coordinates )
+{
+    if( isLeafNode( node ) )
+    {
+        m_leafBegins[node - m_innerNodeCount] = begin;
+        return;
+    }
+    size_t count = m_points.size();
+    size_t splittingDimension = 0;
+    double spreadMax = -1.0;
+    for( size_t dimension = 0; dimension < m_dimensions; dimension++ )
+    {
+        const double* line = &coordinates[dimension * count];
+        double min = line[pointOrder->at( begin )];
+        double max = min;
+        for( size_t index = begin + 1; index < end; index++ )
+        {
+            double position = line[( *pointOrder )[index]];
+            if( position < min )
+                min = position;
+            if( position > max )
+                max = position;
+        }
+        if( max - min > spreadMax )
+        {
+            spreadMax = max - min;
+            splittingDimension = dimension;
+        }
+    }
+
+    size_t median = begin + ( end - begin ) / 2;
+    const double* line = &coordinates[splittingDimension * count];
+    std::nth_element( pointOrder->begin() + begin, pointOrder->begin() + median,
+                      pointOrder->begin() + end, WKdCoordinateOrder( line ) );
+    m_splittingDimensions[node] = splittingDimension;
+    m_splittingPositions[node] = line[( *pointOrder )[median]];
+
+    buildNode( getLowerChild( node ), begin, median, pointOrder, coordinates );
+    buildNode( getHigherChild( node ), median, end, pointOrder, coordinates );
+}
@@ -0,0 +1,246 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WKDTREESTATICND_H
+#define WKDTREESTATICND_H
+
+#include <vector>
+#include "WKdPointND.h"
+
+using std::vector;
+using std::size_t;
+
+/**
+ * Static and pointer free counterpart of WKdTreeND. All points are put into the tree in 
+ * one go. The coordinates are kept within a single contiguous array of the structure of 
+ * arrays layout (all X coordinates first, then all Y coordinates and so on). The nodes 
+ * are kept in an implicit array where the children of the node at index i are found at 
+ * 2i+1 and 2i+2. Points of each leaf node lie consecutively. So searching points 
+ * touches only a few contiguous memory blocks instead of many small heap objects.
+ * 
+ * The tree is split at the median of the widest spread dimension of each node. Adding 
+ * points rebuilds the whole tree, so all points should be added at once. Points can't 
+ * be removed. Use WKdTreeND if the point set has to be changed afterwards. Like 
+ * WKdTreeND the tree doesn't own its points.
+ */
+class WKdTreeStaticND
+{
+public:
+    /**
+     * Instantiates a three dimensional static kd tree.
+     */
+    WKdTreeStaticND();
+
+    /**
+     * Instantiates a static kd tree of an arbitrary dimension count.
+     * \param dimensions The dimension count of the kd tree.
+     */
+    explicit WKdTreeStaticND( size_t dimensions );
+
+    /**
+     * Destroys the static kd tree. Its points are kept.
+     */
+    virtual ~WKdTreeStaticND();
+
+    /**
+     * Adds points to the kd tree. The whole tree is rebuilt including the points that 
+     * were previously added. So add all the points at once.
+     * \param addables Points to add.
+     */
+    void add( vector<WKdPointND*>* addables );
+
+    /**
+     * Fetches all the points of the kd tree into a list.
+     * \param targetPointSet Target point list to put points to.
+     */
+    void fetchPoints( vector<WKdPointND* >* targetPointSet );
+
+    /**
+     * Returns all points of the kd tree within a new list.
+     * \return All points of the kd tree.
+     */
+    vector<WKdPointND*>* getAllPoints();
+
+    /**
+     * Returns the dimension count of the kd tree.
+     * \return The dimension count of the kd tree.
+     */
+    size_t getDimensions();
+
+    /**
+     * Returns the count of points within the kd tree.
+     * \return The point count of the kd tree.
+     */
+    size_t getPointCount();
+
+    /**
+     * Return whether the tree has no points.
+     * \return Tree has no points.
+     */
+    bool isEmpty();
+
+    /**
+     * Returns a point of the kd tree. Points are sorted in the order of the leaf nodes.
+     * \param pointIndex Index of the point within the kd tree.
+     * \return The kd tree point.
+     */
+    WKdPointND* getPoint( size_t pointIndex );
+
+    /**
+     * Returns a single coordinate scalar of a point without touching the point object.
+     * \param pointIndex Index of the point within the kd tree.
+     * \param dimension Dimension of the returned coordinate scalar.
+     * \return The coordinate scalar of a point within a dimension.
+     */
+    double getCoordinate( size_t pointIndex, size_t dimension );
+
+    /**
+     * Returns the index of the root node.
+     * \return The index of the root node.
+     */
+    size_t getRootNode();
+
+    /**
+     * Tells whether a node is a leaf node that only holds points.
+     * \param node Index of the examined node.
+     * \return Node is a leaf node or not.
+     */
+    bool isLeafNode( size_t node );
+
+    /**
+     * Returns the node index of the child on the lower scale across the splitting 
+     * dimension.
+     * \param node Index of the parent node.
+     * \return Lower child node index.
+     */
+    size_t getLowerChild( size_t node );
+
+    /**
+     * Returns the node index of the child on the higher scale across the splitting 
+     * dimension.
+     * \param node Index of the parent node.
+     * \return Higher child node index.
+     */
+    size_t getHigherChild( size_t node );
+
+    /**
+     * Returns the dimension across which a node is split.
+     * \param node Index of the examined node.
+     * \return The splitting dimension of the node.
+     */
+    size_t getSplittingDimension( size_t node );
+
+    /**
+     * Tells whether points of a position within the splitting dimension can lie within 
+     * the lower child. Points of the median can lie in both children.
+     * \param node Index of the examined node.
+     * \param position Position within the splitting dimension.
+     * \return Points of that position can belong to the lower child or not.
+     */
+    bool lowerChildCanContain( size_t node, double position );
+
+    /**
+     * Tells whether points of a position within the splitting dimension can lie within 
+     * the higher child. Points of the median can lie in both children.
+     * \param node Index of the examined node.
+     * \param position Position within the splitting dimension.
+     * \return Points of that position can belong to the higher child or not.
+     */
+    bool higherChildCanContain( size_t node, double position );
+
+    /**
+     * Returns the index of the first point of a leaf node.
+     * \param node Index of a leaf node.
+     * \return The first point index of the leaf node.
+     */
+    size_t getNodePointsBegin( size_t node );
+
+    /**
+     * Returns the index after the last point of a leaf node.
+     * \param node Index of a leaf node.
+     * \return The point index after the last one of the leaf node.
+     */
+    size_t getNodePointsEnd( size_t node );
+
+private:
+    /**
+     * Builds the node arrays and sorts points and coordinates by the leaf node order.
+     */
+    void buildTree();
+
+    /**
+     * Splits a point range of a node at the median of its widest spread dimension and 
+     * continues with the child nodes.
+     * \param node Index of the currently built node.
+     * \param begin First index of the node's points within the point order.
+     * \param end Index after the last point of the node within the point order.
+     * \param pointOrder Point indices that are sorted during the build.
+     * \param coordinates Coordinates of points in the structure of arrays layout 
+     *                    before sorting.
+     */
+    void buildNode( size_t node, size_t begin, size_t end, vector<size_t>* pointOrder, const vector<double>& coordinates );
+
+    /**
+     * The dimension count of the kd tree.
+     */
+    size_t m_dimensions;
+
+    /**
+     * Maximal point count of a leaf node.
+     */
+    size_t m_maxLeafPointCount;
+
+    /**
+     * Count of nodes that have children.
+     */
+    size_t m_innerNodeCount;
+
+    /**
+     * Points of the kd tree sorted by the leaf nodes.
+     */
+    vector<WKdPointND*> m_points;
+
+    /**
+     * Point coordinates sorted by the leaf nodes. The array has the structure of arrays 
+     * layout. The coordinate of the dimension d of the point i is at d * point count + i.
+     */
+    vector<double> m_coordinates;
+
+    /**
+     * Splitting dimensions of the nodes that have children.
+     */
+    vector<size_t> m_splittingDimensions;
+
+    /**
+     * Splitting positions (medians) of the nodes that have children.
+     */
+    vector<double> m_splittingPositions;
+
+    /**
+     * First point index of each leaf node. The last item is the point count.
+     */
+    vector<size_t> m_leafBegins;
+};
+
+#endif  // WKDTREESTATICND_H
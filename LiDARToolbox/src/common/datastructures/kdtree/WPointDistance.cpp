@@ -33,17 +33,23 @@ WPointDistance::WPointDistance()
     m_comparedPoint = 0;
 }
 
-WPointDistance::WPointDistance( vector<double> sourcePoint, WKdPointND* comparedPoint )
+WPointDistance::WPointDistance( const vector<double>& sourcePoint, WKdPointND* comparedPoint )
 {
     m_comparedPoint = comparedPoint;
     m_pointDistance = WVectorMaths::getEuclidianDistance( sourcePoint, getComparedPoint()->getCoordinate() );
 }
 
+WPointDistance::WPointDistance( double distance, WKdPointND* comparedPoint )
+{
+    m_comparedPoint = comparedPoint;
+    m_pointDistance = distance;
+}
+
 WPointDistance::~WPointDistance()
 {
 }
 
-vector<double> WPointDistance::getComparedCoordinate()
+const vector<double>& WPointDistance::getComparedCoordinate()
 {
     return m_comparedPoint->getCoordinate();
 }
@@ -63,7 +69,7 @@ vector<WPosition>* WPointDistance::convertToPointSet( vector<WPointDistance>* po
     vector<WPosition>* pointSet = new vector<WPosition>();
     for( size_t index = 0; index < pointDistances->size(); index++ )
     {
-        vector<double> coordinate = pointDistances->at( index ).getComparedCoordinate();
+        const vector<double>& coordinate = pointDistances->at( index ).getComparedCoordinate();
         if( coordinate.size() == 3 )
             pointSet->push_back( WPosition( coordinate[0], coordinate[1], coordinate[2] ) );
     }
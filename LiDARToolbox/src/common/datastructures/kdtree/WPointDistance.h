@@ -55,7 +55,14 @@ public:
      * \param comparedPoint The second point that is used to calculate the distance 
      *                      between. The object stores its coordinates by that.
      */
-    WPointDistance( vector<double> sourcePoint, WKdPointND* comparedPoint );
+    WPointDistance( const vector<double>& sourcePoint, WKdPointND* comparedPoint );
+
+    /**
+     * Instantiates the coordinate distance pair using an already calculated distance.
+     * \param distance The distance between the reference point and the compared one.
+     * \param comparedPoint The compared point.
+     */
+    WPointDistance( double distance, WKdPointND* comparedPoint );
 
     /**
      * Object destructor
@@ -66,7 +73,7 @@ public:
      * Returns the coordinate of the point compared to the reference.
      * \return The compared point coordinate.
      */
-    vector<double> getComparedCoordinate();
+    const vector<double>& getComparedCoordinate();
 
     /**
      * Returns the point that is considered within the current distance calculation 
@@ -33,6 +33,7 @@ WPointSearcher::WPointSearcher()
 {
     m_distanceSteps = 4;
     m_examinedKdTree = 0;
+    m_examinedStaticKdTree = 0;
     m_maxResultPointCount = 50;
     m_maxSearchDistance = 0.5;
     m_foundPoints = 0;
@@ -45,6 +46,17 @@ WPointSearcher::WPointSearcher( WKdTreeND* kdTree )
     m_maxResultPointCount = 50;
     m_maxSearchDistance = 0.5;
     m_examinedKdTree = kdTree;
+    m_examinedStaticKdTree = 0;
+    m_foundPoints = 0;
+}
+
+WPointSearcher::WPointSearcher( WKdTreeStaticND* kdTree )
+{
+    m_distanceSteps = 4;
+    m_examinedKdTree = 0;
+    m_maxResultPointCount = 50;
+    m_maxSearchDistance = 0.5;
+    m_examinedStaticKdTree = kdTree;
     m_foundPoints = 0;
 }
 
@@ -65,7 +77,7 @@ vector<WPointDistance>* WPointSearcher::getNearestPoints()
         delete m_foundPoints;
         m_foundPoints = new vector<WPointDistance>();
         double maxDistance = m_maxSearchDistance * pow( 2.0, - ( double )distanceSteps + ( double )index );
-        traverseNodePoints( m_examinedKdTree, maxDistance );
+        traverseExaminedKdTree( maxDistance );
         //cout << "Attempt at max distance: " << maxDistance << "    size = " << m_foundPoints->size() << endl;
     }
     std::sort( m_foundPoints->begin(), m_foundPoints->end() );
@@ -79,15 +91,39 @@ vector<WPointDistance>* WPointSearcher::getNearestPoints()
     return m_foundPoints;
 }
 
+vector<WPointDistance>* WPointSearcher::getKNearestPoints()
+{
+    if( m_maxResultPointCount == numeric_limits< size_t >::max() )
+        return getNearestPoints();
+    m_foundPoints = new vector<WPointDistance>();
+    if( m_maxResultPointCount == 0 )
+        return m_foundPoints;
+    m_foundPoints->reserve( m_maxResultPointCount );
+    if( m_examinedStaticKdTree != 0 )
+    {
+        if( !m_examinedStaticKdTree->isEmpty() )
+            traverseKNearestPoints( m_examinedStaticKdTree, m_examinedStaticKdTree->getRootNode() );
+    }
+    else
+    {
+        traverseKNearestPoints( m_examinedKdTree );
+    }
+    std::sort_heap( m_foundPoints->begin(), m_foundPoints->end() );
+    return m_foundPoints;
+}
+
 size_t WPointSearcher::getNearestNeighborCount()
 {
     if( m_maxResultPointCount == numeric_limits< size_t >::max() )
     {
+        if( m_examinedStaticKdTree != 0 )
+            return m_examinedStaticKdTree->isEmpty() ?0
+                    :getNearestNeighborCountInfiniteMaxCount( m_examinedStaticKdTree, m_examinedStaticKdTree->getRootNode() );
         return getNearestNeighborCountInfiniteMaxCount( m_examinedKdTree );
     }
     else
     {
-        vector<WPointDistance>* nearestPoints = getNearestPoints();
+        vector<WPointDistance>* nearestPoints = getKNearestPoints();
         size_t neighbourCount = nearestPoints->size();
         delete nearestPoints;
         return neighbourCount;
@@ -128,9 +164,38 @@ size_t WPointSearcher::getNearestNeighborCountInfiniteMaxCount( WKdTreeND* curre
     return pointCount;
 }
 
+size_t WPointSearcher::getNearestNeighborCountInfiniteMaxCount( WKdTreeStaticND* kdTree, size_t currentNode )
+{
+    size_t pointCount = 0;
+    if( kdTree->isLeafNode( currentNode ) )
+    {
+        size_t end = kdTree->getNodePointsEnd( currentNode );
+        for( size_t index = kdTree->getNodePointsBegin( currentNode ); index < end; index++ )
+            if( !isOutsideSearchRadius( kdTree, index, m_maxSearchDistance )
+                    && pointCanBelongToPointSet( kdTree->getPoint( index )->getCoordinate(), m_maxSearchDistance ) )
+                pointCount++;
+    }
+    else
+    {
+        double pointCoord = m_searchedCoordinate.at( kdTree->getSplittingDimension( currentNode ) );
+        if( kdTree->lowerChildCanContain( currentNode, pointCoord - m_maxSearchDistance ) )
+            pointCount += getNearestNeighborCountInfiniteMaxCount( kdTree, kdTree->getLowerChild( currentNode ) );
+        if( kdTree->higherChildCanContain( currentNode, pointCoord + m_maxSearchDistance ) )
+            pointCount += getNearestNeighborCountInfiniteMaxCount( kdTree, kdTree->getHigherChild( currentNode ) );
+    }
+    return pointCount;
+}
+
 void WPointSearcher::setExaminedKdTree( WKdTreeND* kdTree )
 {
     m_examinedKdTree = kdTree;
+    m_examinedStaticKdTree = 0;
+}
+
+void WPointSearcher::setExaminedKdTree( WKdTreeStaticND* kdTree )
+{
+    m_examinedStaticKdTree = kdTree;
+    m_examinedKdTree = 0;
 }
 
 void WPointSearcher::setSearchedPoint( const vector<double>& searchedPoint )
@@ -185,6 +250,148 @@ void WPointSearcher::traverseNodePoints( WKdTreeND* currentNode, double maxDista
     }
 }
 
+void WPointSearcher::traverseNodePoints( WKdTreeStaticND* kdTree, size_t currentNode, double maxDistance )
+{
+    if( kdTree->isLeafNode( currentNode ) )
+    {
+        size_t end = kdTree->getNodePointsEnd( currentNode );
+        for( size_t index = kdTree->getNodePointsBegin( currentNode ); index < end; index++ )
+        {
+            if( isOutsideSearchRadius( kdTree, index, maxDistance ) )
+                continue;
+            WKdPointND* point = kdTree->getPoint( index );
+            if( pointCanBelongToPointSet( point->getCoordinate(), maxDistance ) )
+                onPointFound( point );
+        }
+    }
+    else
+    {
+        double pointCoord = m_searchedCoordinate.at( kdTree->getSplittingDimension( currentNode ) );
+        if( kdTree->lowerChildCanContain( currentNode, pointCoord - maxDistance ) )
+            traverseNodePoints( kdTree, kdTree->getLowerChild( currentNode ), maxDistance );
+        if( kdTree->higherChildCanContain( currentNode, pointCoord + maxDistance ) )
+            traverseNodePoints( kdTree, kdTree->getHigherChild( currentNode ), maxDistance );
+    }
+}
+
+void WPointSearcher::traverseExaminedKdTree( double maxDistance )
+{
+    if( m_examinedStaticKdTree != 0 )
+    {
+        if( !m_examinedStaticKdTree->isEmpty() )
+            traverseNodePoints( m_examinedStaticKdTree, m_examinedStaticKdTree->getRootNode(), maxDistance );
+    }
+    else
+    {
+        traverseNodePoints( m_examinedKdTree, maxDistance );
+    }
+}
+
+void WPointSearcher::traverseKNearestPoints( WKdTreeND* currentNode )
+{
+    vector<WKdPointND* >* nodePoints = currentNode->getNodePoints();
+    WKdTreeND* lowerChild = currentNode->getLowerChild();
+    WKdTreeND* higherChild = currentNode->getHigherChild();
+    if( nodePoints->size() > 0 && lowerChild == 0 && higherChild == 0)
+    {
+        for( size_t index = 0; index < nodePoints->size(); index++ )
+        {
+            WKdPointND* point = nodePoints->at( index );
+            const vector<double>& coordinate = point->getCoordinate();
+            double distance = WVectorMaths::getEuclidianDistance( m_searchedCoordinate, coordinate );
+            double bound = getKNearestPointsBound();
+            if( distance > bound || ( distance == bound && m_foundPoints->size() == m_maxResultPointCount ) )
+                continue;
+            if( pointCanBelongToPointSet( coordinate, m_maxSearchDistance ) )
+                addKNearestCandidate( distance, point );
+        }
+    }
+    else
+    {
+        if( nodePoints->size() == 0 && lowerChild != 0 && higherChild != 0 )
+        {
+            double pointCoord = m_searchedCoordinate.at( currentNode->getSplittingDimension() );
+            bool isLowerCase = currentNode->isLowerKdNodeCase( pointCoord );
+            traverseKNearestPoints( isLowerCase ?lowerChild :higherChild );
+            double bound = getKNearestPointsBound();
+            if( isLowerCase ?!currentNode->isLowerKdNodeCase( pointCoord + bound )
+                            :currentNode->isLowerKdNodeCase( pointCoord - bound ) )
+                traverseKNearestPoints( isLowerCase ?higherChild :lowerChild );
+        }
+        else
+        {
+            cout << "!!!UNKNOWN EXCEPTION!!! - getting nearest points" << endl;
+        }
+    }
+}
+
+void WPointSearcher::traverseKNearestPoints( WKdTreeStaticND* kdTree, size_t currentNode )
+{
+    if( kdTree->isLeafNode( currentNode ) )
+    {
+        size_t dimensions = std::min( kdTree->getDimensions(), m_searchedCoordinate.size() );
+        size_t end = kdTree->getNodePointsEnd( currentNode );
+        for( size_t index = kdTree->getNodePointsBegin( currentNode ); index < end; index++ )
+        {
+            double sum = 0.0;
+            for( size_t dimension = 0; dimension < dimensions; dimension++ )
+            {
+                double difference = kdTree->getCoordinate( index, dimension ) - m_searchedCoordinate[dimension];
+                sum += difference * difference;
+            }
+            double distance = pow( sum, 0.5 );
+            double bound = getKNearestPointsBound();
+            if( distance > bound || ( distance == bound && m_foundPoints->size() == m_maxResultPointCount ) )
+                continue;
+            WKdPointND* point = kdTree->getPoint( index );
+            if( pointCanBelongToPointSet( point->getCoordinate(), m_maxSearchDistance ) )
+                addKNearestCandidate( distance, point );
+        }
+    }
+    else
+    {
+        double pointCoord = m_searchedCoordinate.at( kdTree->getSplittingDimension( currentNode ) );
+        bool isLowerCase = kdTree->lowerChildCanContain( currentNode, pointCoord );
+        traverseKNearestPoints( kdTree, isLowerCase ?kdTree->getLowerChild( currentNode ) :kdTree->getHigherChild( currentNode ) );
+        double bound = getKNearestPointsBound();
+        if( isLowerCase ?kdTree->higherChildCanContain( currentNode, pointCoord + bound )
+                        :kdTree->lowerChildCanContain( currentNode, pointCoord - bound ) )
+            traverseKNearestPoints( kdTree, isLowerCase ?kdTree->getHigherChild( currentNode ) :kdTree->getLowerChild( currentNode ) );
+    }
+}
+
+double WPointSearcher::getKNearestPointsBound()
+{
+    return m_foundPoints->size() < m_maxResultPointCount ?m_maxSearchDistance :m_foundPoints->front().getDistance();
+}
+
+void WPointSearcher::addKNearestCandidate( double distance, WKdPointND* point )
+{
+    if( m_foundPoints->size() < m_maxResultPointCount )
+    {
+        m_foundPoints->push_back( WPointDistance( distance, point ) );
+        std::push_heap( m_foundPoints->begin(), m_foundPoints->end() );
+    }
+    else
+    {
+        std::pop_heap( m_foundPoints->begin(), m_foundPoints->end() );
+        m_foundPoints->back() = WPointDistance( distance, point );
+        std::push_heap( m_foundPoints->begin(), m_foundPoints->end() );
+    }
+}
+
+bool WPointSearcher::isOutsideSearchRadius( WKdTreeStaticND* kdTree, size_t pointIndex, double maxDistance )
+{
+    double sum = 0.0;
+    size_t dimensions = std::min( kdTree->getDimensions(), m_searchedCoordinate.size() );
+    for( size_t dimension = 0; dimension < dimensions; dimension++ )
+    {
+        double difference = kdTree->getCoordinate( pointIndex, dimension ) - m_searchedCoordinate[dimension];
+        sum += difference * difference;
+    }
+    return sqrt( sum ) > maxDistance;
+}
+
 void WPointSearcher::onPointFound( WKdPointND* point )
 {
     m_foundPoints->push_back( WPointDistance( m_searchedCoordinate, point ) );
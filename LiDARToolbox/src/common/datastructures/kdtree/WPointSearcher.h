@@ -29,6 +29,7 @@
 #include <vector>
 #include "WPointDistance.h"
 #include "WKdTreeND.h"
+#include "WKdTreeStaticND.h"
 #include "WKdPointND.h"
 #include "core/common/math/linearAlgebra/WPosition.h"
 
@@ -53,6 +54,12 @@ public:
      */
     explicit WPointSearcher( WKdTreeND* kdTree );
 
+    /**
+     * Instantiates the points searcher.
+     * \param kdTree Assigned source static kd tree to search points.
+     */
+    explicit WPointSearcher( WKdTreeStaticND* kdTree );
+
     /**
      * Destroys the points searcher
      */
@@ -68,6 +75,18 @@ public:
      */
     vector<WPointDistance>* getNearestPoints();
 
+    /**
+     * Returns the k nearest points of a particular coordinate where k is the maximal 
+     * result point count. Points above the maximal search distance aren't regarded. 
+     * Unlike getNearestPoints() the kd tree is traversed only once. The nearer child 
+     * node is visited first and the farther one is skipped when it can't contain a point 
+     * nearer than the current k-th nearest. The found points are kept within a max-heap 
+     * of the capacity k. An infinite maximal point count results a usual radius search.
+     * \return Neighbor points of a coordinate. The list is sorted ascending by the 
+     *         distance.
+     */
+    vector<WPointDistance>* getKNearestPoints();
+
     /**
      * Counts points within the region during regarding the maximal point count. Setting 
      * an infinite count speeds the process up. Points do would neither to be sorted nor 
@@ -83,6 +102,13 @@ public:
      */
     void setExaminedKdTree( WKdTreeND* kdTree );
 
+    /**
+     * Links a static kd tree to the search engine in order to find nearest points of a 
+     * coordinate. It replaces a previously linked kd tree.
+     * \param kdTree The static kd tree where to look for neighbors.
+     */
+    void setExaminedKdTree( WKdTreeStaticND* kdTree );
+
     /**
      * Sets the coordinate of the point to get its neighbors afterwarts.
      * \param searchedPoint Coordinate to search for neighbors.
@@ -117,6 +143,37 @@ protected:
      */
     void traverseNodePoints( WKdTreeND* currentNode, double maxDistance );
 
+    /**
+     * Traverses static kd-tree nodes to apply onPointFound() on points that were found 
+     * using pointCanBelongToPointSet().
+     * \param kdTree The static kd tree to search.
+     * \param currentNode Index of the current node where neighbor points are searched for.
+     * \param maxDistance Maximal euclidian distance to a output point.
+     */
+    void traverseNodePoints( WKdTreeStaticND* kdTree, size_t currentNode, double maxDistance );
+
+    /**
+     * Traverses the linked kd tree no matter whether it is a WKdTreeND or a 
+     * WKdTreeStaticND.
+     * \param maxDistance Maximal euclidian distance to a output point.
+     */
+    void traverseExaminedKdTree( double maxDistance );
+
+    /**
+     * Traverses kd-tree nodes to find the k nearest points. The nearer child node is 
+     * visited first.
+     * \param currentNode The current node where neighbor points are searched for.
+     */
+    void traverseKNearestPoints( WKdTreeND* currentNode );
+
+    /**
+     * Traverses static kd-tree nodes to find the k nearest points. The nearer child node 
+     * is visited first.
+     * \param kdTree The static kd tree to search.
+     * \param currentNode Index of the current node where neighbor points are searched for.
+     */
+    void traverseKNearestPoints( WKdTreeStaticND* kdTree, size_t currentNode );
+
     /**
      * Action which is executed when a point is found. This method adds points to the 
      * found points list. Overwrite this method in the inheriting class to define own 
@@ -140,6 +197,12 @@ protected:
      */
     WKdTreeND* m_examinedKdTree;
 
+    /**
+     * Static kd tree where nearest points are searched. Either this or m_examinedKdTree 
+     * is set.
+     */
+    WKdTreeStaticND* m_examinedStaticKdTree;
+
     /**
      * maximal euclidian distance within which neighbors are searched.
      */
@@ -177,6 +240,42 @@ private:
      * \result Region point count not regarding the masimal point count.
      */
     size_t getNearestNeighborCountInfiniteMaxCount( WKdTreeND* currentNode );
+
+    /**
+     * Returns the point count within a radius not regarding the maximal point count 
+     * using the static kd tree.
+     * \param kdTree Static kd-tree to search.
+     * \param currentNode Index of the currently searched node.
+     * \result Region point count not regarding the masimal point count.
+     */
+    size_t getNearestNeighborCountInfiniteMaxCount( WKdTreeStaticND* kdTree, size_t currentNode );
+
+    /**
+     * Tells whether a point of the static kd tree lies outside the search radius. It 
+     * reads the contiguous coordinate array only and skips the point object. Searched 
+     * points lie within the radius in every search type.
+     * \param kdTree Static kd tree of the point.
+     * \param pointIndex Index of the point within the static kd tree.
+     * \param maxDistance Maximal euclidian distance to a output point.
+     * \return The point is definitely too far away or not.
+     */
+    bool isOutsideSearchRadius( WKdTreeStaticND* kdTree, size_t pointIndex, double maxDistance );
+
+    /**
+     * Returns the distance within which points can still be added to the k nearest 
+     * points. It is the maximal search distance until k points are found. Afterwards it 
+     * is the distance of the current k-th nearest point.
+     * \return Distance limit of further k nearest point candidates.
+     */
+    double getKNearestPointsBound();
+
+    /**
+     * Puts a point into the max-heap of the k nearest points. If the heap is full the 
+     * farthest point is replaced when the new one is nearer.
+     * \param distance Distance of the point to the searched coordinate.
+     * \param point Point candidate.
+     */
+    void addKNearestCandidate( double distance, WKdPointND* point );
 };
 
 #endif  // WPOINTSEARCHER_H
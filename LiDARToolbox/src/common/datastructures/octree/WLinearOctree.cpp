@@ -0,0 +1,308 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+
+#include "../../algorithms/threadPool/WThreadPool.h"
+#include "../../math/mortonCode/WMortonCode.h"
+#include "../unionFind/WUnionFind.h"
+#include "WLinearOctree.h"
+
+using std::pair;
+
+const size_t WLinearOctree::noLeaf = static_cast<size_t>( -1 );
+
+/**
+ * Thread pool task that calculates the leaf keys of points.
+ */
+template< typename T > class WLinearOctreeKeyTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param tree Tree that calculates the keys.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     * \param pointKeys Output key and index of each point.
+     */
+    WLinearOctreeKeyTask( WLinearOctree* tree, const vector<T>& coordinates,
+            vector< pair<boost::uint64_t, size_t> >* pointKeys ) :
+        m_coordinates( coordinates )
+    {
+        m_tree = tree;
+        m_pointKeys = pointKeys;
+    }
+
+    /**
+     * Calculates the keys of a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            ( *m_pointKeys )[index] = pair<boost::uint64_t, size_t>( m_tree->getLeafKey( m_coordinates[index * 3],
+                    m_coordinates[index * 3 + 1], m_coordinates[index * 3 + 2] ), index );
+    }
+
+private:
+    /**
+     * Tree that calculates the keys.
+     */
+    WLinearOctree* m_tree;
+
+    /**
+     * Interleaved X/Y/Z coordinates of the points.
+     */
+    const vector<T>& m_coordinates;
+
+    /**
+     * Output key and index of each point.
+     */
+    vector< pair<boost::uint64_t, size_t> >* m_pointKeys;
+};
+
+WLinearOctree::WLinearOctree( double detailLevel )
+{
+    m_detailLevel = detailLevel;
+    m_cornerNeighborClass = 1;
+    m_hashBits = 0;
+    m_groupCount = 0;
+    m_leafPointOffsets.push_back( 0 );
+}
+
+WLinearOctree::~WLinearOctree()
+{
+}
+
+void WLinearOctree::buildFromPoints( const vector<double>& coordinates )
+{
+    buildFromCoordinates( coordinates );
+}
+
+void WLinearOctree::buildFromPoints( const vector<float>& coordinates )
+{
+    buildFromCoordinates( coordinates );
+}
+
+size_t WLinearOctree::getLeafCount()
+{
+    return m_leafKeys.size();
+}
+
+size_t WLinearOctree::getPointCount()
+{
+    return m_points.size();
+}
+
+size_t WLinearOctree::getLeafIndex( double x, double y, double z )
+{
+    return findLeaf( getLeafKey( x, y, z ) );
+}
+
+boost::uint64_t WLinearOctree::getLeafKey( double x, double y, double z )
+{
+    double cellSize = m_detailLevel * 2.0;
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    return WMortonCode::encode( static_cast<boost::uint32_t>( static_cast<boost::int64_t>( floor( x / cellSize ) ) + latticeOrigin ),
+                                static_cast<boost::uint32_t>( static_cast<boost::int64_t>( floor( y / cellSize ) ) + latticeOrigin ),
+                                static_cast<boost::uint32_t>( static_cast<boost::int64_t>( floor( z / cellSize ) ) + latticeOrigin ) );
+}
+
+boost::uint64_t WLinearOctree::getLeafKey( size_t leaf )
+{
+    return m_leafKeys[leaf];
+}
+
+double WLinearOctree::getLeafCenter( size_t leaf, size_t dimension )
+{
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    boost::int64_t cell = static_cast<boost::int64_t>( WMortonCode::decode( m_leafKeys[leaf], dimension ) ) - latticeOrigin;
+    return ( static_cast<double>( cell ) * 2.0 + 1.0 ) * m_detailLevel;
+}
+
+size_t WLinearOctree::getLeafPointCount( size_t leaf )
+{
+    return m_leafPointOffsets[leaf + 1] - m_leafPointOffsets[leaf];
+}
+
+size_t WLinearOctree::getLeafPointsBegin( size_t leaf )
+{
+    return m_leafPointOffsets[leaf];
+}
+
+size_t WLinearOctree::getLeafPointsEnd( size_t leaf )
+{
+    return m_leafPointOffsets[leaf + 1];
+}
+
+size_t WLinearOctree::getPoint( size_t position )
+{
+    return m_points[position];
+}
+
+size_t WLinearOctree::getPointLeaf( size_t point )
+{
+    return m_pointLeafs[point];
+}
+
+void WLinearOctree::groupNeighbourLeafs()
+{
+    size_t leafCount = m_leafKeys.size();
+    WThreadPool* threadPool = WThreadPool::getSharedPool();
+    size_t chunkCount = leafCount > 1000 ?threadPool->getThreadCount() * 4 :1;
+    size_t chunkSize = ( leafCount + chunkCount - 1 ) / chunkCount;
+    vector< vector<size_t> > groupablePairs( chunkCount );
+    vector< boost::function<void ()> > chunkSearches;
+    for( size_t chunk = 0; chunk < chunkCount; chunk++ )
+        chunkSearches.push_back( boost::bind( &WLinearOctree::fetchGroupableNeighbors, this,
+                std::min( chunk * chunkSize, leafCount ), std::min( ( chunk + 1 ) * chunkSize, leafCount ),
+                &groupablePairs[chunk] ) );
+    threadPool->parallelInvoke( chunkSearches );
+
+    WUnionFind groups( leafCount );
+    for( size_t chunk = 0; chunk < chunkCount; chunk++ )
+        for( size_t index = 0; index + 1 < groupablePairs[chunk].size(); index += 2 )
+            groups.unite( groupablePairs[chunk][index], groupablePairs[chunk][index + 1] );
+    m_groupCount = groups.getSetLabels( &m_leafGroups );
+}
+
+size_t WLinearOctree::getGroupCount()
+{
+    return m_groupCount;
+}
+
+size_t WLinearOctree::getGroupNr( size_t leaf )
+{
+    return m_leafGroups[leaf];
+}
+
+double WLinearOctree::getDetailLevel()
+{
+    return m_detailLevel;
+}
+
+void WLinearOctree::setCornerNeighborClass( size_t cornerNeighborClass )
+{
+    m_cornerNeighborClass = cornerNeighborClass;
+}
+
+bool WLinearOctree::canGroupLeafs( size_t leaf1, size_t leaf2 )
+{
+    leaf1 = leaf1;
+    leaf2 = leaf2;
+    return true;
+}
+
+template< typename T > void WLinearOctree::buildFromCoordinates( const vector<T>& coordinates )
+{
+    size_t pointCount = coordinates.size() / 3;
+    vector< pair<boost::uint64_t, size_t> > pointKeys( pointCount );
+    WLinearOctreeKeyTask<T> task( this, coordinates, &pointKeys );
+    WThreadPool::getSharedPool()->parallelFor( &task, pointCount );
+    std::sort( pointKeys.begin(), pointKeys.end() );
+
+    m_leafKeys.clear();
+    m_leafPointOffsets.clear();
+    m_points.resize( pointCount );
+    m_pointLeafs.resize( pointCount );
+    for( size_t index = 0; index < pointCount; index++ )
+    {
+        if( index == 0 || pointKeys[index].first != pointKeys[index - 1].first )
+        {
+            m_leafKeys.push_back( pointKeys[index].first );
+            m_leafPointOffsets.push_back( index );
+        }
+        m_points[index] = pointKeys[index].second;
+        m_pointLeafs[pointKeys[index].second] = m_leafKeys.size() - 1;
+    }
+    m_leafPointOffsets.push_back( pointCount );
+    m_leafGroups.clear();
+    m_groupCount = 0;
+    buildLeafIndex();
+}
+
+void WLinearOctree::buildLeafIndex()
+{
+    m_hashBits = 4;
+    while( ( static_cast<size_t>( 1 ) << m_hashBits ) < m_leafKeys.size() * 2 )
+        m_hashBits++;
+    size_t slotCount = static_cast<size_t>( 1 ) << m_hashBits;
+    m_hashKeys.assign( slotCount, 0 );
+    m_hashLeafs.assign( slotCount, noLeaf );
+    for( size_t leaf = 0; leaf < m_leafKeys.size(); leaf++ )
+    {
+        size_t slot = getHashSlot( m_leafKeys[leaf] );
+        while( m_hashLeafs[slot] != noLeaf )
+            slot = ( slot + 1 ) & ( slotCount - 1 );
+        m_hashKeys[slot] = m_leafKeys[leaf];
+        m_hashLeafs[slot] = leaf;
+    }
+}
+
+size_t WLinearOctree::findLeaf( boost::uint64_t key )
+{
+    if( m_leafKeys.empty() )
+        return noLeaf;
+    size_t slotMask = m_hashLeafs.size() - 1;
+    for( size_t slot = getHashSlot( key ); m_hashLeafs[slot] != noLeaf; slot = ( slot + 1 ) & slotMask )
+        if( m_hashKeys[slot] == key )
+            return m_hashLeafs[slot];
+    return noLeaf;
+}
+
+size_t WLinearOctree::getHashSlot( boost::uint64_t key )
+{
+    return static_cast<size_t>( ( key * 0x9e3779b97f4a7c15ULL ) >> ( 64 - m_hashBits ) );
+}
+
+void WLinearOctree::fetchGroupableNeighbors( size_t begin, size_t end, vector<size_t>* targetPairs )
+{
+    for( size_t leaf = begin; leaf < end; leaf++ )
+    {
+        boost::uint32_t cellX = WMortonCode::decode( m_leafKeys[leaf], 0 );
+        boost::uint32_t cellY = WMortonCode::decode( m_leafKeys[leaf], 1 );
+        boost::uint32_t cellZ = WMortonCode::decode( m_leafKeys[leaf], 2 );
+        for( int offsetX = -1; offsetX <= 1; offsetX++ )
+            for( int offsetY = -1; offsetY <= 1; offsetY++ )
+                for( int offsetZ = -1; offsetZ <= 1; offsetZ++ )
+                {
+                    size_t cornerNeighborClass = ( offsetX != 0 ?1 :0 ) + ( offsetY != 0 ?1 :0 ) + ( offsetZ != 0 ?1 :0 );
+                    if( cornerNeighborClass == 0 || cornerNeighborClass > m_cornerNeighborClass )
+                        continue;
+                    size_t neighbor = findLeaf( WMortonCode::encode( cellX + offsetX, cellY + offsetY, cellZ + offsetZ ) );
+                    if( neighbor < leaf && canGroupLeafs( leaf, neighbor ) )
+                    {
+                        targetPairs->push_back( leaf );
+                        targetPairs->push_back( neighbor );
+                    }
+                }
+    }
+}
@@ -0,0 +1,308 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WLINEAROCTREE_H
+#define WLINEAROCTREE_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+using std::vector;
+using std::size_t;
+
+/**
+ * Pointer free counterpart of WOctree. Only the leafs of the finest detail level are 
+ * kept. They are identified by the Morton code of their lattice cell (see 
+ * WOctree::getLeafKey()). The leafs are sorted by that key within a single array, so 
+ * they are ordered the same way WOctree traverses them. An open addressing hash table 
+ * maps keys to leaf indices, so looking up the leaf of a coordinate takes constant time 
+ * instead of walking down from the root.
+ *
+ * The tree is built in one go by sorting the keys of all points. The point indices are 
+ * kept grouped by leaf. Leafs are numbered from 0 to getLeafCount()-1, so derived 
+ * classes and users attach data to the leafs using arrays of that size, e.g. a point 
+ * count, a bounding box or a covariance per leaf. Such arrays can be filled in parallel 
+ * since each leaf lists its points.
+ */
+class WLinearOctree
+{
+public:
+    /**
+     * Instantiates the linear octree.
+     * \param detailLevel The radius of the leafs. Currently only numbers covering 2^n 
+     *                    including negative n are supported.
+     */
+    explicit WLinearOctree( double detailLevel );
+
+    /**
+     * Destroys the linear octree.
+     */
+    virtual ~WLinearOctree();
+
+    /**
+     * Builds the leafs that cover a point set. All previous leafs are replaced. Points 
+     * are referenced by their index within the coordinate array.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     */
+    void buildFromPoints( const vector<double>& coordinates );
+
+    /**
+     * Builds the leafs that cover a point set. All previous leafs are replaced. Points 
+     * are referenced by their index within the coordinate array.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     */
+    void buildFromPoints( const vector<float>& coordinates );
+
+    /**
+     * Returns the count of leafs.
+     * \return The leaf count.
+     */
+    size_t getLeafCount();
+
+    /**
+     * Returns the count of points that the tree was built from.
+     * \return The point count.
+     */
+    size_t getPointCount();
+
+    /**
+     * Returns the index of the leaf that covers a coordinate.
+     * \param x X coordinate covered by the leaf.
+     * \param y Y coordinate covered by the leaf.
+     * \param z Z coordinate covered by the leaf.
+     * \return The leaf index or noLeaf if no point lies within that area.
+     */
+    size_t getLeafIndex( double x, double y, double z );
+
+    /**
+     * Returns the key of the lattice cell that covers a coordinate. It equals 
+     * WOctree::getLeafKey() of an octree with the same detail level.
+     * \param x X coordinate covered by the cell.
+     * \param y Y coordinate covered by the cell.
+     * \param z Z coordinate covered by the cell.
+     * \return The key of the lattice cell.
+     */
+    boost::uint64_t getLeafKey( double x, double y, double z );
+
+    /**
+     * Returns the key of a leaf.
+     * \param leaf Index of the leaf.
+     * \return The Morton code of the leaf's lattice cell.
+     */
+    boost::uint64_t getLeafKey( size_t leaf );
+
+    /**
+     * Returns a center coordinate of a leaf.
+     * \param leaf Index of the leaf.
+     * \param dimension Center dimension to return (0/1/2 = X/Y/Z).
+     * \return The center coordinate of that dimension.
+     */
+    double getLeafCenter( size_t leaf, size_t dimension );
+
+    /**
+     * Returns the count of points that lie within a leaf.
+     * \param leaf Index of the leaf.
+     * \return The point count of the leaf.
+     */
+    size_t getLeafPointCount( size_t leaf );
+
+    /**
+     * Returns the first position of a leaf's points. Use getPoint() to resolve positions 
+     * between getLeafPointsBegin() and getLeafPointsEnd().
+     * \param leaf Index of the leaf.
+     * \return First point position of the leaf.
+     */
+    size_t getLeafPointsBegin( size_t leaf );
+
+    /**
+     * Returns the position after the last point of a leaf.
+     * \param leaf Index of the leaf.
+     * \return Point position after the leaf's last point.
+     */
+    size_t getLeafPointsEnd( size_t leaf );
+
+    /**
+     * Returns the index of a point within the coordinate array the tree was built from.
+     * \param position Point position within the leaf ordered point list.
+     * \return Index of the point.
+     */
+    size_t getPoint( size_t position );
+
+    /**
+     * Returns the leaf of a point. The leaf of each point is kept while the tree is 
+     * built. So it isn't looked up again.
+     * \param point Index of the point within the coordinate array the tree was built 
+     *              from.
+     * \return Index of the leaf that contains the point.
+     */
+    size_t getPointLeaf( size_t point );
+
+    /**
+     * Adjusts group numbers of all leafs so that leafs have the same ID that represent 
+     * altogether a single block. Groups are numbered in the order of their first leaf, 
+     * like WOctree::groupNeighbourLeafsFromRoot() does.
+     */
+    void groupNeighbourLeafs();
+
+    /**
+     * Returns the leaf group count. Execute groupNeighbourLeafs() before acquiring that 
+     * parameter.
+     * \return The leaf group count.
+     */
+    size_t getGroupCount();
+
+    /**
+     * Returns the group ID of a leaf. Execute groupNeighbourLeafs() before acquiring that 
+     * parameter.
+     * \param leaf Index of the leaf.
+     * \return The group ID of the leaf.
+     */
+    size_t getGroupNr( size_t leaf );
+
+    /**
+     * Returns the detail level. It's the radius of the leafs.
+     * \return The radius of the leafs.
+     */
+    double getDetailLevel();
+
+    /**
+     * Neighborship detection mode. It's simply the allowed count of dimensions where 
+     * planes stand next to instead overlap. Having a regular grid these settings mean 
+     * following neighborship kinds:
+     *  1: Neighborship of 6
+     *  2: Neighborship of 18
+     *  3: Neighborship of 27
+     * \param cornerNeighborClass The leaf neighborship class.
+     */
+    void setCornerNeighborClass( size_t cornerNeighborClass );
+
+    /**
+     * Leaf index that is returned if no leaf covers a coordinate.
+     */
+    static const size_t noLeaf;
+
+protected:
+    /**
+     * Describes the condition when neighbor leafs can be grouped. Derived classes 
+     * override it to compare their per leaf data. It is called concurrently.
+     * \param leaf1 Index of the first leaf to verify.
+     * \param leaf2 Index of the second leaf to verify.
+     * \return Leafs can be grouped or not.
+     */
+    virtual bool canGroupLeafs( size_t leaf1, size_t leaf2 );
+
+private:
+    /**
+     * Builds the leafs from interleaved coordinates.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     */
+    template< typename T > void buildFromCoordinates( const vector<T>& coordinates );
+
+    /**
+     * Rebuilds the hash table that maps leaf keys to leaf indices.
+     */
+    void buildLeafIndex();
+
+    /**
+     * Looks up the leaf of a key using the hash table.
+     * \param key Key of the leaf.
+     * \return The leaf index or noLeaf if no leaf has that key.
+     */
+    size_t findLeaf( boost::uint64_t key );
+
+    /**
+     * Returns the hash table slot where the search for a key starts.
+     * \param key Key to look up.
+     * \return The first examined slot.
+     */
+    size_t getHashSlot( boost::uint64_t key );
+
+    /**
+     * Looks up which neighbors of a range of leafs can be grouped with them. Only 
+     * neighbors of a smaller leaf index are regarded so that each pair is found once.
+     * \param begin First examined leaf index.
+     * \param end Index after the last examined leaf.
+     * \param targetPairs List where the leaf indices of groupable pairs are put one 
+     *                    after the other.
+     */
+    void fetchGroupableNeighbors( size_t begin, size_t end, vector<size_t>* targetPairs );
+
+    /**
+     * The radius of the leafs.
+     */
+    double m_detailLevel;
+
+    /**
+     * Neighborship detection mode. See setCornerNeighborClass().
+     */
+    size_t m_cornerNeighborClass;
+
+    /**
+     * Sorted Morton codes of the leafs.
+     */
+    vector<boost::uint64_t> m_leafKeys;
+
+    /**
+     * Position of the first point of each leaf within m_points. An additional last 
+     * entry holds the total point count.
+     */
+    vector<size_t> m_leafPointOffsets;
+
+    /**
+     * Point indices ordered by their leaf.
+     */
+    vector<size_t> m_points;
+
+    /**
+     * Leaf index of each point in the order of the coordinate array.
+     */
+    vector<size_t> m_pointLeafs;
+
+    /**
+     * Keys of the hash table slots.
+     */
+    vector<boost::uint64_t> m_hashKeys;
+
+    /**
+     * Leaf index of each hash table slot. Empty slots contain noLeaf.
+     */
+    vector<size_t> m_hashLeafs;
+
+    /**
+     * Bit count of the hash table size.
+     */
+    size_t m_hashBits;
+
+    /**
+     * Group ID of each leaf.
+     */
+    vector<size_t> m_leafGroups;
+
+    /**
+     * Count of leaf groups.
+     */
+    size_t m_groupCount;
+};
+
+#endif  // WLINEAROCTREE_H
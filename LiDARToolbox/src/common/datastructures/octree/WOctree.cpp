@@ -22,15 +22,184 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <limits>
 #include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+#include "../../algorithms/threadPool/WThreadPool.h"
+#include "../../math/mortonCode/WMortonCode.h"
+#include "../unionFind/WUnionFind.h"
 #include "WOctree.h"
 
+using std::numeric_limits;
+
+/**
+ * Thread pool task that calculates the bounding box of points.
+ */
+template< typename T > class WOctreeBoundsTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     * \param threadCount Thread count of the processing pool.
+     */
+    WOctreeBoundsTask( const vector<T>& coordinates, size_t threadCount ) :
+        m_coordinates( coordinates ),
+        m_minimums( threadCount, vector<double>( 3, numeric_limits<double>::infinity() ) ),
+        m_maximums( threadCount, vector<double>( 3, -numeric_limits<double>::infinity() ) )
+    {
+    }
+
+    /**
+     * Extends the bounding box of a thread by a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        vector<double>& minimum = m_minimums[threadIndex];
+        vector<double>& maximum = m_maximums[threadIndex];
+        for( size_t index = begin; index < end; index++ )
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+            {
+                double coordinate = m_coordinates[index * 3 + dimension];
+                minimum[dimension] = coordinate < minimum[dimension] ?coordinate :minimum[dimension];
+                maximum[dimension] = coordinate > maximum[dimension] ?coordinate :maximum[dimension];
+            }
+    }
+
+    /**
+     * Merges the bounding boxes of all threads.
+     * \param minimum Output minimal coordinate of each dimension.
+     * \param maximum Output maximal coordinate of each dimension.
+     */
+    void fetchBounds( vector<double>* minimum, vector<double>* maximum )
+    {
+        minimum->assign( 3, numeric_limits<double>::infinity() );
+        maximum->assign( 3, -numeric_limits<double>::infinity() );
+        for( size_t thread = 0; thread < m_minimums.size(); thread++ )
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+            {
+                ( *minimum )[dimension] = std::min( ( *minimum )[dimension], m_minimums[thread][dimension] );
+                ( *maximum )[dimension] = std::max( ( *maximum )[dimension], m_maximums[thread][dimension] );
+            }
+    }
+
+private:
+    /**
+     * Interleaved X/Y/Z coordinates of the points.
+     */
+    const vector<T>& m_coordinates;
+
+    /**
+     * Minimal coordinates found by each thread.
+     */
+    vector< vector<double> > m_minimums;
+
+    /**
+     * Maximal coordinates found by each thread.
+     */
+    vector< vector<double> > m_maximums;
+};
+
+/**
+ * Thread pool task that determines the partition node of each point. Partitions are the 
+ * nodes of a particular depth below the root. The calculation follows the node centers 
+ * of WOctNode::touchNode() so that the partitions match the nodes created later.
+ */
+template< typename T > class WOctreePartitionTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param root Root node of the octree.
+     * \param coordinates Interleaved X/Y/Z coordinates of the points.
+     * \param partitionDepth Depth of the partition nodes below the root.
+     * \param pointPartitions Output partition of each point. The drawers of the path 
+     *                        to the partition node are its digits of the base 8.
+     */
+    WOctreePartitionTask( WOctNode* root, const vector<T>& coordinates, size_t partitionDepth,
+            vector<size_t>* pointPartitions ) :
+        m_coordinates( coordinates )
+    {
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+            m_rootCenter[dimension] = root->getCenter( dimension );
+        m_rootRadius = root->getRadius();
+        m_partitionDepth = partitionDepth;
+        m_pointPartitions = pointPartitions;
+    }
+
+    /**
+     * Determines the partitions of a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+        {
+            double center[3] = { m_rootCenter[0], m_rootCenter[1], m_rootCenter[2] };
+            double radius = m_rootRadius;
+            size_t partition = 0;
+            for( size_t depth = 0; depth < m_partitionDepth; depth++ )
+            {
+                size_t drawer = 0;
+                for( size_t dimension = 0; dimension < 3; dimension++ )
+                {
+                    size_t dimensionCase = m_coordinates[index * 3 + dimension] < center[dimension] ?0 :1;
+                    center[dimension] = center[dimension] - radius * 0.5 + static_cast<double>( dimensionCase ) * radius;
+                    drawer += dimensionCase << dimension;
+                }
+                radius *= 0.5;
+                partition = partition * 8 + drawer;
+            }
+            ( *m_pointPartitions )[index] = partition;
+        }
+    }
+
+private:
+    /**
+     * Interleaved X/Y/Z coordinates of the points.
+     */
+    const vector<T>& m_coordinates;
+
+    /**
+     * Center of the root node.
+     */
+    double m_rootCenter[3];
+
+    /**
+     * Radius of the root node.
+     */
+    double m_rootRadius;
+
+    /**
+     * Depth of the partition nodes below the root.
+     */
+    size_t m_partitionDepth;
+
+    /**
+     * Output partition of each point.
+     */
+    vector<size_t>* m_pointPartitions;
+};
+
+const size_t WOctree::noLeaf = static_cast<size_t>( -1 );
+
 WOctree::WOctree( double detailLevel )
 {
     m_root = new WOctNode( 0.0, 0.0, 0.0, detailLevel );
     m_detailLevel = detailLevel;
     m_cornerNeighborClass = 1;
+    m_isParallelGrouping = true;
+    m_isLeafIndexValid = false;
 }
 
 WOctree::WOctree( double detailLevel, WOctNode* nodeType )
@@ -38,6 +207,8 @@ WOctree::WOctree( double detailLevel, WOctNode* nodeType )
     m_root = nodeType->newInstance( 0.0, 0.0, 0.0, detailLevel );
     m_detailLevel = detailLevel;
     m_cornerNeighborClass = 1;
+    m_isParallelGrouping = true;
+    m_isLeafIndexValid = false;
 }
 
 WOctree::~WOctree()
@@ -48,6 +219,7 @@ WOctree::~WOctree()
 void WOctree::registerPoint( double x, double y, double z )
 {
 //    std::cout << "Inflating point: " << x << ", " << y << ", " << z << std::endl;
+    m_isLeafIndexValid = false;
     while  ( !m_root->fitsIn( x, y, z ) || m_root->getRadius() <= m_detailLevel )
         m_root->expand();
 
@@ -62,6 +234,16 @@ void WOctree::registerPoint( double x, double y, double z )
     }
 }
 
+void WOctree::registerPoints( const vector<double>& coordinates )
+{
+    registerCoordinates( coordinates );
+}
+
+void WOctree::registerPoints( const vector<float>& coordinates )
+{
+    registerCoordinates( coordinates );
+}
+
 WOctNode* WOctree::getLeafNode( double x, double y, double z )
 {
     if( !m_root->fitsIn( x, y, z ) )
@@ -90,27 +272,32 @@ size_t WOctree::getGroupCount()
 
 void WOctree::groupNeighbourLeafsFromRoot()
 {
-    resizeGroupList( 0 );
-    groupNeighbourLeafs( m_root );
-    size_t currentFinalGroup = 0;
-    for( size_t groupID = 0; groupID < m_groupEquivs.size(); groupID++ )
-    {
-        bool idUsed = false;
-        for( size_t index = 0; index < m_groupEquivs.size(); index++ )
-        {
-            if( m_groupEquivs[index] == groupID )
-            {
-                m_groupEquivs[index] = currentFinalGroup;
-                idUsed = true;
-            }
-        }
-        if( idUsed ) currentFinalGroup++;
-    }
-    refreshNodeGroup( m_root );
-    resizeGroupList( currentFinalGroup );
-    for( size_t index = 0; index < currentFinalGroup; index++ )
+    refreshLeafIndex();
+    size_t leafCount = m_leafs.size();
+
+    WThreadPool* threadPool = WThreadPool::getSharedPool();
+    size_t chunkCount = m_isParallelGrouping && leafCount > 1000 ?threadPool->getThreadCount() * 4 :1;
+    size_t chunkSize = ( leafCount + chunkCount - 1 ) / chunkCount;
+    vector< vector<size_t> > groupablePairs( chunkCount );
+    vector< boost::function<void ()> > chunkSearches;
+    for( size_t chunk = 0; chunk < chunkCount; chunk++ )
+        chunkSearches.push_back( boost::bind( &WOctree::fetchGroupableNeighbors, this, std::min( chunk * chunkSize, leafCount ),
+                std::min( ( chunk + 1 ) * chunkSize, leafCount ), &groupablePairs[chunk] ) );
+    threadPool->parallelInvoke( chunkSearches );
+
+    WUnionFind groups( leafCount );
+    for( size_t chunk = 0; chunk < chunkCount; chunk++ )
+        for( size_t index = 0; index + 1 < groupablePairs[chunk].size(); index += 2 )
+            groups.unite( groupablePairs[chunk][index], groupablePairs[chunk][index + 1] );
+    vector<size_t> leafGroups;
+    size_t groupCount = groups.getSetLabels( &leafGroups );
+    for( size_t index = 0; index < leafCount; index++ )
+        m_leafs[index]->setGroupNr( leafGroups[index] );
+
+    resizeGroupList( groupCount );
+    for( size_t index = 0; index < groupCount; index++ )
         m_groupEquivs[index] = index;
-//    std::cout << "Found " << currentFinalGroup << " groups." << std::endl;
+//    std::cout << "Found " << groupCount << " groups." << std::endl;
 }
 
 void WOctree::refreshNodeGroup( WOctNode* node )
@@ -128,56 +315,97 @@ void WOctree::refreshNodeGroup( WOctNode* node )
     }
 }
 
-void WOctree::groupNeighbourLeafs( WOctNode* node )
+void WOctree::fetchLeafNodes( WOctNode* node, vector<WOctNode*>* targetLeafs )
 {
     if  ( isLeafNode(node) )
     {
-        size_t group = m_groupEquivs.size();
-        vector<WOctNode*> neighbors = getNeighborsOfNode( node );
-        for( size_t index = 0; index < neighbors.size(); index++ )
-        {
-            WOctNode* neighbor = neighbors[index];
-            size_t neighborID = neighbor != 0 && neighbor->hasGroup()
-                    ?m_groupEquivs[neighbor->getGroupNr()] :group;
-            if( group > neighborID && m_detailLevel == neighbor->getRadius()/*TODO(aschwarzkopf): Consider removing this query*/ )
-                if( neighbor->hasGroup() && canGroupNodes( node, neighbor ) )
-                        group = neighborID;
-        }
-        for( size_t index = 0; index < neighbors.size(); index++ )
-        {
-            WOctNode* neighbor = neighbors[index];
-            size_t neighborID = neighbor != 0 && neighbor->hasGroup()
-                    ?m_groupEquivs[neighbor->getGroupNr()] :group;
-            if( group < neighborID && neighbor->hasGroup() &&
-                    m_detailLevel == neighbor->getRadius() /*TODO( aschwarzkopf ): Consider removing this query*/ )
-            {
-                for( size_t newIdx = 0; newIdx < m_groupEquivs.size(); newIdx++ )
-                    if( m_groupEquivs[newIdx] == neighborID &&  canGroupNodes( node, neighbor ) )
-                            m_groupEquivs[newIdx] = group;
-            }
-        }
-        if( group >= m_groupEquivs.size() )
-        {
-            resizeGroupList( group + 1 );
-            m_groupEquivs[group] = group;
-        }
-        node->setGroupNr( group );
+        targetLeafs->push_back( node );
     }
     else
     {
         for  ( int child = 0; child < 8; child++ )
             if  ( node->getChild( child ) != 0 )
-                groupNeighbourLeafs( node->getChild( child ) );
+                fetchLeafNodes( node->getChild( child ), targetLeafs );
+    }
+}
+
+void WOctree::refreshLeafIndex()
+{
+    if( m_isLeafIndexValid )
+        return;
+    m_leafs.clear();
+    fetchLeafNodes( m_root, &m_leafs );
+    m_leafCells.resize( m_leafs.size() * 3 );
+    m_leafIndices.clear();
+    m_leafIndices.rehash( m_leafs.size() );
+    for( size_t index = 0; index < m_leafs.size(); index++ )
+    {
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+            m_leafCells[index * 3 + dimension] = getLeafCellCoordinate( m_leafs[index]->getCenter( dimension ) );
+        m_leafIndices[getCellKey( m_leafCells[index * 3], m_leafCells[index * 3 + 1], m_leafCells[index * 3 + 2] )] = index;
+    }
+    m_isLeafIndexValid = true;
+}
+
+size_t WOctree::findLeaf( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ )
+{
+    boost::unordered_map<boost::uint64_t, size_t>::const_iterator leaf = m_leafIndices.find( getCellKey( cellX, cellY, cellZ ) );
+    return leaf == m_leafIndices.end() ?noLeaf :leaf->second;
+}
+
+bool WOctree::isNeighborCellOffset( int offsetX, int offsetY, int offsetZ )
+{
+    if( offsetX < -1 || offsetX > 1 || offsetY < -1 || offsetY > 1 || offsetZ < -1 || offsetZ > 1 )
+        return false;
+    size_t touchingDimensions = ( offsetX != 0 ?1 :0 ) + ( offsetY != 0 ?1 :0 ) + ( offsetZ != 0 ?1 :0 );
+    return touchingDimensions > 0 && touchingDimensions <= m_cornerNeighborClass;
+}
+
+void WOctree::fetchGroupableNeighbors( size_t begin, size_t end, vector<size_t>* targetPairs )
+{
+    for( size_t index = begin; index < end; index++ )
+    {
+        const boost::int64_t* cell = &m_leafCells[index * 3];
+        for( int offsetX = -1; offsetX <= 1; offsetX++ )
+            for( int offsetY = -1; offsetY <= 1; offsetY++ )
+                for( int offsetZ = -1; offsetZ <= 1; offsetZ++ )
+                {
+                    if( !isNeighborCellOffset( offsetX, offsetY, offsetZ ) )
+                        continue;
+                    size_t neighbor = findLeaf( cell[0] + offsetX, cell[1] + offsetY, cell[2] + offsetZ );
+                    if( neighbor >= index )
+                        continue;
+                    if( canGroupNodes( m_leafs[index], m_leafs[neighbor] ) )
+                    {
+                        targetPairs->push_back( index );
+                        targetPairs->push_back( neighbor );
+                    }
+                }
     }
 }
 
 vector<WOctNode*> WOctree::getNeighborsOfNode( WOctNode* node )
 {
-    vector<WOctNode*>* foundNeighbors = new vector<WOctNode*>();
-    fetchNeighborsTooNode( node, getRootNode(), foundNeighbors );
     vector<WOctNode*> neighbors;
-    for(size_t index = 0; index < foundNeighbors->size(); index++ )
-        neighbors.push_back( foundNeighbors->at( index ) );
+    if( !isLeafNode( node ) )
+    {
+        fetchNeighborsTooNode( node, getRootNode(), &neighbors );
+        return neighbors;
+    }
+    refreshLeafIndex();
+    boost::int64_t cellX = getLeafCellCoordinate( node->getCenter( 0 ) );
+    boost::int64_t cellY = getLeafCellCoordinate( node->getCenter( 1 ) );
+    boost::int64_t cellZ = getLeafCellCoordinate( node->getCenter( 2 ) );
+    for( int offsetX = -1; offsetX <= 1; offsetX++ )
+        for( int offsetY = -1; offsetY <= 1; offsetY++ )
+            for( int offsetZ = -1; offsetZ <= 1; offsetZ++ )
+            {
+                if( !isNeighborCellOffset( offsetX, offsetY, offsetZ ) )
+                    continue;
+                size_t neighbor = findLeaf( cellX + offsetX, cellY + offsetY, cellZ + offsetZ );
+                if( neighbor != noLeaf )
+                    neighbors.push_back( m_leafs[neighbor] );
+            }
     return neighbors;
 }
 
@@ -203,7 +431,7 @@ bool WOctree::isConnectedTo( WOctNode* node1, WOctNode* node2 )
     size_t cornerNeighborClass = 0;
     for( size_t dimension = 0; dimension < 3; dimension++ )
     {
-        double centerDistance = abs( node1->getCenter( dimension ) - node2->getCenter( dimension ) );
+        double centerDistance = fabs( node1->getCenter( dimension ) - node2->getCenter( dimension ) );
         double radiusSum = node1->getRadius() + node2->getRadius();
         if( centerDistance > radiusSum + 0.000001 )
             return false;
@@ -215,7 +443,9 @@ bool WOctree::isConnectedTo( WOctNode* node1, WOctNode* node2 )
 
 bool WOctree::canGroupNodes( WOctNode* node1, WOctNode* node2 )
 {
-    return isConnectedTo(node1, node2);
+    node1 = node1;
+    node2 = node2;
+    return true;
 }
 
 void WOctree::resizeGroupList( size_t listLength )
@@ -259,7 +489,125 @@ bool WOctree::isLeafNode( WOctNode* node )
     return true;
 }
 
+boost::uint64_t WOctree::getLeafKey( double x, double y, double z )
+{
+    return getCellKey( getLeafCellCoordinate( x ), getLeafCellCoordinate( y ), getLeafCellCoordinate( z ) );
+}
+
+boost::int64_t WOctree::getLeafCellCoordinate( double coordinate )
+{
+    return static_cast<boost::int64_t>( floor( coordinate / ( m_detailLevel * 2.0 ) ) );
+}
+
+boost::uint64_t WOctree::getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ )
+{
+    boost::int64_t latticeOrigin = static_cast<boost::int64_t>( 1 ) << ( WMortonCode::BITS_PER_DIMENSION - 1 );
+    return WMortonCode::encode( static_cast<boost::uint32_t>( cellX + latticeOrigin ), static_cast<boost::uint32_t>( cellY + latticeOrigin ),
+                                static_cast<boost::uint32_t>( cellZ + latticeOrigin ) );
+}
+
+void WOctree::setParallelGrouping( bool isParallelGrouping )
+{
+    m_isParallelGrouping = isParallelGrouping;
+}
+
 void WOctree::setCornerNeighborClass( size_t cornerNeighborClass )
 {
     m_cornerNeighborClass = cornerNeighborClass;
 }
+
+template< typename T > void WOctree::registerCoordinates( const vector<T>& coordinates )
+{
+    size_t pointCount = coordinates.size() / 3;
+    if( pointCount == 0 )
+        return;
+    m_isLeafIndexValid = false;
+    WThreadPool* threadPool = WThreadPool::getSharedPool();
+    WOctreeBoundsTask<T> boundsTask( coordinates, threadPool->getThreadCount() );
+    threadPool->parallelFor( &boundsTask, pointCount );
+    vector<double> minimum;
+    vector<double> maximum;
+    boundsTask.fetchBounds( &minimum, &maximum );
+    while  ( !m_root->fitsIn( minimum[0], minimum[1], minimum[2] ) || !m_root->fitsIn( maximum[0], maximum[1], maximum[2] )
+            || m_root->getRadius() <= m_detailLevel )
+        m_root->expand();
+
+    size_t partitionDepth = 0;
+    size_t partitionCount = 1;
+    double partitionRadius = m_root->getRadius();
+    while( threadPool->getThreadCount() > 1 && partitionCount < threadPool->getThreadCount() * 8
+            && partitionRadius > m_detailLevel )
+    {
+        partitionDepth++;
+        partitionCount *= 8;
+        partitionRadius *= 0.5;
+    }
+    vector<size_t> pointPartitions( pointCount, 0 );
+    WOctreePartitionTask<T> partitionTask( m_root, coordinates, partitionDepth, &pointPartitions );
+    threadPool->parallelFor( &partitionTask, pointCount );
+
+    vector<size_t> partitionOffsets( partitionCount + 1, 0 );
+    for( size_t index = 0; index < pointCount; index++ )
+        partitionOffsets[pointPartitions[index] + 1]++;
+    for( size_t partition = 0; partition < partitionCount; partition++ )
+        partitionOffsets[partition + 1] += partitionOffsets[partition];
+    vector<size_t> pointOrder( pointCount );
+    vector<size_t> partitionPositions( partitionOffsets.begin(), partitionOffsets.end() - 1 );
+    for( size_t index = 0; index < pointCount; index++ )
+        pointOrder[partitionPositions[pointPartitions[index]]++] = index;
+
+    vector< boost::function<void ()> > partitionBuilds;
+    partitionBuilds.push_back( boost::bind( &WOctree::touchUpperNodes<T>, this, boost::cref( coordinates ), partitionDepth ) );
+    for( size_t partition = 0; partition < partitionCount; partition++ )
+    {
+        if( partitionOffsets[partition] == partitionOffsets[partition + 1] )
+            continue;
+        WOctNode* node = m_root;
+        for( size_t depth = partitionDepth; depth > 0; depth-- )
+        {
+            size_t drawer = ( partition >> ( ( depth - 1 ) * 3 ) ) & 7;
+            node->touchNode( drawer );
+            node = node->getChild( drawer );
+        }
+        partitionBuilds.push_back( boost::bind( &WOctree::registerPointsBelow<T>, this, node, boost::cref( coordinates ),
+                &pointOrder, partitionOffsets[partition], partitionOffsets[partition + 1] ) );
+    }
+    threadPool->parallelInvoke( partitionBuilds );
+}
+
+template< typename T > void WOctree::registerPointsBelow( WOctNode* partitionNode, const vector<T>& coordinates,
+        const vector<size_t>* pointOrder, size_t begin, size_t end )
+{
+    for( size_t index = begin; index < end; index++ )
+    {
+        size_t point = pointOrder->at( index );
+        double x = coordinates[point * 3];
+        double y = coordinates[point * 3 + 1];
+        double z = coordinates[point * 3 + 2];
+        WOctNode* node = partitionNode;
+        node->touchPosition( x, y, z );
+        while  ( node->getRadius() > m_detailLevel )
+        {
+            size_t drawer = node->getFittingCase( x, y, z );
+            node->touchNode( drawer );
+            node = node->getChild( drawer );
+            node->touchPosition( x, y, z );
+        }
+    }
+}
+
+template< typename T > void WOctree::touchUpperNodes( const vector<T>& coordinates, size_t partitionDepth )
+{
+    for( size_t point = 0; point < coordinates.size() / 3; point++ )
+    {
+        double x = coordinates[point * 3];
+        double y = coordinates[point * 3 + 1];
+        double z = coordinates[point * 3 + 2];
+        WOctNode* node = m_root;
+        for( size_t depth = 0; depth < partitionDepth; depth++ )
+        {
+            node->touchPosition( x, y, z );
+            node = node->getChild( node->getFittingCase( x, y, z ) );
+        }
+    }
+}
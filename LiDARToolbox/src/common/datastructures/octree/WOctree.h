@@ -26,6 +26,8 @@
 #define WOCTREE_H
 
 #include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
 #include "core/graphicsEngine/WTriangleMesh.h"
 #include "WOctNode.h"
 
@@ -69,6 +71,24 @@ public:
      */
     void registerPoint( double x, double y, double z );
 
+    /**
+     * Registers many points at once using the threads of the shared thread pool. The 
+     * root is expanded to the bounding box of all points first. Then the subtrees of the 
+     * nodes a few levels below the root are built in parallel. Each node touches its 
+     * points in the same order as registerPoint() calls would do.
+     * \param coordinates Interleaved X/Y/Z coordinates of the registered points.
+     */
+    void registerPoints( const vector<double>& coordinates );
+
+    /**
+     * Registers many points at once using the threads of the shared thread pool. The 
+     * root is expanded to the bounding box of all points first. Then the subtrees of the 
+     * nodes a few levels below the root are built in parallel. Each node touches its 
+     * points in the same order as registerPoint() calls would do.
+     * \param coordinates Interleaved X/Y/Z coordinates of the registered points.
+     */
+    void registerPoints( const vector<float>& coordinates );
+
     /**
      * Returns the leaf octree node of the finest detail level that covers a X/Y/Z
      * coordinate
@@ -88,7 +108,9 @@ public:
 
     /**
      * Adjusts group numbers of all leaf nodes so that nodes have the same ID that 
-     * represent altogether a single block.
+     * represent altogether a single block. Neighbors are looked up by the leaf keys 
+     * (see getLeafKey()) and merged using a union-find. Groups are numbered in the 
+     * order in which the tree traverses their first leaf.
      */
     virtual void groupNeighbourLeafsFromRoot(); //TODO(aschwarzkopf): Rename to groupNeighbourLeafs() after extracting neighbors fetch method
 
@@ -106,7 +128,8 @@ public:
     size_t getGroupCount();
 
     /**
-     * Describes the condition when neighbor nodes can be grouped.
+     * Describes the condition when neighbor nodes can be grouped. The base octree 
+     * groups all neighbor leafs of the corner neighbor class.
      * \param node1 First node to verify.
      * \param node2 Second node to verify.
      * \return Nodes can be grouped or not.
@@ -130,6 +153,43 @@ public:
      */
     static float calcColor( size_t groupNr, size_t colorChannel ); //TODO(schwarzkopf): Implement the following parameter another way somewhere else.
 
+    /**
+     * Returns the key of the leaf cell that covers a coordinate. Leafs are cells of an 
+     * integer lattice with the edge length of two times the detail level. The key is 
+     * the Morton code of the cell so that each leaf has a unique key. The lattice 
+     * covers 2^20 cells in each direction from the origin.
+     * \param x X coordinate covered by the cell.
+     * \param y Y coordinate covered by the cell.
+     * \param z Z coordinate covered by the cell.
+     * \return The key of the leaf cell.
+     */
+    boost::uint64_t getLeafKey( double x, double y, double z );
+
+    /**
+     * Returns the leaf cell lattice coordinate that covers a coordinate. See 
+     * getLeafKey().
+     * \param coordinate X, Y or Z coordinate.
+     * \return Lattice coordinate of the covering leaf cell.
+     */
+    boost::int64_t getLeafCellCoordinate( double coordinate );
+
+    /**
+     * Returns the key of a leaf cell using its lattice coordinates. See getLeafKey().
+     * \param cellX X lattice coordinate of the cell.
+     * \param cellY Y lattice coordinate of the cell.
+     * \param cellZ Z lattice coordinate of the cell.
+     * \return The key of the leaf cell.
+     */
+    static boost::uint64_t getCellKey( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ );
+
+    /**
+     * Sets whether groupNeighbourLeafsFromRoot() examines neighbors on all threads of 
+     * the shared thread pool. Derived classes must then have a canGroupNodes() that 
+     * can be called concurrently. It is enabled by default.
+     * \param isParallelGrouping Examine neighbors in parallel or not.
+     */
+    void setParallelGrouping( bool isParallelGrouping );
+
     /**
      * An octree node is a leaf or not.
      * \param node Node to examine whether it is a leaf or not:
@@ -150,15 +210,85 @@ public:
 
 protected:
     /**
-     * Method that traverses a node in order to group all neighbor cubes into mutual 
-     * group numbers.
-     * \param node Subnodes to traverse recursively.
+     * Registers points using the threads of the shared thread pool. See 
+     * registerPoints().
+     * \param coordinates Interleaved X/Y/Z coordinates of the registered points.
+     */
+    template< typename T > void registerCoordinates( const vector<T>& coordinates );
+
+    /**
+     * Registers points below a node of which the area covers them. The nodes above 
+     * aren't touched.
+     * \param partitionNode Node that covers the points.
+     * \param coordinates Interleaved X/Y/Z coordinates of all points.
+     * \param pointOrder Point indices ordered by the node that covers them.
+     * \param begin First registered position within pointOrder.
+     * \param end Position after the last registered point within pointOrder.
+     */
+    template< typename T > void registerPointsBelow( WOctNode* partitionNode, const vector<T>& coordinates,
+            const vector<size_t>* pointOrder, size_t begin, size_t end );
+
+    /**
+     * Touches the nodes above the partition depth with all points. The nodes must 
+     * already exist.
+     * \param coordinates Interleaved X/Y/Z coordinates of all points.
+     * \param partitionDepth Depth below the root where touching stops.
      */
-    void groupNeighbourLeafs( WOctNode* node );
+    template< typename T > void touchUpperNodes( const vector<T>& coordinates, size_t partitionDepth );
 
     /**
-     * Returns possible neighbors of a node. Nodes that are in no case traversed before 
-     * for a comparison aren't added.
+     * Puts all leaf nodes below a node into a list. Children are traversed in the order 
+     * of their index.
+     * \param node Node to traverse recursively.
+     * \param targetLeafs List where the leaf nodes are put.
+     */
+    void fetchLeafNodes( WOctNode* node, vector<WOctNode*>* targetLeafs );
+
+    /**
+     * Rebuilds the leaf index if points were registered since it was built last. The 
+     * leafs are listed in the order of fetchLeafNodes(). Each one is registered by its 
+     * lattice cell (see getLeafKey()). It isn't thread safe.
+     */
+    void refreshLeafIndex();
+
+    /**
+     * Returns the index of the leaf of a lattice cell within the leaf index. 
+     * refreshLeafIndex() must be called before.
+     * \param cellX X lattice coordinate of the cell.
+     * \param cellY Y lattice coordinate of the cell.
+     * \param cellZ Z lattice coordinate of the cell.
+     * \return Index of the leaf within m_leafs or noLeaf if the cell has no leaf.
+     */
+    size_t findLeaf( boost::int64_t cellX, boost::int64_t cellY, boost::int64_t cellZ );
+
+    /**
+     * Tells whether a cell offset reaches a neighbor of the corner neighbor class. It 
+     * is the integer counterpart of isConnectedTo() for two leafs.
+     * \param offsetX X lattice offset between the cells.
+     * \param offsetY Y lattice offset between the cells.
+     * \param offsetZ Z lattice offset between the cells.
+     * \return The offset is between -1 and 1 in each dimension, isn't zero and touches 
+     *         not more dimensions than the corner neighbor class or not.
+     */
+    bool isNeighborCellOffset( int offsetX, int offsetY, int offsetZ );
+
+    /**
+     * Looks up which neighbors of a range of leafs can be grouped with them. Only 
+     * neighbors that come first in the leaf index are regarded so that each pair is 
+     * found once. refreshLeafIndex() must be called before.
+     * \param begin First examined leaf index.
+     * \param end Index after the last examined leaf.
+     * \param targetPairs List where the leaf indices of groupable pairs are put one 
+     *                    after the other.
+     */
+    void fetchGroupableNeighbors( size_t begin, size_t end, vector<size_t>* targetPairs );
+
+    /**
+     * Returns possible neighbors of a node. Neighbors of a leaf are looked up by their 
+     * cells in the leaf index without descending the tree. They are returned in the 
+     * order of their cell offset. The leaf index is rebuilt by the first call after 
+     * points were registered. So that call mustn't run concurrently to other ones. 
+     * Neighbors of inner nodes are searched by fetchNeighborsTooNode().
      * \param node Node to return neighbors of.
      * \return Neighbors of the node.
      */
@@ -225,6 +355,37 @@ protected:
      *  3: Neighborship of 27
      */
     size_t m_cornerNeighborClass;
+
+    /**
+     * Neighbors are examined on all threads of the shared thread pool during grouping 
+     * or not.
+     */
+    bool m_isParallelGrouping;
+
+    /**
+     * Index of m_leafs that marks a cell without leaf.
+     */
+    static const size_t noLeaf;
+
+    /**
+     * Leaf nodes of the leaf index.
+     */
+    vector<WOctNode*> m_leafs;
+
+    /**
+     * Lattice coordinates of the cell of each leaf. Three for each one.
+     */
+    vector<boost::int64_t> m_leafCells;
+
+    /**
+     * Index within m_leafs of each leaf cell key.
+     */
+    boost::unordered_map<boost::uint64_t, size_t> m_leafIndices;
+
+    /**
+     * The leaf index covers all registered points or not.
+     */
+    bool m_isLeafIndexValid;
 };
 
 #endif  // WOCTREE_H
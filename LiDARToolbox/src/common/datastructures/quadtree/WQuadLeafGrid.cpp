@@ -0,0 +1,155 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <vector>
+
+#include "../../algorithms/threadPool/WThreadPool.h"
+#include "WQuadLeafGrid.h"
+
+const size_t WQuadLeafGrid::noLeaf = static_cast<size_t>( -1 );
+
+/**
+ * Thread pool task that puts the leaf nodes of a quadtree into their grid cells.
+ */
+class WQuadLeafGridTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param grid Grid to fill.
+     */
+    explicit WQuadLeafGridTask( WQuadLeafGrid* grid )
+    {
+        m_grid = grid;
+    }
+
+    /**
+     * Puts a range of leaf nodes into their cells.
+     * \param begin First leaf index.
+     * \param end Index after the last leaf.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        m_grid->registerLeaves( begin, end );
+    }
+
+private:
+    /**
+     * Grid to fill.
+     */
+    WQuadLeafGrid* m_grid;
+};
+
+
+WQuadLeafGrid::WQuadLeafGrid()
+{
+    m_quadTree = 0;
+    m_binOffset[0] = m_binOffset[1] = 0;
+    m_size[0] = m_size[1] = 0;
+}
+
+WQuadLeafGrid::~WQuadLeafGrid()
+{
+}
+
+void WQuadLeafGrid::importQuadTree( WQuadTree* quadTree )
+{
+    m_quadTree = quadTree;
+    WQuadNode* rootNode = quadTree->getRootNode();
+    m_binOffset[0] = quadTree->getBin( rootNode->getXMin() );
+    m_binOffset[1] = quadTree->getBin( rootNode->getYMin() );
+    m_size[0] = quadTree->getBin( rootNode->getXMax() ) - m_binOffset[0] + 1;
+    m_size[1] = quadTree->getBin( rootNode->getYMax() ) - m_binOffset[1] + 1;
+    m_leaves.clear();
+    if( rootNode->getPointCount() > 0 )
+        fetchLeaves( rootNode );
+    m_cells.assign( m_size[0] * m_size[1], 0 );
+    WQuadLeafGridTask task( this );
+    WThreadPool::getSharedPool()->parallelFor( &task, m_leaves.size() );
+}
+
+size_t WQuadLeafGrid::getSizeX()
+{
+    return m_size[0];
+}
+
+size_t WQuadLeafGrid::getSizeY()
+{
+    return m_size[1];
+}
+
+size_t WQuadLeafGrid::getLeafCount()
+{
+    return m_leaves.size();
+}
+
+WQuadNode* WQuadLeafGrid::getLeaf( size_t leafIndex )
+{
+    return m_leaves[leafIndex];
+}
+
+size_t WQuadLeafGrid::getLeafIndex( size_t cellX, size_t cellY )
+{
+    if( cellX >= m_size[0] || cellY >= m_size[1] )
+        return noLeaf;
+    boost::uint32_t cell = m_cells[cellX + m_size[0] * cellY];
+    return cell == 0 ?noLeaf :static_cast<size_t>( cell - 1 );
+}
+
+size_t WQuadLeafGrid::getCellX( double x )
+{
+    return m_quadTree->getBin( x ) - m_binOffset[0];
+}
+
+size_t WQuadLeafGrid::getCellY( double y )
+{
+    return m_quadTree->getBin( y ) - m_binOffset[1];
+}
+
+void WQuadLeafGrid::registerLeaves( size_t begin, size_t end )
+{
+    for( size_t leaf = begin; leaf < end; leaf++ )
+    {
+        size_t cellX = getCellX( m_leaves[leaf]->getCenter( 0 ) );
+        size_t cellY = getCellY( m_leaves[leaf]->getCenter( 1 ) );
+        if( cellX < m_size[0] && cellY < m_size[1] )
+            m_cells[cellX + m_size[0] * cellY] = static_cast<boost::uint32_t>( leaf + 1 );
+    }
+}
+
+void WQuadLeafGrid::fetchLeaves( WQuadNode* node )
+{
+    if( node->getRadius() <= m_quadTree->getDetailLevel() )
+    {
+        m_leaves.push_back( node );
+    }
+    else
+    {
+        for  ( size_t child = 0; child < 4; child++ )
+            if  ( node->getChild( child ) != 0 )
+                fetchLeaves( node->getChild( child ) );
+    }
+}
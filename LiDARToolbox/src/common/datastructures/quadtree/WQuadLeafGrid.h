@@ -0,0 +1,157 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WQUADLEAFGRID_H
+#define WQUADLEAFGRID_H
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "WQuadNode.h"
+#include "WQuadTree.h"
+
+using std::vector;
+
+/**
+ * Dense 2D grid of the leaf nodes of a quadtree. Each grid cell is a quadtree bin 
+ * (see WQuadTree::getBin()) within the X/Y bounds of the root node. So a leaf and its 
+ * neighbors can be accessed directly instead of descending the tree for each of them.
+ */
+class WQuadLeafGrid
+{
+public:
+    /**
+     * Creates an empty grid.
+     */
+    WQuadLeafGrid();
+
+    /**
+     * Destroys the grid. The quadtree nodes aren't deleted.
+     */
+    virtual ~WQuadLeafGrid();
+
+    /**
+     * Flattens the leaf nodes of a quadtree into the grid. The quadtree must not be 
+     * changed as long as the grid is used.
+     * \param quadTree Quadtree to flatten.
+     */
+    void importQuadTree( WQuadTree* quadTree );
+
+    /**
+     * Returns the cell count along the X axis.
+     * \return The cell count along the X axis.
+     */
+    size_t getSizeX();
+
+    /**
+     * Returns the cell count along the Y axis.
+     * \return The cell count along the Y axis.
+     */
+    size_t getSizeY();
+
+    /**
+     * Returns the count of leaf nodes of the grid.
+     * \return The count of leaf nodes.
+     */
+    size_t getLeafCount();
+
+    /**
+     * Returns a leaf node.
+     * \param leafIndex Index of the leaf node. The leaves are ordered by the quadtree 
+     *                  traversal.
+     * \return The leaf node.
+     */
+    WQuadNode* getLeaf( size_t leafIndex );
+
+    /**
+     * Returns the leaf node index of a grid cell.
+     * \param cellX Cell index along the X axis.
+     * \param cellY Cell index along the Y axis.
+     * \return Index of the cell's leaf node. noLeaf is returned if the cell has no leaf 
+     *         or lies outside the grid.
+     */
+    size_t getLeafIndex( size_t cellX, size_t cellY );
+
+    /**
+     * Returns the cell index of a X coordinate.
+     * \param x X coordinate.
+     * \return Cell index along the X axis. It may lie outside the grid.
+     */
+    size_t getCellX( double x );
+
+    /**
+     * Returns the cell index of a Y coordinate.
+     * \param y Y coordinate.
+     * \return Cell index along the Y axis. It may lie outside the grid.
+     */
+    size_t getCellY( double y );
+
+    /**
+     * Puts the leaf nodes of a range of leaf indices into their grid cells.
+     * \param begin First leaf index.
+     * \param end Index after the last leaf.
+     */
+    void registerLeaves( size_t begin, size_t end );
+
+    /**
+     * Leaf index that is returned for empty cells.
+     */
+    static const size_t noLeaf;
+
+private:
+    /**
+     * Appends all leaf nodes below a node to m_leaves.
+     * \param node Node to traverse.
+     */
+    void fetchLeaves( WQuadNode* node );
+
+    /**
+     * Flattened quadtree.
+     */
+    WQuadTree* m_quadTree;
+
+    /**
+     * Quadtree bin of the cell 0 along X and Y.
+     */
+    size_t m_binOffset[2];
+
+    /**
+     * Cell count along X and Y.
+     */
+    size_t m_size[2];
+
+    /**
+     * Leaf nodes of the quadtree.
+     */
+    vector<WQuadNode*> m_leaves;
+
+    /**
+     * Leaf index plus one of each cell row by row. Empty cells are 0. 32 bits are used 
+     * because the grid can get very large.
+     */
+    vector<boost::uint32_t> m_cells;
+};
+
+#endif  // WQUADLEAFGRID_H
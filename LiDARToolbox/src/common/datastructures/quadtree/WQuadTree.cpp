@@ -23,11 +23,173 @@
 //---------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
 
+#include "../../algorithms/threadPool/WThreadPool.h"
 #include "WQuadTree.h"
 
+using std::numeric_limits;
+
+/**
+ * Thread pool task that calculates the X/Y bounding box of points.
+ */
+template< typename T > class WQuadTreeBoundsTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param coordinates Interleaved X/Y/value triples of the points.
+     * \param threadCount Thread count of the processing pool.
+     */
+    WQuadTreeBoundsTask( const vector<T>& coordinates, size_t threadCount ) :
+        m_coordinates( coordinates ),
+        m_minimums( threadCount, vector<double>( 2, numeric_limits<double>::infinity() ) ),
+        m_maximums( threadCount, vector<double>( 2, -numeric_limits<double>::infinity() ) )
+    {
+    }
+
+    /**
+     * Extends the bounding box of a thread by a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        vector<double>& minimum = m_minimums[threadIndex];
+        vector<double>& maximum = m_maximums[threadIndex];
+        for( size_t index = begin; index < end; index++ )
+            for( size_t dimension = 0; dimension < 2; dimension++ )
+            {
+                double coordinate = m_coordinates[index * 3 + dimension];
+                minimum[dimension] = coordinate < minimum[dimension] ?coordinate :minimum[dimension];
+                maximum[dimension] = coordinate > maximum[dimension] ?coordinate :maximum[dimension];
+            }
+    }
+
+    /**
+     * Merges the bounding boxes of all threads.
+     * \param minimum Output minimal X and Y coordinate.
+     * \param maximum Output maximal X and Y coordinate.
+     */
+    void fetchBounds( vector<double>* minimum, vector<double>* maximum )
+    {
+        minimum->assign( 2, numeric_limits<double>::infinity() );
+        maximum->assign( 2, -numeric_limits<double>::infinity() );
+        for( size_t thread = 0; thread < m_minimums.size(); thread++ )
+            for( size_t dimension = 0; dimension < 2; dimension++ )
+            {
+                ( *minimum )[dimension] = std::min( ( *minimum )[dimension], m_minimums[thread][dimension] );
+                ( *maximum )[dimension] = std::max( ( *maximum )[dimension], m_maximums[thread][dimension] );
+            }
+    }
+
+private:
+    /**
+     * Interleaved X/Y/value triples of the points.
+     */
+    const vector<T>& m_coordinates;
+
+    /**
+     * Minimal coordinates found by each thread.
+     */
+    vector< vector<double> > m_minimums;
+
+    /**
+     * Maximal coordinates found by each thread.
+     */
+    vector< vector<double> > m_maximums;
+};
+
+/**
+ * Thread pool task that determines the partition node of each point. Partitions are the 
+ * nodes of a particular depth below the root. The calculation follows the node centers 
+ * of WQuadNode::touchNode() so that the partitions match the nodes created later.
+ */
+template< typename T > class WQuadTreePartitionTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param root Root node of the quadtree.
+     * \param coordinates Interleaved X/Y/value triples of the points.
+     * \param partitionDepth Depth of the partition nodes below the root.
+     * \param pointPartitions Output partition of each point. The drawers of the path 
+     *                        to the partition node are its digits of the base 4.
+     */
+    WQuadTreePartitionTask( WQuadNode* root, const vector<T>& coordinates, size_t partitionDepth,
+            vector<size_t>* pointPartitions ) :
+        m_coordinates( coordinates )
+    {
+        for( size_t dimension = 0; dimension < 2; dimension++ )
+            m_rootCenter[dimension] = root->getCenter( dimension );
+        m_rootRadius = root->getRadius();
+        m_partitionDepth = partitionDepth;
+        m_pointPartitions = pointPartitions;
+    }
+
+    /**
+     * Determines the partitions of a range of points.
+     * \param begin First point index of the range.
+     * \param end Index after the last point of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+        {
+            double center[2] = { m_rootCenter[0], m_rootCenter[1] };
+            double radius = m_rootRadius;
+            size_t partition = 0;
+            for( size_t depth = 0; depth < m_partitionDepth; depth++ )
+            {
+                size_t drawer = 0;
+                for( size_t dimension = 0; dimension < 2; dimension++ )
+                {
+                    size_t dimensionCase = m_coordinates[index * 3 + dimension] < center[dimension] ?0 :1;
+                    center[dimension] = center[dimension] - radius * 0.5 + static_cast<double>( dimensionCase ) * radius;
+                    drawer += dimensionCase << dimension;
+                }
+                radius *= 0.5;
+                partition = partition * 4 + drawer;
+            }
+            ( *m_pointPartitions )[index] = partition;
+        }
+    }
+
+private:
+    /**
+     * Interleaved X/Y/value triples of the points.
+     */
+    const vector<T>& m_coordinates;
+
+    /**
+     * Center of the root node.
+     */
+    double m_rootCenter[2];
+
+    /**
+     * Radius of the root node.
+     */
+    double m_rootRadius;
+
+    /**
+     * Depth of the partition nodes below the root.
+     */
+    size_t m_partitionDepth;
+
+    /**
+     * Output partition of each point.
+     */
+    vector<size_t>* m_pointPartitions;
+};
+
 
 WQuadTree::WQuadTree( double detailLevel )
 {
@@ -56,6 +218,22 @@ void WQuadTree::registerPoint( double x, double y, double value )
     }
 }
 
+void WQuadTree::registerPoints( const vector<double>& coordinates )
+{
+    registerCoordinates( coordinates );
+}
+
+void WQuadTree::registerPoints( const vector<float>& coordinates )
+{
+    registerCoordinates( coordinates );
+}
+
+void WQuadTree::expandRoot( double minX, double minY, double maxX, double maxY )
+{
+    while  ( !m_root->fitsIn( minX, minY ) || !m_root->fitsIn( maxX, maxY ) )
+        m_root->expand();
+}
+
 WQuadNode* WQuadTree::getLeafNode( double x, double y )
 {
     return getLeafNode( x, y, m_detailLevel);
@@ -96,3 +274,96 @@ double WQuadTree::getDetailLevel()
 {
     return m_detailLevel;
 }
+
+template< typename T > void WQuadTree::registerCoordinates( const vector<T>& coordinates )
+{
+    size_t pointCount = coordinates.size() / 3;
+    if( pointCount == 0 )
+        return;
+    WThreadPool* threadPool = WThreadPool::getSharedPool();
+    WQuadTreeBoundsTask<T> boundsTask( coordinates, threadPool->getThreadCount() );
+    threadPool->parallelFor( &boundsTask, pointCount );
+    vector<double> minimum;
+    vector<double> maximum;
+    boundsTask.fetchBounds( &minimum, &maximum );
+    expandRoot( minimum[0], minimum[1], maximum[0], maximum[1] );
+
+    size_t partitionDepth = 0;
+    size_t partitionCount = 1;
+    double partitionRadius = m_root->getRadius();
+    while( threadPool->getThreadCount() > 1 && partitionCount < threadPool->getThreadCount() * 8
+            && partitionRadius > m_detailLevel )
+    {
+        partitionDepth++;
+        partitionCount *= 4;
+        partitionRadius *= 0.5;
+    }
+    vector<size_t> pointPartitions( pointCount, 0 );
+    WQuadTreePartitionTask<T> partitionTask( m_root, coordinates, partitionDepth, &pointPartitions );
+    threadPool->parallelFor( &partitionTask, pointCount );
+
+    vector<size_t> partitionOffsets( partitionCount + 1, 0 );
+    for( size_t index = 0; index < pointCount; index++ )
+        partitionOffsets[pointPartitions[index] + 1]++;
+    for( size_t partition = 0; partition < partitionCount; partition++ )
+        partitionOffsets[partition + 1] += partitionOffsets[partition];
+    vector<size_t> pointOrder( pointCount );
+    vector<size_t> partitionPositions( partitionOffsets.begin(), partitionOffsets.end() - 1 );
+    for( size_t index = 0; index < pointCount; index++ )
+        pointOrder[partitionPositions[pointPartitions[index]]++] = index;
+
+    vector< boost::function<void ()> > partitionBuilds;
+    partitionBuilds.push_back( boost::bind( &WQuadTree::updateUpperNodes<T>, this, boost::cref( coordinates ), partitionDepth ) );
+    for( size_t partition = 0; partition < partitionCount; partition++ )
+    {
+        if( partitionOffsets[partition] == partitionOffsets[partition + 1] )
+            continue;
+        WQuadNode* node = m_root;
+        for( size_t depth = partitionDepth; depth > 0; depth-- )
+        {
+            size_t drawer = ( partition >> ( ( depth - 1 ) * 2 ) ) & 3;
+            node->touchNode( drawer );
+            node = node->getChild( drawer );
+        }
+        partitionBuilds.push_back( boost::bind( &WQuadTree::registerPointsBelow<T>, this, node, boost::cref( coordinates ),
+                &pointOrder, partitionOffsets[partition], partitionOffsets[partition + 1] ) );
+    }
+    threadPool->parallelInvoke( partitionBuilds );
+}
+
+template< typename T > void WQuadTree::registerPointsBelow( WQuadNode* partitionNode, const vector<T>& coordinates,
+        const vector<size_t>* pointOrder, size_t begin, size_t end )
+{
+    for( size_t index = begin; index < end; index++ )
+    {
+        size_t point = pointOrder->at( index );
+        double x = coordinates[point * 3];
+        double y = coordinates[point * 3 + 1];
+        double value = coordinates[point * 3 + 2];
+        WQuadNode* node = partitionNode;
+        node->updateMinMax( x, y, value );
+        while  ( node->getRadius() > m_detailLevel )
+        {
+            size_t drawer = node->getFittingCase( x, y );
+            node->touchNode( drawer );
+            node = node->getChild( drawer );
+            node->updateMinMax( x, y, value );
+        }
+    }
+}
+
+template< typename T > void WQuadTree::updateUpperNodes( const vector<T>& coordinates, size_t partitionDepth )
+{
+    for( size_t point = 0; point < coordinates.size() / 3; point++ )
+    {
+        double x = coordinates[point * 3];
+        double y = coordinates[point * 3 + 1];
+        double value = coordinates[point * 3 + 2];
+        WQuadNode* node = m_root;
+        for( size_t depth = 0; depth < partitionDepth; depth++ )
+        {
+            node->updateMinMax( x, y, value );
+            node = node->getChild( node->getFittingCase( x, y ) );
+        }
+    }
+}
@@ -22,12 +22,15 @@
 //
 //---------------------------------------------------------------------------
 
+#include <vector>
 #include "core/graphicsEngine/WTriangleMesh.h"
 #include "WQuadNode.h"
 
 #ifndef WQUADTREE_H
 #define WQUADTREE_H
 
+using std::vector;
+
 /**
  * Octree structure for analyzing buildings point data
  */
@@ -57,6 +60,37 @@ public:
      */
     void registerPoint( double x, double y, double value );
 
+    /**
+     * Registers many points at once using the threads of the shared thread pool. The 
+     * root is expanded to the bounding box of all points first. Then the subtrees of the 
+     * nodes a few levels below the root are built in parallel. Each node is updated by 
+     * its points in the same order as registerPoint() calls would do.
+     * \param coordinates Interleaved X/Y/value triples of the registered points. A 
+     *                    point data set's X/Y/Z coordinates can be passed directly.
+     */
+    void registerPoints( const vector<double>& coordinates );
+
+    /**
+     * Registers many points at once using the threads of the shared thread pool. The 
+     * root is expanded to the bounding box of all points first. Then the subtrees of the 
+     * nodes a few levels below the root are built in parallel. Each node is updated by 
+     * its points in the same order as registerPoint() calls would do.
+     * \param coordinates Interleaved X/Y/value triples of the registered points. A 
+     *                    point data set's X/Y/Z coordinates can be passed directly.
+     */
+    void registerPoints( const vector<float>& coordinates );
+
+    /**
+     * Expands the root until it covers an X/Y area. Points within that area can be 
+     * registered by several registerPoints() calls afterwards, e. g. tile by tile. The 
+     * tree equals the one of registering all of them at once.
+     * \param minX Minimal X coordinate of the area.
+     * \param minY Minimal Y coordinate of the area.
+     * \param maxX Maximal X coordinate of the area.
+     * \param maxY Maximal Y coordinate of the area.
+     */
+    void expandRoot( double minX, double minY, double maxX, double maxY );
+
     /**
      * Returns a leaf node of the maximum detail depth covering X/Y coordinates.
      * \param x X coordinate of the quadtree node.
@@ -96,6 +130,33 @@ public:
     double getDetailLevel();
 
 private:
+    /**
+     * Registers points using the threads of the shared thread pool. See 
+     * registerPoints().
+     * \param coordinates Interleaved X/Y/value triples of the registered points.
+     */
+    template< typename T > void registerCoordinates( const vector<T>& coordinates );
+
+    /**
+     * Registers points below a node of which the area covers them. The nodes above 
+     * aren't updated.
+     * \param partitionNode Node that covers the points.
+     * \param coordinates Interleaved X/Y/value triples of all points.
+     * \param pointOrder Point indices ordered by the node that covers them.
+     * \param begin First registered position within pointOrder.
+     * \param end Position after the last registered point within pointOrder.
+     */
+    template< typename T > void registerPointsBelow( WQuadNode* partitionNode, const vector<T>& coordinates,
+            const vector<size_t>* pointOrder, size_t begin, size_t end );
+
+    /**
+     * Updates the nodes above the partition depth with all points. The nodes must 
+     * already exist.
+     * \param coordinates Interleaved X/Y/value triples of all points.
+     * \param partitionDepth Depth below the root where updating stops.
+     */
+    template< typename T > void updateUpperNodes( const vector<T>& coordinates, size_t partitionDepth );
+
     /**
      * The root quadtree node of the whole tree.
      */
@@ -0,0 +1,423 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "WPointTileStore.h"
+
+/**
+ * Points of a single tile in the memory.
+ */
+class WPointTile
+{
+public:
+    /**
+     * X/Y/Z coordinates of the points.
+     */
+    vector<float> m_vertices;
+
+    /**
+     * R/G/B colors of the points.
+     */
+    vector<float> m_colors;
+
+    /**
+     * Indices of the points within the original point sequence.
+     */
+    vector<boost::uint64_t> m_indices;
+};
+
+const char* WPointTileStore::EXTENSION = ".pointtiles";
+
+const size_t WPointTileStore::BYTES_PER_POINT = 6 * sizeof( float ) + sizeof( boost::uint64_t );
+
+const char WPointTileStore::MAGIC[8] = { 'W', 'P', 'T', 'I', 'L', 'E', 'S', '\0' };
+
+const size_t WPointTileStore::HEADER_SIZE = 96;
+
+WPointTileStore::WPointTileStore() :
+    m_minCoord( 3, 0.0 ),
+    m_maxCoord( 3, 0.0 )
+{
+    m_isWriting = false;
+    m_memoryBudget = 0;
+    m_tileSize = 1.0;
+    m_pointCount = 0;
+    m_pointsInMemory = 0;
+}
+
+WPointTileStore::~WPointTileStore()
+{
+    if( m_isWriting )
+        finishWriting();
+    close();
+}
+
+bool WPointTileStore::create( const std::string& path, double tileSize, size_t memoryBudget )
+{
+    close();
+    m_file.open( path.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+    if( !m_file.is_open() || !( tileSize > 0.0 ) )
+        return false;
+    m_isWriting = true;
+    m_memoryBudget = memoryBudget;
+    m_tileSize = tileSize;
+    vector<char> header( HEADER_SIZE, 0 );
+    m_file.write( &header[0], header.size() );
+    return m_file.good();
+}
+
+void WPointTileStore::addPoints( const vector<float>& vertices, const vector<float>& colors,
+        const vector<boost::uint64_t>& indices )
+{
+    for( size_t index = 0; index < indices.size(); index++ )
+    {
+        const float* vertex = &vertices[index * 3];
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+        {
+            if( vertex[dimension] < m_minCoord[dimension] || m_pointCount == 0 )
+                m_minCoord[dimension] = vertex[dimension];
+            if( vertex[dimension] > m_maxCoord[dimension] || m_pointCount == 0 )
+                m_maxCoord[dimension] = vertex[dimension];
+        }
+        boost::uint64_t key = getTileKey( getTileCoordinate( vertex[0] ), getTileCoordinate( vertex[1] ) );
+        std::map< boost::uint64_t, size_t >::iterator tileIndex = m_tileIndices.find( key );
+        if( tileIndex == m_tileIndices.end() )
+        {
+            tileIndex = m_tileIndices.insert( std::make_pair( key, m_tileKeys.size() ) ).first;
+            m_tileKeys.push_back( key );
+            m_tilePointCounts.push_back( 0 );
+            m_tileChunks.resize( m_tileKeys.size() );
+            m_tiles.push_back( 0 );
+        }
+        size_t tile = tileIndex->second;
+        if( m_tiles[tile] == 0 )
+        {
+            m_tiles[tile] = new WPointTile();
+            m_bufferedTiles.push_back( tile );
+        }
+        WPointTile* buffer = m_tiles[tile];
+        buffer->m_vertices.insert( buffer->m_vertices.end(), vertex, vertex + 3 );
+        buffer->m_colors.insert( buffer->m_colors.end(), colors.begin() + index * 3, colors.begin() + index * 3 + 3 );
+        buffer->m_indices.push_back( indices[index] );
+        m_tilePointCounts[tile]++;
+        m_pointCount++;
+        m_pointsInMemory++;
+        if( m_pointsInMemory * BYTES_PER_POINT > m_memoryBudget )
+            flushBuffers();
+    }
+}
+
+bool WPointTileStore::finishWriting()
+{
+    if( !m_isWriting )
+        return false;
+    flushBuffers();
+    boost::uint64_t directoryOffset = static_cast<boost::uint64_t>( m_file.tellp() );
+    vector<size_t> tileOrder;
+    for( std::map< boost::uint64_t, size_t >::iterator tile = m_tileIndices.begin(); tile != m_tileIndices.end(); tile++ )
+        tileOrder.push_back( tile->second );
+    for( size_t index = 0; index < tileOrder.size(); index++ )
+    {
+        size_t tile = tileOrder[index];
+        boost::uint64_t fields[] = { m_tileKeys[tile], m_tilePointCounts[tile], m_tileChunks[tile].size() };
+        m_file.write( reinterpret_cast<const char*>( fields ), sizeof( fields ) );
+        for( size_t chunk = 0; chunk < m_tileChunks[tile].size(); chunk++ )
+        {
+            boost::uint64_t chunkFields[] = { m_tileChunks[tile][chunk].first, m_tileChunks[tile][chunk].second };
+            m_file.write( reinterpret_cast<const char*>( chunkFields ), sizeof( chunkFields ) );
+        }
+    }
+
+    boost::uint32_t version = 1;
+    boost::uint32_t reserved = 0;
+    boost::uint64_t counts[] = { m_pointCount, tileOrder.size(), directoryOffset };
+    m_file.seekp( 0 );
+    m_file.write( MAGIC, sizeof( MAGIC ) );
+    m_file.write( reinterpret_cast<const char*>( &version ), sizeof( version ) );
+    m_file.write( reinterpret_cast<const char*>( &reserved ), sizeof( reserved ) );
+    m_file.write( reinterpret_cast<const char*>( &m_tileSize ), sizeof( m_tileSize ) );
+    m_file.write( reinterpret_cast<const char*>( counts ), sizeof( counts ) );
+    m_file.write( reinterpret_cast<const char*>( &m_minCoord[0] ), 3 * sizeof( double ) );
+    m_file.write( reinterpret_cast<const char*>( &m_maxCoord[0] ), 3 * sizeof( double ) );
+    bool isWritten = m_file.good();
+    m_isWriting = false;
+    close();
+    return isWritten;
+}
+
+bool WPointTileStore::open( const std::string& path, size_t memoryBudget )
+{
+    close();
+    m_file.open( path.c_str(), std::ios::in | std::ios::binary );
+    if( !m_file.is_open() )
+        return false;
+    m_memoryBudget = memoryBudget;
+
+    char magic[sizeof( MAGIC )];
+    boost::uint32_t version = 0;
+    boost::uint32_t reserved = 0;
+    boost::uint64_t counts[] = { 0, 0, 0 };
+    m_file.read( magic, sizeof( magic ) );
+    m_file.read( reinterpret_cast<char*>( &version ), sizeof( version ) );
+    m_file.read( reinterpret_cast<char*>( &reserved ), sizeof( reserved ) );
+    m_file.read( reinterpret_cast<char*>( &m_tileSize ), sizeof( m_tileSize ) );
+    m_file.read( reinterpret_cast<char*>( counts ), sizeof( counts ) );
+    m_file.read( reinterpret_cast<char*>( &m_minCoord[0] ), 3 * sizeof( double ) );
+    m_file.read( reinterpret_cast<char*>( &m_maxCoord[0] ), 3 * sizeof( double ) );
+    if( !m_file || std::memcmp( magic, MAGIC, sizeof( MAGIC ) ) != 0 || version != 1 || !( m_tileSize > 0.0 ) )
+    {
+        close();
+        return false;
+    }
+
+    m_pointCount = static_cast<size_t>( counts[0] );
+    size_t tileCount = static_cast<size_t>( counts[1] );
+    m_file.seekg( static_cast<std::streamoff>( counts[2] ) );
+    m_tileKeys.resize( tileCount );
+    m_tilePointCounts.resize( tileCount );
+    m_tileChunks.resize( tileCount );
+    m_tiles.assign( tileCount, 0 );
+    m_cacheEntries.assign( tileCount, m_cacheOrder.end() );
+    for( size_t tile = 0; tile < tileCount && m_file; tile++ )
+    {
+        boost::uint64_t fields[] = { 0, 0, 0 };
+        m_file.read( reinterpret_cast<char*>( fields ), sizeof( fields ) );
+        m_tileKeys[tile] = fields[0];
+        m_tilePointCounts[tile] = static_cast<size_t>( fields[1] );
+        m_tileIndices[fields[0]] = tile;
+        for( boost::uint64_t chunk = 0; chunk < fields[2] && m_file; chunk++ )
+        {
+            boost::uint64_t chunkFields[] = { 0, 0 };
+            m_file.read( reinterpret_cast<char*>( chunkFields ), sizeof( chunkFields ) );
+            m_tileChunks[tile].push_back( std::make_pair( chunkFields[0], chunkFields[1] ) );
+        }
+    }
+    if( !m_file )
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+size_t WPointTileStore::getTileCount()
+{
+    return m_tileKeys.size();
+}
+
+size_t WPointTileStore::getPointCount()
+{
+    return m_pointCount;
+}
+
+double WPointTileStore::getTileSize()
+{
+    return m_tileSize;
+}
+
+vector<double> WPointTileStore::getMinCoord()
+{
+    return m_minCoord;
+}
+
+vector<double> WPointTileStore::getMaxCoord()
+{
+    return m_maxCoord;
+}
+
+boost::int64_t WPointTileStore::getTileCoordinate( double coordinate )
+{
+    return static_cast<boost::int64_t>( floor( coordinate / m_tileSize ) );
+}
+
+boost::int64_t WPointTileStore::getTileColumn( size_t tile )
+{
+    return static_cast<boost::int64_t>( m_tileKeys[tile] & 0xffffffffULL ) - 0x80000000LL;
+}
+
+boost::int64_t WPointTileStore::getTileRow( size_t tile )
+{
+    return static_cast<boost::int64_t>( m_tileKeys[tile] >> 32 ) - 0x80000000LL;
+}
+
+size_t WPointTileStore::getTilePointCount( size_t tile )
+{
+    return m_tilePointCounts[tile];
+}
+
+bool WPointTileStore::fetchTile( size_t tile, vector<float>* vertices, vector<float>* colors,
+        vector<boost::uint64_t>* indices )
+{
+    WPointTile* points = loadTile( tile );
+    if( points == 0 )
+    {
+        vertices->clear();
+        colors->clear();
+        indices->clear();
+        return false;
+    }
+    *vertices = points->m_vertices;
+    *colors = points->m_colors;
+    *indices = points->m_indices;
+    return true;
+}
+
+bool WPointTileStore::fetchRegion( double minX, double minY, double maxX, double maxY,
+        vector<float>* vertices, vector<float>* colors, vector<boost::uint64_t>* indices )
+{
+    vertices->clear();
+    colors->clear();
+    indices->clear();
+    boost::int64_t firstColumn = getTileCoordinate( minX );
+    boost::int64_t lastColumn = getTileCoordinate( maxX );
+    for( boost::int64_t row = getTileCoordinate( minY ); row <= getTileCoordinate( maxY ); row++ )
+    {
+        std::map< boost::uint64_t, size_t >::iterator tile = m_tileIndices.lower_bound( getTileKey( firstColumn, row ) );
+        std::map< boost::uint64_t, size_t >::iterator tilesEnd = m_tileIndices.upper_bound( getTileKey( lastColumn, row ) );
+        for( ; tile != tilesEnd; tile++ )
+        {
+            WPointTile* points = loadTile( tile->second );
+            if( points == 0 )
+            {
+                vertices->clear();
+                colors->clear();
+                indices->clear();
+                return false;
+            }
+            for( size_t index = 0; index < points->m_indices.size(); index++ )
+            {
+                const float* vertex = &points->m_vertices[index * 3];
+                if( vertex[0] < minX || vertex[0] > maxX || vertex[1] < minY || vertex[1] > maxY )
+                    continue;
+                vertices->insert( vertices->end(), vertex, vertex + 3 );
+                colors->insert( colors->end(), points->m_colors.begin() + index * 3, points->m_colors.begin() + index * 3 + 3 );
+                indices->push_back( points->m_indices[index] );
+            }
+        }
+    }
+    return true;
+}
+
+void WPointTileStore::close()
+{
+    if( m_file.is_open() )
+        m_file.close();
+    m_file.clear();
+    for( size_t tile = 0; tile < m_tiles.size(); tile++ )
+        delete m_tiles[tile];
+    m_tiles.clear();
+    m_bufferedTiles.clear();
+    m_cacheOrder.clear();
+    m_cacheEntries.clear();
+    m_tileIndices.clear();
+    m_tileKeys.clear();
+    m_tilePointCounts.clear();
+    m_tileChunks.clear();
+    m_pointsInMemory = 0;
+    m_isWriting = false;
+}
+
+boost::uint64_t WPointTileStore::getTileKey( boost::int64_t column, boost::int64_t row )
+{
+    return ( static_cast<boost::uint64_t>( row + 0x80000000LL ) << 32 ) | static_cast<boost::uint64_t>( column + 0x80000000LL );
+}
+
+void WPointTileStore::flushBuffers()
+{
+    for( size_t entry = 0; entry < m_bufferedTiles.size(); entry++ )
+    {
+        size_t tile = m_bufferedTiles[entry];
+        WPointTile* buffer = m_tiles[tile];
+        size_t count = buffer->m_indices.size();
+        if( count > 0 )
+        {
+            m_tileChunks[tile].push_back( std::make_pair( static_cast<boost::uint64_t>( m_file.tellp() ),
+                    static_cast<boost::uint64_t>( count ) ) );
+            m_file.write( reinterpret_cast<const char*>( &buffer->m_vertices[0] ), count * 3 * sizeof( float ) );
+            m_file.write( reinterpret_cast<const char*>( &buffer->m_colors[0] ), count * 3 * sizeof( float ) );
+            m_file.write( reinterpret_cast<const char*>( &buffer->m_indices[0] ), count * sizeof( boost::uint64_t ) );
+        }
+        delete buffer;
+        m_tiles[tile] = 0;
+    }
+    m_bufferedTiles.clear();
+    m_pointsInMemory = 0;
+}
+
+WPointTile* WPointTileStore::loadTile( size_t tile )
+{
+    if( m_tiles[tile] != 0 )
+    {
+        m_cacheOrder.splice( m_cacheOrder.end(), m_cacheOrder, m_cacheEntries[tile] );
+        return m_tiles[tile];
+    }
+
+    while( !m_cacheOrder.empty() && ( m_pointsInMemory + m_tilePointCounts[tile] ) * BYTES_PER_POINT > m_memoryBudget )
+    {
+        size_t evicted = m_cacheOrder.front();
+        m_cacheOrder.pop_front();
+        m_pointsInMemory -= m_tilePointCounts[evicted];
+        delete m_tiles[evicted];
+        m_tiles[evicted] = 0;
+    }
+
+    WPointTile* points = new WPointTile();
+    size_t count = m_tilePointCounts[tile];
+    points->m_vertices.resize( count * 3 );
+    points->m_colors.resize( count * 3 );
+    points->m_indices.resize( count );
+    size_t position = 0;
+    for( size_t chunk = 0; chunk < m_tileChunks[tile].size(); chunk++ )
+    {
+        size_t chunkCount = static_cast<size_t>( m_tileChunks[tile][chunk].second );
+        if( position + chunkCount > count )
+            break;
+        m_file.seekg( static_cast<std::streamoff>( m_tileChunks[tile][chunk].first ) );
+        m_file.read( reinterpret_cast<char*>( &points->m_vertices[position * 3] ), chunkCount * 3 * sizeof( float ) );
+        m_file.read( reinterpret_cast<char*>( &points->m_colors[position * 3] ), chunkCount * 3 * sizeof( float ) );
+        m_file.read( reinterpret_cast<char*>( &points->m_indices[position] ), chunkCount * sizeof( boost::uint64_t ) );
+        if( !m_file )
+            break;
+        position += chunkCount;
+    }
+    if( position != count )
+    {
+        m_file.clear();
+        delete points;
+        return 0;
+    }
+    m_tiles[tile] = points;
+    m_cacheEntries[tile] = m_cacheOrder.insert( m_cacheOrder.end(), tile );
+    m_pointsInMemory += count;
+    return points;
+}
@@ -0,0 +1,313 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WPOINTTILESTORE_H
+#define WPOINTTILESTORE_H
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+using std::vector;
+
+class WPointTile;
+
+/**
+ * Spatially partitioned point file for point sets that don't fit into the memory. The 
+ * X/Y plane is split into square tiles. Each point is stored in the tile that covers 
+ * it together with its color and the index it had in the original point sequence.
+ *
+ * Writing keeps the added points in per tile buffers. If the buffers exceed the memory 
+ * budget, then they are appended to the file as chunks. Reading loads whole tiles and 
+ * keeps the most recently used ones as long as they fit into the memory budget. So 
+ * the memory consumption only depends on the budget and the size of single tiles.
+ *
+ * File layout: A 96 byte header (magic, version, tile size, point count, tile count, 
+ * directory offset and the bounds of all points) is followed by the point chunks and 
+ * the tile directory. A chunk consists of the X/Y/Z floats, the R/G/B floats and the 
+ * 64 bit indices of its points. The directory lists the tile coordinates, the point 
+ * count and the chunks of each tile.
+ */
+class WPointTileStore
+{
+public:
+    /**
+     * Creates a store that is neither opened nor created.
+     */
+    WPointTileStore();
+
+    /**
+     * Closes the store.
+     */
+    virtual ~WPointTileStore();
+
+    /**
+     * Creates a new store file for writing.
+     * \param path Path of the store file.
+     * \param tileSize Edge length of the tiles.
+     * \param memoryBudget Bytes that may be used to buffer points.
+     * \return The file could be created or not.
+     */
+    bool create( const std::string& path, double tileSize, size_t memoryBudget );
+
+    /**
+     * Adds points to a created store.
+     * \param vertices X/Y/Z coordinates of the points.
+     * \param colors R/G/B colors of the points.
+     * \param indices Index of each point within the original point sequence.
+     */
+    void addPoints( const vector<float>& vertices, const vector<float>& colors, const vector<boost::uint64_t>& indices );
+
+    /**
+     * Writes the remaining buffers and the tile directory of a created store and 
+     * closes the file.
+     * \return All data could be written or not.
+     */
+    bool finishWriting();
+
+    /**
+     * Opens a store file for reading.
+     * \param path Path of the store file.
+     * \param memoryBudget Bytes that may be used to cache tiles.
+     * \return The file is a valid store or not.
+     */
+    bool open( const std::string& path, size_t memoryBudget );
+
+    /**
+     * Returns the count of tiles that contain points. The tiles are ordered by their 
+     * row and column.
+     * \return Count of tiles.
+     */
+    size_t getTileCount();
+
+    /**
+     * Returns the count of all points.
+     * \return Count of points.
+     */
+    size_t getPointCount();
+
+    /**
+     * Returns the edge length of the tiles.
+     * \return Edge length of the tiles.
+     */
+    double getTileSize();
+
+    /**
+     * Returns the minimal X/Y/Z coordinate of all points.
+     * \return Minimal coordinate.
+     */
+    vector<double> getMinCoord();
+
+    /**
+     * Returns the maximal X/Y/Z coordinate of all points.
+     * \return Maximal coordinate.
+     */
+    vector<double> getMaxCoord();
+
+    /**
+     * Returns the column or row of the tiles that cover a X or Y coordinate.
+     * \param coordinate X or Y coordinate.
+     * \return Tile column or row.
+     */
+    boost::int64_t getTileCoordinate( double coordinate );
+
+    /**
+     * Returns the column of a tile.
+     * \param tile Index of the tile.
+     * \return Column of the tile.
+     */
+    boost::int64_t getTileColumn( size_t tile );
+
+    /**
+     * Returns the row of a tile.
+     * \param tile Index of the tile.
+     * \return Row of the tile.
+     */
+    boost::int64_t getTileRow( size_t tile );
+
+    /**
+     * Returns the count of points of a tile.
+     * \param tile Index of the tile.
+     * \return Count of points of the tile.
+     */
+    size_t getTilePointCount( size_t tile );
+
+    /**
+     * Fetches all points of a tile.
+     * \param tile Index of the tile.
+     * \param vertices Output X/Y/Z coordinates.
+     * \param colors Output R/G/B colors.
+     * \param indices Output indices within the original point sequence.
+     * \return The tile could be read or not. The outputs are empty if not.
+     */
+    bool fetchTile( size_t tile, vector<float>* vertices, vector<float>* colors, vector<boost::uint64_t>* indices );
+
+    /**
+     * Fetches all points within a X/Y region. The region bounds are inclusive.
+     * \param minX Minimal X coordinate.
+     * \param minY Minimal Y coordinate.
+     * \param maxX Maximal X coordinate.
+     * \param maxY Maximal Y coordinate.
+     * \param vertices Output X/Y/Z coordinates.
+     * \param colors Output R/G/B colors.
+     * \param indices Output indices within the original point sequence.
+     * \return All tiles of the region could be read or not. The outputs are empty if 
+     *         not.
+     */
+    bool fetchRegion( double minX, double minY, double maxX, double maxY,
+            vector<float>* vertices, vector<float>* colors, vector<boost::uint64_t>* indices );
+
+    /**
+     * Extension of store files.
+     */
+    static const char* EXTENSION;
+
+private:
+    /**
+     * Closes the file and releases all buffers and cached tiles.
+     */
+    void close();
+
+    /**
+     * Returns the directory key of a tile. Keys are ordered by row and column.
+     * \param column Column of the tile.
+     * \param row Row of the tile.
+     * \return Key of the tile.
+     */
+    static boost::uint64_t getTileKey( boost::int64_t column, boost::int64_t row );
+
+    /**
+     * Appends the buffered points of all tiles as chunks to the file.
+     */
+    void flushBuffers();
+
+    /**
+     * Returns a cached tile. It is loaded if it isn't cached yet. A tile that can't be 
+     * read completely is neither cached nor returned.
+     * \param tile Index of the tile.
+     * \return The tile's points or 0 if the tile couldn't be read.
+     */
+    WPointTile* loadTile( size_t tile );
+
+    /**
+     * Byte count that a point occupies in the file and in the memory.
+     */
+    static const size_t BYTES_PER_POINT;
+
+    /**
+     * Leading bytes of store files.
+     */
+    static const char MAGIC[8];
+
+    /**
+     * Byte count of the file header.
+     */
+    static const size_t HEADER_SIZE;
+
+    /**
+     * Store file.
+     */
+    std::fstream m_file;
+
+    /**
+     * The store is created for writing or not.
+     */
+    bool m_isWriting;
+
+    /**
+     * Bytes that may be used to buffer or cache points.
+     */
+    size_t m_memoryBudget;
+
+    /**
+     * Edge length of the tiles.
+     */
+    double m_tileSize;
+
+    /**
+     * Count of all points.
+     */
+    size_t m_pointCount;
+
+    /**
+     * Minimal coordinate of all points.
+     */
+    vector<double> m_minCoord;
+
+    /**
+     * Maximal coordinate of all points.
+     */
+    vector<double> m_maxCoord;
+
+    /**
+     * Tile index of each tile key.
+     */
+    std::map< boost::uint64_t, size_t > m_tileIndices;
+
+    /**
+     * Key of each tile.
+     */
+    vector<boost::uint64_t> m_tileKeys;
+
+    /**
+     * Point count of each tile.
+     */
+    vector<size_t> m_tilePointCounts;
+
+    /**
+     * File offset and point count of each chunk of each tile.
+     */
+    vector< vector< std::pair<boost::uint64_t, boost::uint64_t> > > m_tileChunks;
+
+    /**
+     * Buffered or cached points of each tile. Tiles without points in the memory are 0.
+     */
+    vector<WPointTile*> m_tiles;
+
+    /**
+     * Tiles that have buffered points while writing.
+     */
+    vector<size_t> m_bufferedTiles;
+
+    /**
+     * Cached tiles starting with the least recently used one.
+     */
+    std::list<size_t> m_cacheOrder;
+
+    /**
+     * Entry of each cached tile within m_cacheOrder.
+     */
+    vector< std::list<size_t>::iterator > m_cacheEntries;
+
+    /**
+     * Count of buffered or cached points.
+     */
+    size_t m_pointsInMemory;
+};
+
+#endif  // WPOINTTILESTORE_H
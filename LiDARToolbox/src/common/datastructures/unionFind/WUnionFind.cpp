@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <limits>
+#include <vector>
+#include "WUnionFind.h"
+
+WUnionFind::WUnionFind( size_t elementCount ) :
+    m_parents( elementCount, 0 ),
+    m_ranks( elementCount, 0 )
+{
+    for( size_t element = 0; element < elementCount; element++ )
+        m_parents[element] = element;
+}
+
+WUnionFind::~WUnionFind()
+{
+}
+
+size_t WUnionFind::find( size_t element )
+{
+    size_t root = element;
+    while( m_parents[root] != root )
+        root = m_parents[root];
+    while( m_parents[element] != root )
+    {
+        size_t parent = m_parents[element];
+        m_parents[element] = root;
+        element = parent;
+    }
+    return root;
+}
+
+bool WUnionFind::unite( size_t element1, size_t element2 )
+{
+    size_t root1 = find( element1 );
+    size_t root2 = find( element2 );
+    if( root1 == root2 )
+        return false;
+    if( m_ranks[root1] < m_ranks[root2] )
+    {
+        m_parents[root1] = root2;
+    }
+    else
+    {
+        m_parents[root2] = root1;
+        if( m_ranks[root1] == m_ranks[root2] )
+            m_ranks[root1]++;
+    }
+    return true;
+}
+
+size_t WUnionFind::getElementCount()
+{
+    return m_parents.size();
+}
+
+size_t WUnionFind::getSetLabels( vector<size_t>* labels )
+{
+    size_t noLabel = std::numeric_limits< size_t >::max();
+    vector<size_t> labelOfRoot( m_parents.size(), noLabel );
+    labels->resize( m_parents.size() );
+    size_t labelCount = 0;
+    for( size_t element = 0; element < m_parents.size(); element++ )
+    {
+        size_t root = find( element );
+        if( labelOfRoot[root] == noLabel )
+            labelOfRoot[root] = labelCount++;
+        ( *labels )[element] = labelOfRoot[root];
+    }
+    return labelCount;
+}
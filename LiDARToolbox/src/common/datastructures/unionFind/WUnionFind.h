@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WUNIONFIND_H
+#define WUNIONFIND_H
+
+#include <vector>
+
+using std::vector;
+using std::size_t;
+
+/**
+ * Disjoint set forest over the element indices 0 to n-1. It merges sets in almost 
+ * constant time using path compression and union by rank. It is used to find connected 
+ * components like neighboring voxels or points.
+ */
+class WUnionFind
+{
+public:
+    /**
+     * Creates a forest where each element is a set of its own.
+     * \param elementCount Count of elements.
+     */
+    explicit WUnionFind( size_t elementCount );
+
+    /**
+     * Destroys the forest.
+     */
+    virtual ~WUnionFind();
+
+    /**
+     * Returns the representative element of the set of an element.
+     * \param element Element to look up.
+     * \return The representative element of its set.
+     */
+    size_t find( size_t element );
+
+    /**
+     * Merges the sets of two elements.
+     * \param element1 Element of the first set.
+     * \param element2 Element of the second set.
+     * \return The sets were different before or not.
+     */
+    bool unite( size_t element1, size_t element2 );
+
+    /**
+     * Returns the count of elements.
+     * \return The count of elements.
+     */
+    size_t getElementCount();
+
+    /**
+     * Numbers the sets consecutively. Sets are numbered in the order of their first 
+     * element.
+     * \param labels Output set number of each element.
+     * \return Count of sets.
+     */
+    size_t getSetLabels( vector<size_t>* labels );
+
+private:
+    /**
+     * Parent element of each element. Representatives are their own parent.
+     */
+    vector<size_t> m_parents;
+
+    /**
+     * Upper bound of the tree height of each representative.
+     */
+    vector<size_t> m_ranks;
+};
+
+#endif  // WUNIONFIND_H
@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+
+#include "WAffineTransform.h"
+#include "../vectors/WVectorMaths.h"
+
+WAffineTransform::WAffineTransform()
+{
+    for( size_t index = 0; index < 16; index++ )
+        m_matrix[index] = index % 5 == 0 ?1.0 :0.0;
+}
+
+WAffineTransform::~WAffineTransform()
+{
+}
+
+WAffineTransform WAffineTransform::translation( double x, double y, double z )
+{
+    WAffineTransform transform;
+    transform.m_matrix[3] = x;
+    transform.m_matrix[7] = y;
+    transform.m_matrix[11] = z;
+    return transform;
+}
+
+WAffineTransform WAffineTransform::scaling( double x, double y, double z )
+{
+    WAffineTransform transform;
+    transform.m_matrix[0] = x;
+    transform.m_matrix[5] = y;
+    transform.m_matrix[10] = z;
+    return transform;
+}
+
+WAffineTransform WAffineTransform::rotation( size_t firstAxis, size_t secondAxis, double angleDegrees )
+{
+    double angle = angleDegrees / 90.0 * WVectorMaths::ANGLE_90_DEGREES;
+    WAffineTransform transform;
+    transform.m_matrix[firstAxis * 5] = cos( angle );
+    transform.m_matrix[firstAxis * 4 + secondAxis] = -sin( angle );
+    transform.m_matrix[secondAxis * 4 + firstAxis] = sin( angle );
+    transform.m_matrix[secondAxis * 5] = cos( angle );
+    return transform;
+}
+
+WAffineTransform WAffineTransform::followedBy( const WAffineTransform& next ) const
+{
+    WAffineTransform transform;
+    for( size_t row = 0; row < 4; row++ )
+        for( size_t column = 0; column < 4; column++ )
+        {
+            double sum = 0.0;
+            for( size_t index = 0; index < 4; index++ )
+                sum += next.m_matrix[row * 4 + index] * m_matrix[index * 4 + column];
+            transform.m_matrix[row * 4 + column] = sum;
+        }
+    return transform;
+}
+
+double WAffineTransform::get( size_t row, size_t column ) const
+{
+    return m_matrix[row * 4 + column];
+}
+
+void WAffineTransform::transformPoints( float* coordinates, size_t count ) const
+{
+    const double m00 = m_matrix[0], m01 = m_matrix[1], m02 = m_matrix[2], m03 = m_matrix[3];
+    const double m10 = m_matrix[4], m11 = m_matrix[5], m12 = m_matrix[6], m13 = m_matrix[7];
+    const double m20 = m_matrix[8], m21 = m_matrix[9], m22 = m_matrix[10], m23 = m_matrix[11];
+    for( size_t index = 0; index < count; index++ )
+    {
+        float* point = coordinates + index * 3;
+        double x = point[0];
+        double y = point[1];
+        double z = point[2];
+        point[0] = static_cast<float>( m00 * x + m01 * y + m02 * z + m03 );
+        point[1] = static_cast<float>( m10 * x + m11 * y + m12 * z + m13 );
+        point[2] = static_cast<float>( m20 * x + m21 * y + m22 * z + m23 );
+    }
+}
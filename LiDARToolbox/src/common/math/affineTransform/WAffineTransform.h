@@ -0,0 +1,105 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WAFFINETRANSFORM_H
+#define WAFFINETRANSFORM_H
+
+#include <cstddef>
+
+/**
+ * A 4x4 affine transformation matrix of 3D coordinates. Several transformations are 
+ * combined into one matrix, so a point is transformed by a single matrix product.
+ */
+class WAffineTransform
+{
+public:
+    /**
+     * Creates the identity transformation.
+     */
+    WAffineTransform();
+
+    /**
+     * Destroys the transformation.
+     */
+    virtual ~WAffineTransform();
+
+    /**
+     * Creates a translation.
+     * \param x Offset along the X axis.
+     * \param y Offset along the Y axis.
+     * \param z Offset along the Z axis.
+     * \return The translation matrix.
+     */
+    static WAffineTransform translation( double x, double y, double z );
+
+    /**
+     * Creates a scaling along the coordinate axes.
+     * \param x Factor of the X axis.
+     * \param y Factor of the Y axis.
+     * \param z Factor of the Z axis.
+     * \return The scaling matrix.
+     */
+    static WAffineTransform scaling( double x, double y, double z );
+
+    /**
+     * Creates a rotation within the plane of two axes. It rotates like 
+     * WVectorMaths::rotateVector().
+     * \param firstAxis First axis of the rotation plane.
+     * \param secondAxis Second axis of the rotation plane.
+     * \param angleDegrees Rotation angle in degrees.
+     * \return The rotation matrix.
+     */
+    static WAffineTransform rotation( size_t firstAxis, size_t secondAxis, double angleDegrees );
+
+    /**
+     * Returns the transformation that applies this transformation first and another 
+     * one afterwards.
+     * \param next Transformation that is applied afterwards.
+     * \return The combined transformation.
+     */
+    WAffineTransform followedBy( const WAffineTransform& next ) const;
+
+    /**
+     * Returns a matrix element.
+     * \param row Row of the element.
+     * \param column Column of the element.
+     * \return The matrix element.
+     */
+    double get( size_t row, size_t column ) const;
+
+    /**
+     * Transforms interleaved X/Y/Z coordinates in place.
+     * \param coordinates First coordinate of the transformed points.
+     * \param count Count of transformed points.
+     */
+    void transformPoints( float* coordinates, size_t count ) const;
+
+private:
+    /**
+     * Matrix elements in row major order.
+     */
+    double m_matrix[16];
+};
+
+#endif  // WAFFINETRANSFORM_H
@@ -0,0 +1,233 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <cmath>
+#include <vector>
+
+#include "WCovarianceMoments.h"
+
+WCovarianceMoments::WCovarianceMoments()
+{
+    m_pointCount = 0;
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+    {
+        m_origin[dimension] = 0.0;
+        m_sum[dimension] = 0.0;
+    }
+    for( size_t index = 0; index < 6; index++ )
+        m_outerProductSum[index] = 0.0;
+}
+
+WCovarianceMoments::~WCovarianceMoments()
+{
+}
+
+void WCovarianceMoments::addPoint( double x, double y, double z )
+{
+    if( m_pointCount == 0 )
+    {
+        m_origin[0] = x;
+        m_origin[1] = y;
+        m_origin[2] = z;
+    }
+    double dx = x - m_origin[0];
+    double dy = y - m_origin[1];
+    double dz = z - m_origin[2];
+    m_sum[0] += dx;
+    m_sum[1] += dy;
+    m_sum[2] += dz;
+    m_outerProductSum[0] += dx * dx;
+    m_outerProductSum[1] += dx * dy;
+    m_outerProductSum[2] += dx * dz;
+    m_outerProductSum[3] += dy * dy;
+    m_outerProductSum[4] += dy * dz;
+    m_outerProductSum[5] += dz * dz;
+    m_pointCount++;
+}
+
+size_t WCovarianceMoments::getPointCount() const
+{
+    return m_pointCount;
+}
+
+vector<double> WCovarianceMoments::getMean() const
+{
+    vector<double> mean( 3, 0.0 );
+    fetchMean( &mean[0] );
+    return mean;
+}
+
+void WCovarianceMoments::fetchMean( double* mean ) const
+{
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+        mean[dimension] = m_pointCount == 0 ?0.0 :m_origin[dimension] + m_sum[dimension] / m_pointCount;
+}
+
+void WCovarianceMoments::fetchCovariance( double* covariance ) const
+{
+    size_t index = 0;
+    for( size_t row = 0; row < 3; row++ )
+        for( size_t column = row; column < 3; column++ )
+        {
+            covariance[index] = m_pointCount == 0 ?0.0
+                    :( m_outerProductSum[index] - m_sum[row] * m_sum[column] / m_pointCount ) / m_pointCount;
+            index++;
+        }
+}
+
+vector<double> WCovarianceMoments::getEigenValues() const
+{
+    double covariance[6];
+    double eigenValues[3];
+    fetchCovariance( covariance );
+    fetchSymmetricEigenValues( covariance, eigenValues );
+    return vector<double>( eigenValues, eigenValues + 3 );
+}
+
+void WCovarianceMoments::fetchSymmetricEigenValues( const double* matrix, double* eigenValues )
+{
+    double offDiagonal = matrix[1] * matrix[1] + matrix[2] * matrix[2] + matrix[4] * matrix[4];
+    double mean = ( matrix[0] + matrix[3] + matrix[5] ) / 3.0;
+    double xx = matrix[0] - mean;
+    double yy = matrix[3] - mean;
+    double zz = matrix[5] - mean;
+    double deviation = sqrt( ( xx * xx + yy * yy + zz * zz + 2.0 * offDiagonal ) / 6.0 );
+    if( deviation == 0.0 )
+    {
+        for( size_t index = 0; index < 3; index++ )
+            eigenValues[index] = mean;
+        return;
+    }
+
+    // Determinant of ( matrix - mean * I ) / deviation divided by 2
+    double halfDeterminant = ( xx * ( yy * zz - matrix[4] * matrix[4] )
+            - matrix[1] * ( matrix[1] * zz - matrix[4] * matrix[2] )
+            + matrix[2] * ( matrix[1] * matrix[4] - yy * matrix[2] ) )
+            / ( 2.0 * deviation * deviation * deviation );
+    if( halfDeterminant < -1.0 )
+        halfDeterminant = -1.0;
+    if( halfDeterminant > 1.0 )
+        halfDeterminant = 1.0;
+    double angle = acos( halfDeterminant ) / 3.0;
+    eigenValues[0] = mean + 2.0 * deviation * cos( angle );
+    eigenValues[2] = mean + 2.0 * deviation * cos( angle + 2.0 * M_PI / 3.0 );
+    eigenValues[1] = 3.0 * mean - eigenValues[0] - eigenValues[2];
+}
+
+void WCovarianceMoments::fetchSymmetricEigenVector( const double* matrix, double eigenValue, double* eigenVector )
+{
+    double rows[3][3];
+    for( size_t row = 0; row < 3; row++ )
+        for( size_t column = 0; column < 3; column++ )
+            rows[row][column] = matrix[getSymmetricIndex( row, column )] - ( row == column ?eigenValue :0.0 );
+
+    // The Eigen Vector is perpendicular to all rows of ( matrix - eigenValue * I )
+    double biggestLength = 0.0;
+    double biggestRowLength = 0.0;
+    size_t biggestRow = 0;
+    for( size_t row = 0; row < 3; row++ )
+    {
+        const double* first = rows[row];
+        const double* second = rows[( row + 1 ) % 3];
+        double cross[3] = {
+            first[1] * second[2] - first[2] * second[1],
+            first[2] * second[0] - first[0] * second[2],
+            first[0] * second[1] - first[1] * second[0] };
+        double length = cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2];
+        if( length > biggestLength )
+        {
+            biggestLength = length;
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+                eigenVector[dimension] = cross[dimension];
+        }
+        double rowLength = first[0] * first[0] + first[1] * first[1] + first[2] * first[2];
+        if( rowLength > biggestRowLength )
+        {
+            biggestRowLength = rowLength;
+            biggestRow = row;
+        }
+    }
+
+    if( biggestLength <= biggestRowLength * biggestRowLength * 1e-20 )
+    {
+        // Multiple Eigen Value: Any vector perpendicular to the biggest row fits.
+        const double* row = rows[biggestRow];
+        size_t smallestDimension = 0;
+        for( size_t dimension = 1; dimension < 3; dimension++ )
+            if( fabs( row[dimension] ) < fabs( row[smallestDimension] ) )
+                smallestDimension = dimension;
+        double axis[3] = { 0.0, 0.0, 0.0 };
+        axis[smallestDimension] = 1.0;
+        eigenVector[0] = row[1] * axis[2] - row[2] * axis[1];
+        eigenVector[1] = row[2] * axis[0] - row[0] * axis[2];
+        eigenVector[2] = row[0] * axis[1] - row[1] * axis[0];
+        biggestLength = eigenVector[0] * eigenVector[0] + eigenVector[1] * eigenVector[1] + eigenVector[2] * eigenVector[2];
+        if( biggestLength == 0.0 )
+        {
+            eigenVector[0] = 1.0;
+            eigenVector[1] = eigenVector[2] = 0.0;
+            return;
+        }
+    }
+    double length = sqrt( biggestLength );
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+        eigenVector[dimension] /= length;
+}
+
+void WCovarianceMoments::fetchSymmetricEigenVectors( const double* matrix, const double* eigenValues, double* eigenVectors )
+{
+    double* biggest = eigenVectors;
+    double* middle = eigenVectors + 3;
+    double* smallest = eigenVectors + 6;
+    fetchSymmetricEigenVector( matrix, eigenValues[2], smallest );
+    fetchSymmetricEigenVector( matrix, eigenValues[0], biggest );
+
+    // Make the biggest vector orthogonal in case the Eigen Values are close
+    double product = biggest[0] * smallest[0] + biggest[1] * smallest[1] + biggest[2] * smallest[2];
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+        biggest[dimension] -= product * smallest[dimension];
+    double length = sqrt( biggest[0] * biggest[0] + biggest[1] * biggest[1] + biggest[2] * biggest[2] );
+    if( length == 0.0 )
+    {
+        double axis[3] = { 0.0, 0.0, 0.0 };
+        axis[fabs( smallest[0] ) < 0.5 ?0 :1] = 1.0;
+        biggest[0] = smallest[1] * axis[2] - smallest[2] * axis[1];
+        biggest[1] = smallest[2] * axis[0] - smallest[0] * axis[2];
+        biggest[2] = smallest[0] * axis[1] - smallest[1] * axis[0];
+        length = sqrt( biggest[0] * biggest[0] + biggest[1] * biggest[1] + biggest[2] * biggest[2] );
+    }
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+        biggest[dimension] /= length;
+
+    middle[0] = smallest[1] * biggest[2] - smallest[2] * biggest[1];
+    middle[1] = smallest[2] * biggest[0] - smallest[0] * biggest[2];
+    middle[2] = smallest[0] * biggest[1] - smallest[1] * biggest[0];
+}
+
+size_t WCovarianceMoments::getSymmetricIndex( size_t row, size_t column )
+{
+    if( row > column )
+        return getSymmetricIndex( column, row );
+    return row * 3 - row * ( row - 1 ) / 2 + column - row;
+}
@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WCOVARIANCEMOMENTS_H
+#define WCOVARIANCEMOMENTS_H
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+/**
+ * Running moments of a 3D point set: The point count, the coordinate sum and the sum 
+ * of the coordinate outer products. Points are added one by one, so the covariance 
+ * matrix is known without keeping the points. The moments are relative to the first 
+ * added point to avoid cancellation on big coordinates.
+ */
+class WCovarianceMoments
+{
+public:
+    /**
+     * Creates moments of an empty point set.
+     */
+    WCovarianceMoments();
+
+    /**
+     * Destroys the moments.
+     */
+    virtual ~WCovarianceMoments();
+
+    /**
+     * Adds a point to the moments.
+     * \param x X coordinate of the point.
+     * \param y Y coordinate of the point.
+     * \param z Z coordinate of the point.
+     */
+    void addPoint( double x, double y, double z );
+
+    /**
+     * Returns the count of added points.
+     * \return The count of added points.
+     */
+    size_t getPointCount() const;
+
+    /**
+     * Returns the mean of the added points.
+     * \return The mean X/Y/Z coordinate.
+     */
+    vector<double> getMean() const;
+
+    /**
+     * Calculates the mean of the added points.
+     * \param mean Output mean X/Y/Z coordinate.
+     */
+    void fetchMean( double* mean ) const;
+
+    /**
+     * Calculates the covariance matrix of the added points. The sums are divided by 
+     * the point count.
+     * \param covariance Output upper triangle of the symmetric matrix in the order XX, 
+     *                   XY, XZ, YY, YZ and ZZ.
+     */
+    void fetchCovariance( double* covariance ) const;
+
+    /**
+     * Returns the Eigen Values of the covariance matrix.
+     * \return The Eigen Values, the biggest one first.
+     */
+    vector<double> getEigenValues() const;
+
+    /**
+     * Calculates the Eigen Values of a symmetric 3x3 matrix in closed form using the 
+     * trigonometric solution of its characteristic polynomial.
+     * \param matrix Upper triangle of the symmetric matrix in the order XX, XY, XZ, YY, 
+     *               YZ and ZZ.
+     * \param eigenValues Output Eigen Values, the biggest one first.
+     */
+    static void fetchSymmetricEigenValues( const double* matrix, double* eigenValues );
+
+    /**
+     * Calculates the normalized Eigen Vector of a symmetric 3x3 matrix that belongs to 
+     * an Eigen Value. It's the biggest cross product of two rows of ( matrix - eigenValue 
+     * * I ). If the Eigen Value is multiple then any fitting Eigen Vector is returned.
+     * \param matrix Upper triangle of the symmetric matrix in the order XX, XY, XZ, YY, 
+     *               YZ and ZZ.
+     * \param eigenValue Eigen Value of the matrix.
+     * \param eigenVector Output X/Y/Z components of the Eigen Vector.
+     */
+    static void fetchSymmetricEigenVector( const double* matrix, double eigenValue, double* eigenVector );
+
+    /**
+     * Calculates the normalized Eigen Vectors of a symmetric 3x3 matrix. The middle one 
+     * is the cross product of the other ones, so the vectors are always orthogonal.
+     * \param matrix Upper triangle of the symmetric matrix in the order XX, XY, XZ, YY, 
+     *               YZ and ZZ.
+     * \param eigenValues Eigen Values of the matrix, the biggest one first.
+     * \param eigenVectors Output Eigen Vectors in the order of the Eigen Values. Each 
+     *                     one takes three values.
+     */
+    static void fetchSymmetricEigenVectors( const double* matrix, const double* eigenValues, double* eigenVectors );
+
+    /**
+     * Returns the position of a symmetric 3x3 matrix element within its upper triangle 
+     * (order XX, XY, XZ, YY, YZ and ZZ).
+     * \param row Row of the element.
+     * \param column Column of the element.
+     * \return Index of the element within the upper triangle.
+     */
+    static size_t getSymmetricIndex( size_t row, size_t column );
+
+private:
+    /**
+     * Count of added points.
+     */
+    size_t m_pointCount;
+
+    /**
+     * First added point. The sums are relative to it.
+     */
+    double m_origin[3];
+
+    /**
+     * Coordinate sum of the added points.
+     */
+    double m_sum[3];
+
+    /**
+     * Sum of the coordinate outer products in the order XX, XY, XZ, YY, YZ and ZZ.
+     */
+    double m_outerProductSum[6];
+};
+
+#endif  // WCOVARIANCEMOMENTS_H
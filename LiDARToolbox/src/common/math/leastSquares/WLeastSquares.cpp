@@ -31,6 +31,7 @@ WLeastSquares::WLeastSquares()
     m_positions = 0;
     m_dimensions = 3;
     m_verticalDimension = 2;
+    m_hessianNormalForm.resize( m_dimensions + 1 );
 }
 
 WLeastSquares::WLeastSquares( size_t dimensions )
@@ -38,6 +39,7 @@ WLeastSquares::WLeastSquares( size_t dimensions )
     m_positions = 0;
     m_dimensions = dimensions;
     m_verticalDimension = 2;
+    m_hessianNormalForm.resize( m_dimensions + 1 );
 }
 
 WLeastSquares::~WLeastSquares()
@@ -47,12 +49,56 @@ WLeastSquares::~WLeastSquares()
 void WLeastSquares::analyzeData( vector<WPosition>* data )
 {
     m_positions = data;
+    if( m_dimensions == 3 )
+    {
+        WCovarianceMoments moments;
+        for( size_t index = 0; index < data->size(); index++ )
+            moments.addPoint( ( *data )[index][0], ( *data )[index][1], ( *data )[index][2] );
+        analyzeData( moments );
+        return;
+    }
     calculatePerpendicularDimension();
     calculateMatrices();
     calculateHessianNormalForm();
 }
 
-vector<double> WLeastSquares::getHessianNormalForm()
+void WLeastSquares::analyzeData( const WCovarianceMoments& moments )
+{
+    double covariance[6];
+    double eigenValues[3];
+    double normalVector[3];
+    moments.fetchCovariance( covariance );
+    WCovarianceMoments::fetchSymmetricEigenValues( covariance, eigenValues );
+    WCovarianceMoments::fetchSymmetricEigenVector( covariance, eigenValues[2], normalVector );
+    m_verticalDimension = 0;
+    for( size_t dimension = 1; dimension < 3; dimension++ )
+        if( abs( normalVector[dimension] ) > abs( normalVector[m_verticalDimension] ) )
+            m_verticalDimension = dimension;
+
+    // Normal equations of vertical = a_0 + a_1 * u + a_2 * v relative to the mean
+    size_t u = m_verticalDimension == 0 ?1 :0;
+    size_t v = m_verticalDimension == 2 ?1 :2;
+    double uu = covariance[WCovarianceMoments::getSymmetricIndex( u, u )];
+    double uv = covariance[WCovarianceMoments::getSymmetricIndex( u, v )];
+    double vv = covariance[WCovarianceMoments::getSymmetricIndex( v, v )];
+    Eigen::Matrix3d matrixA;
+    matrixA << 1.0, 0.0, 0.0,
+               0.0, uu, uv,
+               0.0, uv, vv;
+    Eigen::Vector3d vectorB( 0.0, covariance[WCovarianceMoments::getSymmetricIndex( u, m_verticalDimension )],
+            covariance[WCovarianceMoments::getSymmetricIndex( v, m_verticalDimension )] );
+    Eigen::Vector3d result = matrixA.ldlt().solve( vectorB );
+
+    double mean[3];
+    moments.fetchMean( mean );
+    m_hessianNormalForm.resize( 4 );
+    m_hessianNormalForm[3] = -( mean[m_verticalDimension] + result( 0 ) - result( 1 ) * mean[u] - result( 2 ) * mean[v] );
+    m_hessianNormalForm[m_verticalDimension] = 1.0;
+    m_hessianNormalForm[u] = -result( 1 );
+    m_hessianNormalForm[v] = -result( 2 );
+}
+
+const vector<double>& WLeastSquares::getHessianNormalForm()
 {
     return m_hessianNormalForm;
 }
@@ -95,10 +141,8 @@ void WLeastSquares::calculateMatrices()
 {
     if( m_positions->size() > 0 )
     {
-        MatrixXd newMatrixX( m_positions->size(), m_dimensions );
-        m_matrixX = newMatrixX;
-        MatrixXd newMatrixY( m_positions->size(), 1 );
-        m_matrixY = newMatrixY;
+        m_matrixX.resize( m_positions->size(), m_dimensions );
+        m_matrixY.resize( m_positions->size(), 1 );
 
         for( size_t row = 0; row < m_positions->size(); row++ )
         {
@@ -31,6 +31,8 @@
 #include "core/common/math/principalComponentAnalysis/WPrincipalComponentAnalysis.h"
 #include <Eigen/Dense>
 
+#include "../covariance/WCovarianceMoments.h"
+
 using std::abs;
 using std::cout;
 using std::endl;
@@ -60,11 +62,22 @@ public:
     virtual ~WLeastSquares();
 
     /**
-     * Launchs the least squares adjustment.
+     * Launchs the least squares adjustment. Three dimensional data is fitted using 
+     * the moments of the points (see analyzeData( const WCovarianceMoments& )).
      * \param data Point data to analyze the best fitted plane for.
      */
     void analyzeData( vector<WPosition>* data );
 
+    /**
+     * Launchs the least squares adjustment of three dimensional points using only their 
+     * moments. The perpendicular dimension is taken from the closed form Eigen Vector of 
+     * the smallest Eigen Value. The 3x3 normal equations are built from the covariance 
+     * and solved with fixed size matrices, so nothing is allocated. Slopes that aren't 
+     * determined by the points (e. g. less than three points) become zero.
+     * \param moments Moments of the points to analyze the best fitted plane for.
+     */
+    void analyzeData( const WCovarianceMoments& moments );
+
     /**
      * Returns the plane formula for the best fitted plane.
      * \return The Hessian normal form of the best fitted plane. First n numbers (by the 
@@ -72,7 +85,7 @@ public:
      *         fitted plane. The last one is the perpendicular euclidian distance to the 
      *         coordinate system orign.
      */
-    vector<double> getHessianNormalForm();
+    const vector<double>& getHessianNormalForm();
 
     /**
      * Returns a not normalized normal vector of the least squares adjustment result.
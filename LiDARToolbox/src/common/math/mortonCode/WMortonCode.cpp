@@ -0,0 +1,62 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include "WMortonCode.h"
+
+boost::uint32_t WMortonCode::getMaxCellCoordinate()
+{
+    return ( static_cast<boost::uint32_t>( 1 ) << BITS_PER_DIMENSION ) - 1;
+}
+
+boost::uint64_t WMortonCode::encode( boost::uint32_t x, boost::uint32_t y, boost::uint32_t z )
+{
+    return spreadBits( x ) | ( spreadBits( y ) << 1 ) | ( spreadBits( z ) << 2 );
+}
+
+boost::uint32_t WMortonCode::decode( boost::uint64_t code, size_t dimension )
+{
+    return compactBits( code >> dimension );
+}
+
+boost::uint64_t WMortonCode::spreadBits( boost::uint32_t value )
+{
+    boost::uint64_t bits = value & 0x1fffff;
+    bits = ( bits | bits << 32 ) & 0x1f00000000ffffULL;
+    bits = ( bits | bits << 16 ) & 0x1f0000ff0000ffULL;
+    bits = ( bits | bits << 8 ) & 0x100f00f00f00f00fULL;
+    bits = ( bits | bits << 4 ) & 0x10c30c30c30c30c3ULL;
+    bits = ( bits | bits << 2 ) & 0x1249249249249249ULL;
+    return bits;
+}
+
+boost::uint32_t WMortonCode::compactBits( boost::uint64_t value )
+{
+    boost::uint64_t bits = value & 0x1249249249249249ULL;
+    bits = ( bits ^ ( bits >> 2 ) ) & 0x10c30c30c30c30c3ULL;
+    bits = ( bits ^ ( bits >> 4 ) ) & 0x100f00f00f00f00fULL;
+    bits = ( bits ^ ( bits >> 8 ) ) & 0x1f0000ff0000ffULL;
+    bits = ( bits ^ ( bits >> 16 ) ) & 0x1f00000000ffffULL;
+    bits = ( bits ^ ( bits >> 32 ) ) & 0x1fffff;
+    return static_cast<boost::uint32_t>( bits );
+}
@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WMORTONCODE_H
+#define WMORTONCODE_H
+
+#include <boost/cstdint.hpp>
+
+/**
+ * Calculates Morton codes (Z-order curve) of 3D cell coordinates. Cells with close 
+ * Morton codes lie spatially close to each other. Sorting by the Morton code is used to 
+ * process points in a cache friendly order.
+ */
+class WMortonCode
+{
+public:
+    /**
+     * Count of bits per dimension that a Morton code can hold.
+     */
+    static const size_t BITS_PER_DIMENSION = 21;
+
+    /**
+     * Returns the largest cell coordinate that can be encoded.
+     * \return Largest encodable cell coordinate of each dimension.
+     */
+    static boost::uint32_t getMaxCellCoordinate();
+
+    /**
+     * Interleaves three cell coordinates to a Morton code. The bits of the X coordinate 
+     * get the lowest position within each group of three bits.
+     * \param x X cell coordinate. Only the lowest 21 bits are used.
+     * \param y Y cell coordinate. Only the lowest 21 bits are used.
+     * \param z Z cell coordinate. Only the lowest 21 bits are used.
+     * \return Morton code of the cell.
+     */
+    static boost::uint64_t encode( boost::uint32_t x, boost::uint32_t y, boost::uint32_t z );
+
+    /**
+     * Returns a single cell coordinate of a Morton code.
+     * \param code Morton code of a cell.
+     * \param dimension Dimension of the returned coordinate. 0 means X, 1 means Y and 2 
+     *                  means Z.
+     * \return Cell coordinate of the dimension.
+     */
+    static boost::uint32_t decode( boost::uint64_t code, size_t dimension );
+
+private:
+    /**
+     * Spreads the lowest 21 bits of a value so that two zero bits lie between each 
+     * original bit.
+     * \param value Value to spread.
+     * \return Spread bits.
+     */
+    static boost::uint64_t spreadBits( boost::uint32_t value );
+
+    /**
+     * Inverse of spreadBits(). It collects each third bit of a value.
+     * \param value Spread bits with the wanted bits at the lowest position.
+     * \return Compacted value.
+     */
+    static boost::uint32_t compactBits( boost::uint64_t value );
+};
+
+#endif  // WMORTONCODE_H
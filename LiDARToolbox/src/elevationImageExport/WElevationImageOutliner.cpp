@@ -39,14 +39,66 @@
 #include "core/graphicsEngine/WGEManagedGroupNode.h"
 #include "core/kernel/WKernel.h"
 #include "core/kernel/WModuleInputData.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "WElevationImageOutliner.h"
 
+/**
+ * Thread pool task that calculates the triangles of the elevation image quadrat rows.
+ */
+class WElevationImageTriangleTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param outliner Outliner that calculates the triangles.
+     * \param quadratRowCount Count of quadrat rows.
+     */
+    WElevationImageTriangleTask( WElevationImageOutliner* outliner, size_t quadratRowCount ) :
+        m_rowTriangles( quadratRowCount )
+    {
+        m_outliner = outliner;
+    }
+
+    /**
+     * Calculates the triangles of a range of quadrat rows.
+     * \param begin First quadrat row.
+     * \param end Row after the last quadrat row.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t quadratY = begin; quadratY < end; quadratY++ )
+            m_outliner->fetchQuadratRowTriangles( quadratY, &m_rowTriangles[quadratY] );
+    }
+
+    /**
+     * Returns the triangles of a quadrat row.
+     * \param quadratY Quadrat row.
+     * \return Vertex ID triples of the row's triangles.
+     */
+    const vector<size_t>& getRowTriangles( size_t quadratY )
+    {
+        return m_rowTriangles[quadratY];
+    }
+
+private:
+    /**
+     * Outliner that calculates the triangles.
+     */
+    WElevationImageOutliner* m_outliner;
+
+    /**
+     * Triangles of each quadrat row.
+     */
+    vector< vector<size_t> > m_rowTriangles;
+};
+
+
 WElevationImageOutliner::WElevationImageOutliner()
 {
     m_minElevImageZ = 0;
     m_intensityIncreasesPerMeter = 5;
-    m_vertices = new WQuadTree( 1 );
-    m_printedQuadrats = new WQuadTree( 1 );
 }
 
 WElevationImageOutliner::~WElevationImageOutliner()
@@ -78,75 +130,52 @@ void WElevationImageOutliner::importElevationImage( WQuadTree* quadTree, size_t
 {
     boost::shared_ptr< WTriangleMesh > tmpMesh( new WTriangleMesh( 0, 0 ) );
     m_outputMesh = tmpMesh;
-    m_vertices = new WQuadTree( quadTree->getDetailLevel() );
-    m_printedQuadrats = new WQuadTree( quadTree->getDetailLevel() );
-    drawNode( quadTree->getRootNode(), quadTree, elevImageMode );
+    m_leafGrid.importQuadTree( quadTree );
+    for( size_t leaf = 0; leaf < m_leafGrid.getLeafCount(); leaf++ )
+        addVertex( m_leafGrid.getLeaf( leaf ), elevImageMode );
+
+    size_t quadratRowCount = m_leafGrid.getSizeY() + 1;
+    WElevationImageTriangleTask task( this, quadratRowCount );
+    WThreadPool::getSharedPool()->parallelFor( &task, quadratRowCount );
+    for( size_t quadratY = 0; quadratY < quadratRowCount; quadratY++ )
+    {
+        const vector<size_t>& triangles = task.getRowTriangles( quadratY );
+        for( size_t index = 0; index < triangles.size(); index += 3 )
+            m_outputMesh->addTriangle( triangles[index], triangles[index + 1], triangles[index + 2] );
+    }
 }
 
-void WElevationImageOutliner::drawNode(
-        WQuadNode* node, WQuadTree* quadTree, size_t elevImageMode )
+void WElevationImageOutliner::fetchQuadratRowTriangles( size_t quadratY, vector<size_t>* triangles )
 {
-    if( node->getRadius() <= quadTree->getDetailLevel() )
+    for( size_t quadratX = 0; quadratX <= m_leafGrid.getSizeX(); quadratX++ )
     {
-        double x = node->getCenter( 0 );
-        double y = node->getCenter( 1 );
-        double d = quadTree->getDetailLevel() * 2;
-
-        WQuadNode* sourceNodes[][3] = { //NOLINT
-            { quadTree->getLeafNode( x-d, y-d ), quadTree->getLeafNode( x, y-d ), quadTree->getLeafNode( x+d, y-d ) }, //NOLINT
-            { quadTree->getLeafNode( x-d, y ), quadTree->getLeafNode( x, y ), quadTree->getLeafNode( x+d, y ) }, //NOLINT
-            { quadTree->getLeafNode( x-d, y+d ), quadTree->getLeafNode( x, y+d ), quadTree->getLeafNode( x+d, y+d ) } }; //NOLINT
-        for( size_t yIdx = 0; yIdx < 2; yIdx++)
-            for( size_t xIdx = 0; xIdx < 2; xIdx++)
+        size_t sourceQuadrat[] = {
+            m_leafGrid.getLeafIndex( quadratX - 1, quadratY - 1 ), m_leafGrid.getLeafIndex( quadratX, quadratY - 1 ),
+            m_leafGrid.getLeafIndex( quadratX, quadratY ), m_leafGrid.getLeafIndex( quadratX - 1, quadratY ) };
+        size_t current = 0;
+        size_t list[] = {0, 0, 0};
+        for( int index = 0; index < 4; index++ )
+        {
+            if( sourceQuadrat[index] != WQuadLeafGrid::noLeaf ) list[current++] = sourceQuadrat[index];
+            if( current == 3 )
             {
-                double xOff = static_cast<double>( xIdx )*d-d+x;
-                double yOff = static_cast<double>( yIdx )*d-d+y;
-                bool isDone = m_printedQuadrats->getLeafNode( xOff, yOff ) != 0;
-                if( !isDone )
-                {
-                    WQuadNode* sourceQuadrat[] = {
-                        sourceNodes[xIdx][yIdx], sourceNodes[xIdx][yIdx+1],
-                        sourceNodes[xIdx+1][yIdx+1], sourceNodes[xIdx+1][yIdx] };
-                    size_t current = 0;
-                    WQuadNode* list[] = {0, 0, 0};
-                    for(int index = 0; index < 4; index++ )
-                    {
-                        if( sourceQuadrat[index] != 0 ) list[current++] = sourceQuadrat[index];
-                        if( current == 3 )
-                        {
-                            size_t vertID0 = getVertexID( list[0], elevImageMode );
-                            size_t vertID1 = getVertexID( list[1], elevImageMode );
-                            size_t vertID2 = getVertexID( list[2], elevImageMode );
-                            m_outputMesh->addTriangle( vertID0, vertID1, vertID2 );
-                            list[1] = list[2];
-                            current--;
-                        }
-                    }
-                    m_printedQuadrats->registerPoint( xOff, yOff, 0 );
-                }
+                triangles->push_back( list[0] );
+                triangles->push_back( list[1] );
+                triangles->push_back( list[2] );
+                list[1] = list[2];
+                current--;
             }
-    }
-    else
-    {
-        for  ( size_t child = 0; child < 4; child++ )
-            if  ( node->getChild( child ) != 0 )
-                drawNode( node->getChild( child ), quadTree, elevImageMode );
+        }
     }
 }
 
-size_t WElevationImageOutliner::getVertexID(
-        WQuadNode* node, size_t elevImageMode )
+void WElevationImageOutliner::addVertex( WQuadNode* node, size_t elevImageMode )
 {
     double x = node->getCenter( 0 );
     double y = node->getCenter( 1 );
-    WQuadNode* existingNode = m_vertices->getLeafNode( x, y );
-    if( existingNode != 0 ) return existingNode->getID();
     double elevation = elevImageMode != 0 ?node->getValueMax() :node->getValueMin();
     if( elevImageMode == 2 ) elevation = node->getPointCount();
-    m_vertices->registerPoint( x, y, elevation );
-    existingNode = m_vertices->getLeafNode( x, y );
     size_t currentVertex = m_outputMesh->vertSize();
-    existingNode->setID( currentVertex );
     m_outputMesh->addVertex( x, y, m_showElevationInMeshOffset ?elevation :0 );
     elevation = ( elevation - m_minElevImageZ ) * m_intensityIncreasesPerMeter;
     if( elevation < 0.0 ) elevation = 0.0;
@@ -155,7 +184,6 @@ size_t WElevationImageOutliner::getVertexID(
     if( !m_showElevationInMeshColor ) elevation = 128;
     osg::Vec4 color = osg::Vec4( elevation, elevation, elevation, 1.0 );
     m_outputMesh->setVertexColor( currentVertex, color );
-    return existingNode->getID();
 }
 
 void WElevationImageOutliner::setExportElevationImageSettings( double minElevImageZ, double intensityIncreasesPerMeter )
@@ -191,15 +219,15 @@ void WElevationImageOutliner::highlightBuildingGroups( boost::shared_ptr< WDataS
     {
         float x = verts->at( vertex*3 );
         float y = verts->at( vertex*3+1 );
-        WQuadNode* node = m_vertices->getLeafNode( x, y );
-        if( node != 0 )
+        size_t leaf = m_leafGrid.getLeafIndex( m_leafGrid.getCellX( x ), m_leafGrid.getCellY( y ) );
+        if( leaf != WQuadLeafGrid::noLeaf )
         {
-            if( node->getID() < m_outputMesh->vertSize() )
+            if( leaf < m_outputMesh->vertSize() )
             {
                 size_t group = groups->at( vertex );
                 osg::Vec4 color = osg::Vec4( WOctree::calcColor( group, 0 ),
                         WOctree::calcColor( group, 1 ), WOctree::calcColor( group, 2 ), 1.0f );
-                m_outputMesh->setVertexColor( node->getID(), color );
+                m_outputMesh->setVertexColor( leaf, color );
             }
             else
             {
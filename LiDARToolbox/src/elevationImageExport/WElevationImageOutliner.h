@@ -71,6 +71,7 @@
 #include "../common/algorithms/bitmapImage/WBmpSaver.h"
 #include "../common/datastructures/quadtree/WQuadTree.h"
 #include "../common/datastructures/quadtree/WQuadNode.h"
+#include "../common/datastructures/quadtree/WQuadLeafGrid.h"
 #include "../common/datastructures/octree/WOctree.h"
 #include "../common/datastructures/octree/WOctNode.h"
 
@@ -126,7 +127,9 @@ public:
     void setShowElevationInMeshOffset( bool showElevationInMeshOffset );
 
     /**
-     * Draws an elevation image to the m_outputMesh triangle mesh.
+     * Draws an elevation image to the m_outputMesh triangle mesh. Each leaf node becomes 
+     * a vertex. The triangles of the quadrats between the leaves are calculated in 
+     * parallel.
      * \param quadTree Input quadtree depicting an elevation image.
      * \param elevImageMode Input quadtree depicting an elevation image.
      *                      0: Minimal Z values each X/Y bin coordinate.
@@ -147,37 +150,27 @@ public:
      */
     boost::shared_ptr< WTriangleMesh > getOutputMesh();
 
+    /**
+     * Calculates the triangles of a row of quadrats. A quadrat is the area between 
+     * four neighboring leaf grid cells. Quadrats of three or four existing leaves are 
+     * drawn. Their vertex IDs are the leaf indices of m_leafGrid.
+     * \param quadratY Quadrat row. It lies between the leaf grid rows quadratY - 1 and 
+     *                 quadratY.
+     * \param triangles Output vertex ID triples of the row's triangles.
+     */
+    void fetchQuadratRowTriangles( size_t quadratY, vector<size_t>* triangles );
+
 private:
     /**
-     * Draws an elevation image to the m_outputMesh triangle mesh from an elevation image 
-     * data node. All subnodes will be traversed.
-     * \param node If it's a leaf node then physical neighbor nodes will be analyzed to 
-     *             draw triangles to m_outputMesh. If it's a parent node then it'll 
-     *             used to traverse children.
-     * \param quadTree The quadtree object of the node. It's mainly used to be able to poll 
-     *                 node's physical neighbors.
-     * \param elevImageMode Elevation image kind to draw.
-     *                      0: Depicts minimal Z values
-     *                      1: Depicts maximal Z values
-     *                      2: Depicts point counts within elevation image areas
-     */
-    void drawNode( WQuadNode* node, WQuadTree* quadTree, size_t elevImageMode );
-
-    /**
-     * Returns the vertex ID corresponding to a quadtree leaf node X/Y coordinate.
-     * The corresponding output triangle mesh vertex will be added if it doesn't exist 
-     * in m_outputMesh. All parameters including the color depicting the elevation height 
-     * will be initialized.
-     * \param node Elevation image area (only leaf nodes) to gather a corresponding 
-     *             m_outputMesh vertex ID.
-     * \param elevImageMode Elevation image type for initializing the vertex if doesn't 
-     *                      exist before:
+     * Adds the vertex of a leaf node to m_outputMesh. All parameters including the color 
+     * depicting the elevation height will be initialized.
+     * \param node Elevation image area (only leaf nodes) to add a vertex for.
+     * \param elevImageMode Elevation image type:
      *                      0: Minimal Z values each X/Y bin coordinate.
      *                      1: Maximal Z values each X/Y bin coordinate.
      *                      2: Corresponding to the Point count each X/Y bin coordinate.
-     * \return The m_outputMesh vertex ID to the corresponding elevation image value node.
      */
-    size_t getVertexID( WQuadNode* node, size_t elevImageMode );
+    void addVertex( WQuadNode* node, size_t elevImageMode );
 
     /**
      * Triangle mesh where the elevation image can be generated using importElevationImage().
@@ -185,16 +178,9 @@ private:
     boost::shared_ptr< WTriangleMesh > m_outputMesh;
 
     /**
-     * This field is a map to real m_outputMesh vertex indices. Leaf node m_id params map to them.
-     */
-    WQuadTree* m_vertices;
-
-    /**
-     * The elevation image is a grid of vertices which are organized by quadrats.
-     * during drawing triangles importElevationImage() needs to know on which quadrat 
-     * areas triangle pairs have already been drawn in order to avoid duplicate triangles.
+     * Leaf nodes of the elevation image. Their indices are the m_outputMesh vertex indices.
      */
-    WQuadTree* m_printedQuadrats;
+    WQuadLeafGrid m_leafGrid;
 
     /**
      * Elevation reference height which will be taken as the black color;
@@ -127,6 +127,13 @@ void WMElevationImageExport::properties()
                             "Target file path of the exportable elevation image *.bmp file",
                             WPathHelper::getAppPath() );
     m_exportTriggerProp = m_properties->addProperty( "Write: ",  "Export elevation image", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+    m_useStoreInput = m_properties->addProperty( "Tile store input: ", "Reads the points tile by tile from a tile store "
+                     "instead of the input connector. So point clouds that exceed the memory can be processed.", false, m_propCondition );
+    m_inputStoreFile = m_properties->addProperty( "Input store: ", "Tile store whose points are put into the elevation image.",
+                            WPathHelper::getAppPath(), m_propCondition );
+    m_storeMemoryMB = m_properties->addProperty( "Store memory [MB]: ", "Memory of the tile cache of the input store.",
+                            512, m_propCondition );
+    m_storeMemoryMB->setMin( 1 );
     m_showElevationInMeshColor = m_properties->addProperty( "Show elevation in mesh color: ",
                      "If trigger set then the elevation will be displayed in the triangle mesh "
                      "color..", true, m_propCondition );
@@ -164,26 +171,25 @@ void WMElevationImageExport::moduleMain()
         m_moduleState.wait();
 
         boost::shared_ptr< WDataSetPoints > points = m_input->getData();
+        WPointTileStore store;
+        bool isStoreInput = m_useStoreInput->get() && store.open( m_inputStoreFile->get().c_str(),
+                static_cast<size_t>( m_storeMemoryMB->get() ) * 1024 * 1024 );
 //        std::cout << "Execute cycle\r\n";
         WItemSelector elevImageModeSelector = m_elevImageMode->get();
-        if( points )
+        if( points || isStoreInput )
         {
-            WDataSetPoints::VertexArray verts = points->getVertices();
             WElevationImageOutliner* m_elevationImageOutliner = new WElevationImageOutliner();
-            size_t count = verts->size()/3;
+            size_t count = isStoreInput ?store.getPointCount() :points->getVertices()->size()/3;
             setProgressSettings( count );
 
             m_detailDepthLabel->set( pow( 2.0, m_detailDepth->get() ) * 2.0 );
             m_elevationImage = new WQuadTree( pow( 2.0, m_detailDepth->get() ) );
 
-            for( size_t vertex = 0; vertex < count; vertex++)
-            {
-                double x = verts->at( vertex*3 );
-                double y = verts->at( vertex*3+1 );
-                double z = verts->at( vertex*3+2 );
-                m_elevationImage->registerPoint( x, y, z );
-                m_progressStatus->increment( 1 );
-            }
+            if( isStoreInput )
+                registerStorePoints( &store );
+            else
+                m_elevationImage->registerPoints( *points->getVertices() );
+            m_progressStatus->increment( count );
             m_nbPoints->set( count );
             m_xMin->set( m_elevationImage->getRootNode()->getXMin() );
             m_xMax->set( m_elevationImage->getRootNode()->getXMax() );
@@ -244,3 +250,24 @@ void WMElevationImageExport::setProgressSettings( size_t steps )
     m_progressStatus = boost::shared_ptr< WProgress >( new WProgress( headerText, steps ) );
     m_progress->addSubProgress( m_progressStatus );
 }
+
+void WMElevationImageExport::registerStorePoints( WPointTileStore* store )
+{
+    if( store->getPointCount() == 0 )
+        return;
+    vector<double> minCoord = store->getMinCoord();
+    vector<double> maxCoord = store->getMaxCoord();
+    m_elevationImage->expandRoot( minCoord[0], minCoord[1], maxCoord[0], maxCoord[1] );
+    vector<float> vertices;
+    vector<float> colors;
+    vector<boost::uint64_t> indices;
+    for( size_t tile = 0; tile < store->getTileCount(); tile++ )
+    {
+        if( !store->fetchTile( tile, &vertices, &colors, &indices ) )
+        {
+            std::cout << "!!!Could not read the tile store " << m_inputStoreFile->get().c_str() << std::endl;
+            return;
+        }
+        m_elevationImage->registerPoints( vertices );
+    }
+}
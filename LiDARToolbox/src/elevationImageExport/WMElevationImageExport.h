@@ -43,6 +43,7 @@
 #include <osg/Geode>
 #include "core/dataHandler/WDataSetPoints.h"
 #include "../common/datastructures/quadtree/WQuadTree.h"
+#include "../common/datastructures/tileStore/WPointTileStore.h"
 
 
 
@@ -147,6 +148,14 @@ private:
      */
     void setProgressSettings( size_t steps );
 
+    /**
+     * Registers the points of the input tile store tile by tile in the elevation image. 
+     * Its root is expanded to the store bounds first. So the image equals the one of 
+     * the in-memory points. It stops at the first tile that can't be read.
+     * \param store Tile store that was opened for reading.
+     */
+    void registerStorePoints( WPointTileStore* store );
+
     /**
      * WDataSetPoints data input (proposed for LiDAR data).
      */
@@ -250,6 +259,21 @@ private:
 
     WPropTrigger  m_exportTriggerProp; //!< This property triggers the actual reading,
 
+    /**
+     * Reads the points from a tile store instead of the input connector.
+     */
+    WPropBool m_useStoreInput;
+
+    /**
+     * Tile store whose points are put into the elevation image.
+     */
+    WPropFilename m_inputStoreFile;
+
+    /**
+     * Megabytes that can be used by the tile cache of the input store.
+     */
+    WPropInt m_storeMemoryMB;
+
     /**
      * If trigger set then the elevation will be displayed in the triangle mesh color.
      */
@@ -175,10 +175,12 @@ void WMPointGroupsTransform::properties()
                                                         "that offset.", 0.0, m_propCondition  );
 
     m_groupFileOperations = m_properties->addPropertyGroup( "File options", "" );
-    m_inputFile = m_groupFileOperations->addProperty( "Input path: ", "", WPathHelper::getAppPath() );
+    m_inputFile = m_groupFileOperations->addProperty( "Input path: ", "Point file to load. Files ending with \".groupsbin\" are read "
+                            "as binary instead of text.", WPathHelper::getAppPath() );
     WPropertyHelper::PC_PATHEXISTS::addTo( m_inputFile );
     m_reloadPointsTrigger = m_groupFileOperations->addProperty( "Load points:",  "Load from file", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
-    m_outputFile = m_groupFileOperations->addProperty( "Output path: ", "", WPathHelper::getAppPath() );
+    m_outputFile = m_groupFileOperations->addProperty( "Output path: ", "Point file to save. It is written as binary if the "
+                            "path ends with \".groupsbin\", otherwise as text ending with \".groups\".", WPathHelper::getAppPath() );
     m_savePointsTrigger = m_groupFileOperations->addProperty( "Save points:",  "Save to file", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
 
 
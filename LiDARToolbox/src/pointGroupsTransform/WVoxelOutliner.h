@@ -30,6 +30,7 @@
 #include "core/dataHandler/WDataSetPoints.h"
 #include "../common/datastructures/octree/WOctNode.h"
 #include "../common/datastructures/octree/WOctree.h"
+#include "../common/algorithms/voxelMesher/WVoxelMesher.h"
 
 /**
  * Tool to draw an octree to a WTriangle mesh in order to e. g. display it using the plugin 
@@ -75,7 +76,8 @@ public:
     WOctNode* getOctreeLeafNode( double x, double y, double z );
 
     /**
-     * Converts an octree to a triangle mesh. Only smallest possible octree nodes will be drawn.
+     * Converts an octree to a triangle mesh. Only smallest possible octree nodes will be drawn. 
+     * Only voxel faces that border on empty voxels are drawn.
      * \param highlightUsingColors Add color to voxels corresponding to their group IDs.
      * \return The drawn output triangle mesh.
      */
@@ -83,17 +85,16 @@ public:
 
 private:
     /**
-     * Outlines an octree node in the triangle mesh if it's a leaf noce. Parents are 
+     * Adds an octree node to the voxel mesher if it's a leaf noce. Parents are 
      * just traversed recursively.
      * \param node Octree node to outline. It doesn't outline itself but children if it 
      *             has some. All subnodes will be traversed.
-     * \param outputMesh The target triangle mesh to draw octree leaf nodes.
+     * \param voxelMesher The voxel mesher that draws octree leaf nodes.
      * \param octree The octree object of the node. It's required to poll some dimension 
      *               propertiies.
      * \param highlightUsingColors Add color to voxels corresponding to their group ID.
      */
-    static void drawNode( WOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh, WOctree* octree,
-                          bool highlightUsingColors );
+    static void drawNode( WOctNode* node, WVoxelMesher* voxelMesher, WOctree* octree, bool highlightUsingColors );
 
     /**
      * Voxels organized using a regular grid. They are used to outline point areas. It 
@@ -22,10 +22,91 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <vector>
+#include <boost/thread/mutex.hpp>
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "WGroupValidator.h"
 
+/**
+ * Thread pool task that validates reference groups.
+ */
+class WGroupValidationTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param validator Validator that validates the groups.
+     * \param progress Progress status that is incremented for each validated group.
+     * \param missingAreaVertices Output reference points of not segmented areas for 
+     *                            each reference group.
+     * \param correctlySegmentedVertices Output correctly segmented reference points for 
+     *                                   each reference group.
+     * \param falseSegmentedVertices Output points of the best matching group that 
+     *                               don't belong to each reference group.
+     */
+    WGroupValidationTask( WGroupValidator* validator, boost::shared_ptr< WProgress > progress,
+            vector< vector<float> >* missingAreaVertices, vector< vector<float> >* correctlySegmentedVertices,
+            vector< vector<float> >* falseSegmentedVertices )
+    {
+        m_validator = validator;
+        m_progress = progress;
+        m_missingAreaVertices = missingAreaVertices;
+        m_correctlySegmentedVertices = correctlySegmentedVertices;
+        m_falseSegmentedVertices = falseSegmentedVertices;
+    }
+
+    /**
+     * Validates a range of reference groups.
+     * \param begin First reference group ID of the range.
+     * \param end ID after the last reference group of the range.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t group = begin; group < end; group++ )
+            m_validator->validateGroup( group, &( *m_missingAreaVertices )[group],
+                    &( *m_correctlySegmentedVertices )[group], &( *m_falseSegmentedVertices )[group] );
+        boost::mutex::scoped_lock lock( m_progressMutex );
+        m_progress->increment( end - begin );
+    }
+
+private:
+    /**
+     * Validator that validates the groups.
+     */
+    WGroupValidator* m_validator;
+
+    /**
+     * Progress status that is incremented for each validated group.
+     */
+    boost::shared_ptr< WProgress > m_progress;
+
+    /**
+     * Guards the progress status.
+     */
+    boost::mutex m_progressMutex;
+
+    /**
+     * Output reference points of not segmented areas for each reference group.
+     */
+    vector< vector<float> >* m_missingAreaVertices;
+
+    /**
+     * Output correctly segmented reference points for each reference group.
+     */
+    vector< vector<float> >* m_correctlySegmentedVertices;
+
+    /**
+     * Output points of the best matching group that don't belong to each reference 
+     * group.
+     */
+    vector< vector<float> >* m_falseSegmentedVertices;
+};
+
 WGroupValidator::WGroupValidator()
 {
     m_groupInfo = new vector<WGroupInfo*>();
@@ -141,33 +222,71 @@ void WGroupValidator::validateGroups(
     m_validatedGroups = m_validatedPoints->getGroups();
 
 
-    setProgressSettings( m_referenceGroupEditor.getLastGroupID() );
-    for( size_t refGroup = 0; refGroup <= m_referenceGroupEditor.getLastGroupID(); refGroup++ )
+    size_t referenceGroupCount = m_referenceGroupEditor.getLastGroupID() + 1;
+    size_t validatedGroupCount = 0;
+    for( size_t index = 0; index < m_validatedGroups->size(); index++ )
+        if( m_validatedGroups->at( index ) >= validatedGroupCount )
+            validatedGroupCount = m_validatedGroups->at( index ) + 1;
+    bucketPointsByGroup( m_referenceGroups, referenceGroupCount, &m_referenceGroupOffsets, &m_referenceGroupPoints );
+    bucketPointsByGroup( m_validatedGroups, validatedGroupCount, &m_validatedGroupOffsets, &m_validatedGroupPoints );
+    if( m_validatedVertices->size() > 0 )
     {
-        boost::shared_ptr< WDataSetPoints > referenceGroup = getPointsOfGroup( m_referencePoints, refGroup );
-        size_t bestGroupIDInValidated = getBestMatchingGroupID( referenceGroup );
-        validateGroup( refGroup, bestGroupIDInValidated );
+        boost::shared_ptr< WDataSetPoints > validatedPoints( new WDataSetPoints( m_validatedVertices, m_validatedColors ) );
+        m_validatedPointSearcher.initSubtraction( validatedPoints, m_coordinateAccuracy );
+    }
+    else
+    {
+        m_validatedPointSearcher.initSubtraction( boost::shared_ptr< WDataSetPoints >(), m_coordinateAccuracy );
+    }
 
-        m_progressStatus->increment( 1 );
+    for( size_t refGroup = 0; refGroup < referenceGroupCount; refGroup++ )
+        m_groupInfo->push_back( new WGroupInfo() );
+    vector< vector<float> > groupMissingAreaVertices( referenceGroupCount );
+    vector< vector<float> > groupCorrectVertices( referenceGroupCount );
+    vector< vector<float> > groupFalseVertices( referenceGroupCount );
+    setProgressSettings( m_referenceGroupEditor.getLastGroupID() );
+    WGroupValidationTask task( this, m_progressStatus, &groupMissingAreaVertices, &groupCorrectVertices, &groupFalseVertices );
+    WThreadPool::getSharedPool()->parallelFor( &task, referenceGroupCount, 1 );
+
+    for( size_t refGroup = 0; refGroup < referenceGroupCount; refGroup++ )
+    {
+        for( size_t index = 0; index < groupMissingAreaVertices[refGroup].size() / 3; index++ )
+        {
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+                m_pointsOfNotSegmentedAreasVertices->push_back( groupMissingAreaVertices[refGroup][index * 3 + dimension] );
+            m_pointsOfNotSegmentedAreasColors->push_back( 0.65 );
+            m_pointsOfNotSegmentedAreasColors->push_back( 0.0 );
+            m_pointsOfNotSegmentedAreasColors->push_back( 1.0 );
+        }
+        for( size_t index = 0; index < groupCorrectVertices[refGroup].size(); index++ )
+        {
+            m_correctlySegmentedVertices->push_back( groupCorrectVertices[refGroup][index] );
+            m_correctlySegmentedColors->push_back( 1.0 );
+        }
+        for( size_t index = 0; index < groupFalseVertices[refGroup].size() / 3; index++ )
+        {
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+                m_falseSegmentedVertices->push_back( groupFalseVertices[refGroup][index * 3 + dimension] );
+            m_falseSegmentedColors->push_back( 1.0 );
+            m_falseSegmentedColors->push_back( 0.0 );
+            m_falseSegmentedColors->push_back( 0.0 );
+        }
     }
 
     identifyNotSegmentedGroupPoints();
     m_progressStatus->finish();
 }
 
-
-
-
-
-void WGroupValidator::validateGroup( size_t referenceGroupID, size_t validatedGroupID )
+void WGroupValidator::validateGroup( size_t referenceGroupID, vector<float>* missingAreaVertices,
+        vector<float>* correctlySegmentedVertices, vector<float>* falseSegmentedVertices )
 {
-    cout << "WGroupValidator::validateGroup() - " << referenceGroupID << ", " << validatedGroupID << endl;
-    boost::shared_ptr< WDataSetPoints > referenceGroup = getPointsOfGroup( m_referencePoints, referenceGroupID );
+    boost::shared_ptr< WDataSetPoints > referenceGroup = getPointsOfGroup( m_referencePoints,
+            m_referenceGroupOffsets, m_referenceGroupPoints, referenceGroupID );
+    size_t validatedGroupID = getBestMatchingGroupID( referenceGroup );
     WDataSetPoints::VertexArray referenceVertices = referenceGroup->getVertices();
-    WDataSetPoints::ColorArray referenceColors = referenceGroup->getColors();
-    boost::shared_ptr< WDataSetPoints > validatedGroup = getPointsOfGroup( m_validatedPoints, validatedGroupID );
+    boost::shared_ptr< WDataSetPoints > validatedGroup = getPointsOfGroup( m_validatedPoints,
+            m_validatedGroupOffsets, m_validatedGroupPoints, validatedGroupID );
     WDataSetPoints::VertexArray validatedVertices = validatedGroup->getVertices();
-    WDataSetPoints::ColorArray validatedColors = validatedGroup->getColors();
 
     WPointSubtactionHelper referenceSearcher;
     referenceSearcher.initSubtraction( referenceGroup, m_coordinateAccuracy );
@@ -176,47 +295,32 @@ void WGroupValidator::validateGroup( size_t referenceGroupID, size_t validatedGr
     WPointSubtactionHelper validatedAreaSearcher;
     validatedAreaSearcher.initSubtraction( validatedGroup, m_pointAreaRadius * 2.0 );
 
-    cout << "WGroupValidator::validateGroup() - Calculating completeness";
     size_t completenessPointCount = 0;
     size_t pointCountOfMissingAreas = 0;
+    vector<bool> refHitsValidatedArea = validatedAreaSearcher.pointsExistNearCoordinates( *referenceVertices );
+    vector<bool> refHitsValidatedPoint = validatedSearcher.pointsExistNearCoordinates( *referenceVertices );
     for( size_t index = 0; index < referenceVertices->size() / 3; index++ )
     {
-        vector<double> refCoord = WVectorMaths::new3dVector( referenceVertices->at( index * 3 + 0 ),
-                referenceVertices->at( index * 3 + 1 ), referenceVertices->at( index * 3 + 2 ) );
-
-        if( !validatedAreaSearcher.pointsExistNearCoordinate( refCoord ) )
+        if( !refHitsValidatedArea[index] )
         {
             pointCountOfMissingAreas++;
             for( size_t dimension = 0; dimension < 3; dimension++ )
-                m_pointsOfNotSegmentedAreasVertices->push_back( referenceVertices->at( index * 3 + dimension ) );
-            m_pointsOfNotSegmentedAreasColors->push_back( 0.65 );
-            m_pointsOfNotSegmentedAreasColors->push_back( 0.0 );
-            m_pointsOfNotSegmentedAreasColors->push_back( 1.0 );
+                missingAreaVertices->push_back( referenceVertices->at( index * 3 + dimension ) );
         }
-        if( validatedSearcher.pointsExistNearCoordinate( refCoord ) )
+        if( refHitsValidatedPoint[index] )
         {
             completenessPointCount++;
-
             for( size_t dimension = 0; dimension < 3; dimension++ )
-            {
-                m_correctlySegmentedVertices->push_back( referenceVertices->at( index * 3 + dimension ) );
-                m_correctlySegmentedColors->push_back( 1.0 );
-            }
+                correctlySegmentedVertices->push_back( referenceVertices->at( index * 3 + dimension ) );
         }
     }
 
-    cout << "WGroupValidator::validateGroup() - Calculating correctness";
     size_t uncorrectPoints = 0;
+    vector<bool> validatedHitsReference = referenceSearcher.pointsExistNearCoordinates( *validatedVertices );
     for( size_t index = 0; index < validatedVertices->size() / 3; index++ )
-    {
-        vector<double> validatedCoord = WVectorMaths::new3dVector( validatedVertices->at( index * 3 + 0 ),
-                validatedVertices->at( index * 3 + 1 ), validatedVertices->at( index * 3 + 2 ) );
-        if( !referenceSearcher.pointsExistNearCoordinate( validatedCoord ) )
+        if( !validatedHitsReference[index] )
             uncorrectPoints++;
-    }
 
-    while( m_groupInfo->size() <= referenceGroupID )
-        m_groupInfo->push_back( new WGroupInfo() );
     WGroupInfo* newGroup = m_groupInfo->at( referenceGroupID );
     newGroup->setReferenceGroupID( referenceGroupID );
     newGroup->setValidatedGroupID( validatedGroupID );
@@ -231,18 +335,9 @@ void WGroupValidator::validateGroup( size_t referenceGroupID, size_t validatedGr
 
     if( newGroup->isCertainlyDetected() )
         for( size_t index = 0; index < validatedVertices->size() / 3; index++ )
-        {
-            vector<double> validatedCoord = WVectorMaths::new3dVector( validatedVertices->at( index * 3 + 0 ),
-                    validatedVertices->at( index * 3 + 1 ), validatedVertices->at( index * 3 + 2 ) );
-            if( !referenceSearcher.pointsExistNearCoordinate( validatedCoord ) )
-            {
+            if( !validatedHitsReference[index] )
                 for( size_t dimension = 0; dimension < 3; dimension++ )
-                    m_falseSegmentedVertices->push_back( validatedVertices->at( index * 3 + dimension ) );
-                m_falseSegmentedColors->push_back( 1.0 );
-                m_falseSegmentedColors->push_back( 0.0 );
-                m_falseSegmentedColors->push_back( 0.0 );
-            }
-        }
+                    falseSegmentedVertices->push_back( validatedVertices->at( index * 3 + dimension ) );
 }
 
 void WGroupValidator::identifyNotSegmentedGroupPoints()
@@ -269,15 +364,15 @@ void WGroupValidator::identifyNotSegmentedGroupPoints()
     WDataSetPoints::ColorArray notDetectedColors( new WDataSetPoints::ColorArray::element_type() );
     m_notSegmentedPointsColors = notDetectedColors;
 
+    vector<bool> refHitsCorrectlySegmentedPoint( m_referenceVertices->size() / 3, false );
+    if( m_correctlySegmentedVertices->size() > 0 )
+        refHitsCorrectlySegmentedPoint = correctlyDetected.pointsExistNearCoordinates( *m_referenceVertices );
+    vector<bool> refHitsNotCorrectlySegmentedPoint( m_referenceVertices->size() / 3, false );
+    if( m_falseSegmentedVertices->size() > 0 )
+        refHitsNotCorrectlySegmentedPoint = wronglyDetected.pointsExistNearCoordinates( *m_referenceVertices );
     for( size_t index = 0; index < m_referenceVertices->size() / 3; index++ )
     {
-        vector<double> refCoord = WVectorMaths::new3dVector( m_referenceVertices->at( index * 3 + 0 ),
-                m_referenceVertices->at( index * 3 + 1 ), m_referenceVertices->at( index * 3 + 2 ) );
-        bool refHitsCorrectlySegmentedPoint = m_correctlySegmentedVertices->size() > 0
-                && correctlyDetected.pointsExistNearCoordinate( refCoord );
-        bool refHitsNotCorrectlySegmentedPoint = m_falseSegmentedVertices->size() > 0
-                && wronglyDetected.pointsExistNearCoordinate( refCoord );
-        if( !refHitsCorrectlySegmentedPoint && !refHitsNotCorrectlySegmentedPoint )
+        if( !refHitsCorrectlySegmentedPoint[index] && !refHitsNotCorrectlySegmentedPoint[index] )
         {
             for( size_t dimension = 0; dimension < 3; dimension++ )
                 m_notSegmentedPointsVertices->push_back( m_referenceVertices->at( index * 3 + dimension ) );
@@ -290,89 +385,82 @@ void WGroupValidator::identifyNotSegmentedGroupPoints()
 
 size_t WGroupValidator::getBestMatchingGroupID( boost::shared_ptr< WDataSetPoints > referenceGroup )
 {
-    WDataSetPointsGrouped::VertexArray validatedVerts(
-            new WDataSetPointsGrouped::VertexArray::element_type() );
-    WDataSetPointsGrouped::ColorArray validatedColors(
-            new WDataSetPointsGrouped::ColorArray::element_type() );
-    WDataSetPointsGrouped::GroupArray validatedGroups(
-            new WDataSetPointsGrouped::GroupArray::element_type() );
-
-    WPointSubtactionHelper referencePoints;
-    referencePoints.initSubtraction( referenceGroup, m_coordinateAccuracy );
-
-    for( size_t index = 0; index < m_validatedVertices->size() / 3; index++ )
+    WDataSetPoints::VertexArray referenceVertices = referenceGroup->getVertices();
+    vector<size_t> validatedPoints;
+    for( size_t index = 0; index < referenceVertices->size() / 3; index++ )
+        m_validatedPointSearcher.fetchPointsNearCoordinate( referenceVertices->at( index * 3 ),
+                referenceVertices->at( index * 3 + 1 ), referenceVertices->at( index * 3 + 2 ), &validatedPoints );
+    if( validatedPoints.size() == 0 )
+        return 0;
+
+    std::sort( validatedPoints.begin(), validatedPoints.end() );
+    validatedPoints.erase( std::unique( validatedPoints.begin(), validatedPoints.end() ), validatedPoints.end() );
+    vector<size_t> validatedGroups( validatedPoints.size() );
+    for( size_t index = 0; index < validatedPoints.size(); index++ )
+        validatedGroups[index] = m_validatedGroups->at( validatedPoints[index] );
+    std::sort( validatedGroups.begin(), validatedGroups.end() );
+
+    size_t biggestGroup = 0;
+    size_t maxGroupSize = 0;
+    for( size_t begin = 0, end = 0; begin < validatedGroups.size(); begin = end )
     {
-        vector<double> coordinate = WVectorMaths::new3dVector( m_validatedVertices->at( index * 3 + 0 ),
-                m_validatedVertices->at( index * 3 + 1 ), m_validatedVertices->at( index * 3 + 2 ) );
-        if( referencePoints.pointsExistNearCoordinate( coordinate ) )
+        while( end < validatedGroups.size() && validatedGroups[end] == validatedGroups[begin] )
+            end++;
+        if( end - begin > maxGroupSize )
         {
-            for( size_t dimension = 0; dimension < 3; dimension++ )
-            {
-                validatedVerts->push_back( m_validatedVertices->at( index * 3 + dimension ) );
-                validatedColors->push_back( m_validatedColors->at( index * 3 + dimension ) );
-            }
-            validatedGroups->push_back( m_validatedGroups->at( index ) );
+            biggestGroup = validatedGroups[begin];
+            maxGroupSize = end - begin;
         }
     }
-
-    if( validatedVerts->size() > 0 )
-    {
-        boost::shared_ptr< WDataSetPointsGrouped > validatedPoints(
-                new WDataSetPointsGrouped( validatedVerts, validatedColors, validatedGroups ) );
-        WGroupEdit groupEdit;
-        groupEdit.initProocessBegin();
-        groupEdit.setMergeGroups( false );
-        groupEdit.setGroupSizeThreshold( 0 );
-        groupEdit.mergeGroupSet( validatedPoints );
-        size_t biggestGroup = 0;
-        size_t maxGroupSize = 0;
-
-        for( size_t groupID = 0; groupID <= groupEdit.getLastGroupID(); groupID++ )
-            if( groupID == 0 || groupEdit.getGroupSize( groupID ) > maxGroupSize)
-            {
-                biggestGroup = groupID;
-                maxGroupSize = groupEdit.getGroupSize( groupID );
-            }
-        return biggestGroup;
-    }
-    return 0;
+    return biggestGroup;
 }
 
-boost::shared_ptr< WDataSetPoints > WGroupValidator::getPointsOfGroup(
-        boost::shared_ptr< WDataSetPointsGrouped > groupedPoints, size_t groupID )
+boost::shared_ptr< WDataSetPoints > WGroupValidator::getPointsOfGroup( boost::shared_ptr< WDataSetPointsGrouped > groupedPoints,
+        const vector<size_t>& groupOffsets, const vector<size_t>& groupPoints, size_t groupID )
 {
+    if( groupID + 1 >= groupOffsets.size() || groupOffsets[groupID] == groupOffsets[groupID + 1] )
+        return getEmptyShowablePointSet();
+
     WDataSetPointsGrouped::VertexArray origVertices = groupedPoints->getVertices();
     WDataSetPointsGrouped::ColorArray origColors = groupedPoints->getColors();
-    WDataSetPointsGrouped::GroupArray origGroups = groupedPoints->getGroups();
 
     WDataSetPoints::VertexArray newVertices(
             new WDataSetPointsGrouped::VertexArray::element_type() );
     WDataSetPoints::ColorArray newColors(
             new WDataSetPointsGrouped::ColorArray::element_type() );
+    newVertices->reserve( ( groupOffsets[groupID + 1] - groupOffsets[groupID] ) * 3 );
+    newColors->reserve( ( groupOffsets[groupID + 1] - groupOffsets[groupID] ) * 3 );
 
-    for( size_t index = 0; index < origVertices->size() / 3; index++ )
+    for( size_t position = groupOffsets[groupID]; position < groupOffsets[groupID + 1]; position++ )
     {
-        if( origGroups->at( index ) == groupID )
+        size_t index = groupPoints[position];
+        for( size_t dimension = 0; dimension < 3; dimension++ )
         {
-            for( size_t dimension = 0; dimension < 3; dimension++ )
-            {
-                newVertices->push_back( origVertices->at( index * 3 + dimension ) );
-                newColors->push_back( origColors->at( index * 3 + dimension ) );
-            }
+            newVertices->push_back( origVertices->at( index * 3 + dimension ) );
+            newColors->push_back( origColors->at( index * 3 + dimension ) );
         }
     }
 
-    if( newVertices->size() > 0 )
-    {
-        boost::shared_ptr< WDataSetPoints > outputPoints(
-                new WDataSetPoints( newVertices, newColors ) );
-        return outputPoints;
-    }
-    else
-    {
-        boost::shared_ptr< WDataSetPoints > outputPoints = getEmptyShowablePointSet();
-        return outputPoints;
-    }
+    boost::shared_ptr< WDataSetPoints > outputPoints(
+            new WDataSetPoints( newVertices, newColors ) );
+    return outputPoints;
+}
+
+void WGroupValidator::bucketPointsByGroup( WDataSetPointsGrouped::GroupArray groups, size_t groupCount,
+        vector<size_t>* groupOffsets, vector<size_t>* groupPoints )
+{
+    groupOffsets->assign( groupCount + 1, 0 );
+    for( size_t index = 0; index < groups->size(); index++ )
+        if( groups->at( index ) < groupCount )
+            ( *groupOffsets )[groups->at( index ) + 1]++;
+    for( size_t group = 0; group < groupCount; group++ )
+        ( *groupOffsets )[group + 1] += ( *groupOffsets )[group];
+
+    vector<size_t> groupPositions( groupOffsets->begin(), groupOffsets->end() - 1 );
+    groupPoints->resize( ( *groupOffsets )[groupCount] );
+    for( size_t index = 0; index < groups->size(); index++ )
+        if( groups->at( index ) < groupCount )
+            ( *groupPoints )[groupPositions[groups->at( index )]++] = index;
 }
 
 boost::shared_ptr< WDataSetPoints > WGroupValidator::getEmptyShowablePointSet()
@@ -104,7 +104,9 @@ public:
     void setPointAreaRadius( double pointAreaRadius );
 
     /**
-     * Starts to validate groups using a reference point group set.
+     * Starts to validate groups using a reference point group set. The points of both 
+     * sets are bucketed by their group ID once. Afterwards the reference groups are 
+     * validated in parallel.
      * \param referenceGroups REference group set that is probably a hand segmented.
      * \param validatedGroups Groups that are segmented by an algorithm to be evaluated.
      */
@@ -175,16 +177,22 @@ public:
      */
     void setProgressSettings( size_t referenceGroupCount );
 
-
-private:
     /**
-     * Validates a single group using a reference point group set.
+     * Validates a single group using a reference point group set. It is called by 
+     * validateGroups() for different reference groups concurrently.
      * \param referenceGroupID Reference group to be verefied for completeness.
-     * \param validatedGroupID Best matching group of the reference group to be 
-     *                         evaluated.
+     * \param missingAreaVertices Output reference points of areas that are not 
+     *                            segmented by the best matching group.
+     * \param correctlySegmentedVertices Output reference points that are segmented by 
+     *                                   the best matching group.
+     * \param falseSegmentedVertices Output points of the best matching group that don't 
+     *                               belong to the reference group.
      */
-    void validateGroup( size_t referenceGroupID, size_t validatedGroupID );
+    void validateGroup( size_t referenceGroupID, vector<float>* missingAreaVertices,
+            vector<float>* correctlySegmentedVertices, vector<float>* falseSegmentedVertices );
+
 
+private:
     /**
      * Identifies points of reference groups that were not detected by groups to be 
      * validated. Validated groups are left out if they were not fit to a reference 
@@ -203,11 +211,26 @@ private:
     /**
      * Returns all points of any entire group.
      * \param groupedPoints Point group set to where to look for a group
+     * \param groupOffsets Position of each group's first point within groupPoints. 
+     *                     See bucketPointsByGroup().
+     * \param groupPoints Point indices ordered by their group.
      * \param groupID Desired point group ID.
      * \return desired group points.
      */
-    static boost::shared_ptr< WDataSetPoints > getPointsOfGroup(
-            boost::shared_ptr< WDataSetPointsGrouped > groupedPoints, size_t groupID );
+    static boost::shared_ptr< WDataSetPoints > getPointsOfGroup( boost::shared_ptr< WDataSetPointsGrouped > groupedPoints,
+            const vector<size_t>& groupOffsets, const vector<size_t>& groupPoints, size_t groupID );
+
+    /**
+     * Lists the points of each group one after another using a counting sort. Points 
+     * of a group keep their order.
+     * \param groups Group ID of each point.
+     * \param groupCount Count of group IDs. Points of larger IDs are left out.
+     * \param groupOffsets Output position of each group's first point within 
+     *                     groupPoints. An additional last entry holds the list size.
+     * \param groupPoints Output point indices ordered by their group.
+     */
+    static void bucketPointsByGroup( WDataSetPointsGrouped::GroupArray groups, size_t groupCount,
+            vector<size_t>* groupOffsets, vector<size_t>* groupPoints );
 
     /**
      * We still MUST create point sets wit at least one point. Complete OpenWalnut 
@@ -266,6 +289,17 @@ private:
      */
     WDataSetPointsGrouped::GroupArray m_referenceGroups;
 
+    /**
+     * Position of each reference group's first point within m_referenceGroupPoints. An 
+     * additional last entry holds the point count.
+     */
+    vector<size_t> m_referenceGroupOffsets;
+
+    /**
+     * Reference point indices ordered by their group.
+     */
+    vector<size_t> m_referenceGroupPoints;
+
     /**
      * Grouped dataset points of the group to be validated.
      */
@@ -286,6 +320,22 @@ private:
      */
     WDataSetPointsGrouped::GroupArray m_validatedGroups;
 
+    /**
+     * Position of each validated group's first point within m_validatedGroupPoints. An 
+     * additional last entry holds the point count.
+     */
+    vector<size_t> m_validatedGroupOffsets;
+
+    /**
+     * Validated point indices ordered by their group.
+     */
+    vector<size_t> m_validatedGroupPoints;
+
+    /**
+     * Finds all validated points near reference points by the coordinate accuracy.
+     */
+    WPointSubtactionHelper m_validatedPointSearcher;
+
 
     /**
      * Vertices of points to be validated that were segmented corresponding to reference 
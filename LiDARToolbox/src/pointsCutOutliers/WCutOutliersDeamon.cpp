@@ -22,12 +22,273 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
 #include "WCutOutliersDeamon.h"
-#include "../common/datastructures/octree/WOctNode.h"
-#include "../common/datastructures/octree/WOctree.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
+#include "../common/datastructures/octree/WLinearOctree.h"
+#include "../common/datastructures/unionFind/WUnionFind.h"
+
+const size_t WCutOutliersDeamon::compactionChunkSize = 65536;
+
+/**
+ * Thread pool task of the in-memory outlier cut. Each item is a chunk of 
+ * WCutOutliersDeamon::compactionChunkSize points. The first pass counts the points of 
+ * each chunk that belong to the largest group. The second pass copies them to the 
+ * output offset of their chunk. So the points keep their order.
+ */
+class WCutOutliersCompactionTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param octree Octree which leafs are already grouped.
+     * \param largestGroup Group whose points are kept.
+     * \param pointCount Count of input points.
+     * \param chunkKeptCounts Count of kept points of each chunk. It is filled by the 
+     *                        first pass.
+     */
+    WCutOutliersCompactionTask( WLinearOctree* octree, size_t largestGroup, size_t pointCount, vector<size_t>* chunkKeptCounts )
+    {
+        m_octree = octree;
+        m_largestGroup = largestGroup;
+        m_pointCount = pointCount;
+        m_chunkKeptCounts = chunkKeptCounts;
+        m_chunkOffsets = 0;
+        m_vertices = 0;
+        m_colors = 0;
+        m_outVertices = 0;
+        m_outColors = 0;
+    }
+
+    /**
+     * Switches the task to the copying pass.
+     * \param chunkOffsets Output point offset of each chunk.
+     * \param vertices Input vertices.
+     * \param colors Input colors.
+     * \param outVertices Output vertices that are already sized for the kept points.
+     * \param outColors Output colors that are already sized for the kept points.
+     */
+    void setCopyPass( const vector<size_t>* chunkOffsets, const vector<float>* vertices, const vector<float>* colors,
+            vector<float>* outVertices, vector<float>* outColors )
+    {
+        m_chunkOffsets = chunkOffsets;
+        m_vertices = vertices;
+        m_colors = colors;
+        m_outVertices = outVertices;
+        m_outColors = outColors;
+    }
+
+    /**
+     * Counts or copies the kept points of a range of chunks.
+     * \param begin First chunk.
+     * \param end Chunk after the last one.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t chunk = begin; chunk < end; chunk++ )
+        {
+            size_t pointsBegin = chunk * WCutOutliersDeamon::compactionChunkSize;
+            size_t pointsEnd = std::min( pointsBegin + WCutOutliersDeamon::compactionChunkSize, m_pointCount );
+            if( m_chunkOffsets == 0 )
+            {
+                size_t keptCount = 0;
+                for( size_t point = pointsBegin; point < pointsEnd; point++ )
+                    if( isKept( point ) )
+                        keptCount++;
+                ( *m_chunkKeptCounts )[chunk] = keptCount;
+                continue;
+            }
+            size_t target = ( *m_chunkOffsets )[chunk] * 3;
+            for( size_t point = pointsBegin; point < pointsEnd; point++ )
+            {
+                if( !isKept( point ) )
+                    continue;
+                for( size_t item = 0; item < 3; item++ )
+                {
+                    ( *m_outVertices )[target + item] = ( *m_vertices )[point * 3 + item];
+                    ( *m_outColors )[target + item] = ( *m_colors )[point * 3 + item];
+                }
+                target += 3;
+            }
+        }
+    }
+
+private:
+    /**
+     * Tells whether a point belongs to the largest group.
+     * \param point Index of the input point.
+     * \return The point is kept or not.
+     */
+    bool isKept( size_t point )
+    {
+        return m_octree->getGroupNr( m_octree->getPointLeaf( point ) ) == m_largestGroup;
+    }
+
+    /**
+     * Octree which leafs are already grouped.
+     */
+    WLinearOctree* m_octree;
+
+    /**
+     * Group whose points are kept.
+     */
+    size_t m_largestGroup;
+
+    /**
+     * Count of input points.
+     */
+    size_t m_pointCount;
+
+    /**
+     * Count of kept points of each chunk.
+     */
+    vector<size_t>* m_chunkKeptCounts;
+
+    /**
+     * Output point offset of each chunk. It is null during the counting pass.
+     */
+    const vector<size_t>* m_chunkOffsets;
+
+    /**
+     * Input vertices.
+     */
+    const vector<float>* m_vertices;
+
+    /**
+     * Input colors.
+     */
+    const vector<float>* m_colors;
+
+    /**
+     * Output vertices.
+     */
+    vector<float>* m_outVertices;
+
+    /**
+     * Output colors.
+     */
+    vector<float>* m_outColors;
+};
+
+/**
+ * Grouped voxels of a single tile of a point tile store. The points of the tile and 
+ * a margin of two voxels around it are grouped by a WLinearOctree. A voxel is owned 
+ * by the tile that contains its center. So all points and neighbors of the owned 
+ * voxels are known. A group without foreign voxels is complete. Other groups continue 
+ * in neighbor tiles.
+ */
+class WCutOutliersTile
+{
+public:
+    /**
+     * Fetches and groups the points of a tile.
+     * \param store Tile store that contains the points.
+     * \param column Tile column.
+     * \param row Tile row.
+     * \param detailDepth Voxel radius.
+     */
+    WCutOutliersTile( WPointTileStore* store, boost::int64_t column, boost::int64_t row, double detailDepth ) :
+        m_octree( detailDepth )
+    {
+        double tileSize = store->getTileSize();
+        double margin = detailDepth * 4.0;
+        double minX = static_cast<double>( column ) * tileSize;
+        double minY = static_cast<double>( row ) * tileSize;
+        m_isFetched = store->fetchRegion( minX - margin, minY - margin, minX + tileSize + margin, minY + tileSize + margin,
+                &m_vertices, &m_colors, &m_indices );
+        if( m_indices.empty() )
+            return;
+        m_octree.buildFromPoints( m_vertices );
+        m_octree.groupNeighbourLeafs();
+
+        double borderWidth = detailDepth * 6.0;
+        size_t groupCount = m_octree.getGroupCount();
+        m_groupLeafCounts.assign( groupCount, 0 );
+        m_groupMinKeys.assign( groupCount, std::numeric_limits<boost::uint64_t>::max() );
+        m_groupHasForeignLeafs.assign( groupCount, false );
+        m_isOwnedLeaf.assign( m_octree.getLeafCount(), false );
+        m_isBorderLeaf.assign( m_octree.getLeafCount(), false );
+        for( size_t leaf = 0; leaf < m_octree.getLeafCount(); leaf++ )
+        {
+            size_t group = m_octree.getGroupNr( leaf );
+            double centerX = m_octree.getLeafCenter( leaf, 0 );
+            double centerY = m_octree.getLeafCenter( leaf, 1 );
+            m_isOwnedLeaf[leaf] = store->getTileCoordinate( centerX ) == column && store->getTileCoordinate( centerY ) == row;
+            if( !m_isOwnedLeaf[leaf] )
+            {
+                m_groupHasForeignLeafs[group] = true;
+                continue;
+            }
+            m_isBorderLeaf[leaf] = centerX < minX + borderWidth || centerX > minX + tileSize - borderWidth
+                    || centerY < minY + borderWidth || centerY > minY + tileSize - borderWidth;
+            m_groupLeafCounts[group]++;
+            if( m_octree.getLeafKey( leaf ) < m_groupMinKeys[group] )
+                m_groupMinKeys[group] = m_octree.getLeafKey( leaf );
+        }
+    }
+
+    /**
+     * Octree that groups the points.
+     */
+    WLinearOctree m_octree;
+
+    /**
+     * Points of the tile and its margin.
+     */
+    vector<float> m_vertices;
+
+    /**
+     * Colors of the points.
+     */
+    vector<float> m_colors;
+
+    /**
+     * Indices of the points within the whole point sequence.
+     */
+    vector<boost::uint64_t> m_indices;
+
+    /**
+     * All points of the tile and its margin could be read or not.
+     */
+    bool m_isFetched;
+
+    /**
+     * Count of owned voxels of each group.
+     */
+    vector<size_t> m_groupLeafCounts;
+
+    /**
+     * Smallest key of the owned voxels of each group.
+     */
+    vector<boost::uint64_t> m_groupMinKeys;
+
+    /**
+     * Flag of each group whether it contains voxels of other tiles.
+     */
+    vector<bool> m_groupHasForeignLeafs;
+
+    /**
+     * Flag of each voxel whether it is owned by the tile.
+     */
+    vector<bool> m_isOwnedLeaf;
+
+    /**
+     * Flag of each owned voxel whether it is near enough to the tile border to be 
+     * fetched by neighbor tiles.
+     */
+    vector<bool> m_isBorderLeaf;
+};
 
 WCutOutliersDeamon::WCutOutliersDeamon()
 {
@@ -43,19 +304,11 @@ boost::shared_ptr< WDataSetPoints > WCutOutliersDeamon::cutOutliers( boost::shar
     WDataSetPoints::VertexArray verts = points->getVertices();
     WDataSetPoints::ColorArray colors = points->getColors();
     size_t count = verts->size()/3;
-    WOctree* octree = new WOctree( m_detailDepth );
-
-    for  ( size_t vertex = 0; vertex < count; vertex++)
-    {
-        double x = verts->at( vertex*3 );
-        double y = verts->at( vertex*3+1 );
-        double z = verts->at( vertex*3+2 );
-        octree->registerPoint( x, y, z );
-    }
-    octree->groupNeighbourLeafsFromRoot();
+    WLinearOctree octree( m_detailDepth );
+    octree.buildFromPoints( *verts );
+    octree.groupNeighbourLeafs();
 
-    resizeItemCountGroupList( 0 );
-    countGroups( octree->getRootNode() );
+    countGroups( &octree );
     size_t largestGroup = 0;
     size_t largestGroupNodeCount = 0;
     for( size_t index = 0; index < m_pointCounts.size(); index++ )
@@ -65,62 +318,154 @@ boost::shared_ptr< WDataSetPoints > WCutOutliersDeamon::cutOutliers( boost::shar
             largestGroupNodeCount = m_pointCounts[index];
         }
 
-    WDataSetPoints::VertexArray outVertices(
-            new WDataSetPoints::VertexArray::element_type() );
-    WDataSetPoints::ColorArray outColors(
-            new WDataSetPoints::ColorArray::element_type() );
+    size_t chunkCount = ( count + compactionChunkSize - 1 ) / compactionChunkSize;
+    vector<size_t> chunkKeptCounts( chunkCount, 0 );
+    WCutOutliersCompactionTask task( &octree, largestGroup, count, &chunkKeptCounts );
+    WThreadPool::getSharedPool()->parallelFor( &task, chunkCount, 1 );
 
-    for( size_t vertex = 0; vertex < count; vertex++ )
+    vector<size_t> chunkOffsets( chunkCount, 0 );
+    size_t keptCount = 0;
+    for( size_t chunk = 0; chunk < chunkCount; chunk++ )
     {
-        double x = verts->at( vertex*3 );
-        double y = verts->at( vertex*3+1 );
-        double z = verts->at( vertex*3+2 );
-        WOctNode* node = octree->getLeafNode( x, y, z );
-        if(node != 0 && node->getGroupNr() == largestGroup )
-        {
-            float r = colors->at( vertex*3 );
-            float g = colors->at( vertex*3+1 );
-            float b = colors->at( vertex*3+2 );
-            outVertices->push_back( x );
-            outVertices->push_back( y );
-            outVertices->push_back( z );
-            outColors->push_back( r );
-            outColors->push_back( g );
-            outColors->push_back( b );
-        }
+        chunkOffsets[chunk] = keptCount;
+        keptCount += chunkKeptCounts[chunk];
     }
 
+    WDataSetPoints::VertexArray outVertices(
+            new WDataSetPoints::VertexArray::element_type( keptCount * 3 ) );
+    WDataSetPoints::ColorArray outColors(
+            new WDataSetPoints::ColorArray::element_type( keptCount * 3 ) );
+    task.setCopyPass( &chunkOffsets, verts.get(), colors.get(), outVertices.get(), outColors.get() );
+    WThreadPool::getSharedPool()->parallelFor( &task, chunkCount, 1 );
+
     boost::shared_ptr< WDataSetPoints > outputPoints(
             new WDataSetPoints( outVertices, outColors ) );
     return outputPoints;
 }
 
-void WCutOutliersDeamon::countGroups( WOctNode* node )
+bool WCutOutliersDeamon::cutOutliers( WPointTileStore* inputStore, WPointTileStore* outputStore )
 {
-    if  ( node->getRadius() <= m_detailDepth )
+    boost::int64_t tileReach = static_cast<boost::int64_t>( ceil( m_detailDepth / inputStore->getTileSize() ) );
+    std::set< std::pair<boost::int64_t, boost::int64_t> > tiles;
+    for( size_t tile = 0; tile < inputStore->getTileCount(); tile++ )
+        for( boost::int64_t row = -tileReach; row <= tileReach; row++ )
+            for( boost::int64_t column = -tileReach; column <= tileReach; column++ )
+                tiles.insert( std::make_pair( inputStore->getTileRow( tile ) + row, inputStore->getTileColumn( tile ) + column ) );
+
+    const size_t noNode = std::numeric_limits<size_t>::max();
+    boost::unordered_map<boost::uint64_t, size_t> borderLeafNodes;
+    vector< std::pair<boost::uint64_t, size_t> > foreignLeafNodes;
+    vector<size_t> nodeLeafCounts;
+    vector<boost::uint64_t> nodeMinKeys;
+    size_t largestCount = 0;
+    boost::uint64_t largestMinKey = std::numeric_limits<boost::uint64_t>::max();
+    for( std::set< std::pair<boost::int64_t, boost::int64_t> >::iterator tile = tiles.begin(); tile != tiles.end(); tile++ )
     {
-        size_t groupNr = node->getGroupNr();
-        if( groupNr >= m_pointCounts.size() )
-            resizeItemCountGroupList( groupNr + 1 );
-        m_pointCounts[groupNr] = m_pointCounts[groupNr] + 1;
+        WCutOutliersTile groups( inputStore, tile->second, tile->first, m_detailDepth );
+        if( !groups.m_isFetched )
+            return false;
+        vector<size_t> groupNodes( groups.m_groupLeafCounts.size(), noNode );
+        for( size_t group = 0; group < groupNodes.size(); group++ )
+        {
+            size_t leafCount = groups.m_groupLeafCounts[group];
+            boost::uint64_t minKey = groups.m_groupMinKeys[group];
+            if( leafCount > 0 && groups.m_groupHasForeignLeafs[group] )
+            {
+                groupNodes[group] = nodeLeafCounts.size();
+                nodeLeafCounts.push_back( leafCount );
+                nodeMinKeys.push_back( minKey );
+            }
+            else if( leafCount > largestCount || ( leafCount == largestCount && leafCount > 0 && minKey < largestMinKey ) )
+            {
+                largestCount = leafCount;
+                largestMinKey = minKey;
+            }
+        }
+        for( size_t leaf = 0; leaf < groups.m_isOwnedLeaf.size(); leaf++ )
+        {
+            size_t node = groupNodes[groups.m_octree.getGroupNr( leaf )];
+            if( node == noNode )
+                continue;
+            if( !groups.m_isOwnedLeaf[leaf] )
+                foreignLeafNodes.push_back( std::make_pair( groups.m_octree.getLeafKey( leaf ), node ) );
+            else if( groups.m_isBorderLeaf[leaf] )
+                borderLeafNodes[groups.m_octree.getLeafKey( leaf )] = node;
+        }
     }
-    else
+
+    WUnionFind nodes( nodeLeafCounts.size() );
+    for( size_t index = 0; index < foreignLeafNodes.size(); index++ )
     {
-        for  ( int child = 0; child < 8; child++ )
-            if  ( node->getChild( child ) != 0 )
-                countGroups( node->getChild( child ) );
+        boost::unordered_map<boost::uint64_t, size_t>::iterator owner = borderLeafNodes.find( foreignLeafNodes[index].first );
+        if( owner != borderLeafNodes.end() )
+            nodes.unite( foreignLeafNodes[index].second, owner->second );
     }
-}
+    vector<size_t> rootLeafCounts( nodeLeafCounts.size(), 0 );
+    vector<boost::uint64_t> rootMinKeys( nodeLeafCounts.size(), std::numeric_limits<boost::uint64_t>::max() );
+    for( size_t node = 0; node < nodeLeafCounts.size(); node++ )
+    {
+        size_t root = nodes.find( node );
+        rootLeafCounts[root] += nodeLeafCounts[node];
+        rootMinKeys[root] = std::min( rootMinKeys[root], nodeMinKeys[node] );
+    }
+    size_t largestRoot = noNode;
+    for( size_t root = 0; root < rootLeafCounts.size(); root++ )
+        if( rootLeafCounts[root] > largestCount
+                || ( rootLeafCounts[root] == largestCount && rootLeafCounts[root] > 0 && rootMinKeys[root] < largestMinKey ) )
+        {
+            largestRoot = root;
+            largestCount = rootLeafCounts[root];
+            largestMinKey = rootMinKeys[root];
+        }
+
+    size_t nextNode = 0;
+    vector<float> outVertices;
+    vector<float> outColors;
+    vector<boost::uint64_t> outIndices;
+    for( std::set< std::pair<boost::int64_t, boost::int64_t> >::iterator tile = tiles.begin(); tile != tiles.end(); tile++ )
+    {
+        WCutOutliersTile groups( inputStore, tile->second, tile->first, m_detailDepth );
+        if( !groups.m_isFetched )
+            return false;
+        vector<bool> isInLargestGroup( groups.m_groupLeafCounts.size(), false );
+        for( size_t group = 0; group < isInLargestGroup.size(); group++ )
+        {
+            if( groups.m_groupLeafCounts[group] > 0 && groups.m_groupHasForeignLeafs[group] )
+                isInLargestGroup[group] = largestRoot != noNode && nodes.find( nextNode++ ) == largestRoot;
+            else
+                isInLargestGroup[group] = largestRoot == noNode && groups.m_groupLeafCounts[group] > 0
+                        && groups.m_groupMinKeys[group] == largestMinKey;
+        }
 
+        outVertices.clear();
+        outColors.clear();
+        outIndices.clear();
+        for( size_t leaf = 0; leaf < groups.m_isOwnedLeaf.size(); leaf++ )
+        {
+            if( !groups.m_isOwnedLeaf[leaf] || !isInLargestGroup[groups.m_octree.getGroupNr( leaf )] )
+                continue;
+            for( size_t position = groups.m_octree.getLeafPointsBegin( leaf );
+                    position < groups.m_octree.getLeafPointsEnd( leaf ); position++ )
+            {
+                size_t point = groups.m_octree.getPoint( position );
+                for( size_t item = 0; item < 3; item++ )
+                {
+                    outVertices.push_back( groups.m_vertices[point * 3 + item] );
+                    outColors.push_back( groups.m_colors[point * 3 + item] );
+                }
+                outIndices.push_back( groups.m_indices[point] );
+            }
+        }
+        outputStore->addPoints( outVertices, outColors, outIndices );
+    }
+    return true;
+}
 
-void WCutOutliersDeamon::resizeItemCountGroupList( size_t newSize )
+void WCutOutliersDeamon::countGroups( WLinearOctree* octree )
 {
-    size_t oldSize = m_pointCounts.size();
-    m_pointCounts.reserve( newSize );
-    m_pointCounts.resize( newSize );
-    if( newSize > oldSize )
-        for( size_t index = oldSize; index < newSize; index++)
-            m_pointCounts[index] = 0;
+    m_pointCounts.assign( octree->getGroupCount(), 0 );
+    for( size_t leaf = 0; leaf < octree->getLeafCount(); leaf++ )
+        m_pointCounts[octree->getGroupNr( leaf )]++;
 }
 
 void WCutOutliersDeamon::setDetailDepth( double detailDepth )
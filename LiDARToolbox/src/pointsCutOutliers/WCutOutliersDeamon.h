@@ -28,7 +28,8 @@
 #include <vector>
 #include "core/graphicsEngine/WTriangleMesh.h"
 #include "core/dataHandler/WDataSetPoints.h"
-#include "../common/datastructures/octree/WOctNode.h"
+#include "../common/datastructures/octree/WLinearOctree.h"
+#include "../common/datastructures/tileStore/WPointTileStore.h"
 
 /**
  * This is an outliers cut algorithm it simply groups all the points in cube groups. 
@@ -56,6 +57,20 @@ public:
     boost::shared_ptr< WDataSetPoints > cutOutliers(
             boost::shared_ptr< WDataSetPoints > points );
 
+    /**
+     * Cuts outliers of a point tile store tile by tile. Each tile is grouped together 
+     * with a margin of two voxels around it. Groups that reach other tiles are joined 
+     * over the tile borders afterwards. So only a tile and its neighborhood has to be 
+     * held in the memory. The remaining points equal the output of the in-memory 
+     * cutOutliers().
+     * \param inputStore Tile store whose outliers are cut.
+     * \param outputStore Tile store that was created for writing. It gets the remaining 
+     *                    points together with their index.
+     * \return All tiles of the input store could be read or not. The output is 
+     *         incomplete if not.
+     */
+    bool cutOutliers( WPointTileStore* inputStore, WPointTileStore* outputStore );
+
     /**
      * Sets the cube radius to determine cube neighborships. Not connected nodes are cut off.
      * \param detailDepth Cube radius in meters. Use only numbers that are in 2^n 
@@ -63,18 +78,18 @@ public:
      */
     void setDetailDepth( double detailDepth );
 
-private:
     /**
-     * Counts voxels of each group. The method traverses recursively.
-     * \param node Octree node to count voxels of each physically connected node group.
+     * Count of points of the in-memory cutOutliers() that are counted and copied by one 
+     * thread pool item.
      */
-    void countGroups( WOctNode* node );
+    static const size_t compactionChunkSize;
 
+private:
     /**
-     * Resizes the voxel group list representing corresponding voxel counts.
-     * \param newSize Target list length to apply.
+     * Counts voxels of each group.
+     * \param octree Octree which leafs are already grouped.
      */
-    void resizeItemCountGroupList( size_t newSize );
+    void countGroups( WLinearOctree* octree );
 
     /**
      * Cube width bin points into.
@@ -25,6 +25,7 @@
 #include <string>
 
 #include <fstream>
+#include <iostream>
 #include <vector>
 
 #include <osg/Geometry>
@@ -95,6 +96,17 @@ void WMPointsCutOutliers::properties()
                             "in meters for the octree search tree.", pow( 2.0, m_detailDepth->get() ) * 2.0 );
     m_detailDepthLabel->setPurpose( PV_PURPOSE_INFORMATION );
 
+    m_groupTileStore = m_properties->addPropertyGroup( "Tile store processor", "" );
+    m_inputStoreFile = m_groupTileStore->addProperty( "Input store: ", "Tile store whose outliers are cut tile by tile.",
+                            WPathHelper::getAppPath() );
+    WPropertyHelper::PC_PATHEXISTS::addTo( m_inputStoreFile );
+    m_outputStoreFile = m_groupTileStore->addProperty( "Output store: ", "Tile store that gets the remaining points. It should "
+                            "end with \"" + std::string( WPointTileStore::EXTENSION ) + "\".", WPathHelper::getAppPath() );
+    m_storeMemoryMB = m_groupTileStore->addProperty( "Memory [MB]: ", "Memory of the tile caches of both stores.", 512, m_propCondition );
+    m_storeMemoryMB->setMin( 2 );
+    m_cutStoreTrigger = m_groupTileStore->addProperty( "Cut store outliers:",  "Cut outliers",
+                            WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+
     WModule::properties();
 }
 
@@ -132,6 +144,7 @@ void WMPointsCutOutliers::moduleMain()
 
             m_progressStatus->finish();
         }
+        onStoreCutOutliers();
 
 
         // woke up since the module is requested to finish?
@@ -157,3 +170,28 @@ void WMPointsCutOutliers::setProgressSettings( size_t steps )
     m_progressStatus = boost::shared_ptr< WProgress >( new WProgress( headerText, steps ) );
     m_progress->addSubProgress( m_progressStatus );
 }
+
+void WMPointsCutOutliers::onStoreCutOutliers()
+{
+    if( !m_cutStoreTrigger->get( true ) )
+        return;
+    m_cutStoreTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+    size_t memoryBudget = static_cast<size_t>( m_storeMemoryMB->get() ) * 1024 * 1024;
+    WPointTileStore inputStore;
+    WPointTileStore outputStore;
+    if( !inputStore.open( m_inputStoreFile->get().c_str(), memoryBudget / 2 )
+            || !outputStore.create( m_outputStoreFile->get().c_str(), inputStore.getTileSize(), memoryBudget / 2 ) )
+    {
+        std::cout << "!!!Could not open the input or create the output tile store" << std::endl;
+        return;
+    }
+
+    setProgressSettings( 1 );
+    WCutOutliersDeamon groups = WCutOutliersDeamon();
+    groups.setDetailDepth( pow( 2.0, m_detailDepth->get() ) );
+    if( !groups.cutOutliers( &inputStore, &outputStore ) )
+        std::cout << "!!!Could not read the tile store " << m_inputStoreFile->get().c_str() << std::endl;
+    if( !outputStore.finishWriting() )
+        std::cout << "!!!Could not write the tile store " << m_outputStoreFile->get().c_str() << std::endl;
+    m_progressStatus->finish();
+}
@@ -144,6 +144,12 @@ private:
      */
     void setProgressSettings( size_t steps );
 
+    /**
+     * Cuts the outliers of the input tile store into the output tile store if the 
+     * store trigger is pressed.
+     */
+    void onStoreCutOutliers();
+
     /**
      * WDataSetPoints data input (proposed for LiDAR data).
      */
@@ -174,6 +180,31 @@ private:
      */
     WPropDouble m_detailDepthLabel;
 
+    /**
+     * Tile store settings group.
+     */
+    WPropGroup m_groupTileStore;
+
+    /**
+     * Tile store whose outliers are cut.
+     */
+    WPropFilename m_inputStoreFile;
+
+    /**
+     * Tile store that gets the remaining points.
+     */
+    WPropFilename m_outputStoreFile;
+
+    /**
+     * Megabytes that can be used by the caches of both tile stores.
+     */
+    WPropInt m_storeMemoryMB;
+
+    /**
+     * Button that triggers cutting the outliers of the input tile store.
+     */
+    WPropTrigger m_cutStoreTrigger;
+
     /**
      * Plugin progress status that is shared with the reader.
      */
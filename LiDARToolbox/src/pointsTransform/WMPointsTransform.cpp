@@ -29,6 +29,8 @@
 #include <vector>
 #include <limits>
 
+#include <boost/thread/mutex.hpp>
+
 #include <osg/Geometry>
 #include "core/kernel/WModule.h"
 
@@ -43,6 +45,325 @@
 #include "WMPointsTransform.xpm"
 #include "WMPointsTransform.h"
 #include "../common/datastructures/octree/WOctree.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
+
+/**
+ * Thread pool task that crops and transforms blocks of points. It runs twice: The 
+ * first run flags and counts the remaining points of each block. After prepareOutput() 
+ * the second run writes the remaining points of each block to their output position.
+ */
+class WPointsTransformTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param vertices Input vertices.
+     * \param colors Input colors.
+     * \param pointsExistNearSubtraction Flag of each input point whether it lies near 
+     *                                   a subtracted point.
+     * \param blockSize Count of points of a thread pool chunk.
+     * \param progress Progress status that is incremented by the writing run.
+     */
+    WPointsTransformTask( const vector<float>& vertices, const vector<float>& colors,
+            const vector<bool>& pointsExistNearSubtraction, size_t blockSize, boost::shared_ptr< WProgress > progress ) :
+        m_vertices( vertices ),
+        m_colors( colors ),
+        m_pointsExistNearSubtraction( pointsExistNearSubtraction ),
+        m_isRemaining( vertices.size() / 3, 0 ),
+        m_blockPointCounts( ( vertices.size() / 3 + blockSize - 1 ) / blockSize, 0 )
+    {
+        m_blockSize = blockSize;
+        m_progress = progress;
+        m_outVertices = 0;
+        m_outColors = 0;
+        m_outGroups = 0;
+        m_pointIndices = 0;
+        m_outIndices = 0;
+        m_colorMode = 0;
+        m_groupID = 0;
+    }
+
+    /**
+     * Sets which points remain.
+     * \param fromCoord Minimal coordinate of the crop area.
+     * \param toCoord Maximal coordinate of the crop area.
+     * \param invertCropping Points within the crop area are removed instead of kept.
+     * \param disableCrop Disables cropping.
+     * \param skipModulo Only each skipModulo-th point remains.
+     * \param invertSubtraction Keep the points near subtracted points instead of 
+     *                          removing them.
+     */
+    void setSelection( const vector<double>& fromCoord, const vector<double>& toCoord, bool invertCropping,
+            bool disableCrop, size_t skipModulo, bool invertSubtraction )
+    {
+        m_fromCoord = fromCoord;
+        m_toCoord = toCoord;
+        m_invertCropping = invertCropping;
+        m_disableCrop = disableCrop;
+        m_skipModulo = skipModulo;
+        m_invertSubtraction = invertSubtraction;
+    }
+
+    /**
+     * Sets how the remaining points are transformed.
+     * \param transform Coordinate transformation.
+     * \param contrast Factor of each color channel.
+     * \param colorOffset Offset that is added to each color channel.
+     * \param colorMode Colored or greyscale output (see M_COLOR_MODE_*).
+     * \param groupID Group ID of the output points.
+     */
+    void setTransform( const WAffineTransform& transform, const vector<double>& contrast,
+            const vector<double>& colorOffset, size_t colorMode, size_t groupID )
+    {
+        m_transform = transform;
+        m_contrast = contrast;
+        m_colorOffset = colorOffset;
+        m_colorMode = colorMode;
+        m_groupID = groupID;
+    }
+
+    /**
+     * Sets the indices of the input points within the whole point sequence. They are 
+     * used for skipping and copied to the output of the remaining points.
+     * \param pointIndices Index of each input point.
+     * \param outIndices Output indices. The indices of the remaining points are appended.
+     */
+    void setPointIndices( const vector<boost::uint64_t>* pointIndices, vector<boost::uint64_t>* outIndices )
+    {
+        m_pointIndices = pointIndices;
+        m_outIndices = outIndices;
+    }
+
+    /**
+     * Computes the output position of each block after the counting run. The writing 
+     * run is done by the next parallelFor() call.
+     * \param vertices Output vertices. The remaining points are appended.
+     * \param colors Output colors.
+     * \param groups Output group IDs.
+     */
+    void prepareOutput( vector<float>* vertices, vector<float>* colors, vector<size_t>* groups )
+    {
+        size_t position = groups->size();
+        m_blockOffsets.resize( m_blockPointCounts.size() );
+        for( size_t block = 0; block < m_blockPointCounts.size(); block++ )
+        {
+            m_blockOffsets[block] = position;
+            position += m_blockPointCounts[block];
+        }
+        vertices->resize( position * 3 );
+        colors->resize( position * 3 );
+        groups->resize( position );
+        if( m_pointIndices != 0 )
+            m_outIndices->resize( position );
+        m_outVertices = vertices;
+        m_outColors = colors;
+        m_outGroups = groups;
+    }
+
+    /**
+     * Counts or writes the remaining points of a block.
+     * \param begin First point of the block.
+     * \param end Point after the last one of the block.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        size_t block = begin / m_blockSize;
+        if( m_outVertices == 0 )
+        {
+            size_t count = 0;
+            for( size_t index = begin; index < end; index++ )
+            {
+                m_isRemaining[index] = isPointRemaining( index );
+                count += m_isRemaining[index];
+            }
+            m_blockPointCounts[block] = count;
+            return;
+        }
+
+        size_t firstPosition = m_blockOffsets[block];
+        size_t position = firstPosition;
+        for( size_t index = begin; index < end; index++ )
+        {
+            if( m_isRemaining[index] == 0 )
+                continue;
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+            {
+                ( *m_outVertices )[position * 3 + dimension] = m_vertices[index * 3 + dimension];
+                ( *m_outColors )[position * 3 + dimension] = m_colors[index * 3 + dimension];
+            }
+            if( m_pointIndices != 0 )
+                ( *m_outIndices )[position] = ( *m_pointIndices )[index];
+            position++;
+        }
+        if( position > firstPosition )
+            m_transform.transformPoints( &( *m_outVertices )[firstPosition * 3], position - firstPosition );
+
+        double color[3] = { 0.0, 0.0, 0.0 };
+        for( size_t index = firstPosition; index < position; index++ )
+        {
+            float* outColor = &( *m_outColors )[index * 3];
+            for( size_t item = 0; item < 3; item++ )
+                color[item] = outColor[item] * m_contrast[item] + m_colorOffset[item];
+            double intensity = m_colorMode == WMPointsTransform::M_COLOR_MODE_GREYSCALE_PERCEPTIONAL
+                    ?( color[0]*0.3 + color[1]*0.59 + color[2]*0.11 )
+                    :( ( color[0] + color[1] + color[2] ) / 3.0 );
+            for( size_t item = 0; item < 3; item++ )
+                outColor[item] = m_colorMode == WMPointsTransform::M_COLOR_MODE_COLORED ?color[item] :intensity;
+            ( *m_outGroups )[index] = m_groupID;
+        }
+
+        boost::mutex::scoped_lock lock( m_progressMutex );
+        m_progress->increment( end - begin );
+    }
+
+private:
+    /**
+     * Tells whether a point remains after cropping, skipping and subtraction.
+     * \param index Index of the input point.
+     * \return The point remains or not.
+     */
+    bool isPointRemaining( size_t index )
+    {
+        if( m_skipModulo > 1 && ( m_pointIndices == 0 ?index :( *m_pointIndices )[index] ) % m_skipModulo != 0 )
+            return false;
+        if( m_pointsExistNearSubtraction[index] != m_invertSubtraction )
+            return false;
+        if( m_disableCrop )
+            return true;
+        const float* vertex = &m_vertices[index * 3];
+        bool isInsideSelection = vertex[0] >= m_fromCoord[0] && vertex[0] <= m_toCoord[0]
+                && vertex[1] >= m_fromCoord[1] && vertex[1] <= m_toCoord[1]
+                && vertex[2] >= m_fromCoord[2] && vertex[2] <= m_toCoord[2];
+        return isInsideSelection != m_invertCropping;
+    }
+
+    /**
+     * Input vertices.
+     */
+    const vector<float>& m_vertices;
+
+    /**
+     * Input colors.
+     */
+    const vector<float>& m_colors;
+
+    /**
+     * Flag of each input point whether it lies near a subtracted point.
+     */
+    const vector<bool>& m_pointsExistNearSubtraction;
+
+    /**
+     * Count of points of a thread pool chunk.
+     */
+    size_t m_blockSize;
+
+    /**
+     * Flag of each point whether it remains. It is set by the counting run.
+     */
+    vector<unsigned char> m_isRemaining;
+
+    /**
+     * Count of remaining points of each block.
+     */
+    vector<size_t> m_blockPointCounts;
+
+    /**
+     * Output position of the first remaining point of each block.
+     */
+    vector<size_t> m_blockOffsets;
+
+    /**
+     * Minimal coordinate of the crop area.
+     */
+    vector<double> m_fromCoord;
+
+    /**
+     * Maximal coordinate of the crop area.
+     */
+    vector<double> m_toCoord;
+
+    /**
+     * Points within the crop area are removed instead of kept.
+     */
+    bool m_invertCropping;
+
+    /**
+     * Cropping is disabled.
+     */
+    bool m_disableCrop;
+
+    /**
+     * Only each m_skipModulo-th point remains.
+     */
+    size_t m_skipModulo;
+
+    /**
+     * Keep the points near subtracted points instead of removing them.
+     */
+    bool m_invertSubtraction;
+
+    /**
+     * Coordinate transformation.
+     */
+    WAffineTransform m_transform;
+
+    /**
+     * Factor of each color channel.
+     */
+    vector<double> m_contrast;
+
+    /**
+     * Offset that is added to each color channel.
+     */
+    vector<double> m_colorOffset;
+
+    /**
+     * Colored or greyscale output.
+     */
+    size_t m_colorMode;
+
+    /**
+     * Group ID of the output points.
+     */
+    size_t m_groupID;
+
+    /**
+     * Indices of the input points within the whole point sequence or 0.
+     */
+    const vector<boost::uint64_t>* m_pointIndices;
+
+    /**
+     * Output indices of the remaining points.
+     */
+    vector<boost::uint64_t>* m_outIndices;
+
+    /**
+     * Output vertices. The counting run is done as long as it is 0.
+     */
+    vector<float>* m_outVertices;
+
+    /**
+     * Output colors.
+     */
+    vector<float>* m_outColors;
+
+    /**
+     * Output group IDs.
+     */
+    vector<size_t>* m_outGroups;
+
+    /**
+     * Progress status that is incremented by the writing run.
+     */
+    boost::shared_ptr< WProgress > m_progress;
+
+    /**
+     * Guards the progress status.
+     */
+    boost::mutex m_progressMutex;
+};
 
 WMPointsTransform::WMPointsTransform():
     WModule(),
@@ -232,12 +553,25 @@ void WMPointsTransform::properties()
 
 
     m_groupFileOperations = m_properties->addPropertyGroup( "File proocessor", "" );
-    m_inputFile = m_groupFileOperations->addProperty( "Input path: ", "", WPathHelper::getAppPath() );
+    m_inputFile = m_groupFileOperations->addProperty( "Input path: ", "Point file to load. Files ending with \".pointsbin\" are read "
+                            "as binary instead of text.", WPathHelper::getAppPath() );
     WPropertyHelper::PC_PATHEXISTS::addTo( m_inputFile );
     m_reloadPointsTrigger = m_groupFileOperations->addProperty( "Load points:",  "Load from file", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
-    m_outputFile = m_groupFileOperations->addProperty( "Output path: ", "", WPathHelper::getAppPath() );
+    m_outputFile = m_groupFileOperations->addProperty( "Output path: ", "Point file to save. It is written as binary if the "
+                            "path ends with \".pointsbin\", otherwise as text ending with \".points\".", WPathHelper::getAppPath() );
     m_savePointsTrigger = m_groupFileOperations->addProperty( "Save points:",  "Save to file", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
 
+    m_groupTileStore = m_properties->addPropertyGroup( "Tile store processor", "" );
+    m_inputStoreFile = m_groupTileStore->addProperty( "Input store: ", "Tile store whose points are transformed tile by tile.",
+                            WPathHelper::getAppPath() );
+    WPropertyHelper::PC_PATHEXISTS::addTo( m_inputStoreFile );
+    m_outputStoreFile = m_groupTileStore->addProperty( "Output store: ", "Tile store that gets the transformed points. It should "
+                            "end with \"" + std::string( WPointTileStore::EXTENSION ) + "\".", WPathHelper::getAppPath() );
+    m_storeMemoryMB = m_groupTileStore->addProperty( "Memory [MB]: ", "Memory of the tile caches of both stores.", 512, m_propCondition );
+    m_storeMemoryMB->setMin( 2 );
+    m_transformStoreTrigger = m_groupTileStore->addProperty( "Transform store:",  "Transform",
+                            WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+
 
     m_pointGroupOptionsGroup = m_properties->addPropertyGroup( "Options for point group output", "" );
     m_assignedGroupID = m_pointGroupOptionsGroup->addProperty( "Assigned point group: ", "", 0, m_propCondition );
@@ -257,6 +591,8 @@ const size_t WMPointsTransform::M_COLOR_MODE_GREYSCALE_PERCEPTIONAL = M_COLOR_MO
 const size_t WMPointsTransform::M_COLOR_MODE_GREYSCALE_PROPORTIONAL =
         M_COLOR_MODE_GREYSCALE_PERCEPTIONAL + 1;
 
+const size_t WMPointsTransform::M_TRANSFORM_BLOCK_SIZE = 65536;
+
 void WMPointsTransform::requirements()
 {
 }
@@ -331,6 +667,7 @@ void WMPointsTransform::moduleMain()
 
             onFileSave();
         }
+        onStoreTransform();
         m_progressStatus->finish();
         m_infoRenderTimeSeconds->set( timer.elapsed() );
 
@@ -400,66 +737,51 @@ void WMPointsTransform::setMinMax()
     }
 }
 
-void WMPointsTransform::addTransformedPoints()
+void WMPointsTransform::addTransformedPoints( const vector<boost::uint64_t>* pointIndices, vector<boost::uint64_t>* outIndices )
 {
-    double angleXY = m_rotation1AngleXY->get();
-    double angleYZ = m_rotation2AngleYZ->get();
-    double angleXZ = m_rotation3AngleXZ->get();
-    vector<double>* point = new vector<double>( 3, 0.0 );
-    vector<double> color( 3, 0.0 );
     size_t count = m_inVerts->size() / 3;
-    vector<double> offset = WVectorMaths::new3dVector( m_translationOffset[0]->get(),
-            m_translationOffset[1]->get(), m_translationOffset[2]->get() );
-    vector<double> factor = WVectorMaths::new3dVector( m_coordFactor[0]->get(),
-            m_coordFactor[1]->get(), m_coordFactor[2]->get() );
-    vector<double> rotationAnchor = WVectorMaths::new3dVector( m_rotationAnchor[0]->get(),
-            m_rotationAnchor[1]->get(), m_rotationAnchor[2]->get() );
-    vector<double>* rotationAnchorInverted = WVectorMaths::copyVectorForPointer( rotationAnchor );
-    WVectorMaths::invertVector( rotationAnchorInverted );
+    vector<double> fromCoord( 3, 0.0 );
+    vector<double> toCoord( 3, 0.0 );
+    for( size_t dimension = 0; dimension < 3; dimension++ )
+    {
+        fromCoord[dimension] = m_fromCoord[dimension]->get();
+        toCoord[dimension] = m_toCoord[dimension]->get();
+    }
     vector<double> contrast = WVectorMaths::new3dVector( m_contrast[0]->get(),
             m_contrast[1]->get(), m_contrast[2]->get() );
     vector<double> colorOffset = WVectorMaths::new3dVector( m_colorOffset[0]->get(),
             m_colorOffset[1]->get(), m_colorOffset[2]->get() );
     size_t colorMode = m_colorModeType->get().getItemIndexOfSelected( 0 );
-    for( size_t index = 0; index < count; index++)
-    {
-        point->at( 0 ) = m_inVerts->at( index * 3 );
-        point->at( 1 ) = m_inVerts->at( index * 3 + 1 );
-        point->at( 2 ) = m_inVerts->at( index * 3 + 2 );
-        bool isInsideSelection = true;
-        for( size_t dimension = 0; dimension < 3 && isInsideSelection; dimension++ )
-            isInsideSelection = point->at( dimension ) >= m_fromCoord[dimension]->get()
-                    && point->at( dimension ) <= m_toCoord[dimension]->get();
-        size_t modulo = m_skipRatio->get() + 1;
-        bool isPointSkipped = index % ( modulo ) != 0;
-        bool remainsAfterCropping = isInsideSelection != m_invertCropping->get() || m_disablePointCrop->get();
-        bool remainsAafterSubtraction = m_pointSubtraction.pointsExistNearCoordinate( *point ) == m_invertSubtraction->get();
-        if( remainsAfterCropping && !isPointSkipped && remainsAafterSubtraction )
-        {
-            WVectorMaths::addVector( point, offset );
-            WVectorMaths::multiplyVector( point, factor );
+    vector<bool> pointsExistNearSubtraction = m_pointSubtraction.pointsExistNearCoordinates( *m_inVerts );
+    if( count == 0 )
+        return;
 
-            WVectorMaths::addVector( point, *rotationAnchorInverted );
-            WVectorMaths::rotateVector( point, 0, 1, angleXY );
-            WVectorMaths::rotateVector( point, 1, 2, angleYZ );
-            WVectorMaths::rotateVector( point, 0, 2, angleXZ );
-            WVectorMaths::addVector( point, rotationAnchor );
+    WPointsTransformTask task( *m_inVerts, *m_inColors, pointsExistNearSubtraction, M_TRANSFORM_BLOCK_SIZE,
+            m_progressStatus );
+    task.setSelection( fromCoord, toCoord, m_invertCropping->get(), m_disablePointCrop->get(), m_skipRatio->get() + 1,
+            m_invertSubtraction->get() );
+    task.setTransform( getCoordinateTransform(), contrast, colorOffset, colorMode, m_assignedGroupID->get() );
+    if( pointIndices != 0 )
+        task.setPointIndices( pointIndices, outIndices );
+    WThreadPool* pool = WThreadPool::getSharedPool();
+    pool->parallelFor( &task, count, M_TRANSFORM_BLOCK_SIZE );
+    task.prepareOutput( m_outVerts.get(), m_outColors.get(), m_outGroups.get() );
+    pool->parallelFor( &task, count, M_TRANSFORM_BLOCK_SIZE );
+}
 
-            for( size_t item = 0; item < 3; item++ )
-            {
-                m_outVerts->push_back( point->at( item ) );
-                color[item] = m_inColors->at( index * 3 + item ) * contrast[item] + colorOffset[item];
-            }
-            double intensity = colorMode == M_COLOR_MODE_GREYSCALE_PERCEPTIONAL
-                    ?( color[0]*0.3 + color[1]*0.59 + color[2]*0.11 )
-                    :( ( color[0] + color[1] + color[2] ) / 3.0 );
-            for( size_t item = 0; item < 3; item++ )
-                m_outColors->push_back( colorMode == M_COLOR_MODE_COLORED ?color[item] :intensity );
-            m_outGroups->push_back( m_assignedGroupID->get() );
-        }
-        m_progressStatus->increment( 1 );
-    }
-    delete rotationAnchorInverted;
+WAffineTransform WMPointsTransform::getCoordinateTransform()
+{
+    double anchorX = m_rotationAnchor[0]->get();
+    double anchorY = m_rotationAnchor[1]->get();
+    double anchorZ = m_rotationAnchor[2]->get();
+    return WAffineTransform::translation( m_translationOffset[0]->get(), m_translationOffset[1]->get(),
+                    m_translationOffset[2]->get() )
+            .followedBy( WAffineTransform::scaling( m_coordFactor[0]->get(), m_coordFactor[1]->get(), m_coordFactor[2]->get() ) )
+            .followedBy( WAffineTransform::translation( -anchorX, -anchorY, -anchorZ ) )
+            .followedBy( WAffineTransform::rotation( 0, 1, m_rotation1AngleXY->get() ) )
+            .followedBy( WAffineTransform::rotation( 1, 2, m_rotation2AngleYZ->get() ) )
+            .followedBy( WAffineTransform::rotation( 0, 2, m_rotation3AngleXZ->get() ) )
+            .followedBy( WAffineTransform::translation( anchorX, anchorY, anchorZ ) );
 }
 
 bool WMPointsTransform::onFileLoad()
@@ -493,6 +815,48 @@ void WMPointsTransform::onFileSave()
     }
     m_savePointsTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
 }
+void WMPointsTransform::onStoreTransform()
+{
+    if( !m_transformStoreTrigger->get( true ) )
+        return;
+    m_transformStoreTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+    size_t memoryBudget = static_cast<size_t>( m_storeMemoryMB->get() ) * 1024 * 1024;
+    WPointTileStore inputStore;
+    WPointTileStore outputStore;
+    if( !inputStore.open( m_inputStoreFile->get().c_str(), memoryBudget / 2 )
+            || !outputStore.create( m_outputStoreFile->get().c_str(), inputStore.getTileSize(), memoryBudget / 2 ) )
+    {
+        std::cout << "!!!Could not open the input or create the output tile store" << std::endl;
+        return;
+    }
+
+    setProgressSettings( inputStore.getPointCount() * 2 );
+    m_infoInputPointCount->set( inputStore.getPointCount() );
+    vector<boost::uint64_t> indices;
+    vector<boost::uint64_t> outIndices;
+    for( size_t tile = 0; tile < inputStore.getTileCount(); tile++ )
+    {
+        m_inVerts = WDataSetPoints::VertexArray( new WDataSetPoints::VertexArray::element_type() );
+        m_inColors = WDataSetPoints::ColorArray( new WDataSetPoints::ColorArray::element_type() );
+        m_outVerts = WDataSetPoints::VertexArray( new WDataSetPoints::VertexArray::element_type() );
+        m_outColors = WDataSetPoints::ColorArray( new WDataSetPoints::ColorArray::element_type() );
+        m_outGroups = WDataSetPointsGrouped::GroupArray( new WDataSetPointsGrouped::GroupArray::element_type() );
+        outIndices.clear();
+        if( !inputStore.fetchTile( tile, m_inVerts.get(), m_inColors.get(), &indices ) )
+        {
+            std::cout << "!!!Could not read the tile store " << m_inputStoreFile->get().c_str() << std::endl;
+            return;
+        }
+        initBoundingBox( tile == 0 );
+        addTransformedPoints( &indices, &outIndices );
+        outputStore.addPoints( *m_outVerts, *m_outColors, outIndices );
+    }
+    if( !outputStore.finishWriting() )
+        std::cout << "!!!Could not write the tile store " << m_outputStoreFile->get().c_str() << std::endl;
+    m_infoOutputPointCount->set( outputStore.getPointCount() );
+    setMinMax();
+}
+
 void WMPointsTransform::onColorIntensityCorrect()
 {
     double intensityMin = m_infoColorMin[0]->get(), intensityMax = m_infoColorMax[0]->get();
@@ -46,6 +46,7 @@
 
 
 #include "../common/algorithms/pointSaver/WPointSaver.h"
+#include "../common/datastructures/tileStore/WPointTileStore.h"
 
 
 //!.Unnecessary imports
@@ -69,6 +70,7 @@
 #include "core/graphicsEngine/WGEUtils.h"
 #include "core/graphicsEngine/WGERequirement.h"
 #include "../common/math/vectors/WVectorMaths.h"
+#include "../common/math/affineTransform/WAffineTransform.h"
 
 // forward declarations to reduce compile dependencies
 template< class T > class WModuleInputData;
@@ -170,6 +172,11 @@ public:
      */
     static const size_t M_COLOR_MODE_GREYSCALE_PROPORTIONAL;
 
+    /**
+     * Count of points that are transformed by a single thread pool chunk.
+     */
+    static const size_t M_TRANSFORM_BLOCK_SIZE;
+
 protected:
     /**
      * Entry point after loading the module. Runs in separate thread.
@@ -222,9 +229,23 @@ private:
      * Returns a cropped data set corresponding to the selection. The selection is
      * set by m_<from/to>_<X/Y/Z>. m_cutInsteadOfCrop determines whether to crop to
      * a selection or to cut away a cube area.
+     * The points are processed in parallel blocks. A first pass counts the remaining 
+     * points of each block. The second one writes them to their final output position 
+     * and transforms them by a single matrix (see getCoordinateTransform()).
+     * \param pointIndices Indices of the input points within the whole point sequence. 
+     *                     They are used for skipping points instead of the position in 
+     *                     m_inVerts if they are set.
+     * \param outIndices Output indices of the remaining points. It is only filled if 
+     *                   pointIndices is set.
      * \return The cropped or cut point data set.
      */
-    void addTransformedPoints();
+    void addTransformedPoints( const vector<boost::uint64_t>* pointIndices = 0, vector<boost::uint64_t>* outIndices = 0 );
+
+    /**
+     * Combines the translation, scaling and rotation settings to a single matrix.
+     * \return The coordinate transformation of the remaining points.
+     */
+    WAffineTransform getCoordinateTransform();
 
     /**
      * Method that is executing for loading files. File is loaded every time when the 
@@ -238,6 +259,14 @@ private:
      */
     void onFileSave();
 
+    /**
+     * Transforms the points of a tile store into another one if the store trigger is 
+     * pressed. The tiles are processed one by one. So only a single input and output 
+     * tile is held in the memory besides the cache of each store. The output equals 
+     * the in-memory transformation of the same points.
+     */
+    void onStoreTransform();
+
     /**
      * Method that handles color intensity correction.
      */
@@ -478,6 +507,31 @@ private:
      */
     WPropTrigger m_reloadPointsTrigger;
 
+    /**
+     * Tile store settings group.
+     */
+    WPropGroup m_groupTileStore;
+
+    /**
+     * Tile store whose points are transformed.
+     */
+    WPropFilename m_inputStoreFile;
+
+    /**
+     * Tile store that gets the transformed points.
+     */
+    WPropFilename m_outputStoreFile;
+
+    /**
+     * Megabytes that can be used by the caches of both tile stores.
+     */
+    WPropInt m_storeMemoryMB;
+
+    /**
+     * Button that triggers the transformation of the input tile store.
+     */
+    WPropTrigger m_transformStoreTrigger;
+
 
     /**
      * Operation for WDataSetPointsGrouped points for conversion of input data to a 
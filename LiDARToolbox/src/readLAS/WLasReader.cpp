@@ -23,18 +23,346 @@
 //---------------------------------------------------------------------------
 
 #include <liblas/liblas.hpp>
+#include <algorithm>
+#include <cstring>
 #include <fstream>  // std::ifstream
 
 #include <string>
 #include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "WLasReader.h"
 #include "core/kernel/WModule.h"
 #include "core/kernel/WKernel.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "../common/math/vectors/WVectorMaths.h"
 
 namespace laslibb
 {
+    /**
+     * Reads little endian fields of the LAS file format.
+     */
+    class WLasBinaryField
+    {
+    public:
+        /**
+         * Reads an unsigned 16 bit integer.
+         * \param data First byte of the field.
+         * \return The field value.
+         */
+        static boost::uint16_t readUInt16( const unsigned char* data )
+        {
+            return static_cast<boost::uint16_t>( data[0] | ( data[1] << 8 ) );
+        }
+
+        /**
+         * Reads an unsigned 32 bit integer.
+         * \param data First byte of the field.
+         * \return The field value.
+         */
+        static boost::uint32_t readUInt32( const unsigned char* data )
+        {
+            return static_cast<boost::uint32_t>( data[0] ) | ( static_cast<boost::uint32_t>( data[1] ) << 8 )
+                    | ( static_cast<boost::uint32_t>( data[2] ) << 16 ) | ( static_cast<boost::uint32_t>( data[3] ) << 24 );
+        }
+
+        /**
+         * Reads a signed 32 bit integer.
+         * \param data First byte of the field.
+         * \return The field value.
+         */
+        static boost::int32_t readInt32( const unsigned char* data )
+        {
+            return static_cast<boost::int32_t>( readUInt32( data ) );
+        }
+
+        /**
+         * Reads an unsigned 64 bit integer.
+         * \param data First byte of the field.
+         * \return The field value.
+         */
+        static boost::uint64_t readUInt64( const unsigned char* data )
+        {
+            return static_cast<boost::uint64_t>( readUInt32( data ) )
+                    | ( static_cast<boost::uint64_t>( readUInt32( data + 4 ) ) << 32 );
+        }
+
+        /**
+         * Reads an IEEE 754 double.
+         * \param data First byte of the field.
+         * \return The field value.
+         */
+        static double readDouble( const unsigned char* data )
+        {
+            boost::uint64_t bits = readUInt64( data );
+            double value = 0.0;
+            std::memcpy( &value, &bits, sizeof( value ) );
+            return value;
+        }
+    };
+
+    /**
+     * Thread pool task that decodes blocks of LAS point records (see WLasTileIndex). 
+     * Each block puts its selected points at the position of its list entry times the 
+     * block size within the output arrays. The blocks are moved together afterwards. 
+     * The bounds and tiles of each block can be put into a tile index on the fly.
+     */
+    class WLasBlockDecodeTask : public WThreadPoolTask
+    {
+    public:
+        /**
+         * Creates the task.
+         * \param pointData First byte of the point records.
+         * \param recordLength Byte count of a point record.
+         * \param colorPosition Byte position of the RGB color within a record. It equals 
+         *                      the record length if the records have no color.
+         * \param scale Scale factor of the X/Y/Z coordinates.
+         * \param coordinateOffset Offset of the X/Y/Z coordinates.
+         * \param pointCount Count of point records.
+         * \param blocks Ascending indices of the decoded blocks.
+         * \param progress Progress status that is incremented once per chunk of blocks.
+         */
+        WLasBlockDecodeTask( const unsigned char* pointData, size_t recordLength, size_t colorPosition,
+                const vector<double>& scale, const vector<double>& coordinateOffset, size_t pointCount,
+                const vector<size_t>* blocks, boost::shared_ptr< WProgress > progress ) :
+            m_scale( scale ),
+            m_coordinateOffset( coordinateOffset ),
+            m_selectedCounts( blocks->size(), 0 )
+        {
+            m_pointData = pointData;
+            m_recordLength = recordLength;
+            m_colorPosition = colorPosition;
+            m_pointCount = pointCount;
+            m_blocks = blocks;
+            m_progress = progress;
+            m_vertices = 0;
+            m_colors = 0;
+            m_tileIndex = 0;
+        }
+
+        /**
+         * Sets the selection and output parameters.
+         * \param selection Selection center X/Y coordinate and radius. A radius of 0 
+         *                  selects all points.
+         * \param translation Offset that is subtracted from the selected coordinates.
+         * \param colorsEnabled Output the RGB color instead of the intensity.
+         * \param contrast Factor that multiplies the output color.
+         * \param vertices Output vertices sized for all points of the decoded blocks.
+         * \param colors Output colors sized for all points of the decoded blocks.
+         */
+        void setOutput( const vector<double>& selection, const vector<double>& translation, bool colorsEnabled,
+                double contrast, vector<float>* vertices, vector<float>* colors )
+        {
+            m_selection = selection;
+            m_translation = translation;
+            m_colorsEnabled = colorsEnabled;
+            m_contrast = contrast;
+            m_vertices = vertices;
+            m_colors = colors;
+        }
+
+        /**
+         * Sets the tile index that gets the bounds and tiles of the decoded blocks.
+         * \param tileIndex Tile index that was reset for the decoded file.
+         */
+        void setTileIndex( WLasTileIndex* tileIndex )
+        {
+            m_tileIndex = tileIndex;
+        }
+
+        /**
+         * Decodes a range of blocks.
+         * \param begin First entry of the block list.
+         * \param end Entry after the last one of the block list.
+         * \param threadIndex Index of the processing thread.
+         */
+        virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+        {
+            threadIndex = threadIndex;
+            size_t recordCount = 0;
+            vector<double> bounds( WLasTileIndex::boundCount, 0.0 );
+            vector<size_t> tiles;
+            double color[3] = { 0.0, 0.0, 0.0 };
+            for( size_t entry = begin; entry < end; entry++ )
+            {
+                size_t firstRecord = ( *m_blocks )[entry] * WLasTileIndex::blockPointCount;
+                size_t lastRecord = std::min( firstRecord + WLasTileIndex::blockPointCount, m_pointCount );
+                size_t selectedPosition = entry * WLasTileIndex::blockPointCount;
+                tiles.clear();
+                for( size_t index = firstRecord; index < lastRecord; index++ )
+                {
+                    const unsigned char* record = m_pointData + index * m_recordLength;
+                    double position[3] = { 0.0, 0.0, 0.0 };
+                    for( size_t dimension = 0; dimension < 3; dimension++ )
+                        position[dimension] = WLasBinaryField::readInt32( record + dimension * 4 ) * m_scale[dimension]
+                                + m_coordinateOffset[dimension];
+                    double intensity = WLasBinaryField::readUInt16( record + 12 );
+                    for( size_t dimension = 0; dimension < 3; dimension++ )
+                        color[dimension] = m_colorPosition < m_recordLength
+                                ?WLasBinaryField::readUInt16( record + m_colorPosition + dimension * 2 ) :0.0;
+
+                    if( m_tileIndex != 0 )
+                    {
+                        for( size_t dimension = 0; dimension < 3; dimension++ )
+                        {
+                            if( position[dimension] < bounds[dimension] || index == firstRecord )
+                                bounds[dimension] = position[dimension];
+                            if( position[dimension] > bounds[3 + dimension] || index == firstRecord )
+                                bounds[3 + dimension] = position[dimension];
+                            if( color[dimension] < bounds[6 + dimension] || index == firstRecord )
+                                bounds[6 + dimension] = color[dimension];
+                            if( color[dimension] > bounds[9 + dimension] || index == firstRecord )
+                                bounds[9 + dimension] = color[dimension];
+                        }
+                        if( intensity < bounds[12] || index == firstRecord )
+                            bounds[12] = intensity;
+                        if( intensity > bounds[13] || index == firstRecord )
+                            bounds[13] = intensity;
+                        size_t tile = m_tileIndex->getTile( position[0], position[1] );
+                        if( tiles.empty() || tiles.back() != tile )
+                            tiles.push_back( tile );
+                    }
+
+                    if( m_selection[2] == 0
+                            || ( position[0] >= m_selection[0] - m_selection[2]
+                                    && position[0] <= m_selection[0] + m_selection[2]
+                                    && position[1] >= m_selection[1] - m_selection[2]
+                                    && position[1] <= m_selection[1] + m_selection[2] ) )
+                    {
+                        for( size_t dimension = 0; dimension < 3; dimension++ )
+                        {
+                            ( *m_vertices )[selectedPosition * 3 + dimension] = position[dimension] - m_translation[dimension];
+                            ( *m_colors )[selectedPosition * 3 + dimension] = m_colorsEnabled
+                                    ?( color[dimension] * m_contrast ) :( intensity * m_contrast );
+                        }
+                        selectedPosition++;
+                    }
+                }
+                m_selectedCounts[entry] = selectedPosition - entry * WLasTileIndex::blockPointCount;
+                recordCount += lastRecord - firstRecord;
+                if( m_tileIndex != 0 )
+                    m_tileIndex->setBlock( ( *m_blocks )[entry], &bounds[0], tiles );
+            }
+
+            boost::mutex::scoped_lock lock( m_progressMutex );
+            m_progress->increment( recordCount );
+        }
+
+        /**
+         * Moves the selected points of all blocks together and shrinks the output arrays.
+         * \return Count of selected points.
+         */
+        size_t compactOutput()
+        {
+            size_t selectedCount = 0;
+            for( size_t entry = 0; entry < m_selectedCounts.size(); entry++ )
+            {
+                size_t blockBegin = entry * WLasTileIndex::blockPointCount * 3;
+                std::copy( m_vertices->begin() + blockBegin, m_vertices->begin() + blockBegin + m_selectedCounts[entry] * 3,
+                        m_vertices->begin() + selectedCount * 3 );
+                std::copy( m_colors->begin() + blockBegin, m_colors->begin() + blockBegin + m_selectedCounts[entry] * 3,
+                        m_colors->begin() + selectedCount * 3 );
+                selectedCount += m_selectedCounts[entry];
+            }
+            m_vertices->resize( selectedCount * 3 );
+            m_colors->resize( selectedCount * 3 );
+            return selectedCount;
+        }
+
+    private:
+        /**
+         * First byte of the point records.
+         */
+        const unsigned char* m_pointData;
+
+        /**
+         * Byte count of a point record.
+         */
+        size_t m_recordLength;
+
+        /**
+         * Byte position of the RGB color within a record.
+         */
+        size_t m_colorPosition;
+
+        /**
+         * Count of point records.
+         */
+        size_t m_pointCount;
+
+        /**
+         * Scale factor of the X/Y/Z coordinates.
+         */
+        vector<double> m_scale;
+
+        /**
+         * Offset of the X/Y/Z coordinates.
+         */
+        vector<double> m_coordinateOffset;
+
+        /**
+         * Ascending indices of the decoded blocks.
+         */
+        const vector<size_t>* m_blocks;
+
+        /**
+         * Selection center X/Y coordinate and radius.
+         */
+        vector<double> m_selection;
+
+        /**
+         * Offset that is subtracted from the selected coordinates.
+         */
+        vector<double> m_translation;
+
+        /**
+         * Output the RGB color instead of the intensity.
+         */
+        bool m_colorsEnabled;
+
+        /**
+         * Factor that multiplies the output color.
+         */
+        double m_contrast;
+
+        /**
+         * Output vertices.
+         */
+        vector<float>* m_vertices;
+
+        /**
+         * Output colors.
+         */
+        vector<float>* m_colors;
+
+        /**
+         * Tile index that gets the block bounds. No index is built if it is 0.
+         */
+        WLasTileIndex* m_tileIndex;
+
+        /**
+         * Count of selected points of each block list entry.
+         */
+        vector<size_t> m_selectedCounts;
+
+        /**
+         * Progress status that is incremented once per chunk of blocks.
+         */
+        boost::shared_ptr< WProgress > m_progress;
+
+        /**
+         * Guards the progress status.
+         */
+        boost::mutex m_progressMutex;
+    };
+
+    const size_t WLasReader::chunkPointCount = 65536;
+
+    const size_t WLasReader::storeBatchPointCount = 1048576;
+
     WLasReader::WLasReader()
     {
         m_minCoord.reserve( 3 );
@@ -96,6 +424,191 @@ namespace laslibb
         WDataSetPoints::ColorArray colors(
                 new WDataSetPoints::ColorArray::element_type() );
 
+        vector<double> offset = WVectorMaths::new3dVector( m_selectionX, m_selectionY,
+                ( m_maxCoord[2] - m_minCoord[2] ) / 2.0 );
+        bool isRead = false;
+        try
+        {
+            isRead = readMappedPoints( offset, vertices, colors );
+        }
+        catch( const boost::interprocess::interprocess_exception& exception )
+        {
+            std::cout << "!!!Could not map the LAS file: " << exception.what() << std::endl;
+        }
+        if( !isRead )
+            readLibLasPoints( offset, vertices, colors );
+        m_progressStatus->finish();
+        size_t addedPoints = vertices->size() / 3;
+
+        if  ( addedPoints == 0 )
+        {
+            //TODO(aschwarzkopf): Handle the problem in other way. When no points exist then the program crashes.
+            for  ( size_t lfd = 0; lfd < 3; lfd++)
+            {
+                vertices->push_back( 0 );
+                colors->push_back( 0 );
+            }
+        }
+        boost::shared_ptr< WDataSetPoints > outputPoints(
+                new WDataSetPoints( vertices, colors ) );
+        m_outputPoints = outputPoints;
+
+        return m_outputPoints;
+    }
+
+    bool WLasReader::writeTileStore( WPointTileStore* tileStore )
+    {
+        WDataSetPoints::VertexArray vertices(
+                new WDataSetPoints::VertexArray::element_type() );
+        WDataSetPoints::ColorArray colors(
+                new WDataSetPoints::ColorArray::element_type() );
+
+        vector<double> offset = WVectorMaths::new3dVector( m_selectionX, m_selectionY,
+                ( m_maxCoord[2] - m_minCoord[2] ) / 2.0 );
+        bool isRead = false;
+        try
+        {
+            isRead = readMappedPoints( offset, vertices, colors, tileStore );
+        }
+        catch( const boost::interprocess::interprocess_exception& exception )
+        {
+            std::cout << "!!!Could not map the LAS file: " << exception.what() << std::endl;
+        }
+        if( !isRead )
+            std::cout << "!!!Only uncompressed LAS files can be written to a tile store" << std::endl;
+        else
+            m_progressStatus->finish();
+        return isRead;
+    }
+
+    bool WLasReader::readMappedPoints( const vector<double>& offset, WDataSetPoints::VertexArray vertices,
+            WDataSetPoints::ColorArray colors, WPointTileStore* tileStore )
+    {
+        boost::interprocess::file_mapping file( m_filePath, boost::interprocess::read_only );
+        boost::interprocess::mapped_region region( file, boost::interprocess::read_only );
+        const unsigned char* data = static_cast<const unsigned char*>( region.get_address() );
+        size_t fileSize = region.get_size();
+        if( fileSize < 227 || std::memcmp( data, "LASF", 4 ) != 0 )
+            return false;
+
+        size_t headerSize = WLasBinaryField::readUInt16( data + 94 );
+        size_t pointDataOffset = WLasBinaryField::readUInt32( data + 96 );
+        size_t pointFormat = data[104];
+        size_t recordLength = WLasBinaryField::readUInt16( data + 105 );
+        boost::uint64_t pointCount = WLasBinaryField::readUInt32( data + 107 );
+        if( pointCount == 0 && data[25] >= 4 && headerSize >= 255 && fileSize >= 255 )
+            pointCount = WLasBinaryField::readUInt64( data + 247 );
+
+        const size_t colorPositions[] = { 0, 0, 20, 28, 0, 28, 0, 30, 30, 0, 30 };
+        if( pointFormat > 10 || recordLength < 20 || pointDataOffset > fileSize )
+            return false;
+        size_t colorPosition = colorPositions[pointFormat] > 0 ?colorPositions[pointFormat] :recordLength;
+        if( colorPosition < recordLength && colorPosition + 6 > recordLength )
+            return false;
+        pointCount = std::min( pointCount, static_cast<boost::uint64_t>( ( fileSize - pointDataOffset ) / recordLength ) );
+
+        vector<double> scale( 3, 0.0 );
+        vector<double> coordinateOffset( 3, 0.0 );
+        for( size_t dimension = 0; dimension < 3; dimension++ )
+        {
+            scale[dimension] = WLasBinaryField::readDouble( data + 131 + dimension * 8 );
+            coordinateOffset[dimension] = WLasBinaryField::readDouble( data + 155 + dimension * 8 );
+        }
+        size_t count = static_cast<size_t>( pointCount );
+        std::string filePath( m_filePath );
+        bool isIndexed = m_tileIndex.isBuiltFor( filePath, count ) || m_tileIndex.load( filePath, count );
+        vector<size_t> blocks;
+        if( isIndexed && m_selectionRadius != 0 )
+        {
+            m_tileIndex.fetchBlocksInRegion( m_selectionX - m_selectionRadius, m_selectionY - m_selectionRadius,
+                    m_selectionX + m_selectionRadius, m_selectionY + m_selectionRadius, &blocks );
+        }
+        else
+        {
+            blocks.resize( ( count + WLasTileIndex::blockPointCount - 1 ) / WLasTileIndex::blockPointCount );
+            for( size_t block = 0; block < blocks.size(); block++ )
+                blocks[block] = block;
+        }
+        size_t decodedCount = blocks.size() * WLasTileIndex::blockPointCount;
+        if( !blocks.empty() && ( blocks.back() + 1 ) * WLasTileIndex::blockPointCount > count )
+            decodedCount -= ( blocks.back() + 1 ) * WLasTileIndex::blockPointCount - count;
+        setProgressSettings( decodedCount );
+        if( count == 0 )
+            return true;
+        if( !isIndexed )
+        {
+            m_tileIndex.reset( filePath, count, WLasBinaryField::readDouble( data + 187 ),
+                    WLasBinaryField::readDouble( data + 203 ), WLasBinaryField::readDouble( data + 179 ),
+                    WLasBinaryField::readDouble( data + 195 ) );
+            region.advise( boost::interprocess::mapped_region::advice_sequential );
+        }
+
+        size_t batchBlockCount = tileStore == 0 ?blocks.size() :storeBatchPointCount / WLasTileIndex::blockPointCount;
+        boost::uint64_t firstIndex = 0;
+        for( size_t batchBegin = 0; batchBegin < blocks.size(); batchBegin += batchBlockCount )
+        {
+            vector<size_t> batch( blocks.begin() + batchBegin,
+                    blocks.begin() + std::min( batchBegin + batchBlockCount, blocks.size() ) );
+            vertices->resize( batch.size() * WLasTileIndex::blockPointCount * 3 );
+            colors->resize( vertices->size() );
+            WLasBlockDecodeTask task( data + pointDataOffset, recordLength, colorPosition, scale, coordinateOffset,
+                    count, &batch, m_progressStatus );
+            task.setOutput( WVectorMaths::new3dVector( m_selectionX, m_selectionY, m_selectionRadius ),
+                    m_translateToCenter ?offset :vector<double>( 3, 0.0 ), m_colorsEnabled, m_contrast,
+                    vertices.get(), colors.get() );
+            if( !isIndexed )
+                task.setTileIndex( &m_tileIndex );
+            WThreadPool::getSharedPool()->parallelFor( &task, batch.size(),
+                    chunkPointCount / WLasTileIndex::blockPointCount );
+            size_t selectedCount = task.compactOutput();
+
+            if( tileStore != 0 )
+            {
+                vector<boost::uint64_t> indices( selectedCount, 0 );
+                for( size_t index = 0; index < selectedCount; index++ )
+                    indices[index] = firstIndex + index;
+                tileStore->addPoints( *vertices, *colors, indices );
+            }
+            firstIndex += selectedCount;
+        }
+
+        if( !isIndexed )
+        {
+            m_tileIndex.finishBlocks();
+            if( !m_tileIndex.save() )
+                std::cout << "!!!Could not save the tile index beside " << filePath << std::endl;
+        }
+        m_tileIndex.fetchBounds( &m_minCoord, &m_maxCoord, &m_minColor, &m_maxColor, &m_intensityMin, &m_intensityMax );
+        return true;
+    }
+
+    bool WLasReader::readHeaderBounds()
+    {
+        try
+        {
+            boost::interprocess::file_mapping file( m_filePath, boost::interprocess::read_only );
+            boost::interprocess::mapped_region region( file, boost::interprocess::read_only );
+            const unsigned char* data = static_cast<const unsigned char*>( region.get_address() );
+            if( region.get_size() < 227 || std::memcmp( data, "LASF", 4 ) != 0 )
+                return false;
+
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+            {
+                m_maxCoord[dimension] = WLasBinaryField::readDouble( data + 179 + dimension * 16 );
+                m_minCoord[dimension] = WLasBinaryField::readDouble( data + 187 + dimension * 16 );
+            }
+        }
+        catch( const boost::interprocess::interprocess_exception& exception )
+        {
+            std::cout << "!!!Could not map the LAS file: " << exception.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void WLasReader::readLibLasPoints( const vector<double>& offset, WDataSetPoints::VertexArray vertices,
+            WDataSetPoints::ColorArray colors )
+    {
         std::ifstream ifs;
         ifs.open( m_filePath, std::ios::in | std::ios::binary );
 
@@ -108,17 +621,19 @@ namespace laslibb
         liblas::Color colorLas;
         size_t count = header.GetPointRecordsCount();
         setProgressSettings( count );
-        size_t addedPoints = 0;
-        vector<double> offset = WVectorMaths::new3dVector( m_selectionX, m_selectionY,
-                ( m_maxCoord[2] - m_minCoord[2] ) / 2.0 );
+        vertices->reserve( count * 3 );
+        colors->reserve( count * 3 );
+        vector<double> coord( 3, 0.0 );
         vector<double> color( 3, 0.0 );
 
         for  ( size_t i = 0; i < count; i++ )
         {
             reader.ReadNextPoint();
 
-            liblas::Point point = reader.GetPoint();
-            vector<double> coord = WVectorMaths::new3dVector( point.GetX(), point.GetY(), point.GetZ() );
+            liblas::Point const& point = reader.GetPoint();
+            coord[0] = point.GetX();
+            coord[1] = point.GetY();
+            coord[2] = point.GetZ();
 
             double intensity = point.GetIntensity(); //TODO(schwarzkopf): Still had no colored data set to check some liblas functions.
             colorLas = point.GetColor();
@@ -140,8 +655,8 @@ namespace laslibb
                     m_maxColor[dimension] = color[dimension];
             }
 
-            if  ( intensity < m_intensityMin ) m_intensityMin = intensity;
-            if  ( intensity > m_intensityMax ) m_intensityMax = intensity;
+            if  ( intensity < m_intensityMin || i == 0 ) m_intensityMin = intensity;
+            if  ( intensity > m_intensityMax || i == 0 ) m_intensityMax = intensity;
 
             if  ( m_selectionRadius == 0
                     || ( coord[0] >= m_selectionX - m_selectionRadius
@@ -157,26 +672,10 @@ namespace laslibb
                 for  ( int colorIndex = 0; colorIndex < 3; colorIndex++ )
                     colors->push_back( m_colorsEnabled ?( color[colorIndex] * m_contrast )
                             :( intensity * m_contrast ) );
-                addedPoints++;
             }
-            m_progressStatus->increment( 1 );
+            if( i % chunkPointCount == chunkPointCount - 1 || i == count - 1 )
+                m_progressStatus->increment( i % chunkPointCount + 1 );
         }
-        m_progressStatus->finish();
-
-        if  ( addedPoints == 0 )
-        {
-            //TODO(aschwarzkopf): Handle the problem in other way. When no points exist then the program crashes.
-            for  ( size_t lfd = 0; lfd < 3; lfd++)
-            {
-                vertices->push_back( 0 );
-                colors->push_back( 0 );
-            }
-        }
-        boost::shared_ptr< WDataSetPoints > outputPoints(
-                new WDataSetPoints( vertices, colors ) );
-        m_outputPoints = outputPoints;
-
-        return m_outputPoints;
     }
 
     void WLasReader::setDataSetRegion( double selectionX, double selectionY, double selectionRadius )
@@ -36,6 +36,8 @@
 #include "core/graphicsEngine/WTriangleMesh.h"
 #include "core/dataHandler/WDataSetPoints.h"
 #include "core/common/datastructures/WColoredVertices.h"
+#include "WLasTileIndex.h"
+#include "../common/datastructures/tileStore/WPointTileStore.h"
 
 using osg::Vec3;
 using std::vector;
@@ -85,6 +87,24 @@ namespace laslibb
          */
         boost::shared_ptr< WDataSetPoints > getPoints();
 
+        /**
+         * Reads the points of the LAS file like getPoints() but adds them to a tile store 
+         * instead of returning them. The points are decoded in batches of 
+         * storeBatchPointCount points so that the memory usage doesn't depend on the file 
+         * size. The points keep their index of the getPoints() output.
+         * \param tileStore Tile store that was created for writing. It isn't finished by 
+         *                  this method.
+         * \return The points could be read or not.
+         */
+        bool writeTileStore( WPointTileStore* tileStore );
+
+        /**
+         * Takes the minimal and maximal coordinate from the LAS file header without 
+         * reading any point.
+         * \return The header could be read or not.
+         */
+        bool readHeaderBounds();
+
         /**
          * Sets from which data set region the point data should be loaded.
          * \param selectionX Selection centre X coordinate.
@@ -142,7 +162,48 @@ namespace laslibb
         double getIntensityMax();
 
 
+        /**
+         * Count of points that are decoded by a single thread pool chunk. The progress 
+         * bar is updated once per chunk.
+         */
+        static const size_t chunkPointCount;
+
+        /**
+         * Count of decoded point records that is held in the memory at once while writing 
+         * a tile store.
+         */
+        static const size_t storeBatchPointCount;
+
     private:
+        /**
+         * Reads the points by mapping the LAS file into memory. The fixed size point 
+         * records are decoded in parallel chunks on the shared thread pool. It supports 
+         * the uncompressed point data formats 0 to 10. The first read builds a tile index 
+         * of the file. Later reads of a region only decode the record blocks of the tiles 
+         * that overlap the region.
+         * \param offset Offset that is subtracted from the coordinates if the data is 
+         *               translated to the center.
+         * \param vertices Output vertices of the selected points.
+         * \param colors Output colors of the selected points.
+         * \param tileStore Tile store that gets the selected points batch by batch. The 
+         *                  output arrays only hold the last batch then. All points are put 
+         *                  into the output arrays if it is 0.
+         * \return The file could be read or not. Compressed or invalid files must be read 
+         *         by readLibLasPoints().
+         */
+        bool readMappedPoints( const vector<double>& offset, WDataSetPoints::VertexArray vertices,
+                WDataSetPoints::ColorArray colors, WPointTileStore* tileStore = 0 );
+
+        /**
+         * Reads the points one by one using liblas.
+         * \param offset Offset that is subtracted from the coordinates if the data is 
+         *               translated to the center.
+         * \param vertices Output vertices of the selected points.
+         * \param colors Output colors of the selected points.
+         */
+        void readLibLasPoints( const vector<double>& offset, WDataSetPoints::VertexArray vertices,
+                WDataSetPoints::ColorArray colors );
+
         /**
          * Sets the linked module progress bar settings.
          * \param steps Points count as reference to the progress bar.
@@ -228,6 +289,11 @@ namespace laslibb
          * Maximal color intensity in LAS file.
          */
         double m_intensityMax;
+
+        /**
+         * Tile index of the point records of the input LAS file.
+         */
+        WLasTileIndex m_tileIndex;
     };
 } /* namespace butterfly */
 #endif  // WLASREADER_H
@@ -0,0 +1,298 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+
+#include "WLasTileIndex.h"
+
+namespace laslibb
+{
+    const size_t WLasTileIndex::blockPointCount = 4096;
+
+    const size_t WLasTileIndex::tilesPerDimension = 256;
+
+    const size_t WLasTileIndex::boundCount = 14;
+
+    /**
+     * Leading bytes of a tile index cache file.
+     */
+    static const char tileIndexMagic[8] = { 'W', 'L', 'A', 'S', 'T', 'I', 'L', '1' };
+
+    WLasTileIndex::WLasTileIndex()
+    {
+        m_sourceSize = 0;
+        m_sourceTime = 0;
+        m_pointCount = 0;
+        m_isComplete = false;
+        for( size_t dimension = 0; dimension < 2; dimension++ )
+        {
+            m_gridMin[dimension] = 0.0;
+            m_tileSize[dimension] = 1.0;
+        }
+    }
+
+    WLasTileIndex::~WLasTileIndex()
+    {
+    }
+
+    void WLasTileIndex::reset( const std::string& sourcePath, size_t pointCount, double minX, double minY,
+            double maxX, double maxY )
+    {
+        m_sourcePath = sourcePath;
+        m_sourceSize = 0;
+        m_sourceTime = 0;
+        fetchFileState( sourcePath, &m_sourceSize, &m_sourceTime );
+        m_pointCount = pointCount;
+        m_isComplete = false;
+        double minCoord[] = { minX, minY };
+        double maxCoord[] = { maxX, maxY };
+        for( size_t dimension = 0; dimension < 2; dimension++ )
+        {
+            m_gridMin[dimension] = minCoord[dimension];
+            m_tileSize[dimension] = ( maxCoord[dimension] - minCoord[dimension] ) / tilesPerDimension;
+            if( !( m_tileSize[dimension] > 0.0 ) )
+                m_tileSize[dimension] = 1.0;
+        }
+        size_t blockCount = ( pointCount + blockPointCount - 1 ) / blockPointCount;
+        m_blockBounds.assign( blockCount * boundCount, 0.0 );
+        m_blockTiles.clear();
+        m_blockTiles.resize( blockCount );
+        m_tileBlockOffsets.clear();
+        m_tileBlocks.clear();
+    }
+
+    bool WLasTileIndex::isBuiltFor( const std::string& sourcePath, size_t pointCount )
+    {
+        size_t size = 0;
+        std::time_t time = 0;
+        return m_isComplete && sourcePath == m_sourcePath && pointCount == m_pointCount
+                && fetchFileState( sourcePath, &size, &time ) && size == m_sourceSize && time == m_sourceTime;
+    }
+
+    size_t WLasTileIndex::getBlockCount()
+    {
+        return m_blockBounds.size() / boundCount;
+    }
+
+    size_t WLasTileIndex::getTile( double x, double y )
+    {
+        return getTileCoordinate( y, 1 ) * tilesPerDimension + getTileCoordinate( x, 0 );
+    }
+
+    void WLasTileIndex::setBlock( size_t block, const double* bounds, const vector<size_t>& tiles )
+    {
+        std::copy( bounds, bounds + boundCount, m_blockBounds.begin() + block * boundCount );
+        vector<size_t>& blockTiles = m_blockTiles[block];
+        blockTiles = tiles;
+        std::sort( blockTiles.begin(), blockTiles.end() );
+        blockTiles.erase( std::unique( blockTiles.begin(), blockTiles.end() ), blockTiles.end() );
+    }
+
+    void WLasTileIndex::finishBlocks()
+    {
+        m_tileBlockOffsets.assign( tilesPerDimension * tilesPerDimension + 1, 0 );
+        for( size_t block = 0; block < m_blockTiles.size(); block++ )
+            for( size_t index = 0; index < m_blockTiles[block].size(); index++ )
+                m_tileBlockOffsets[m_blockTiles[block][index] + 1]++;
+        for( size_t tile = 0; tile + 1 < m_tileBlockOffsets.size(); tile++ )
+            m_tileBlockOffsets[tile + 1] += m_tileBlockOffsets[tile];
+
+        m_tileBlocks.resize( m_tileBlockOffsets.back() );
+        vector<size_t> positions( m_tileBlockOffsets.begin(), m_tileBlockOffsets.end() - 1 );
+        for( size_t block = 0; block < m_blockTiles.size(); block++ )
+            for( size_t index = 0; index < m_blockTiles[block].size(); index++ )
+                m_tileBlocks[positions[m_blockTiles[block][index]]++] = block;
+        m_blockTiles.clear();
+        m_isComplete = true;
+    }
+
+    void WLasTileIndex::fetchBlocksInRegion( double minX, double minY, double maxX, double maxY, vector<size_t>* blocks )
+    {
+        blocks->clear();
+        size_t firstColumn = getTileCoordinate( minX, 0 );
+        size_t lastColumn = getTileCoordinate( maxX, 0 );
+        size_t firstRow = getTileCoordinate( minY, 1 );
+        size_t lastRow = getTileCoordinate( maxY, 1 );
+        for( size_t row = firstRow; row <= lastRow; row++ )
+        {
+            for( size_t column = firstColumn; column <= lastColumn; column++ )
+            {
+                size_t tile = row * tilesPerDimension + column;
+                for( size_t index = m_tileBlockOffsets[tile]; index < m_tileBlockOffsets[tile + 1]; index++ )
+                {
+                    const double* bounds = &m_blockBounds[m_tileBlocks[index] * boundCount];
+                    if( bounds[0] <= maxX && bounds[3] >= minX && bounds[1] <= maxY && bounds[4] >= minY )
+                        blocks->push_back( m_tileBlocks[index] );
+                }
+            }
+        }
+        std::sort( blocks->begin(), blocks->end() );
+        blocks->erase( std::unique( blocks->begin(), blocks->end() ), blocks->end() );
+    }
+
+    void WLasTileIndex::fetchBounds( vector<double>* minCoord, vector<double>* maxCoord, vector<double>* minColor,
+            vector<double>* maxColor, double* intensityMin, double* intensityMax )
+    {
+        for( size_t block = 0; block < getBlockCount(); block++ )
+        {
+            const double* bounds = &m_blockBounds[block * boundCount];
+            for( size_t dimension = 0; dimension < 3; dimension++ )
+            {
+                if( bounds[dimension] < ( *minCoord )[dimension] || block == 0 )
+                    ( *minCoord )[dimension] = bounds[dimension];
+                if( bounds[3 + dimension] > ( *maxCoord )[dimension] || block == 0 )
+                    ( *maxCoord )[dimension] = bounds[3 + dimension];
+                if( bounds[6 + dimension] < ( *minColor )[dimension] || block == 0 )
+                    ( *minColor )[dimension] = bounds[6 + dimension];
+                if( bounds[9 + dimension] > ( *maxColor )[dimension] || block == 0 )
+                    ( *maxColor )[dimension] = bounds[9 + dimension];
+            }
+            if( bounds[12] < *intensityMin || block == 0 )
+                *intensityMin = bounds[12];
+            if( bounds[13] > *intensityMax || block == 0 )
+                *intensityMax = bounds[13];
+        }
+    }
+
+    bool WLasTileIndex::load( const std::string& sourcePath, size_t pointCount )
+    {
+        m_isComplete = false;
+        size_t sourceSize = 0;
+        std::time_t sourceTime = 0;
+        if( !fetchFileState( sourcePath, &sourceSize, &sourceTime ) )
+            return false;
+        std::ifstream stream( getCachePath( sourcePath ).c_str(), std::ios::in | std::ios::binary );
+        if( !stream.is_open() )
+            return false;
+
+        char magic[sizeof( tileIndexMagic )];
+        boost::uint64_t fields[7] = { 0, 0, 0, 0, 0, 0, 0 };
+        stream.read( magic, sizeof( magic ) );
+        stream.read( reinterpret_cast<char*>( fields ), sizeof( fields ) );
+        if( !stream || std::memcmp( magic, tileIndexMagic, sizeof( magic ) ) != 0
+                || fields[0] != sourceSize || static_cast<std::time_t>( fields[1] ) != sourceTime
+                || fields[2] != pointCount || fields[3] != blockPointCount || fields[4] != tilesPerDimension
+                || fields[5] != ( pointCount + blockPointCount - 1 ) / blockPointCount )
+            return false;
+
+        stream.read( reinterpret_cast<char*>( m_gridMin ), sizeof( m_gridMin ) );
+        stream.read( reinterpret_cast<char*>( m_tileSize ), sizeof( m_tileSize ) );
+        m_blockBounds.resize( static_cast<size_t>( fields[5] ) * boundCount );
+        m_tileBlockOffsets.resize( tilesPerDimension * tilesPerDimension + 1 );
+        m_tileBlocks.resize( static_cast<size_t>( fields[6] ) );
+        vector<boost::uint64_t> values( m_tileBlockOffsets.size() + m_tileBlocks.size() );
+        if( !m_blockBounds.empty() )
+            stream.read( reinterpret_cast<char*>( &m_blockBounds[0] ), m_blockBounds.size() * sizeof( double ) );
+        stream.read( reinterpret_cast<char*>( &values[0] ), values.size() * sizeof( boost::uint64_t ) );
+        if( !stream )
+            return false;
+        for( size_t index = 0; index < m_tileBlockOffsets.size(); index++ )
+            m_tileBlockOffsets[index] = static_cast<size_t>( values[index] );
+        for( size_t index = 0; index < m_tileBlocks.size(); index++ )
+        {
+            m_tileBlocks[index] = static_cast<size_t>( values[m_tileBlockOffsets.size() + index] );
+            if( m_tileBlocks[index] >= fields[5] )
+                return false;
+        }
+        for( size_t tile = 0; tile + 1 < m_tileBlockOffsets.size(); tile++ )
+            if( m_tileBlockOffsets[tile] > m_tileBlockOffsets[tile + 1] )
+                return false;
+        if( m_tileBlockOffsets[0] != 0 || m_tileBlockOffsets.back() != m_tileBlocks.size() )
+            return false;
+
+        m_sourcePath = sourcePath;
+        m_sourceSize = sourceSize;
+        m_sourceTime = sourceTime;
+        m_pointCount = pointCount;
+        m_blockTiles.clear();
+        m_isComplete = true;
+        return true;
+    }
+
+    bool WLasTileIndex::save()
+    {
+        if( !m_isComplete )
+            return false;
+        std::string cachePath = getCachePath( m_sourcePath );
+        std::ofstream stream( cachePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if( !stream.is_open() )
+            return false;
+
+        boost::uint64_t fields[] = { m_sourceSize, static_cast<boost::uint64_t>( m_sourceTime ), m_pointCount,
+                blockPointCount, tilesPerDimension, getBlockCount(), m_tileBlocks.size() };
+        vector<boost::uint64_t> values( m_tileBlockOffsets.begin(), m_tileBlockOffsets.end() );
+        values.insert( values.end(), m_tileBlocks.begin(), m_tileBlocks.end() );
+        stream.write( tileIndexMagic, sizeof( tileIndexMagic ) );
+        stream.write( reinterpret_cast<const char*>( fields ), sizeof( fields ) );
+        stream.write( reinterpret_cast<const char*>( m_gridMin ), sizeof( m_gridMin ) );
+        stream.write( reinterpret_cast<const char*>( m_tileSize ), sizeof( m_tileSize ) );
+        if( !m_blockBounds.empty() )
+            stream.write( reinterpret_cast<const char*>( &m_blockBounds[0] ), m_blockBounds.size() * sizeof( double ) );
+        stream.write( reinterpret_cast<const char*>( &values[0] ), values.size() * sizeof( boost::uint64_t ) );
+        stream.close();
+        if( !stream )
+        {
+            std::remove( cachePath.c_str() );
+            return false;
+        }
+        return true;
+    }
+
+    std::string WLasTileIndex::getCachePath( const std::string& sourcePath )
+    {
+        return sourcePath + ".tiles";
+    }
+
+    bool WLasTileIndex::fetchFileState( const std::string& path, size_t* size, std::time_t* time )
+    {
+        boost::system::error_code error;
+        boost::uintmax_t fileSize = boost::filesystem::file_size( path, error );
+        if( error )
+            return false;
+        std::time_t fileTime = boost::filesystem::last_write_time( path, error );
+        if( error )
+            return false;
+        *size = static_cast<size_t>( fileSize );
+        *time = fileTime;
+        return true;
+    }
+
+    size_t WLasTileIndex::getTileCoordinate( double coordinate, size_t dimension )
+    {
+        double tile = std::floor( ( coordinate - m_gridMin[dimension] ) / m_tileSize[dimension] );
+        if( !( tile > 0.0 ) )
+            return 0;
+        return tile < tilesPerDimension ?static_cast<size_t>( tile ) :tilesPerDimension - 1;
+    }
+} /* namespace laslibb */
@@ -0,0 +1,245 @@
+//---------------------------------------------------------------------------
+//
+// Project: OpenWalnut ( http://www.openwalnut.org )
+//
+// Copyright 2009 OpenWalnut Community, BSV-Leipzig and CNCF-CBS
+// For more information see http://www.openwalnut.org/copying
+//
+// This file is part of OpenWalnut.
+//
+// OpenWalnut is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWalnut is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenWalnut. If not, see <http://www.gnu.org/licenses/>.
+//
+//---------------------------------------------------------------------------
+
+#ifndef WLASTILEINDEX_H
+#define WLASTILEINDEX_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace laslibb
+{
+    /**
+     * Coarse spatial index of the point records of a LAS file. The records are split 
+     * into blocks of blockPointCount consecutive records. Each block keeps the bounds of 
+     * its points. The X/Y area of the file header is split into a grid of tiles that 
+     * lists the blocks having points within the tile. So selecting a region only needs 
+     * the blocks of the overlapping tiles to be decoded, and the bounds of the whole file 
+     * are known without decoding it.
+     *
+     * The index is built while the whole file is decoded once. It is cached beside the 
+     * LAS file and reused as long as the file's size and modification time don't change.
+     */
+    class WLasTileIndex
+    {
+    public:
+        /**
+         * Creates an empty index.
+         */
+        WLasTileIndex();
+
+        /**
+         * Destroys the index.
+         */
+        virtual ~WLasTileIndex();
+
+        /**
+         * Clears the index and prepares it for a new LAS file. Blocks are added using 
+         * setBlock() and the index is completed by finishBlocks().
+         * \param sourcePath Path of the indexed LAS file.
+         * \param pointCount Count of point records of the file.
+         * \param minX Minimal X coordinate of the file header.
+         * \param minY Minimal Y coordinate of the file header.
+         * \param maxX Maximal X coordinate of the file header.
+         * \param maxY Maximal Y coordinate of the file header.
+         */
+        void reset( const std::string& sourcePath, size_t pointCount, double minX, double minY, double maxX, double maxY );
+
+        /**
+         * Returns whether the index is complete and belongs to a file in its current state.
+         * \param sourcePath Path of the LAS file.
+         * \param pointCount Count of point records of the file.
+         * \return The index can be used for that file or not.
+         */
+        bool isBuiltFor( const std::string& sourcePath, size_t pointCount );
+
+        /**
+         * Returns the count of record blocks.
+         * \return The count of record blocks.
+         */
+        size_t getBlockCount();
+
+        /**
+         * Returns the tile that covers a X/Y coordinate. Coordinates outside the header 
+         * area are put into the nearest border tile.
+         * \param x X coordinate.
+         * \param y Y coordinate.
+         * \return Index of the tile.
+         */
+        size_t getTile( double x, double y );
+
+        /**
+         * Stores the bounds and tiles of a block. Different blocks can be set 
+         * concurrently.
+         * \param block Index of the block.
+         * \param bounds Minimal and maximal X/Y/Z coordinates, minimal and maximal R/G/B 
+         *               colors and the minimal and maximal intensity of the block's points 
+         *               (see boundCount).
+         * \param tiles Tiles that contain points of the block. The list may contain 
+         *              duplicates.
+         */
+        void setBlock( size_t block, const double* bounds, const vector<size_t>& tiles );
+
+        /**
+         * Builds the tile lookup after all blocks are set.
+         */
+        void finishBlocks();
+
+        /**
+         * Returns the blocks that may have points within a region.
+         * \param minX Minimal X coordinate of the region.
+         * \param minY Minimal Y coordinate of the region.
+         * \param maxX Maximal X coordinate of the region.
+         * \param maxY Maximal Y coordinate of the region.
+         * \param blocks Output list of ascending block indices.
+         */
+        void fetchBlocksInRegion( double minX, double minY, double maxX, double maxY, vector<size_t>* blocks );
+
+        /**
+         * Merges the bounds of all blocks.
+         * \param minCoord Output minimal X/Y/Z coordinate.
+         * \param maxCoord Output maximal X/Y/Z coordinate.
+         * \param minColor Output minimal R/G/B color.
+         * \param maxColor Output maximal R/G/B color.
+         * \param intensityMin Output minimal intensity.
+         * \param intensityMax Output maximal intensity.
+         */
+        void fetchBounds( vector<double>* minCoord, vector<double>* maxCoord, vector<double>* minColor,
+                vector<double>* maxColor, double* intensityMin, double* intensityMax );
+
+        /**
+         * Loads the cached index of a LAS file.
+         * \param sourcePath Path of the LAS file.
+         * \param pointCount Count of point records of the LAS file.
+         * \return The cache existed and matches the file or not.
+         */
+        bool load( const std::string& sourcePath, size_t pointCount );
+
+        /**
+         * Saves the index beside its LAS file.
+         * \return The index could be saved or not.
+         */
+        bool save();
+
+        /**
+         * Count of consecutive point records of a block.
+         */
+        static const size_t blockPointCount;
+
+        /**
+         * Count of tiles of the X and the Y axis.
+         */
+        static const size_t tilesPerDimension;
+
+        /**
+         * Count of values of a block's bounds.
+         */
+        static const size_t boundCount;
+
+    private:
+        /**
+         * Returns the path of the index cache file.
+         * \param sourcePath Path of the LAS file.
+         * \return Path of the cache file.
+         */
+        static std::string getCachePath( const std::string& sourcePath );
+
+        /**
+         * Fetches the size and the modification time of a file.
+         * \param path Path of the file.
+         * \param size Output file size in bytes.
+         * \param time Output modification time.
+         * \return The file state could be fetched or not.
+         */
+        static bool fetchFileState( const std::string& path, size_t* size, std::time_t* time );
+
+        /**
+         * Returns the tile column or row of a coordinate.
+         * \param coordinate X or Y coordinate.
+         * \param dimension 0 for X and 1 for Y.
+         * \return Column or row index.
+         */
+        size_t getTileCoordinate( double coordinate, size_t dimension );
+
+        /**
+         * Path of the indexed LAS file.
+         */
+        std::string m_sourcePath;
+
+        /**
+         * Size of the indexed LAS file in bytes.
+         */
+        size_t m_sourceSize;
+
+        /**
+         * Modification time of the indexed LAS file.
+         */
+        std::time_t m_sourceTime;
+
+        /**
+         * Count of point records of the indexed file.
+         */
+        size_t m_pointCount;
+
+        /**
+         * Index is complete or not.
+         */
+        bool m_isComplete;
+
+        /**
+         * Minimal X and Y coordinate of the tile grid.
+         */
+        double m_gridMin[2];
+
+        /**
+         * Edge length of the tiles along X and Y.
+         */
+        double m_tileSize[2];
+
+        /**
+         * Bounds of each block. See boundCount.
+         */
+        vector<double> m_blockBounds;
+
+        /**
+         * Tiles of each block until finishBlocks() is called.
+         */
+        vector< vector<size_t> > m_blockTiles;
+
+        /**
+         * Position of each tile's first block within m_tileBlocks. An additional last 
+         * entry holds the list size.
+         */
+        vector<size_t> m_tileBlockOffsets;
+
+        /**
+         * Blocks of each tile.
+         */
+        vector<size_t> m_tileBlocks;
+    };
+} /* namespace laslibb */
+#endif  // WLASTILEINDEX_H
@@ -116,6 +116,17 @@ void WMReadLAS::properties()
                             "Note that the output has the range between 0.0 and 1.0.\r\nHint: Look ath the intensity "
                             "maximum param in the information tab of the ReadLAS plugin.", 0.005, m_propCondition );
 
+    WPropGroup tileStoreGroup = m_properties->addPropertyGroup( "Tile store", "" );
+    m_tileStoreFile = tileStoreGroup->addProperty( "Tile store path: ", "Target file of the tile store. It should end with \""
+                            + std::string( WPointTileStore::EXTENSION ) + "\".", WPathHelper::getAppPath() );
+    m_tileStoreTileSize = tileStoreGroup->addProperty( "Tile size: ", "Edge length of the square X/Y tiles of the store.",
+                            100.0, m_propCondition );
+    m_tileStoreTileSize->setMin( 0.001 );
+    m_tileStoreMemoryMB = tileStoreGroup->addProperty( "Memory [MB]: ", "Maximal size of the buffered points "
+                            "while writing the tile store.", 512, m_propCondition );
+    m_tileStoreMemoryMB->setMin( 1 );
+    m_writeTileStore = tileStoreGroup->addProperty( "Write tile store:",  "Write", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+
     m_nbVertices = m_infoProperties->addProperty( "Points", "The number of vertices in the loaded scan.", 0 );
     m_nbVertices->setMax( std::numeric_limits< int >::max() );
     m_minCoord.push_back( m_infoProperties->addProperty( "X min.: ", "Minimal x coordinate of all input points.", 0.0 ) );
@@ -160,6 +171,8 @@ void WMReadLAS::moduleMain()
         m_moduleState.wait();
 
         reader.setInputFilePath( m_lasFile->get().c_str() );
+        if( reader.readHeaderBounds() )
+            refreshScrollBars();
         try
         {
             reader.setDataSetRegion( m_sliderX->get( true ),
@@ -168,6 +181,19 @@ void WMReadLAS::moduleMain()
             reader.setColorsEnabled( m_colorsEnabled->get() );
             reader.setTranslateToCenter( m_translateDataToCenter->get( true ) );
             reader.setContrast( m_contrast->get() );
+            if( m_writeTileStore->get( true ) )
+            {
+                WPointTileStore tileStore;
+                if( !tileStore.create( m_tileStoreFile->get().c_str(), m_tileStoreTileSize->get(),
+                        static_cast<size_t>( m_tileStoreMemoryMB->get() ) * 1024 * 1024 ) )
+                    std::cout << "!!!Could not create the tile store " << m_tileStoreFile->get().c_str() << std::endl;
+                else if( reader.writeTileStore( &tileStore ) )
+                    m_nbVertices->set( tileStore.getPointCount() );
+                tileStore.finishWriting();
+                m_writeTileStore->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+                refreshScrollBars();
+                continue;
+            }
             boost::shared_ptr< WDataSetPoints > tmpPointSet = reader.getPoints();
             WDataSetPoints::VertexArray points = tmpPointSet->getVertices();
             WDataSetPoints::ColorArray colors = tmpPointSet->getColors();
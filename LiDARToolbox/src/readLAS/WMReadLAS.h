@@ -195,6 +195,27 @@ private:
      */
     WPropDouble m_contrast;
 
+    /**
+     * Path of the tile store file that is written by m_writeTileStore.
+     */
+    WPropFilename m_tileStoreFile;
+
+    /**
+     * Edge length of the tiles of the written tile store.
+     */
+    WPropDouble m_tileStoreTileSize;
+
+    /**
+     * Megabytes of points that are buffered in the memory while writing the tile store.
+     */
+    WPropInt m_tileStoreMemoryMB;
+
+    /**
+     * Writes the selected points into a tile store file instead of putting them out. 
+     * So point clouds that exceed the memory can be processed tile by tile.
+     */
+    WPropTrigger m_writeTileStore;
+
     WPropInt m_nbVertices; //!< Info-property showing the number of vertices in the mesh.
 
     /**
@@ -22,15 +22,99 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
+#include <functional>
+#include <utility>
 #include <vector>
 #include <limits>
+#include <boost/thread/mutex.hpp>
 #include "WLariBoundaryDetector.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "../common/math/leastSquares/WLeastSquares.h"
 
+/**
+ * Thread pool task that splits input point groups that can be spatially disconnected.
+ */
+class WBoundaryDetectionTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param classifier Point classifier whose progress is incremented for each input 
+     *                   cluster.
+     * \param inputClusters Spatial domain points grouped by their group ID.
+     * \param inputClusterOrder Sizes and indices of the input clusters in the order of 
+     *                          processing.
+     * \param maxPointDistanceR Neighbor search distance limit.
+     * \param clusterCounts Output count of spatially connected clusters of each input 
+     *                      cluster.
+     */
+    WBoundaryDetectionTask( WLariPointClassifier* classifier, vector<vector<WSpatialDomainKdPoint*>*>* inputClusters,
+            const vector< std::pair<size_t, size_t> >& inputClusterOrder, double maxPointDistanceR, vector<size_t>* clusterCounts )
+        : m_inputClusterOrder( inputClusterOrder )
+    {
+        m_classifier = classifier;
+        m_inputClusters = inputClusters;
+        m_maxPointDistanceR = maxPointDistanceR;
+        m_clusterCounts = clusterCounts;
+    }
+
+    /**
+     * Splits a range of input clusters. Each input cluster uses an own boundary 
+     * detector.
+     * \param begin First position within the processing order.
+     * \param end Position after the last one within the processing order.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t position = begin; position < end; position++ )
+        {
+            size_t cluster = m_inputClusterOrder[position].second;
+            WLariBoundaryDetector clusterDetector;
+            clusterDetector.setMaxPointDistanceR( m_maxPointDistanceR );
+            ( *m_clusterCounts )[cluster] = clusterDetector.detectInputCluster( m_inputClusters->at( cluster ) );
+            boost::mutex::scoped_lock lock( m_progressMutex );
+            m_classifier->incrementProgress();
+        }
+    }
+
+private:
+    /**
+     * Point classifier whose progress is incremented for each input cluster.
+     */
+    WLariPointClassifier* m_classifier;
+
+    /**
+     * Guards the progress status.
+     */
+    boost::mutex m_progressMutex;
+
+    /**
+     * Spatial domain points grouped by their group ID.
+     */
+    vector<vector<WSpatialDomainKdPoint*>*>* m_inputClusters;
+
+    /**
+     * Sizes and indices of the input clusters in the order of processing.
+     */
+    const vector< std::pair<size_t, size_t> >& m_inputClusterOrder;
+
+    /**
+     * Neighbor search distance limit.
+     */
+    double m_maxPointDistanceR;
+
+    /**
+     * Output count of spatially connected clusters of each input cluster.
+     */
+    vector<size_t>* m_clusterCounts;
+};
+
 
 WLariBoundaryDetector::WLariBoundaryDetector()
 {
-    m_spatialDomain = new WKdTreeND();
     m_spatialInputClusters = new vector<vector<WSpatialDomainKdPoint*>*>();
     m_currentClusterID = 0;
     m_transformAngle1zx = 0.0;
@@ -41,6 +125,10 @@ WLariBoundaryDetector::WLariBoundaryDetector()
 
 WLariBoundaryDetector::~WLariBoundaryDetector()
 {
+    for( size_t cluster = 0; cluster < m_spatialInputClusters->size(); cluster++ )
+        delete m_spatialInputClusters->at( cluster );
+    delete m_spatialInputClusters;
+    delete m_currentBoundary;
 }
 
 void WLariBoundaryDetector::detectBoundaries( WLariPointClassifier* classifier )
@@ -49,13 +137,23 @@ void WLariBoundaryDetector::detectBoundaries( WLariPointClassifier* classifier )
     cout << "detectBoundaries()" << endl;
     groupPointsByGroupID( m_classifier->getParameterDomain() );
 
-    m_classifier->setProgressSettings( m_spatialInputClusters->size(), m_spatialInputClusters->size(), "Boundary detection - " );
-    for( size_t cluster = 0; cluster < m_spatialInputClusters->size(); cluster++ )
+    size_t inputClusterCount = m_spatialInputClusters->size();
+    vector< std::pair<size_t, size_t> > inputClusterOrder( inputClusterCount );
+    for( size_t cluster = 0; cluster < inputClusterCount; cluster++ )
+        inputClusterOrder[cluster] = std::make_pair( m_spatialInputClusters->at( cluster )->size(), cluster );
+    std::sort( inputClusterOrder.begin(), inputClusterOrder.end(), std::greater< std::pair<size_t, size_t> >() );
+
+    m_classifier->setProgressSettings( inputClusterCount, inputClusterCount, "Boundary detection - " );
+    vector<size_t> clusterCounts( inputClusterCount, 0 );
+    WBoundaryDetectionTask task( m_classifier, m_spatialInputClusters, inputClusterOrder, m_maxPointDistanceR, &clusterCounts );
+    WThreadPool::getSharedPool()->parallelFor( &task, inputClusterCount, 1 );
+
+    for( size_t cluster = 0; cluster < inputClusterCount; cluster++ )
     {
-        cout << "Modified convex hull on cluster " << m_spatialInputClusters->at( cluster )->size()
-                << " points. [" << cluster << "]" << endl;
-        detectInputCluster( m_spatialInputClusters->at( cluster ) );
-        m_classifier->incrementProgress();
+        vector<WSpatialDomainKdPoint*>* inputCluster = m_spatialInputClusters->at( cluster );
+        for( size_t index = 0; index < inputCluster->size(); index++ )
+            inputCluster->at( index )->setClusterID( inputCluster->at( index )->getClusterID() + m_currentClusterID );
+        m_currentClusterID += clusterCounts[cluster];
     }
 }
 
@@ -70,7 +168,9 @@ void WLariBoundaryDetector::groupPointsByGroupID( WKdTreeND* parameterDomain )
 {
     cout << "groupPointsByGroupID()" << endl;
     vector<WKdPointND*>* parameterPoints = parameterDomain->getAllPoints();
-    m_spatialInputClusters = new vector<vector<WSpatialDomainKdPoint*>*>();
+    for( size_t cluster = 0; cluster < m_spatialInputClusters->size(); cluster++ )
+        delete m_spatialInputClusters->at( cluster );
+    m_spatialInputClusters->resize( 0 );
 
     for( size_t index = 0; index < parameterPoints->size(); index++ )
     {
@@ -90,6 +190,7 @@ void WLariBoundaryDetector::groupPointsByGroupID( WKdTreeND* parameterDomain )
             m_spatialInputClusters->at( currentInputClusterID )->push_back( spatialPoint );
         }
     }
+    delete parameterPoints;
 }
 
 void WLariBoundaryDetector::transformPoint( vector<double>* transformable )
@@ -98,8 +199,9 @@ void WLariBoundaryDetector::transformPoint( vector<double>* transformable )
     WVectorMaths::rotateVector( transformable, 2, 1, m_transformAngle2zy );
 }
 
-void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>* inputPointCluster )
+size_t WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>* inputPointCluster )
 {
+    m_currentClusterID = 0;
     initTransformationCoordinateSystem( inputPointCluster );
     vector<WBoundaryDetectPoint*>* clusterPoints = new vector<WBoundaryDetectPoint*>();
     WBoundaryDetectPoint* mostLeftPoint = 0;
@@ -109,7 +211,7 @@ void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>*
         WSpatialDomainKdPoint* currentPoint = inputPointCluster->at( index );
         vector<double>* coordinate = WVectorMaths::copyVectorForPointer( currentPoint->getCoordinate() );
         transformPoint( coordinate );
-        WBoundaryDetectPoint* clusterPoint = new WBoundaryDetectPoint( *coordinate );
+        WBoundaryDetectPoint* clusterPoint = m_clusterPoints.create( *coordinate );
         clusterPoint->setSpatialPoint( currentPoint );
         clusterPoints->push_back( clusterPoint );
         currentPoint->setClusterID( 9 );
@@ -117,6 +219,9 @@ void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>*
         delete coordinate;
     }
 
+    WKdTreeND* clusterKdTree = new WKdTreeND( 2 );
+    clusterKdTree->add( reinterpret_cast< vector<WKdPointND*>*>( clusterPoints ) );
+    m_clusterSearcher.setExaminedKdTree( clusterKdTree );
     while( clusterPoints->size() > 0 )
     {
         m_currentBoundary->resize( 0 );
@@ -124,7 +229,7 @@ void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>*
 
         for( size_t index = 0; index < clusterPoints->size(); index++ )
         {
-            vector<double> coordinate = clusterPoints->at( index )->getCoordinate();
+            const vector<double>& coordinate = clusterPoints->at( index )->getCoordinate();
             if( index == 0 || coordinate[0] < mostLeftPoint->getCoordinate()[0] )
                 mostLeftPoint = clusterPoints->at( index );
             if( !WVectorMaths::isValidVector( coordinate ) )
@@ -138,10 +243,6 @@ void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>*
             }
         }
 
-        WKdTreeND* clusterKdTree = new WKdTreeND( 2 );
-        clusterKdTree->add( reinterpret_cast< vector<WKdPointND*>*>( clusterPoints ) );
-        m_clusterSearcher.setExaminedKdTree( clusterKdTree );
-
         m_currentBoundary->push_back( mostLeftPoint );
         mostLeftPoint->getSpatialPoint()->setClusterID( m_currentClusterID );
         mostLeftPoint->setIsAddedToPlane( true );
@@ -180,8 +281,15 @@ void WLariBoundaryDetector::detectInputCluster( vector<WSpatialDomainKdPoint*>*
         for( size_t index = 0; index < oldPoints->size(); index++ )
             if( !oldPoints->at( index )->isAddedToPlane() )
                 clusterPoints->push_back( oldPoints->at( index ) );
+            else
+                oldPoints->at( index )->setIsRemovedFromWaitList( true );
+        delete oldPoints;
         //TODO(aschwarzkopf): Merge invalid points group by distance.
     }
+    delete clusterPoints;
+    delete clusterKdTree;
+    m_clusterPoints.clear();
+    return m_currentClusterID;
 }
 
 void WLariBoundaryDetector::initTransformationCoordinateSystem( vector<WSpatialDomainKdPoint*>* extentPointCluster )
@@ -220,7 +328,7 @@ WBoundaryDetectPoint* WLariBoundaryDetector::getNextBoundPoint()
     {
         WBoundaryDetectPoint* currentNextPoint = static_cast<WBoundaryDetectPoint*>( nearestPoints->at(
                 index ).getComparedPoint() ); //TODO(aschwarzkopf): Can't watch coordinates using expressions
-        if( lastBoundaryPointCanReachPoint( nearestPoints->at(index) ) )
+        if( !currentNextPoint->isRemovedFromWaitList() && lastBoundaryPointCanReachPoint( nearestPoints->at(index) ) )
         {
             double nextAngle = getAngleToNextPoint( previousPoint, currentPoint, currentNextPoint );
             if( nextAngle < narrowestAngle && !isResultingBoundIntersection( currentNextPoint ) )
@@ -231,6 +339,7 @@ WBoundaryDetectPoint* WLariBoundaryDetector::getNextBoundPoint()
         }
     }
 
+    delete nearestPoints;
     if( m_currentBoundary->size() < 2 )
         delete previousPoint;
     return nextPoint;
@@ -252,16 +361,11 @@ bool WLariBoundaryDetector::lastBoundaryPointCanReachPoint( WPointDistance nextP
 double WLariBoundaryDetector::getAngleToNextPoint( WBoundaryDetectPoint* previousPoint,
         WBoundaryDetectPoint* currentPoint, WBoundaryDetectPoint* nextPoint )
 {
-    vector<double>* vectorPoint = WVectorMaths::copyVectorForPointer( nextPoint->getCoordinate() );
-    vector<double>* currentPointCoords = WVectorMaths::copyVectorForPointer( currentPoint->getCoordinate() );
-    WVectorMaths::invertVector( currentPointCoords );
-    WVectorMaths::addVector( vectorPoint, *currentPointCoords );
-    double angleToNext = WVectorMaths::getAngleToAxisComplete( vectorPoint->at( 0 ), vectorPoint->at( 1 ) );
-    vectorPoint = WVectorMaths::copyVectorForPointer( previousPoint->getCoordinate() );
-    WVectorMaths::addVector( vectorPoint, *currentPointCoords );
-    double angleToPrevious = WVectorMaths::getAngleToAxisComplete( vectorPoint->at( 0 ), vectorPoint->at( 1 ) );
-    delete currentPointCoords;
-    delete vectorPoint;
+    const vector<double>& current = currentPoint->getCoordinate();
+    const vector<double>& next = nextPoint->getCoordinate();
+    const vector<double>& previous = previousPoint->getCoordinate();
+    double angleToNext = WVectorMaths::getAngleToAxisComplete( next[0] - current[0], next[1] - current[1] );
+    double angleToPrevious = WVectorMaths::getAngleToAxisComplete( previous[0] - current[0], previous[1] - current[1] );
     while( angleToNext < 0.0 )
         angleToNext += 360.0;
     while( angleToPrevious <= angleToNext )
@@ -345,11 +449,11 @@ bool WLariBoundaryDetector::pointIsInBounds( const vector<double>& point )
 
 bool WLariBoundaryDetector::pointLiesOnBound( const vector<double>& point, size_t boundNr )
 {
-    const vector<double> boundPoint1 = m_currentBoundary->at( boundNr )->getCoordinate();
+    const vector<double>& boundPoint1 = m_currentBoundary->at( boundNr )->getCoordinate();
     double secondIndex = boundNr + 1;
     while( boundNr >= m_currentBoundary->size() )
         boundNr -= m_currentBoundary->size();
-    const vector<double> boundPoint2 = m_currentBoundary->at( secondIndex )->getCoordinate();
+    const vector<double>& boundPoint2 = m_currentBoundary->at( secondIndex )->getCoordinate();
     if( !WVectorMaths::isPointOnLine2d( point, boundPoint1, boundPoint2 ) )
         return false;
     return WVectorMaths::isPointOnLine2d( point, boundPoint1, boundPoint2 );
@@ -357,11 +461,11 @@ bool WLariBoundaryDetector::pointLiesOnBound( const vector<double>& point, size_
 
 bool WLariBoundaryDetector::pointHitsBound( const vector<double>& point, size_t boundNr )
 {
-    const vector<double> boundPoint1 = m_currentBoundary->at( boundNr )->getCoordinate();
+    const vector<double>& boundPoint1 = m_currentBoundary->at( boundNr )->getCoordinate();
     size_t secondIndex = boundNr + 1;
     while( secondIndex >= m_currentBoundary->size() )
         secondIndex -= m_currentBoundary->size();
-    const vector<double> boundPoint2 = m_currentBoundary->at( secondIndex )->getCoordinate();
+    const vector<double>& boundPoint2 = m_currentBoundary->at( secondIndex )->getCoordinate();
     return WVectorMaths::linesCanIntersectBounded( boundPoint1, boundPoint2, point, m_oneOutsidePoint );
 }
 
@@ -33,6 +33,7 @@
 #include "structure/WSpatialDomainKdPoint.h"
 #include "structure/WBoundaryDetectPoint.h"
 #include "../common/datastructures/kdtree/WKdTreeND.h"
+#include "../common/datastructures/kdtree/WKdPointArena.h"
 #include "../common/datastructures/kdtree/WKdPointND.h"
 #include "../common/datastructures/kdtree/WPointSearcher.h"
 #include "../common/math/vectors/WVectorMaths.h"
@@ -52,10 +53,12 @@ using std::vector;
  * How it works:
  *  A) Isolating points in sets to treat point sets only of a similar planar formula of 
  *     points in relation to their neighbors.
- *  B) Treating each cluster
+ *  B) Treating each cluster. Clusters are independent, so they are processed in 
+ *     parallel beginning with the largest ones.
  *      1) Rotating that way so that this planar normal vector is approximately parallel 
  *         to the Z axis to enable the set to be analyzed using a two dimensional 
- *         coordinate system. That point set is added to the wait list.
+ *         coordinate system. That point set is added to the wait list and to a two 
+ *         dimensional kd tree that is built only once.
  *      2) While still points remain in the wait list.
  *          a) marking the most left point.
  *          b) Detecting the bound from that point counterclockwise.
@@ -66,7 +69,10 @@ using std::vector;
  *                 every bound hit. It supposes that this condition can't remain after a 
  *                 bound hit.
  *          d) Adding the bound and points inside to a new cluster.
- *          e) Removing it from the waiting list.
+ *          e) Removing it from the waiting list. Removed points are skipped by 
+ *             further kd tree searches.
+ *  C) Numbering the new clusters of each input cluster consecutively in the order of 
+ *     the input clusters.
  */
 class WLariBoundaryDetector
 {
@@ -105,6 +111,14 @@ public:
      */
     void setMaxPointDistanceR( double maxPointDistanceR );
 
+    /**
+     * Splits a single point group that can be spatially disconnected. The spatially 
+     * connected clusters get the cluster IDs beginning with 0.
+     * \param inputPointCluster Input point group to be further splitted.
+     * \return Count of the detected spatially connected clusters.
+     */
+    size_t detectInputCluster( vector<WSpatialDomainKdPoint*>* inputPointCluster );
+
 private:
     /**
      * Groups spatial domain points using their group ID that was previously assigned by 
@@ -114,12 +128,6 @@ private:
      */
     void groupPointsByGroupID( WKdTreeND* parameterDomain );
 
-    /**
-     * Splits a single point group that can be spatially disconnected.
-     * \param inputPointCluster Input point group to be further splitted.
-     */
-    void detectInputCluster( vector<WSpatialDomainKdPoint*>* inputPointCluster );
-
     /**
      * Inits the points rotation angles to use boundary detection on two dimensional 
      * basis. The averate normal vector of point's planar formulas in relation to its 
@@ -230,11 +238,6 @@ private:
      */
     WLariPointClassifier* m_classifier;
 
-    /**
-     * Spatial domain point set kd tree to be analyzed and its point group IDs modified.
-     */
-    WKdTreeND* m_spatialDomain;
-
     /**
      * Spatial domain points grouped by their group ID. Previously points are detected 
      * using the peak detection approach oof Lari/Habib. So previously points were 
@@ -268,6 +271,12 @@ private:
      */
     vector<WBoundaryDetectPoint*>* m_currentBoundary;
 
+    /**
+     * Keeps the transformed points of the examined input cluster until the cluster is 
+     * done.
+     */
+    WKdPointArena<WBoundaryDetectPoint> m_clusterPoints;
+
     /**
      * Point search instance to find points near an arbitrary coordinate.
      */
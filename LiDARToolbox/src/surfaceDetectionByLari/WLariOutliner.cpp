@@ -50,7 +50,7 @@ boost::shared_ptr< WDataSetPointsGrouped > WLariOutliner::outlineParameterDomain
         WParameterDomainKdPoint* parameter = static_cast<WParameterDomainKdPoint*>( parameters->at( index ) );
         if( m_pointClassifier->calculateIsPlanarPoint( parameter->getSpatialPoint()->getEigenValues() ) )
         {
-            vector<double> parameterCoordinate = parameter->getCoordinate();
+            const vector<double>& parameterCoordinate = parameter->getCoordinate();
             for( size_t dimension = 0; dimension < parameterCoordinate.size(); dimension++ )
                 outVertices->push_back( parameterCoordinate[dimension] );
             for( size_t colorCh = 0; colorCh < 3; colorCh++ )
@@ -77,7 +77,7 @@ boost::shared_ptr< WDataSetPointsGrouped > WLariOutliner::outlineSpatialDomainGr
         WSpatialDomainKdPoint* spatialPoint = static_cast<WSpatialDomainKdPoint*>( spatialDomainPoints->at( index ) );
         if( m_pointClassifier->calculateIsPlanarPoint( spatialPoint->getEigenValues() ) )
         {
-            vector<double> spatialCoordinate = spatialPoint->getCoordinate();
+            const vector<double>& spatialCoordinate = spatialPoint->getCoordinate();
             for( size_t dimension = 0; dimension < spatialCoordinate.size(); dimension++ )
                 outVertices->push_back( spatialCoordinate[dimension] );
             outGroups->push_back( spatialPoint->getClusterID() );
@@ -98,7 +98,7 @@ boost::shared_ptr< WDataSetPoints > WLariOutliner::outlineSpatialDomainCategorie
     for( size_t index = 0; index < spatialDomainPoints->size(); index++ )
     {
         WSpatialDomainKdPoint* spatialPoint = static_cast<WSpatialDomainKdPoint*>( spatialDomainPoints->at( index ) );
-        vector<double> spatialCoordinate = spatialPoint->getCoordinate();
+        const vector<double>& spatialCoordinate = spatialPoint->getCoordinate();
         vector<double> eigenValues = spatialPoint->getEigenValues();
 
         for( size_t dimension = 0; dimension < spatialCoordinate.size(); dimension++ )
@@ -129,7 +129,7 @@ boost::shared_ptr< WTriangleMesh > WLariOutliner::outlineLeastSquaresPlanes( dou
     for( size_t index = 0; index < spatialNodes->size(); index++ )
     {
         WSpatialDomainKdPoint* spatialDomainPoint = static_cast<WSpatialDomainKdPoint*>( spatialNodes->at( index ) );
-        vector<double> spatialCoordinate = spatialDomainPoint->getCoordinate();
+        const vector<double>& spatialCoordinate = spatialDomainPoint->getCoordinate();
         WPosition spatialPoint( 0.0, 0.0, 0.0 );
         for( size_t dimension = 0; dimension < spatialCoordinate.size(); dimension++ )
             spatialPoint[dimension] = spatialCoordinate[dimension];
@@ -22,11 +22,78 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <limits>
 #include <string>
 #include "WLariPointClassifier.h"
-#include "../common/math/leastSquares/WLeastSquares.h"
+
+const size_t WLariPointClassifier::searchBlockSize = 65536;
+
+/**
+ * Thread pool task that classifies a block of points of which the nearest neighbors 
+ * are already searched.
+ */
+class WLariClassificationTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param classifier Classifier that analyzes the points.
+     * \param blockPoints First classified point of the block.
+     * \param neighborOffsets Index of the first neighbor of each block point within 
+     *                        neighborIndices and an additional last item.
+     * \param neighborIndices Spatial domain indices of the neighbors of all block points.
+     */
+    WLariClassificationTask( WLariPointClassifier* classifier, WSpatialDomainKdPoint** blockPoints,
+            const vector<size_t>& neighborOffsets, const vector<size_t>& neighborIndices ) :
+        m_neighborOffsets( neighborOffsets ),
+        m_neighborIndices( neighborIndices )
+    {
+        m_classifier = classifier;
+        m_blockPoints = blockPoints;
+    }
+
+    /**
+     * Classifies a range of block points. The least squares adjustment is shared by the 
+     * points of the range.
+     * \param begin First point index within the block.
+     * \param end Index after the last point.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        WLeastSquares leastSquares;
+        for( size_t index = begin; index < end; index++ )
+            m_classifier->classifyPoint( m_blockPoints[index], &m_neighborIndices[0] + m_neighborOffsets[index],
+                    m_neighborOffsets[index + 1] - m_neighborOffsets[index], &leastSquares );
+        m_classifier->incrementProgress( end - begin );
+    }
+
+private:
+    /**
+     * Classifier that analyzes the points.
+     */
+    WLariPointClassifier* m_classifier;
+
+    /**
+     * First classified point of the block.
+     */
+    WSpatialDomainKdPoint** m_blockPoints;
+
+    /**
+     * Index of the first neighbor of each block point within m_neighborIndices.
+     */
+    const vector<size_t>& m_neighborOffsets;
+
+    /**
+     * Spatial domain indices of the neighbors of all block points.
+     */
+    const vector<size_t>& m_neighborIndices;
+};
+
 
 
 WLariPointClassifier::WLariPointClassifier()
@@ -41,14 +108,18 @@ WLariPointClassifier::WLariPointClassifier()
     m_cylindricalNLambdaMin.resize( 3 );
     m_cylindricalNLambdaMax.reserve( 3 );
     m_cylindricalNLambdaMax.resize( 3 );
-    m_spatialDomain = new WKdTreeND( 3 );
+    m_spatialDomain = new WKdTreeStaticND( 3 );
     m_parameterDomain = new WKdTreeND( 3 );
+    m_threadPool = 0;
 
-    setCpuThreadCount( 8 );
+    setCpuThreadCount( WThreadPool::getHardwareThreadCount() );
 }
 
 WLariPointClassifier::~WLariPointClassifier()
 {
+    delete m_spatialDomain;
+    delete m_parameterDomain;
+    delete m_threadPool;
 }
 
 void WLariPointClassifier::analyzeData( vector<WSpatialDomainKdPoint*>* inputPoints )
@@ -56,8 +127,9 @@ void WLariPointClassifier::analyzeData( vector<WSpatialDomainKdPoint*>* inputPoi
     cout << "Attempting to analyze " << inputPoints->size() << " points" << endl;
     delete m_spatialDomain;
     delete m_parameterDomain;
-    m_spatialDomain = new WKdTreeND( 3 );
+    m_spatialDomain = new WKdTreeStaticND( 3 );
     m_parameterDomain = new WKdTreeND( 3 );
+    m_parameterPoints.clear();
     m_spatialDomain->add( reinterpret_cast<vector<WKdPointND*>*>( inputPoints ) );
     vector<WParameterDomainKdPoint*>* parameterPoints = new vector<WParameterDomainKdPoint*>();
 
@@ -65,6 +137,7 @@ void WLariPointClassifier::analyzeData( vector<WSpatialDomainKdPoint*>* inputPoi
 
     cout << "Adding " << parameterPoints->size() << " parameter points" << endl;
     m_parameterDomain->add( reinterpret_cast<vector<WKdPointND*>*>( parameterPoints ) );
+    delete parameterPoints;
 }
 
 WKdTreeND* WLariPointClassifier::getParameterDomain()
@@ -72,7 +145,7 @@ WKdTreeND* WLariPointClassifier::getParameterDomain()
     return m_parameterDomain;
 }
 
-WKdTreeND* WLariPointClassifier::getSpatialDomain()
+WKdTreeStaticND* WLariPointClassifier::getSpatialDomain()
 {
     return m_spatialDomain;
 }
@@ -81,20 +154,33 @@ void WLariPointClassifier::classifyPoints( vector<WSpatialDomainKdPoint*>* spati
 {
     setProgressSettings( spatialPoints->size(), spatialPoints->size(), "Point classification - " );
 
-    size_t threads = m_cpuThreadCount < spatialPoints->size() ?m_cpuThreadCount :spatialPoints->size();
-    for( size_t thread = 0; thread < threads; thread++ )
-        m_cpuThreads[thread] = new boost::thread( &WLariPointClassifier::
-                classifyPointsAtThread, this, spatialPoints, thread );
-    for( size_t thread = 0; thread < threads; thread++ )
-        m_cpuThreads[thread]->join();
+    WBatchPointSearcher spatialSearcher( m_spatialDomain );
+    spatialSearcher.setThreadPool( m_threadPool );
+    spatialSearcher.setMaxResultPointCount( m_numberPointsK );
+    spatialSearcher.setMaxSearchDistance( m_maxPointDistanceR );
+    vector<double> coordinates;
+    vector<size_t> neighborOffsets;
+    vector<size_t> neighborIndices;
+    for( size_t blockBegin = 0; blockBegin < spatialPoints->size(); blockBegin += searchBlockSize )
+    {
+        size_t blockEnd = std::min( blockBegin + searchBlockSize, spatialPoints->size() );
+        coordinates.clear();
+        for( size_t index = blockBegin; index < blockEnd; index++ )
+        {
+            const vector<double>& coordinate = spatialPoints->at( index )->getCoordinate();
+            coordinates.insert( coordinates.end(), coordinate.begin(), coordinate.begin() + 3 );
+        }
+        spatialSearcher.getNearestPointIndices( coordinates, &neighborOffsets, &neighborIndices );
+        WLariClassificationTask task( this, &( *spatialPoints )[blockBegin], neighborOffsets, neighborIndices );
+        m_threadPool->parallelFor( &task, blockEnd - blockBegin );
+    }
 
     for( size_t index = 0; index < spatialPoints->size(); index++ )
     {
         WSpatialDomainKdPoint* spatialPoint = spatialPoints->at( index );
         if( calculateIsPlanarPoint(spatialPoint->getEigenValues() ) && spatialPoint->hasValidParameters() )
         {
-            WParameterDomainKdPoint* newParameter =
-                    new WParameterDomainKdPoint( spatialPoint->getParametersXYZ0() );
+            WParameterDomainKdPoint* newParameter = m_parameterPoints.create( spatialPoint->getParametersXYZ0() );
             newParameter->setSpatialPoint( spatialPoint );
             parameterPoints->push_back( newParameter );
         }
@@ -102,36 +188,35 @@ void WLariPointClassifier::classifyPoints( vector<WSpatialDomainKdPoint*>* spati
     }
 }
 
-void WLariPointClassifier::classifyPointsAtThread( vector<WSpatialDomainKdPoint*>* spatialPoints, size_t threadIndex )
+void WLariPointClassifier::classifyPoint( WSpatialDomainKdPoint* spatialPoint, const size_t* neighbors, size_t neighborCount,
+        WLeastSquares* leastSquares )
 {
-    WPointSearcher spatialSearcher( m_spatialDomain );
-    spatialSearcher.setMaxResultPointCount( m_numberPointsK );
-    spatialSearcher.setMaxSearchDistance( m_maxPointDistanceR );
-    for( size_t index = threadIndex; index < spatialPoints->size(); index += m_cpuThreadCount )
+    WCovarianceMoments moments;
+    for( size_t neighbor = 0; neighbor < neighborCount; neighbor++ )
+        moments.addPoint( m_spatialDomain->getCoordinate( neighbors[neighbor], 0 ),
+                m_spatialDomain->getCoordinate( neighbors[neighbor], 1 ),
+                m_spatialDomain->getCoordinate( neighbors[neighbor], 2 ) );
+    spatialPoint->setKNearestPoints( neighborCount );
+    const vector<double>& coordinate = spatialPoint->getCoordinate();
+    double distance = 0.0;
+    for( size_t dimension = 0; dimension < 3; dimension++ )
     {
-        WSpatialDomainKdPoint* spatialPoint = spatialPoints->at( index );
-        vector<double> spatialCoordinate = spatialPoint->getCoordinate();
-        spatialSearcher.setSearchedPoint( spatialCoordinate );
-        vector<WPointDistance>* nearestPoints = spatialSearcher.getNearestPoints();
-        vector<WPosition>* points = WPointDistance::convertToPointSet( nearestPoints );
-        spatialPoint->setKNearestPoints( points->size() );
-        spatialPoint->setDistanceToNthNearestNeighbor( nearestPoints->at( points->size() - 1 ).getDistance() );
-
-        WPrincipalComponentAnalysis pca;
-        pca.analyzeData( *points );
-        spatialPoint->setEigenVectors( pca.getEigenVectors() );
-        vector<double> eigenValues = pca.getEigenValues();
-        spatialPoint->setEigenValues( eigenValues );
-
-        WLeastSquares leastSquares;
-        leastSquares.analyzeData( points );
-        spatialPoint->setHessianNormalForm( leastSquares.getHessianNormalForm() );
+        double difference = m_spatialDomain->getCoordinate( neighbors[neighborCount - 1], dimension ) - coordinate[dimension];
+        distance += difference * difference;
+    }
+    spatialPoint->setDistanceToNthNearestNeighbor( sqrt( distance ) );
 
-        delete nearestPoints;
-        delete points;
+    double covariance[6];
+    double eigenValues[3];
+    double eigenVectors[9];
+    moments.fetchCovariance( covariance );
+    WCovarianceMoments::fetchSymmetricEigenValues( covariance, eigenValues );
+    WCovarianceMoments::fetchSymmetricEigenVectors( covariance, eigenValues, eigenVectors );
+    spatialPoint->setEigenVectors( eigenVectors );
+    spatialPoint->setEigenValues( eigenValues );
 
-        incrementProgress();
-    }
+    leastSquares->analyzeData( moments );
+    spatialPoint->setHessianNormalForm( leastSquares->getHessianNormalForm() );
 }
 
 bool WLariPointClassifier::calculateIsPlanarPoint( const vector<double>& eigenValues )
@@ -180,9 +265,10 @@ void WLariPointClassifier::setMaxPointDistanceR( double maxPointDistance )
 
 void WLariPointClassifier::setCpuThreadCount( size_t cpuThreadCount )
 {
-    m_cpuThreadCount = cpuThreadCount;
-    m_cpuThreads.reserve( m_cpuThreadCount );
-    m_cpuThreads.resize( m_cpuThreadCount );
+    if( m_threadPool != 0 && m_threadPool->getThreadCount() == cpuThreadCount )
+        return;
+    delete m_threadPool;
+    m_threadPool = new WThreadPool( cpuThreadCount );
 }
 
 void WLariPointClassifier::setPlanarNLambdaRange( size_t lambdaIndex, double min, double max )
@@ -216,6 +302,11 @@ void WLariPointClassifier::incrementProgress()
     m_progressStatus->increment( 1 );
 }
 
+void WLariPointClassifier::incrementProgress( size_t steps )
+{
+    m_progressStatus->increment( steps );
+}
+
 void WLariPointClassifier::finishProgress()
 {
     m_progressStatus->finish();
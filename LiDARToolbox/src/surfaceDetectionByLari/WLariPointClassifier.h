@@ -28,16 +28,20 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <boost/thread.hpp>
 
 #include "core/dataHandler/WDataSetPoints.h"
 #include "structure/WParameterDomainKdPoint.h"
 #include "structure/WSpatialDomainKdPoint.h"
-#include "core/common/math/principalComponentAnalysis/WPrincipalComponentAnalysis.h"
 #include "core/common/WRealtimeTimer.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
+#include "../common/datastructures/kdtree/WBatchPointSearcher.h"
+#include "../common/datastructures/kdtree/WKdPointArena.h"
 #include "../common/datastructures/kdtree/WKdTreeND.h"
+#include "../common/datastructures/kdtree/WKdTreeStaticND.h"
 #include "../common/datastructures/kdtree/WKdPointND.h"
 #include "../common/datastructures/kdtree/WPointSearcher.h"
+#include "../common/math/covariance/WCovarianceMoments.h"
+#include "../common/math/leastSquares/WLeastSquares.h"
 #include "../common/math/vectors/WVectorMaths.h"
 #include "../tempLeastSquaresTest/WMTempLeastSquaresTest.h"
 
@@ -64,7 +68,8 @@ public:
     virtual ~WLariPointClassifier();
 
     /**
-     * Analyzes input point data.
+     * Analyzes input point data. The input points aren't owned by the classifier. They 
+     * have to outlive it.
      * \param inputPoints Input point data to analyze.
      */
     void analyzeData( vector<WSpatialDomainKdPoint*>* inputPoints );
@@ -80,7 +85,7 @@ public:
      * Returns the input points that belong to the spatial domain.
      * \return The whole point set of the spatial domain.
      */
-    WKdTreeND* getSpatialDomain();
+    WKdTreeStaticND* getSpatialDomain();
 
     /**
      * Calculates whether a point's eigen values in relation to its neighbors have 
@@ -113,7 +118,8 @@ public:
     void setMaxPointDistanceR( double maxPointDistance );
 
     /**
-     * Sets the applied CPU thread count.
+     * Sets the applied CPU thread count. The classifier keeps a thread pool of that 
+     * size. It defaults to the hardware thread count.
      * \param cpuThreadCount Applied CPU thread count.
      */
     void setCpuThreadCount( size_t cpuThreadCount );
@@ -165,31 +171,49 @@ public:
      */
     void incrementProgress();
 
+    /**
+     * Increments the progress status.
+     * \param steps Count of units to increment.
+     */
+    void incrementProgress( size_t steps );
+
     /**
      * Finishes the progress.
      */
     void finishProgress();
 
+    /**
+     * Classifies a point using Eigen Value analyses (Eigen Values and Eigen Vectors) and 
+     * least squares adjustment. Both are calculated in closed form from the moments of 
+     * the neighbors.
+     * \param spatialPoint Spatial domain point to analyze.
+     * \param neighbors Indices of the point's nearest neighbors within the spatial 
+     *                  domain (see WKdTreeStaticND::getPoint()) sorted by their distance 
+     *                  ascending.
+     * \param neighborCount Count of the nearest neighbors.
+     * \param leastSquares Least squares adjustment that is reused by consecutive calls 
+     *                     of a thread.
+     */
+    void classifyPoint( WSpatialDomainKdPoint* spatialPoint, const size_t* neighbors, size_t neighborCount,
+            WLeastSquares* leastSquares );
+
+    /**
+     * Count of points of which the nearest neighbors are searched at once. It limits the 
+     * memory of the neighbor lists.
+     */
+    static const size_t searchBlockSize;
+
 private:
     /**
      * Classifies points using Eigen Value analyses (Eigen Values and Eigen Vectors) and 
-     * least squares adjustment. The method uses multithreading.
+     * least squares adjustment. The nearest neighbors of blocks of points are searched 
+     * at once. Each block is classified in dynamically scheduled chunks on m_threadPool.
      * \param spatialPoints Spatial domain points to analyze.
      * \param parameterPoints List of assigned parameter domain points that are 
      *                        initialized in this method.
      */
     void classifyPoints( vector<WSpatialDomainKdPoint*>* spatialPoints, vector<WParameterDomainKdPoint*>* parameterPoints );
 
-    /**
-     * Classifies points using Eigen Value analyses (Eigen Values and Eigen Vectors) and 
-     * least squares adjustment. The method Apply this method for every thread index.
-     * \param spatialPoints Spatial domain points to analyze.
-     * \param threadIndex CPU thread index.
-     */
-    void classifyPointsAtThread( vector<WSpatialDomainKdPoint*>* spatialPoints, size_t threadIndex );
-
-
-
 
     /**
      * The maximal count of analyzed neighbors of an examined input point. It is the 
@@ -230,7 +254,7 @@ private:
      * the parameter domain points. Each parameter point depicts a best fitted plane 
      * formula of each corresponding input point of the spatial domain.
      */
-    WKdTreeND* m_spatialDomain;
+    WKdTreeStaticND* m_spatialDomain;
 
     /**
      * The input points that belong to the spatial domain.
@@ -238,14 +262,16 @@ private:
     WKdTreeND* m_parameterDomain;
 
     /**
-     * CPU threads count for multithreading support.
+     * Keeps the parameter domain points. They are freed at once when the next analysis 
+     * starts or the classifier is destroyed.
      */
-    size_t m_cpuThreadCount;
+    WKdPointArena<WParameterDomainKdPoint> m_parameterPoints;
 
     /**
-     * CPU threads object for multithreading support.
+     * Thread pool that classifies the points. Its threads are reused by each 
+     * analyzeData() call.
      */
-    vector<boost::thread*> m_cpuThreads;
+    WThreadPool* m_threadPool;
 
 
     /**
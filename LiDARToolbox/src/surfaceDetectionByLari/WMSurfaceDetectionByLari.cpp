@@ -122,9 +122,10 @@ void WMSurfaceDetectionByLari::properties()
 
     m_squareWidth = m_properties->addProperty( "Plane outline size: ", "", 0.2, m_propCondition );
 
-    m_cpuThreadCount = m_properties->addProperty( "CPU threads: ", "", 8, m_propCondition );
-    m_cpuThreadCount->setMin( 4 );
-    m_cpuThreadCount->setMax( 24 );
+    int hardwareThreadCount = static_cast<int>( WThreadPool::getHardwareThreadCount() );
+    m_cpuThreadCount = m_properties->addProperty( "CPU threads: ", "", hardwareThreadCount, m_propCondition );
+    m_cpuThreadCount->setMin( 1 );
+    m_cpuThreadCount->setMax( hardwareThreadCount > 24 ?hardwareThreadCount :24 );
 
     m_planarGroup = m_properties->addPropertyGroup( "Planar feature properties",
                                             "All conditions must be met to detect as a surface." );
@@ -214,13 +215,15 @@ void WMSurfaceDetectionByLari::moduleMain()
 
             WQuadTree* boundingBox = new WQuadTree( pow( 2.0, 3 ) );
 
+            WKdPointArena<WSpatialDomainKdPoint> inputPointArena;
             vector<WSpatialDomainKdPoint*>* inputPoints = new vector<WSpatialDomainKdPoint*>();
+            inputPoints->reserve( count );
             for  ( size_t vertex = 0; vertex < count; vertex++)
             {
                 float x = inputVerts->at( vertex*3 );
                 float y = inputVerts->at( vertex*3+1 );
                 float z = inputVerts->at( vertex*3+2 );
-                inputPoints->push_back( new WSpatialDomainKdPoint( x, y, z ) );
+                inputPoints->push_back( inputPointArena.create( x, y, z ) );
                 boundingBox->registerPoint( x, y, z );
             }
 
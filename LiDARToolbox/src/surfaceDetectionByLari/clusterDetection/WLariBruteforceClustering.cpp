@@ -30,12 +30,16 @@
 #include "WLariBruteforceClustering.h"
 
 
+const size_t WLariBruteforceClustering::notInExtentHeap = static_cast<size_t>( -1 );
+
 WLariBruteforceClustering::WLariBruteforceClustering( WLariPointClassifier* classifier )
 {
     m_pointClassifier = classifier;
 
     m_parameterDomain = new WKdTreeND( 3 );
-    m_parameterDomain->add( classifier->getParameterDomain()->getAllPoints() );
+    vector<WKdPointND*>* parameterPoints = classifier->getParameterDomain()->getAllPoints();
+    m_parameterDomain->add( parameterPoints );
+    delete parameterPoints;
 
     m_segmentationMaxAngleDegrees = 10.0;
     m_segmentationMaxPlaneDistance = 1.0;
@@ -44,40 +48,20 @@ WLariBruteforceClustering::WLariBruteforceClustering( WLariPointClassifier* clas
 
 WLariBruteforceClustering::~WLariBruteforceClustering()
 {
+    delete m_parameterDomain;
 }
 
 void WLariBruteforceClustering::detectClustersByBruteForce()
 {
     vector<WKdPointND*>* parameterNodes = m_parameterDomain->getAllPoints();
     m_currentClusterID = 0;
-    while( parameterNodes->size() > 0 )
+    initExtentSizes( parameterNodes );
+    initExtentHeap( parameterNodes );
+    delete parameterNodes;
+    while( m_extentHeap.size() > 0 )
     {
-        initExtentSizes( parameterNodes );
-        WParameterDomainKdPoint* biggestExtentPoint = 0;
-        size_t mostNeighborsCount = 0;
-        for( size_t index = 0; index < parameterNodes->size(); index++ )
-        {
-            WParameterDomainKdPoint* parameterPoint = static_cast<WParameterDomainKdPoint*>( parameterNodes->at( index ) );
-            if( parameterPoint->getExtentPointCount() > mostNeighborsCount )
-            {
-                biggestExtentPoint = parameterPoint;
-                mostNeighborsCount = parameterPoint->getExtentPointCount();
-            }
-        }
-        addExtentCluster( biggestExtentPoint, m_currentClusterID++ );
-
-        vector<WKdPointND*>* oldParameterNodes = parameterNodes;
-        parameterNodes = new vector<WKdPointND*>();
-        for(size_t index = 0; index < oldParameterNodes->size(); index++ )
-            if( !( static_cast<WParameterDomainKdPoint*>( oldParameterNodes->at(index) ) )->isAddedToPlane() )
-            {
-                parameterNodes->push_back( oldParameterNodes->at( index ) );
-            }
-            else
-            {
-                m_parameterDomain->removePoint( oldParameterNodes->at( index ) );
-            }
-        cout << "Current parameter space Size: " << m_parameterDomain->getAllPoints()->size() << "    ";
+        addExtentCluster( m_parameterPoints[m_extentHeap[0]], m_currentClusterID++ );
+        cout << "Current parameter space Size: " << m_extentHeap.size() << "    ";
     }
 }
 
@@ -103,7 +87,10 @@ void WLariBruteforceClustering::initExtentSizes( vector<WKdPointND*>* pointsToPr
         m_cpuThreads[thread] = new boost::thread(
                 &WLariBruteforceClustering::initExtentSizesAtThread, this, pointsToProcess, thread );
     for( size_t thread = 0; thread < threads; thread++ )
+    {
         m_cpuThreads[thread]->join();
+        delete m_cpuThreads[thread];
+    }
 }
 
 void WLariBruteforceClustering::initExtentSizesAtThread( vector<WKdPointND*>* pointsToProcess, size_t threadIndex )
@@ -128,43 +115,135 @@ void WLariBruteforceClustering::initExtentSizesAtThread( vector<WKdPointND*>* po
     }
 }
 
+void WLariBruteforceClustering::initExtentHeap( vector<WKdPointND*>* parameterPoints )
+{
+    m_parameterPoints.resize( parameterPoints->size() );
+    m_pointIndices.clear();
+    m_extentHeap.resize( parameterPoints->size() );
+    m_extentHeapPositions.resize( parameterPoints->size() );
+    for( size_t index = 0; index < parameterPoints->size(); index++ )
+    {
+        m_parameterPoints[index] = static_cast<WParameterDomainKdPoint*>( parameterPoints->at( index ) );
+        m_pointIndices[parameterPoints->at( index )] = index;
+        m_extentHeap[index] = index;
+        m_extentHeapPositions[index] = index;
+    }
+    for( size_t heapPosition = m_extentHeap.size() / 2; heapPosition > 0; heapPosition-- )
+        siftExtentHeapDown( heapPosition - 1 );
+}
+
 void WLariBruteforceClustering::addExtentCluster( WParameterDomainKdPoint* peakCenterPoint, size_t clusterID )
 {
     vector<WParameterDomainKdPoint*>* extentPoints =
             getParametersOfExtent( peakCenterPoint->getCoordinate() );
-    m_pointClassifier->setProgressSettings( m_currentClusterID, extentPoints->size(), "Adding cluster " );
-    cout << "Updating Data for extent: " << extentPoints->size() << "/" << m_parameterDomain->getAllPoints()->size() << endl;
-    size_t threads = m_cpuThreadCount < extentPoints->size() ?m_cpuThreadCount :extentPoints->size();
+    cout << "Updating Data for extent: " << extentPoints->size() << "/" << m_extentHeap.size() << endl;
+    extentPoints->push_back( peakCenterPoint );
+    vector<WParameterDomainKdPoint*> removedPoints;
+    for( size_t index = 0; index < extentPoints->size(); index++ )
+    {
+        WParameterDomainKdPoint* extentPoint = extentPoints->at( index );
+        if( !extentPoint->isAddedToPlane() )
+        {
+            extentPoint->getSpatialPoint()->setClusterID( clusterID );
+            extentPoint->setIsAddedToPlane( true );
+            m_parameterDomain->removePoint( extentPoint );
+            removeFromExtentHeap( m_pointIndices[extentPoint] );
+            removedPoints.push_back( extentPoint );
+        }
+    }
+    delete extentPoints;
+    if( m_extentHeap.size() == 0 )
+        return;
+
+    m_pointClassifier->setProgressSettings( m_currentClusterID, removedPoints.size(), "Adding cluster " );
+    size_t threads = m_cpuThreadCount < removedPoints.size() ?m_cpuThreadCount :removedPoints.size();
+    vector< vector<WKdPointND*> > peakCenters( threads );
     for( size_t thread = 0; thread < threads; thread++ )
         m_cpuThreads[thread] = new boost::thread(
-                &WLariBruteforceClustering::addExtentClusterAtThread, this, extentPoints, clusterID, thread );
+                &WLariBruteforceClustering::addExtentClusterAtThread, this, &removedPoints, &peakCenters[thread], thread );
     for( size_t thread = 0; thread < threads; thread++ )
+    {
         m_cpuThreads[thread]->join();
+        delete m_cpuThreads[thread];
+    }
 
-    peakCenterPoint->getSpatialPoint()->setClusterID( clusterID );
-    peakCenterPoint->setIsAddedToPlane( true );
+    for( size_t thread = 0; thread < threads; thread++ )
+        for( size_t index = 0; index < peakCenters[thread].size(); index++ )
+        {
+            size_t pointIndex = m_pointIndices[peakCenters[thread][index]];
+            WParameterDomainKdPoint* peakCenter = m_parameterPoints[pointIndex];
+            peakCenter->setExtentPointCount( peakCenter->getExtentPointCount() - 1 );
+            siftExtentHeapDown( m_extentHeapPositions[pointIndex] );
+        }
 }
 
-void WLariBruteforceClustering::addExtentClusterAtThread( vector<WParameterDomainKdPoint*>* extentPoints, size_t clusterID, size_t threadIndex )
+void WLariBruteforceClustering::addExtentClusterAtThread( vector<WParameterDomainKdPoint*>* removedPoints,
+        vector<WKdPointND*>* peakCenters, size_t threadIndex )
 {
-    WParameterSpaceSearcher taggerToRefresh;
-    taggerToRefresh.setExaminedKdTree( m_parameterDomain );
-    taggerToRefresh.setSegmentationSettings( m_segmentationMaxAngleDegrees, m_segmentationMaxPlaneDistance );
-    for(size_t index = threadIndex; index < extentPoints->size(); index += m_cpuThreadCount )
+    WParameterSpaceSearcher peakCenterSearcher;
+    peakCenterSearcher.setExaminedKdTree( m_parameterDomain );
+    peakCenterSearcher.setSegmentationSettings( m_segmentationMaxAngleDegrees, m_segmentationMaxPlaneDistance );
+    for(size_t index = threadIndex; index < removedPoints->size(); index += m_cpuThreadCount )
     {
-        WParameterDomainKdPoint* extentPoint = static_cast<WParameterDomainKdPoint*>( extentPoints->at( index ) );
-        if( !extentPoint->isAddedToPlane() )
-        {
-            taggerToRefresh.setSearchedPeakCenter( extentPoint->getCoordinate() );
-            taggerToRefresh.tagExtentToRefresh();
+        peakCenterSearcher.setSearchedExtentPoint( removedPoints->at( index )->getCoordinate() );
+        vector<WPointDistance>* foundPeakCenters = peakCenterSearcher.getNearestPoints();
+        for( size_t peakCenter = 0; peakCenter < foundPeakCenters->size(); peakCenter++ )
+            peakCenters->push_back( foundPeakCenters->at( peakCenter ).getComparedPoint() );
+        delete foundPeakCenters;
+        m_pointClassifier->incrementProgress();
+    }
+}
 
-            WSpatialDomainKdPoint* assignedSpatialNode = extentPoint->getSpatialPoint();
-            assignedSpatialNode->setClusterID( clusterID );
+bool WLariBruteforceClustering::isAboveInExtentHeap( size_t pointIndex1, size_t pointIndex2 )
+{
+    size_t extentPointCount1 = m_parameterPoints[pointIndex1]->getExtentPointCount();
+    size_t extentPointCount2 = m_parameterPoints[pointIndex2]->getExtentPointCount();
+    return extentPointCount1 > extentPointCount2 || ( extentPointCount1 == extentPointCount2 && pointIndex1 < pointIndex2 );
+}
 
-            extentPoint->setIsAddedToPlane( true );
-        }
-        m_pointClassifier->incrementProgress();
+void WLariBruteforceClustering::siftExtentHeapDown( size_t heapPosition )
+{
+    size_t pointIndex = m_extentHeap[heapPosition];
+    while( heapPosition * 2 + 1 < m_extentHeap.size() )
+    {
+        size_t child = heapPosition * 2 + 1;
+        if( child + 1 < m_extentHeap.size() && isAboveInExtentHeap( m_extentHeap[child + 1], m_extentHeap[child] ) )
+            child++;
+        if( !isAboveInExtentHeap( m_extentHeap[child], pointIndex ) )
+            break;
+        m_extentHeap[heapPosition] = m_extentHeap[child];
+        m_extentHeapPositions[m_extentHeap[heapPosition]] = heapPosition;
+        heapPosition = child;
+    }
+    m_extentHeap[heapPosition] = pointIndex;
+    m_extentHeapPositions[pointIndex] = heapPosition;
+}
+
+void WLariBruteforceClustering::siftExtentHeapUp( size_t heapPosition )
+{
+    size_t pointIndex = m_extentHeap[heapPosition];
+    while( heapPosition > 0 && isAboveInExtentHeap( pointIndex, m_extentHeap[( heapPosition - 1 ) / 2] ) )
+    {
+        m_extentHeap[heapPosition] = m_extentHeap[( heapPosition - 1 ) / 2];
+        m_extentHeapPositions[m_extentHeap[heapPosition]] = heapPosition;
+        heapPosition = ( heapPosition - 1 ) / 2;
     }
+    m_extentHeap[heapPosition] = pointIndex;
+    m_extentHeapPositions[pointIndex] = heapPosition;
+}
+
+void WLariBruteforceClustering::removeFromExtentHeap( size_t pointIndex )
+{
+    size_t heapPosition = m_extentHeapPositions[pointIndex];
+    size_t lastPointIndex = m_extentHeap[m_extentHeap.size() - 1];
+    m_extentHeap.pop_back();
+    m_extentHeapPositions[pointIndex] = notInExtentHeap;
+    if( lastPointIndex == pointIndex )
+        return;
+    m_extentHeap[heapPosition] = lastPointIndex;
+    m_extentHeapPositions[lastPointIndex] = heapPosition;
+    siftExtentHeapUp( heapPosition );
+    siftExtentHeapDown( m_extentHeapPositions[lastPointIndex] );
 }
 
 vector<WParameterDomainKdPoint*>* WLariBruteforceClustering::getParametersOfExtent( const vector<double>& parametersXYZ0 )
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <vector>
 #include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "core/dataHandler/WDataSetPoints.h"
 #include "../structure/WParameterDomainKdPoint.h"
@@ -51,12 +52,18 @@ using std::vector;
  * Class that groups points that belong to the same planar formula. It uses the brute force peak detection approach.
  * 
  * It works as follows:
- *  A) While not all parameter domain points classified
- *      1) Calculate for every point how many parameters it would have in its extent if 
- *         the parameter domain point was the peak center
- *      2) Take the point with the highest parameter count as extent (peak center).
- *      3) Take the parameters and cluster it as one single planar patch
- *      4) Remove added points from waiting list
+ *  A) Calculate for every point how many parameters it would have in its extent if the 
+ *     parameter domain point was the peak center. The points are kept in a max-heap by 
+ *     that count.
+ *  B) While not all parameter domain points classified
+ *      1) Take the point with the highest parameter count as extent (peak center).
+ *      2) Take the parameters and cluster it as one single planar patch
+ *      3) Remove added points from waiting list
+ *      4) Decrement the count of those remaining points whose extent contained a 
+ *         removed point
+ * 
+ * So a single cluster step costs time proportional to its extent and not to the whole 
+ * parameter domain.
  * 
  * Note: Boundary detection has to be executed to separate spatially disconnected surfaces.
  */
@@ -118,25 +125,60 @@ private:
      */
     void initExtentSizesAtThread( vector<WKdPointND*>* pointsToProcess, size_t threadIndex );
 
+    /**
+     * Puts all parameter domain points into the extent heap after their extent sizes 
+     * are initialized.
+     * \param parameterPoints All parameter domain points.
+     */
+    void initExtentHeap( vector<WKdPointND*>* parameterPoints );
+
     /**
      * Assignes parameter domain points to a single planar patch. These points are then 
-     * removed from waiting list and its remaining neighbors are tagged to be refreshed 
-     * by their extent point count. The method uses multithreading.
+     * removed from waiting list and the extent point count of its remaining neighbors 
+     * is decremented. The method uses multithreading.
      * \param peakCenterPoint Peak center of the new planar patch that is clustered.
      * \param clusterID Current cluster ID that is assigned.
      */
     void addExtentCluster( WParameterDomainKdPoint* peakCenterPoint, size_t clusterID );
 
     /**
-     * Assignes parameter domain points to a single planar patch. These points are then 
-     * removed from waiting list and its remaining neighbors are tagged to be refreshed 
-     * by their extent point count. The method has to be executed multiple times for 
-     * every thread index.
-     * \param extentPoints Points of the added extent (added planar patch).
-     * \param clusterID Current assigned cluster ID.
+     * Searches the remaining peak centers whose extent contained removed parameter 
+     * domain points. The method has to be executed multiple times for every thread 
+     * index.
+     * \param removedPoints Points of the added extent (added planar patch).
+     * \param peakCenters Output peak centers. A peak center is added once for each 
+     *                    removed point of its extent.
      * \param threadIndex Thread index of multithreading.
      */
-    void addExtentClusterAtThread( vector<WParameterDomainKdPoint*>* extentPoints, size_t clusterID, size_t threadIndex );
+    void addExtentClusterAtThread( vector<WParameterDomainKdPoint*>* removedPoints, vector<WKdPointND*>* peakCenters,
+            size_t threadIndex );
+
+    /**
+     * Tells whether a point is placed above another one in the extent heap. Bigger 
+     * extents and, with equal extents, lower point indices come first.
+     * \param pointIndex1 Index of the first point.
+     * \param pointIndex2 Index of the second point.
+     * \return The first point is placed above the second one or not.
+     */
+    bool isAboveInExtentHeap( size_t pointIndex1, size_t pointIndex2 );
+
+    /**
+     * Moves a heap entry towards the leafs until the heap order is restored.
+     * \param heapPosition Position of the moved entry within the heap.
+     */
+    void siftExtentHeapDown( size_t heapPosition );
+
+    /**
+     * Moves a heap entry towards the root until the heap order is restored.
+     * \param heapPosition Position of the moved entry within the heap.
+     */
+    void siftExtentHeapUp( size_t heapPosition );
+
+    /**
+     * Removes a point from the extent heap.
+     * \param pointIndex Index of the removed point.
+     */
+    void removeFromExtentHeap( size_t pointIndex );
 
     /**
      * Returns the points within the parameter domain which belong to an extent of a 
@@ -186,6 +228,32 @@ private:
      * CPU threads object for multithreading support.
      */
     vector<boost::thread*> m_cpuThreads;
+
+    /**
+     * All parameter domain points in the order of their point index.
+     */
+    vector<WParameterDomainKdPoint*> m_parameterPoints;
+
+    /**
+     * Point index of each parameter domain point.
+     */
+    boost::unordered_map<WKdPointND*, size_t> m_pointIndices;
+
+    /**
+     * Max-heap of the point indices of not yet clustered parameter domain points. It 
+     * is ordered by their extent point count.
+     */
+    vector<size_t> m_extentHeap;
+
+    /**
+     * Position of each point within m_extentHeap or notInExtentHeap.
+     */
+    vector<size_t> m_extentHeapPositions;
+
+    /**
+     * Heap position of points that are already clustered.
+     */
+    static const size_t notInExtentHeap;
 };
 
 #endif  // WLARIBRUTEFORCECLUSTERING_H
@@ -33,6 +33,7 @@
 WParameterSpaceSearcher::WParameterSpaceSearcher()
 {
     m_tagToRefresh = false;
+    m_searchPeakCenters = false;
     m_segmentationMaxAngleDegrees = 15;
     m_segmentationMaxPlaneDistance = 0.7;
 }
@@ -54,12 +55,34 @@ void WParameterSpaceSearcher::setSearchedPeakCenter( const vector<double>& peakC
     setMaxResultPointCountInfinite();
     m_distanceSteps = 4;
     m_tagToRefresh = false;
+    m_searchPeakCenters = false;
+}
+
+void WParameterSpaceSearcher::setSearchedExtentPoint( const vector<double>& extentPoint )
+{
+    // Peak centers of the same extent differ by at most the plane distance from the 
+    // extent point's distance to the origin. The extent radius grows convexly with that 
+    // distance, so the largest radius is found at one of both limits. It is slightly 
+    // enlarged because the radius is only used to limit the kd tree traversal.
+    double parameterDistance = WVectorMaths::getEuclidianDistance( extentPoint );
+    vector<double> nearestPeakCenter( 3, 0.0 );
+    vector<double> farthestPeakCenter( 3, 0.0 );
+    nearestPeakCenter[0] = std::max( 0.0, parameterDistance - m_segmentationMaxPlaneDistance );
+    farthestPeakCenter[0] = parameterDistance + m_segmentationMaxPlaneDistance;
+    double nearestRadius = getMaxParameterDistance( nearestPeakCenter );
+    double farthestRadius = getMaxParameterDistance( farthestPeakCenter );
+    setSearchedPoint( extentPoint );
+    setMaxSearchDistance( ( nearestRadius > farthestRadius ?nearestRadius :farthestRadius ) * 1.000001 );
+    setMaxResultPointCountInfinite();
+    m_distanceSteps = 4;
+    m_tagToRefresh = false;
+    m_searchPeakCenters = true;
 }
 
 void WParameterSpaceSearcher::tagExtentToRefresh()
 {
     m_tagToRefresh = true;
-    traverseNodePoints( m_examinedKdTree, m_maxSearchDistance );
+    traverseExaminedKdTree( m_maxSearchDistance );
     m_tagToRefresh = false;
 }
 
@@ -77,6 +100,12 @@ void WParameterSpaceSearcher::onPointFound( WKdPointND* point )
 
 bool WParameterSpaceSearcher::pointCanBelongToPointSet( const vector<double>& point, double maxDistance )
 {
+    if( m_searchPeakCenters )
+    {
+        if( WVectorMaths::getEuclidianDistance( point, m_searchedCoordinate ) > getMaxParameterDistance( point ) )
+            return false;
+        return isParameterOfSameExtent( point, m_searchedCoordinate );
+    }
     if( WVectorMaths::getEuclidianDistance( m_searchedCoordinate, point ) > maxDistance )
         return false;
     return ( isParameterOfSameExtent( m_searchedCoordinate, point ) );
@@ -85,8 +114,7 @@ bool WParameterSpaceSearcher::pointCanBelongToPointSet( const vector<double>& po
 double WParameterSpaceSearcher::getMaxParameterDistance( const vector<double>& parametersXYZ0 )
 {   //TODO(aschwarzkopf): Implement a better bounding box concept later.
     vector<double> extent( 3, 0.0 );
-    vector<double> origin( 3, 0.0 );
-    extent[0] = WVectorMaths::getEuclidianDistance( origin, parametersXYZ0 );
+    extent[0] = WVectorMaths::getEuclidianDistance( parametersXYZ0 );
     double angle = m_segmentationMaxAngleDegrees / 90.0 * asin( 1.0 );
     double distanceNear = extent[0] - m_segmentationMaxPlaneDistance;
     double distanceFar = extent[0] + m_segmentationMaxPlaneDistance;
@@ -105,9 +133,8 @@ double WParameterSpaceSearcher::getMaxParameterDistance( const vector<double>& p
 
 bool WParameterSpaceSearcher::isParameterOfSameExtent( const vector<double>& parameters1, const vector<double>& parameters2 )
 {
-    vector<double> origin( 3, 0 );
-    double distance1 = WVectorMaths::getEuclidianDistance( origin, parameters1 );
-    double distance2 = WVectorMaths::getEuclidianDistance( origin, parameters2 );
+    double distance1 = WVectorMaths::getEuclidianDistance( parameters1 );
+    double distance2 = WVectorMaths::getEuclidianDistance( parameters2 );
     if( distance1 + distance2 == 0.0 )
         return true;
     if( abs( distance1 - distance2 ) > m_segmentationMaxPlaneDistance )
@@ -73,6 +73,14 @@ public:
      */
     void setSearchedPeakCenter( const vector<double>& peakCenter );
 
+    /**
+     * Sets an extent point. The search then returns all peak centers whose extent 
+     * contains that point. It is the reverse of setSearchedPeakCenter() because the 
+     * extent radius depends on the peak center.
+     * \param extentPoint Parameter domain point whose peak centers are searched.
+     */
+    void setSearchedExtentPoint( const vector<double>& extentPoint );
+
 protected:
     /**
      * Method that is executed during points are found. The method either adds points to 
@@ -132,6 +140,12 @@ private:
      * Tag points to be refreshed instead of searching them
      */
     bool m_tagToRefresh;
+
+    /**
+     * Search peak centers whose extent contains the searched point instead of the 
+     * extent of the searched point.
+     */
+    bool m_searchPeakCenters;
 };
 
 #endif  // WPARAMETERSPACESEARCHER_H
@@ -26,17 +26,19 @@
 #include <vector>
 #include "WBoundaryDetectPoint.h"
 
-WBoundaryDetectPoint::WBoundaryDetectPoint( vector<double> coordinate ) : WKdPointND( coordinate[0], coordinate[1] )
+WBoundaryDetectPoint::WBoundaryDetectPoint( const vector<double>& coordinate ) : WKdPointND( coordinate[0], coordinate[1] )
 {
     if( coordinate.size() >= 3 )
         m_zCoordinate = coordinate[2];
     m_isAddedToPlane = false;
+    m_isRemovedFromWaitList = false;
 }
 
 WBoundaryDetectPoint::WBoundaryDetectPoint( double x, double y, double z ) : WKdPointND( x, y )
 {
     m_zCoordinate = z;
     m_isAddedToPlane = false;
+    m_isRemovedFromWaitList = false;
 }
 
 WBoundaryDetectPoint::~WBoundaryDetectPoint()
@@ -59,6 +61,16 @@ void WBoundaryDetectPoint::setIsAddedToPlane( bool isAddedToPlane )
     m_isAddedToPlane = isAddedToPlane;
 }
 
+bool WBoundaryDetectPoint::isRemovedFromWaitList()
+{
+    return m_isRemovedFromWaitList;
+}
+
+void WBoundaryDetectPoint::setIsRemovedFromWaitList( bool isRemovedFromWaitList )
+{
+    m_isRemovedFromWaitList = isRemovedFromWaitList;
+}
+
 void WBoundaryDetectPoint::setSpatialPoint( WSpatialDomainKdPoint* assignedSpatialPoint )
 {
     m_assignedSpatialPoint = assignedSpatialPoint;
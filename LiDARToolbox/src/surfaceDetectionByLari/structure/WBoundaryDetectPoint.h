@@ -45,7 +45,7 @@ public:
      * \param coordinate A three dimensional point. The three dimensional coordinate 
      *                   isn't considered during the analysis.
      */
-    explicit WBoundaryDetectPoint( vector<double> coordinate );
+    explicit WBoundaryDetectPoint( const vector<double>& coordinate );
 
     /**
      * Creates an instance for boundary detection and points inside.
@@ -82,6 +82,20 @@ public:
      */
     void setIsAddedToPlane( bool isAddedToPlane );
 
+    /**
+     * Tells whether a point was removed from the wait list. Unlike isAddedToPlane() 
+     * it is only set after a spatially connected cluster is complete. So points of the 
+     * cluster kd tree are filtered that were clustered by previous passes.
+     * \return Point is removed from the wait list or not.
+     */
+    bool isRemovedFromWaitList();
+
+    /**
+     * Sets whether a point was removed from the wait list.
+     * \param isRemovedFromWaitList Point is removed from the wait list or not.
+     */
+    void setIsRemovedFromWaitList( bool isRemovedFromWaitList );
+
     /**
      * Sets the assigned spatial domain point (coordinate equal to input points).
      * \param assignedSpatialPoint Assitned spatial domain point.
@@ -105,6 +119,11 @@ private:
      * clustering.
      */
     bool m_isAddedToPlane;
+
+    /**
+     * Point is removed from the wait list of the modified convex hull clustering or not.
+     */
+    bool m_isRemovedFromWaitList;
 };
 
 #endif  // WBOUNDARYDETECTPOINT_H
@@ -26,7 +26,7 @@
 #include <vector>
 #include "WParameterDomainKdPoint.h"
 
-WParameterDomainKdPoint::WParameterDomainKdPoint( vector<double> coordinate ) : WKdPointND( coordinate )
+WParameterDomainKdPoint::WParameterDomainKdPoint( const vector<double>& coordinate ) : WKdPointND( coordinate )
 {
     m_isAddedToPlane = false;
     m_markedToRefresh = true;
@@ -44,7 +44,7 @@ public:
      * \param coordinate Parameter space coordinate corresponding to the Lari/Habib 
      *                   approach.
      */
-    explicit WParameterDomainKdPoint( vector<double> coordinate );
+    explicit WParameterDomainKdPoint( const vector<double>& coordinate );
 
     /**
      * Instantiates a parameter domain point in an three dimensional space. A parameter 
@@ -26,12 +26,28 @@
 #include <vector>
 #include "WSpatialDomainKdPoint.h"
 
-WSpatialDomainKdPoint::WSpatialDomainKdPoint( vector<double> coordinate ) : WKdPointND( coordinate )
+WSpatialDomainKdPoint::WSpatialDomainKdPoint( const vector<double>& coordinate ) : WKdPointND( coordinate )
 {
+    for( size_t index = 0; index < 3; index++ )
+        m_eigenValues[index] = 0.0;
+    for( size_t index = 0; index < 4; index++ )
+        m_hessianNormalForm[index] = 0.0;
+    m_clusterID = 0;
+    m_kNearestPoints = 0;
+    m_distanceToNthNearestNeighbor = 0.0;
+    m_indexInInputArray = 0;
 }
 
 WSpatialDomainKdPoint::WSpatialDomainKdPoint( double x, double y, double z ) : WKdPointND( x, y, z )
 {
+    for( size_t index = 0; index < 3; index++ )
+        m_eigenValues[index] = 0.0;
+    for( size_t index = 0; index < 4; index++ )
+        m_hessianNormalForm[index] = 0.0;
+    m_clusterID = 0;
+    m_kNearestPoints = 0;
+    m_distanceToNthNearestNeighbor = 0.0;
+    m_indexInInputArray = 0;
 }
 
 WSpatialDomainKdPoint::~WSpatialDomainKdPoint()
@@ -46,17 +62,17 @@ size_t WSpatialDomainKdPoint::getClusterID()
 
 vector<double> WSpatialDomainKdPoint::getEigenValues()
 {
-    return m_eigenValues;
+    return vector<double>( m_eigenValues, m_eigenValues + 3 );
 }
 
 vector<double> WSpatialDomainKdPoint::getHessianNormalForm()
 {
-    return m_hessianNormalForm;
+    return vector<double>( m_hessianNormalForm, m_hessianNormalForm + 4 );
 }
 
 vector<double> WSpatialDomainKdPoint::getParametersXYZ0()
 {
-    return WLeastSquares::getParametersXYZ0( m_hessianNormalForm );
+    return WLeastSquares::getParametersXYZ0( getHessianNormalForm() );
 }
 
 double WSpatialDomainKdPoint::getDistanceToNthNearestNeighbor()
@@ -97,20 +113,32 @@ void WSpatialDomainKdPoint::setDistanceToNthNearestNeighbor( double distanceToNt
 
 void WSpatialDomainKdPoint::setEigenValues( vector<double> eigenValues )
 {
-    m_eigenValues = eigenValues;
-    for( size_t index = 0; index < m_eigenValues.size(); index++ )
-        if( m_eigenValues[index] < 0.0 )
-            m_eigenValues[index] = 0.0;
+    for( size_t index = 0; index < 3 && index < eigenValues.size(); index++ )
+        m_eigenValues[index] = eigenValues[index] < 0.0 ?0.0 :eigenValues[index];
+}
+
+void WSpatialDomainKdPoint::setEigenValues( const double* eigenValues )
+{
+    for( size_t index = 0; index < 3; index++ )
+        m_eigenValues[index] = eigenValues[index] < 0.0 ?0.0 :eigenValues[index];
 }
 
 void WSpatialDomainKdPoint::setEigenVectors( vector<WVector3d> eigenVectors )
 {
-    m_eigenVectors = eigenVectors;
+    for( size_t index = 0; index < 3 && index < eigenVectors.size(); index++ )
+        m_eigenVectors[index] = eigenVectors[index];
+}
+
+void WSpatialDomainKdPoint::setEigenVectors( const double* eigenVectors )
+{
+    for( size_t index = 0; index < 3; index++ )
+        m_eigenVectors[index] = WVector3d( eigenVectors[index * 3], eigenVectors[index * 3 + 1], eigenVectors[index * 3 + 2] );
 }
 
-void WSpatialDomainKdPoint::setHessianNormalForm( vector<double> hessianNormalForm )
+void WSpatialDomainKdPoint::setHessianNormalForm( const vector<double>& hessianNormalForm )
 {
-    m_hessianNormalForm = hessianNormalForm;
+    for( size_t index = 0; index < 4 && index < hessianNormalForm.size(); index++ )
+        m_hessianNormalForm[index] = hessianNormalForm[index];
 }
 
 void WSpatialDomainKdPoint::setKNearestPoints( size_t kNearestPoints )
@@ -32,6 +32,8 @@
 
 /**
  * Point information container that is used for surface detection approach of Lari/Habib.
+ * The meta data is kept in fixed size fields of a three dimensional point. So a point 
+ * holds no heap memory apart from its coordinate and can be kept in a WKdPointArena.
  */
 class WSpatialDomainKdPoint : public WKdPointND
 {
@@ -40,7 +42,7 @@ public:
      * Instantiates the point using an n dimensional coordinate.
      * \param coordinate An n dimensional coordinate.
      */
-    explicit WSpatialDomainKdPoint( vector<double> coordinate );
+    explicit WSpatialDomainKdPoint( const vector<double>& coordinate );
 
     /**
      * Instantiates the point using a three dimensional coordinate.
@@ -114,19 +116,32 @@ public:
      */
     void setEigenValues( vector<double> eigenValues );
 
+    /**
+     * Sets the eigens values of the point in relation to its neighbors.
+     * \param eigenValues Array of the three eigen values.
+     */
+    void setEigenValues( const double* eigenValues );
+
     /**
      * Sets the eigens vectors of the point in relation to its neighbors.
      * \param eigenVectors The eigen vectors of a poinnt in relation to its neighbors.
      */
     void setEigenVectors( vector<WVector3d> eigenVectors );
 
+    /**
+     * Sets the eigens vectors of the point in relation to its neighbors.
+     * \param eigenVectors Array of the three eigen vectors. Each vector is given by 
+     *                     three consecutive components.
+     */
+    void setEigenVectors( const double* eigenVectors );
+
     /**
      * Sets the Hessian normal form of the point's best fitted plane in relation to its 
      * neighbors.
      * \param hessianNormalForm The Hessian normal formula of the point's best 
      *                            fitted plane.
      */
-    void setHessianNormalForm( vector<double> hessianNormalForm );
+    void setHessianNormalForm( const vector<double>& hessianNormalForm );
 
     /**
      * Sets the plane cluster ID to the point.
@@ -156,17 +171,17 @@ private:
     /**
      * The eigen values of a poinnt in relation to its neighbors.
      */
-    vector<double> m_eigenValues;
+    double m_eigenValues[3];
 
     /**
      * The eigen vectors of a poinnt in relation to its neighbors.
      */
-    vector<WVector3d> m_eigenVectors;
+    WVector3d m_eigenVectors[3];
 
     /**
      * Space for the calculated Hessian Normal Form.
      */
-    vector<double> m_hessianNormalForm;
+    double m_hessianNormalForm[4];
 
     /**
      * Plane cluster ID of the point.
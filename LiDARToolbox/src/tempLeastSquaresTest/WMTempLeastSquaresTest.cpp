@@ -22,6 +22,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <cstdlib>
 #include <string>
 
 #include <fstream>  // std::ifstream
@@ -87,6 +88,19 @@ void WMTempLeastSquaresTest::connectors()
 void WMTempLeastSquaresTest::properties()
 {
     // ---> Put the code for your properties here. See "src/modules/template/" for an extensively documented example.
+    m_kdBenchmarkTrigger = m_properties->addProperty( "Benchmark kd queries:", "Measures neighbor queries per second "
+                            "on 1M random points.", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+    boost::shared_ptr< WItemSelection > buildBenchmarkSizes( boost::shared_ptr< WItemSelection >( new WItemSelection() ) );
+    buildBenchmarkSizes->addItem( "1M points", "" );
+    buildBenchmarkSizes->addItem( "10M points", "" );
+    buildBenchmarkSizes->addItem( "50M points", "" );
+    m_kdBuildBenchmarkSize = m_properties->addProperty( "Kd build benchmark size", "Point count of the kd tree build benchmark.",
+            buildBenchmarkSizes->getSelector( 0 ), m_propCondition );
+    WPropertyHelper::PC_SELECTONLYONE::addTo( m_kdBuildBenchmarkSize );
+    m_kdBuildBenchmarkTrigger = m_properties->addProperty( "Benchmark kd builds:", "Measures the kd tree build time on random "
+                            "points.", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
+    m_planeFitBenchmarkTrigger = m_properties->addProperty( "Benchmark plane fits:", "Measures plane fits per second for "
+                            "neighborhoods of 8 to 128 points.", WPVBaseTypes::PV_TRIGGER_READY, m_propCondition );
     WModule::properties();
 }
 
@@ -115,6 +129,21 @@ void WMTempLeastSquaresTest::moduleMain()
 
         //m_output->updateData( getRandomPoints() );
         analyzeBestFittedPlane();
+        if( m_kdBenchmarkTrigger->get( true ) )
+        {
+            runKdQueryBenchmark();
+            m_kdBenchmarkTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+        }
+        if( m_kdBuildBenchmarkTrigger->get( true ) )
+        {
+            runKdBuildBenchmark();
+            m_kdBuildBenchmarkTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+        }
+        if( m_planeFitBenchmarkTrigger->get( true ) )
+        {
+            runPlaneFitBenchmark();
+            m_planeFitBenchmarkTrigger->set( WPVBaseTypes::PV_TRIGGER_READY, true );
+        }
 
 //        std::cout << "this is WOTree " << std::endl;
 
@@ -199,6 +228,202 @@ void WMTempLeastSquaresTest::analyzeBestFittedPlane()
     }
 }
 
+void WMTempLeastSquaresTest::runKdQueryBenchmark()
+{
+    const size_t pointCount = 1000000;
+    const size_t queryCount = 100000;
+    WKdPointArena<WKdPointND> pointArena;
+    vector<WKdPointND*> dynamicTreePoints;
+    createRandomKdPoints( pointCount, &pointArena, &dynamicTreePoints );
+    vector< vector<double> > queries;
+    queries.reserve( queryCount );
+    for( size_t query = 0; query < queryCount; query++ )
+        queries.push_back( dynamicTreePoints[static_cast<size_t>( rand() * ( pointCount - 1.0 ) / RAND_MAX )]->getCoordinate() );
+
+    WKdTreeND dynamicTree( 3 );
+    dynamicTree.add( &dynamicTreePoints );
+    WPointSearcher dynamicTreeSearcher( &dynamicTree );
+    measureKdQueries( &dynamicTreeSearcher, queries, "WKdTreeND" );
+
+    vector<WKdPointND*> staticTreePoints;
+    createRandomKdPoints( pointCount, &pointArena, &staticTreePoints );
+    WKdTreeStaticND staticTree( 3 );
+    staticTree.add( &staticTreePoints );
+    WPointSearcher staticTreeSearcher( &staticTree );
+    measureKdQueries( &staticTreeSearcher, queries, "WKdTreeStaticND" );
+}
+
+void WMTempLeastSquaresTest::measureKdQueries( WPointSearcher* searcher, const vector< vector<double> >& queries,
+        const std::string& treeName )
+{
+    WRealtimeTimer timer;
+    searcher->setMaxSearchDistance( 1.0 );
+    searcher->setMaxResultPointCountInfinite();
+    timer.reset();
+    for( size_t query = 0; query < queries.size(); query++ )
+    {
+        searcher->setSearchedPoint( queries[query] );
+        searcher->getNearestNeighborCount();
+    }
+    double countQueriesPerSecond = queries.size() / timer.elapsed();
+
+    searcher->setMaxResultPointCount( 12 );
+    timer.reset();
+    for( size_t query = 0; query < queries.size(); query++ )
+    {
+        searcher->setSearchedPoint( queries[query] );
+        delete searcher->getNearestPoints();
+    }
+    double nearestQueriesPerSecond = queries.size() / timer.elapsed();
+
+    std::cout << "runKdQueryBenchmark() - " << treeName << ": " << countQueriesPerSecond << " radius count queries/s, "
+            << nearestQueriesPerSecond << " 12 nearest neighbor queries/s" << std::endl;
+}
+
+void WMTempLeastSquaresTest::runKdBuildBenchmark()
+{
+    const size_t pointCounts[] = { 1000000, 10000000, 50000000 };
+    size_t pointCount = pointCounts[m_kdBuildBenchmarkSize->get().getItemIndexOfSelected( 0 )];
+    WRealtimeTimer timer;
+    double dynamicTreeSeconds = 0.0;
+    double staticTreeSeconds = 0.0;
+    {
+        WKdPointArena<WKdPointND> pointArena;
+        vector<WKdPointND*> points;
+        createRandomKdPoints( pointCount, &pointArena, &points );
+        WKdTreeND kdTree( 3 );
+        timer.reset();
+        kdTree.add( &points );
+        dynamicTreeSeconds = timer.elapsed();
+    }
+    {
+        WKdPointArena<WKdPointND> pointArena;
+        vector<WKdPointND*> points;
+        createRandomKdPoints( pointCount, &pointArena, &points );
+        WKdTreeStaticND kdTree( 3 );
+        timer.reset();
+        kdTree.add( &points );
+        staticTreeSeconds = timer.elapsed();
+    }
+    std::cout << "runKdBuildBenchmark() - " << pointCount << " points, " << WThreadPool::getSharedPool()->getThreadCount()
+            << " threads: WKdTreeND " << dynamicTreeSeconds << " s, WKdTreeStaticND " << staticTreeSeconds << " s" << std::endl;
+}
+
+void WMTempLeastSquaresTest::createRandomKdPoints( size_t pointCount, WKdPointArena<WKdPointND>* pointArena,
+        vector<WKdPointND*>* points )
+{
+    srand( 0 );
+    points->reserve( points->size() + pointCount );
+    for( size_t point = 0; point < pointCount; point++ )
+    {
+        double x = rand() * 500.0 / RAND_MAX;
+        double y = rand() * 500.0 / RAND_MAX;
+        double z = rand() * 20.0 / RAND_MAX;
+        points->push_back( pointArena->create( x, y, z ) );
+    }
+}
+
+void WMTempLeastSquaresTest::runPlaneFitBenchmark()
+{
+    const size_t neighborhoodCount = 1024;
+    const double minSeconds = 1.0;
+    srand( 0 );
+    for( size_t pointCount = 8; pointCount <= 128; pointCount *= 2 )
+    {
+        vector< vector<WPosition> > neighborhoods( neighborhoodCount );
+        for( size_t neighborhood = 0; neighborhood < neighborhoodCount; neighborhood++ )
+        {
+            double slopeX = rand() * 2.0 / RAND_MAX - 1.0;
+            double slopeY = rand() * 2.0 / RAND_MAX - 1.0;
+            for( size_t point = 0; point < pointCount; point++ )
+            {
+                double x = rand() * 1.0 / RAND_MAX;
+                double y = rand() * 1.0 / RAND_MAX;
+                double noise = rand() * 0.01 / RAND_MAX;
+                neighborhoods[neighborhood].push_back( WPosition( 1000.0 + x, 2000.0 + y, 100.0 + slopeX * x + slopeY * y + noise ) );
+            }
+        }
+
+        WLeastSquares leastSquares;
+        WRealtimeTimer timer;
+        timer.reset();
+        size_t momentFits = 0;
+        while( timer.elapsed() < minSeconds )
+        {
+            for( size_t neighborhood = 0; neighborhood < neighborhoodCount; neighborhood++ )
+            {
+                const vector<WPosition>& points = neighborhoods[neighborhood];
+                WCovarianceMoments moments;
+                for( size_t point = 0; point < points.size(); point++ )
+                    moments.addPoint( points[point][0], points[point][1], points[point][2] );
+                leastSquares.analyzeData( moments );
+            }
+            momentFits += neighborhoodCount;
+        }
+        double momentFitsPerSecond = momentFits / timer.elapsed();
+
+        timer.reset();
+        size_t listFits = 0;
+        while( timer.elapsed() < minSeconds )
+        {
+            for( size_t neighborhood = 0; neighborhood < neighborhoodCount; neighborhood++ )
+                leastSquares.analyzeData( &neighborhoods[neighborhood] );
+            listFits += neighborhoodCount;
+        }
+        double listFitsPerSecond = listFits / timer.elapsed();
+
+        vector<double> hessianNormalForm;
+        timer.reset();
+        size_t matrixFits = 0;
+        while( timer.elapsed() < minSeconds )
+        {
+            for( size_t neighborhood = 0; neighborhood < neighborhoodCount; neighborhood++ )
+                fitPlaneByMatrices( neighborhoods[neighborhood], &hessianNormalForm );
+            matrixFits += neighborhoodCount;
+        }
+        double matrixFitsPerSecond = matrixFits / timer.elapsed();
+
+        std::cout << "runPlaneFitBenchmark() - " << pointCount << " points: " << momentFitsPerSecond
+                << " fits/s from moments, " << listFitsPerSecond << " fits/s from point lists, "
+                << matrixFitsPerSecond << " fits/s by PCA and matrices (reference)" << std::endl;
+    }
+}
+
+void WMTempLeastSquaresTest::fitPlaneByMatrices( const vector<WPosition>& points, vector<double>* hessianNormalForm )
+{
+    WPrincipalComponentAnalysis pca;
+    pca.analyzeData( points );
+    vector<double> eigenValues = pca.getEigenValues();
+    size_t perpendicularEigenVector = 0;
+    for( size_t index = 1; index < eigenValues.size(); index++ )
+        if( eigenValues[index] < eigenValues[perpendicularEigenVector] )
+            perpendicularEigenVector = index;
+
+    WVector3d eigenVector = pca.getEigenVectors()[perpendicularEigenVector];
+    size_t verticalDimension = 0;
+    for( size_t index = 1; index < 3; index++ )
+        if( abs( eigenVector[index] ) > abs( eigenVector[verticalDimension] ) )
+            verticalDimension = index;
+
+    Eigen::MatrixXd matrixX( points.size(), 3 );
+    Eigen::MatrixXd matrixY( points.size(), 1 );
+    for( size_t row = 0; row < points.size(); row++ )
+    {
+        matrixX( row, 0 ) = 1.0;
+        for( size_t col = 1; col < 3; col++ )
+            matrixX( row, col ) = points[row][col <= verticalDimension ?col - 1 :col];
+        matrixY( row, 0 ) = points[row][verticalDimension];
+    }
+    Eigen::MatrixXd matrixXTranspose = matrixX.transpose();
+    Eigen::MatrixXd result = ( matrixXTranspose * matrixX ).inverse() * matrixXTranspose * matrixY;
+
+    hessianNormalForm->resize( 4 );
+    ( *hessianNormalForm )[3] = -result( 0, 0 );
+    ( *hessianNormalForm )[verticalDimension] = 1.0;
+    for( size_t index = 1; index < 3; index++ )
+        ( *hessianNormalForm )[index <= verticalDimension ?index - 1 :index] = -result( index, 0 );
+}
+
 void WMTempLeastSquaresTest::outlineNormalPlane( vector<double> planeHessianNormalForm,
         WPosition nearestPoint, double planeRadius, boost::shared_ptr< WTriangleMesh > targetTriangleMesh )
 {
@@ -70,6 +70,12 @@
 
 
 #include "core/common/math/linearAlgebra/WVectorFixed.h"
+#include "core/common/WRealtimeTimer.h"
+#include "../common/datastructures/kdtree/WKdPointArena.h"
+#include "../common/datastructures/kdtree/WKdTreeND.h"
+#include "../common/datastructures/kdtree/WKdTreeStaticND.h"
+#include "../common/datastructures/kdtree/WPointSearcher.h"
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "../common/math/leastSquares/WLeastSquares.h"
 
 
@@ -186,6 +192,56 @@ private:
      */
     void analyzeBestFittedPlane();
 
+    /**
+     * Measures the neighbor queries per second of WPointSearcher on a synthetic cloud of 
+     * 1M random points. Both kd tree backends are measured. The result is printed to 
+     * the console.
+     */
+    void runKdQueryBenchmark();
+
+    /**
+     * Measures radius count queries and 12 nearest neighbor queries of a point searcher 
+     * and prints their queries per second.
+     * \param searcher Point searcher whose kd tree is already assigned.
+     * \param queries Coordinates of the searched points.
+     * \param treeName Name of the kd tree backend that is printed.
+     */
+    void measureKdQueries( WPointSearcher* searcher, const vector< vector<double> >& queries, const std::string& treeName );
+
+    /**
+     * Measures the build time of both kd tree backends on a synthetic cloud of random 
+     * points. The point count is taken from m_kdBuildBenchmarkSize. The result is 
+     * printed to the console.
+     */
+    void runKdBuildBenchmark();
+
+    /**
+     * Creates uniformly distributed random points within 500 x 500 x 20 meters. Each 
+     * call creates the same points.
+     * \param pointCount Count of created points.
+     * \param pointArena Arena that keeps the created points.
+     * \param points Output list of the created points.
+     */
+    static void createRandomKdPoints( size_t pointCount, WKdPointArena<WKdPointND>* pointArena, vector<WKdPointND*>* points );
+
+    /**
+     * Measures the plane fits per second of WLeastSquares for neighborhoods of 8 to 128 
+     * random points near a plane. Fits from point moments, from point lists and by the 
+     * reference fitPlaneByMatrices() are measured separately. The result is printed to 
+     * the console.
+     */
+    void runPlaneFitBenchmark();
+
+    /**
+     * Fits a plane the way WLeastSquares did before it used point moments. The 
+     * perpendicular dimension is taken from a principal component analysis and the 
+     * plane is solved using dense matrices. It is the reference of 
+     * runPlaneFitBenchmark().
+     * \param points Points to fit the plane to.
+     * \param hessianNormalForm Output Hessian normal form of the fitted plane.
+     */
+    static void fitPlaneByMatrices( const vector<WPosition>& points, vector<double>* hessianNormalForm );
+
     /**
      * WDataSetPoints data input (proposed for LiDAR data).
      */
@@ -200,6 +256,26 @@ private:
      */
     boost::shared_ptr< WCondition > m_propCondition;
 
+    /**
+     * Triggers the kd tree neighbor query benchmark.
+     */
+    WPropTrigger m_kdBenchmarkTrigger;
+
+    /**
+     * Point count of the kd tree build benchmark: 1M, 10M or 50M points.
+     */
+    WPropSelection m_kdBuildBenchmarkSize;
+
+    /**
+     * Triggers the kd tree build benchmark.
+     */
+    WPropTrigger m_kdBuildBenchmarkTrigger;
+
+    /**
+     * Triggers the plane fit benchmark.
+     */
+    WPropTrigger m_planeFitBenchmarkTrigger;
+
     /**
      * Plugin progress status that is shared with the reader.
      */
@@ -24,8 +24,66 @@
 
 #include <iostream>
 #include <vector>
+#include <boost/thread/mutex.hpp>
+#include "../common/algorithms/threadPool/WThreadPool.h"
 #include "WPCADetector.h"
 
+/**
+ * Thread pool task that calculates the isotropic level of leaf nodes.
+ */
+class WPCALeafAnalysisTask : public WThreadPoolTask
+{
+public:
+    /**
+     * Creates the task.
+     * \param detector Detector that analyzes the leaf nodes.
+     * \param leafNodes Leaf nodes to analyze.
+     * \param progressStatus Progress status that is incremented for each leaf node.
+     */
+    WPCALeafAnalysisTask( WPCADetector* detector, const vector<WPcaDetectOctNode*>& leafNodes,
+            boost::shared_ptr< WProgress > progressStatus ) : m_leafNodes( leafNodes )
+    {
+        m_detector = detector;
+        m_progressStatus = progressStatus;
+    }
+
+    /**
+     * Analyzes a range of leaf nodes.
+     * \param begin Index of the first leaf node.
+     * \param end Index after the last leaf node.
+     * \param threadIndex Index of the processing thread.
+     */
+    virtual void processRange( size_t begin, size_t end, size_t threadIndex )
+    {
+        threadIndex = threadIndex;
+        for( size_t index = begin; index < end; index++ )
+            m_detector->analyzeLeafNode( m_leafNodes[index] );
+        boost::mutex::scoped_lock lock( m_progressMutex );
+        m_progressStatus->increment( end - begin );
+    }
+
+private:
+    /**
+     * Detector that analyzes the leaf nodes.
+     */
+    WPCADetector* m_detector;
+
+    /**
+     * Leaf nodes to analyze.
+     */
+    const vector<WPcaDetectOctNode*>& m_leafNodes;
+
+    /**
+     * Progress status that is incremented for each leaf node.
+     */
+    boost::shared_ptr< WProgress > m_progressStatus;
+
+    /**
+     * Guards the progress status.
+     */
+    boost::mutex m_progressMutex;
+};
+
 WPCADetector::WPCADetector( WOctree* analyzableOctree, boost::shared_ptr< WProgress > progressStatus )
 {
     m_analyzableOctree = analyzableOctree;
@@ -59,34 +117,47 @@ void WPCADetector::analyze()
 
 void WPCADetector::analyzeNode( WPcaDetectOctNode* node )
 {
-    m_progressStatus->increment( 1 );
+    vector<WPcaDetectOctNode*> leafNodes;
+    fetchLeafNodes( node, &leafNodes );
+    WPCALeafAnalysisTask task( this, leafNodes, m_progressStatus );
+    WThreadPool::getSharedPool()->parallelFor( &task, leafNodes.size() );
+}
+
+void WPCADetector::analyzeLeafNode( WPcaDetectOctNode* node )
+{
+    if( node->getPointCount() >= 3 )
+    {
+        vector<double> eigenValues = node->getMoments().getEigenValues();
+        if( eigenValues[0] > 0.0 )
+            node->setEigenValueQuotient( eigenValues[2] / eigenValues[0] );
+    }
+}
+
+void WPCADetector::fetchLeafNodes( WPcaDetectOctNode* node, vector<WPcaDetectOctNode*>* leafNodes )
+{
     if  ( node->getRadius() <= m_analyzableOctree->getDetailLevel() )
     {
-        if(node->getPointCount() >= 3 )
-        {
-            WPrincipalComponentAnalysis pca;
-            pca.analyzeData( *( node->getInputPoints() ) );
-            node->clearInputData();
-            vector<double> eigenValues = pca.getEigenValues();
-            if( eigenValues[0] > 0.0 )
-                node->setEigenValueQuotient( eigenValues[2] / eigenValues[0] );
-        }
+        leafNodes->push_back( node );
     }
     else
     {
+        m_progressStatus->increment( 1 );
         for  ( int child = 0; child < 8; child++ )
             if  ( node->getChild( child ) != 0 )
-                analyzeNode( static_cast<WPcaDetectOctNode*>( node->getChild( child ) ) );
+                fetchLeafNodes( static_cast<WPcaDetectOctNode*>( node->getChild( child ) ), leafNodes );
     }
 }
+
 boost::shared_ptr< WTriangleMesh > WPCADetector::getOutline()
 {
-    boost::shared_ptr< WTriangleMesh > tmpMesh( new WTriangleMesh( 0, 0 ) );
-    drawNode( static_cast<WPcaDetectOctNode*>( m_analyzableOctree->getRootNode() ), tmpMesh );
+    m_voxelMesher.setVoxelWidth( m_analyzableOctree->getDetailLevel() * 2.0 );
+    drawNode( static_cast<WPcaDetectOctNode*>( m_analyzableOctree->getRootNode() ) );
+    boost::shared_ptr< WTriangleMesh > tmpMesh = m_voxelMesher.getMesh();
+    m_voxelMesher.clear();
     return tmpMesh;
 }
 
-void WPCADetector::drawNode( WPcaDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh )
+void WPCADetector::drawNode( WPcaDetectOctNode* node )
 {
     if  ( node->getRadius() <= m_analyzableOctree->getDetailLevel() )
     {
@@ -95,48 +166,19 @@ void WPCADetector::drawNode( WPcaDetectOctNode* node, boost::shared_ptr< WTriang
         if( node->getPointCount() < m_minPointsPerVoxelToDraw )
             return;
 
-        drawLeafNode( node, outputMesh );
+        drawLeafNode( node );
     }
     else
     {
         for  ( int child = 0; child < 8; child++ )
             if  ( node->getChild( child ) != 0 )
-                drawNode( static_cast<WPcaDetectOctNode*>( node->getChild( child ) ), outputMesh );
+                drawNode( static_cast<WPcaDetectOctNode*>( node->getChild( child ) ) );
     }
 }
 
-void WPCADetector::drawLeafNode( WPcaDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh )
+void WPCADetector::drawLeafNode( WPcaDetectOctNode* node )
 {
-    size_t index = outputMesh->vertSize();
-    for( size_t vertex = 0; vertex <= 8; vertex++ )
-    {
-        double iX = vertex % 2;
-        double iY = ( vertex / 2 ) % 2;
-        double iZ = ( vertex / 4 ) % 2;
-        double x = node->getCenter( 0 ) + node->getRadius() * ( iX * 2.0 - 1.0 );
-        double y = node->getCenter( 1 ) + node->getRadius() * ( iY * 2.0 - 1.0 );
-        double z = node->getCenter( 2 ) + node->getRadius() * ( iZ * 2.0 - 1.0 );
-        outputMesh->addVertex( x, y, z );
-        outputMesh->setVertexColor( index+vertex, calculateColorForNode( node ) );
-    }
-    // Z = 0
-    outputMesh->addTriangle( index + 0, index + 2, index + 1 );
-    outputMesh->addTriangle( index + 3, index + 1, index + 2 );
-    // X = 0
-    outputMesh->addTriangle( index + 0, index + 4, index + 2 );
-    outputMesh->addTriangle( index + 4, index + 6, index + 2 );
-    // Y = 0
-    outputMesh->addTriangle( index + 0, index + 1, index + 4 );
-    outputMesh->addTriangle( index + 1, index + 5, index + 4 );
-    // Z = 1
-    outputMesh->addTriangle( index + 4, index + 5, index + 6 );
-    outputMesh->addTriangle( index + 5, index + 7, index + 6 );
-    // X = 1
-    outputMesh->addTriangle( index + 1, index + 3, index + 5 );
-    outputMesh->addTriangle( index + 3, index + 7, index + 5 );
-    // Y = 1
-    outputMesh->addTriangle( index + 2, index + 6, index + 3 );
-    outputMesh->addTriangle( index + 6, index + 7, index + 3 );
+    m_voxelMesher.addVoxel( node->getCenter( 0 ), node->getCenter( 1 ), node->getCenter( 2 ), calculateColorForNode( node ) );
 }
 
 osg::Vec4 WPCADetector::calculateColorForNode( WPcaDetectOctNode* node )
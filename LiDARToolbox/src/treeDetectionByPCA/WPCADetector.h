@@ -32,8 +32,8 @@
 #include "../common/datastructures/quadtree/WQuadNode.h"
 #include "../common/datastructures/quadtree/WQuadTree.h"
 #include "../common/datastructures/octree/WOctree.h"
+#include "../common/algorithms/voxelMesher/WVoxelMesher.h"
 #include "structure/WPcaDetectOctNode.h"
-#include "core/common/math/principalComponentAnalysis/WPrincipalComponentAnalysis.h"
 #include "core/common/WProgress.h"
 
 /**
@@ -62,11 +62,19 @@ public:
     void analyze();
 
     /**
-     * Starts the isotropic analysis for all children pf a node.
+     * Starts the isotropic analysis for all children pf a node. The leaf nodes are 
+     * analyzed in parallel.
      * \param node Node and all its subchildren to to analyze.
      */
     void analyzeNode( WPcaDetectOctNode* node );
 
+    /**
+     * Calculates the isotropic level of a leaf node using the Eigen Values of its 
+     * point covariance moments.
+     * \param node Leaf node to analyze.
+     */
+    void analyzeLeafNode( WPcaDetectOctNode* node );
+
     /**
      * Sets the displayed isotropic threshold range.
      * \param showedIsotropicThresholdMin Minimal showed threshold.
@@ -89,28 +97,31 @@ public:
     void setMinPointsPerVoxelToDraw( size_t minPointsPerVoxelToDraw );
 
     /**
-     * Puts the voxel's isotropic threshold display in a triangle mesh.
+     * Puts the voxel's isotropic threshold display in a triangle mesh. Only voxel 
+     * faces that border on not drawn voxels are put out.
      * \return The ouput triangle mesh that depicts the data.
      */
     boost::shared_ptr< WTriangleMesh > getOutline();
 
 private:
     /**
-     * Draws a colored voxel into the output triangle mesh. It draws nodes that can have
-     * leaf nodes.
+     * Collects the leaf nodes below a node.
+     * \param node Node and all its subchildren to collect the leaf nodes of.
+     * \param leafNodes Output leaf node list.
+     */
+    void fetchLeafNodes( WPcaDetectOctNode* node, vector<WPcaDetectOctNode*>* leafNodes );
+
+    /**
+     * Adds colored voxels to the voxel mesher. It draws nodes that can have leaf nodes.
      * \param node Node to export to the triangle mesh.
-     * \param outputMesh Triangle mesh where the isotropic threshold of voxels should be 
-     * depicted.
      */
-    void drawNode( WPcaDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh );
+    void drawNode( WPcaDetectOctNode* node );
 
     /**
-     * Draws a colored voxel into the output triangle mesh. It draws only leaf nodes.
+     * Adds a colored voxel to the voxel mesher. It draws only leaf nodes.
      * \param node Node to export to the triangle mesh.
-     * \param outputMesh Triangle mesh where the isotropic threshold of voxels should be 
-     * depicted.
      */
-    void drawLeafNode( WPcaDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh );
+    void drawLeafNode( WPcaDetectOctNode* node );
 
     /**
      * Calculates a color for a drawable leaf node. The color depends on the quotient of
@@ -152,6 +163,11 @@ private:
      * Minimal point amount per voxel to draw. Voxels below that amount aren't drawn.
      */
     size_t m_minPointsPerVoxelToDraw;
+
+    /**
+     * Converts the drawn voxels to the output triangle mesh.
+     */
+    WVoxelMesher m_voxelMesher;
 };
 
 #endif  // WPCADETECTOR_H
@@ -28,14 +28,12 @@
 
 WPcaDetectOctNode::WPcaDetectOctNode()
 {
-    m_inputPoints = new vector<WPosition>();
     m_hasEigenValueQuotient = false;
 }
 
 WPcaDetectOctNode::WPcaDetectOctNode( double centerX, double centerY, double centerZ, double radius ) :
         WOctNode( centerX, centerY, centerZ, radius )
 {
-    m_inputPoints = new vector<WPosition>();
     m_hasEigenValueQuotient = false;
 }
 
@@ -50,12 +48,12 @@ WOctNode* WPcaDetectOctNode::newInstance( double centerX, double centerY, double
 
 void WPcaDetectOctNode::onTouchPosition( double x, double y, double z )
 {
-    m_inputPoints->push_back( WPosition( x, y, z ) );
+    m_moments.addPoint( x, y, z );
 }
 
-vector<WPosition>* WPcaDetectOctNode::getInputPoints()
+const WCovarianceMoments& WPcaDetectOctNode::getMoments()
 {
-    return m_inputPoints;
+    return m_moments;
 }
 
 void WPcaDetectOctNode::setEigenValueQuotient( double eigenValueQuotient )
@@ -73,9 +71,3 @@ bool WPcaDetectOctNode::hasEigenValueQuotient()
 {
     return m_hasEigenValueQuotient;
 }
-
-void WPcaDetectOctNode::clearInputData()
-{
-    m_inputPoints->resize( 0 );
-    m_inputPoints->reserve( 0 );
-}
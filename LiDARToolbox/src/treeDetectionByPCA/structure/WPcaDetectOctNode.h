@@ -27,13 +27,15 @@
 #define WPCADETECTOCTNODE_H
 #include <vector>
 #include "../../common/datastructures/octree/WOctNode.h"
+#include "../../common/math/covariance/WCovarianceMoments.h"
 #include "core/common/math/linearAlgebra/WPosition.h"
 #include "core/dataHandler/WDataSetPoints.h"
 
 using std::vector;
 
 /**
- * Voxel Node type that holds an additional color parameter and input data point set.
+ * Voxel Node type that holds an additional color parameter and the running covariance 
+ * moments of the input data points.
  */
 class WPcaDetectOctNode : public WOctNode
 {
@@ -70,7 +72,7 @@ public:
     virtual WOctNode* newInstance( double centerX, double centerY, double centerZ, double radius );
 
     /**
-     * Adds a point to the inpuz data set.
+     * Adds a point to the covariance moments.
      * This method is executed every time when this node is touched.
      * \param x X coordinate of the new point.
      * \param y Y coordinate of the new point.
@@ -79,10 +81,11 @@ public:
     virtual void onTouchPosition( double x, double y, double z );
 
     /**
-     * Returns input data points. covered by the node's area.
-     * \return Input point data set.
+     * Returns the covariance moments of the input data points covered by the node's 
+     * area.
+     * \return Covariance moments of the input points.
      */
-    vector<WPosition>* getInputPoints();
+    const WCovarianceMoments& getMoments();
 
     /**
      * Sets the node color.
@@ -119,17 +122,11 @@ public:
      */
     bool hasEigenValueQuotient();
 
-    /**
-     * Clears the input point data. It mainly frees space after the Principal
-     * Component Analysis.
-     */
-    void clearInputData();
-
 private:
     /**
-     * Input data set points covered by that node.
+     * Covariance moments of the input data set points covered by that node.
      */
-    vector<WPosition>* m_inputPoints;
+    WCovarianceMoments m_moments;
 
     /**
      * Quotient of the smallest Eigen Value over the biggest.
@@ -115,7 +115,10 @@ boost::shared_ptr< WDataSetPoints > WPCAWallDetector::getOutlinePoints( WDataSet
 boost::shared_ptr< WTriangleMesh > WPCAWallDetector::getOutline()
 {
     boost::shared_ptr< WTriangleMesh > tmpMesh( new WTriangleMesh( 0, 0 ) );
+    m_voxelMesher.setVoxelWidth( m_analyzableOctree->getDetailLevel() * 2.0 );
     drawNode( static_cast<WWallDetectOctNode*>( m_analyzableOctree->getRootNode() ), tmpMesh );
+    m_voxelMesher.addToMesh( tmpMesh );
+    m_voxelMesher.clear();
     return tmpMesh;
 }
 
@@ -130,7 +133,7 @@ void WPCAWallDetector::drawNode( WWallDetectOctNode* node, boost::shared_ptr< WT
             return;
 
         if( m_voxelOutlineMode == 0 )
-            drawLeafNodeCube( node, outputMesh );
+            drawLeafNodeCube( node );
         if( m_voxelOutlineMode == 1 )
             drawLeafNodeNormalVector( node, outputMesh );
     }
@@ -142,49 +145,20 @@ void WPCAWallDetector::drawNode( WWallDetectOctNode* node, boost::shared_ptr< WT
     }
 }
 
-void WPCAWallDetector::drawLeafNodeCube( WWallDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh )
+void WPCAWallDetector::drawLeafNodeCube( WWallDetectOctNode* node )
 {
-    size_t index = outputMesh->vertSize();
     osg::Vec4 color = osg::Vec4(
             WOctree::calcColor( node->getGroupNr(), 0 ),
             WOctree::calcColor( node->getGroupNr(), 1 ),
             WOctree::calcColor( node->getGroupNr(), 2 ), 1.0 );
-    for( size_t vertex = 0; vertex <= 8; vertex++ )
-    {
-        double iX = vertex % 2;
-        double iY = ( vertex / 2 ) % 2;
-        double iZ = ( vertex / 4 ) % 2;
-        double x = node->getCenter( 0 ) + node->getRadius() * ( iX * 2.0 - 1.0 );
-        double y = node->getCenter( 1 ) + node->getRadius() * ( iY * 2.0 - 1.0 );
-        double z = node->getCenter( 2 ) + node->getRadius() * ( iZ * 2.0 - 1.0 );
-        outputMesh->addVertex( x, y, z );
-        outputMesh->setVertexColor( index+vertex, color );
-    }
-    // Z = 0
-    outputMesh->addTriangle( index + 0, index + 2, index + 1 );
-    outputMesh->addTriangle( index + 3, index + 1, index + 2 );
-    // X = 0
-    outputMesh->addTriangle( index + 0, index + 4, index + 2 );
-    outputMesh->addTriangle( index + 4, index + 6, index + 2 );
-    // Y = 0
-    outputMesh->addTriangle( index + 0, index + 1, index + 4 );
-    outputMesh->addTriangle( index + 1, index + 5, index + 4 );
-    // Z = 1
-    outputMesh->addTriangle( index + 4, index + 5, index + 6 );
-    outputMesh->addTriangle( index + 5, index + 7, index + 6 );
-    // X = 1
-    outputMesh->addTriangle( index + 1, index + 3, index + 5 );
-    outputMesh->addTriangle( index + 3, index + 7, index + 5 );
-    // Y = 1
-    outputMesh->addTriangle( index + 2, index + 6, index + 3 );
-    outputMesh->addTriangle( index + 6, index + 7, index + 3 );
+    m_voxelMesher.addVoxel( node->getCenter( 0 ), node->getCenter( 1 ), node->getCenter( 2 ), color );
 }
 
 void WPCAWallDetector::drawLeafNodeNormalVector( WWallDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh )
 {
     if( !node->hasEigenValuesAndVectors() )
     {
-        drawLeafNodeCube( node, outputMesh );
+        drawLeafNodeCube( node );
         return;
     }
 
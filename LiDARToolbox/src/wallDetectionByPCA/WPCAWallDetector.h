@@ -31,6 +31,7 @@
 #include "core/dataHandler/WDataSetPoints.h"
 #include "../common/datastructures/quadtree/WQuadNode.h"
 #include "../common/datastructures/quadtree/WQuadTree.h"
+#include "../common/algorithms/voxelMesher/WVoxelMesher.h"
 #include "structure/WWallDetectOctree.h"
 #include "structure/WWallDetectOctNode.h"
 #include "core/common/math/principalComponentAnalysis/WPrincipalComponentAnalysis.h"
@@ -123,11 +124,11 @@ public:
 
 private:
     /**
-     * Draws a leaf node as a voxel on the output triangle mesh.
+     * Adds a leaf node as a voxel to the voxel mesher. The voxels are put into the 
+     * output triangle mesh by getOutline().
      * \param node Leaf node to draw.
-     * \param outputMesh The output triangle mesh to draw a voxel.
      */
-    void drawLeafNodeCube( WWallDetectOctNode* node, boost::shared_ptr< WTriangleMesh > outputMesh );
+    void drawLeafNodeCube( WWallDetectOctNode* node );
 
     /**
      * Draws a voxel using a rhomb. It Displays the node group, Eigen Vectors, Eigen
@@ -173,6 +174,11 @@ private:
      *    Values and the mean coordinate of input points.
      */
     size_t m_voxelOutlineMode;
+
+    /**
+     * Converts the voxels of the voxel outline mode 0 to the output triangle mesh.
+     */
+    WVoxelMesher m_voxelMesher;
 };
 
 #endif  // WPCAWALLDETECTOR_H